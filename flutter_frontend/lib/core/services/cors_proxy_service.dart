@@ -1,6 +1,7 @@
 import 'dart:async';
 import 'dart:convert';
 import 'dart:io';
+import 'dart:math';
 import 'package:flutter/foundation.dart';
 import 'package:http/http.dart' as http;
 import '../exceptions/feed_validation_exception.dart';
@@ -34,6 +35,62 @@ class CorsProxyConfig {
   }
 }
 
+/// Passive health of one proxy, updated by every request made through it
+class _ProxyStats {
+  /// Weight of the newest sample in the moving averages
+  static const double _alpha = 0.3;
+
+  /// Latency assumed before the first sample so unmeasured proxies get tried
+  static const double _priorLatencyMs = 1500;
+
+  double? latencyMs;
+  double errorRate = 0;
+  int consecutiveFailures = 0;
+  DateTime? lastSampleAt;
+  DateTime? coolingUntil;
+
+  void record(double elapsedMs, {required bool success}) {
+    final now = DateTime.now();
+    lastSampleAt = now;
+    final previous = latencyMs;
+    latencyMs = previous == null ? elapsedMs : previous + _alpha * (elapsedMs - previous);
+    errorRate += _alpha * ((success ? 0 : 1) - errorRate);
+    if (success) {
+      consecutiveFailures = 0;
+      coolingUntil = null;
+    } else {
+      consecutiveFailures++;
+      if (consecutiveFailures >= 2) coolingUntil = now.add(_cooldown());
+    }
+  }
+
+  /// A timeout costs the whole budget and benches the proxy immediately
+  void recordTimeout(Duration timeout) {
+    record(timeout.inMilliseconds.toDouble(), success: false);
+    coolingUntil = DateTime.now().add(_cooldown());
+  }
+
+  /// 30 s after the first failure, doubling up to 10 minutes
+  Duration _cooldown() =>
+      Duration(seconds: min(30 << min(max(consecutiveFailures - 1, 0), 5), 600));
+
+  bool isCooling(DateTime now) => coolingUntil != null && now.isBefore(coolingUntil!);
+
+  bool isStale(DateTime now, Duration maxAge) =>
+      lastSampleAt == null || now.difference(lastSampleAt!) > maxAge;
+
+  bool isHealthy(DateTime now) =>
+      lastSampleAt != null && !isCooling(now) && errorRate < 0.5;
+
+  /// Expected cost of a request: latency inflated by the chance of retrying
+  double get score => (latencyMs ?? _priorLatencyMs) / max(1 - errorRate, 0.05);
+
+  @override
+  String toString() => latencyMs == null
+      ? 'unmeasured'
+      : '${latencyMs!.round()}ms, ${(errorRate * 100).round()}% errors';
+}
+
 /// Service to handle CORS proxy functionality for web RSS feed access
 class CorsProxyService {
   static CorsProxyService? _instance;
@@ -41,7 +98,15 @@ class CorsProxyService {
   
   CorsProxyService._();
 
-  final Map<String, bool> _proxyHealthStatus = {};
+  /// Local caching gateway (linux/gateway/cors_gateway.cc) tried before the
+  /// public proxies, e.g. --dart-define=CORS_GATEWAY_URL=http://localhost:8787
+  static const String _gatewayUrl = String.fromEnvironment('CORS_GATEWAY_URL');
+
+  /// Proxies scoring within this factor of the best share the load
+  static const double _nearBestFactor = 2.0;
+
+  final Map<String, _ProxyStats> _proxyStats = {};
+  final Random _random = Random();
   Timer? _healthCheckTimer;
   CorsProxyConfig _config = CorsProxyConfig.defaults();
 
@@ -51,11 +116,16 @@ class CorsProxyService {
       // Get proxy configuration from Firebase Remote Config
       await _loadProxyConfig();
       
-      // Start health check timer
-      _startHealthCheckTimer();
-      
-      // Initial health check for all proxies
-      await _performHealthCheck();
+      if (hasGateway) {
+        // Public proxies are only a fallback; check them lazily on failure
+        debugPrint('CorsProxyService: Using CORS gateway at $_gatewayUrl');
+      } else {
+        // Start health check timer
+        _startHealthCheckTimer();
+
+        // Initial health check for all proxies
+        await _performHealthCheck();
+      }
       
       debugPrint('CorsProxyService: Initialized successfully');
     } catch (e) {
@@ -86,19 +156,21 @@ class CorsProxyService {
     });
   }
 
-  /// Perform health check on all proxy services
+  List<String> get _allProxies => [_config.primaryProxyUrl, ..._config.fallbackProxyUrls];
+
+  _ProxyStats _statsFor(String proxy) => _proxyStats.putIfAbsent(proxy, () => _ProxyStats());
+
+  /// Probe, concurrently, the proxies real traffic has not measured recently
   Future<void> _performHealthCheck() async {
-    final allProxies = [_config.primaryProxyUrl, ..._config.fallbackProxyUrls];
-    
-    for (final proxy in allProxies) {
-      try {
-        final isHealthy = await _checkProxyHealth(proxy);
-        _proxyHealthStatus[proxy] = isHealthy;
-        debugPrint('CorsProxyService: Proxy $proxy health: $isHealthy');
-      } catch (e) {
-        _proxyHealthStatus[proxy] = false;
-        debugPrint('CorsProxyService: Proxy $proxy health check failed: $e');
-      }
+    final now = DateTime.now();
+    final stale = _allProxies
+        .where((proxy) => _statsFor(proxy).isStale(now, _config.healthCheckInterval))
+        .toList();
+    if (stale.isEmpty) return;
+
+    await Future.wait(stale.map(_checkProxyHealth));
+    for (final proxy in stale) {
+      debugPrint('CorsProxyService: Proxy $proxy health: ${_statsFor(proxy)}');
     }
   }
 
@@ -106,37 +178,62 @@ class CorsProxyService {
   Future<bool> _checkProxyHealth(String proxyUrl) async {
     try {
       // Use a simple test URL to check proxy health
-      final testUrl = 'https://httpbin.org/status/200';
-      final proxiedUrl = _wrapUrlWithProxy(testUrl, proxyUrl);
-      
-      final response = await http.get(
-        Uri.parse(proxiedUrl),
-        headers: {'User-Agent': 'ModernDashboard/1.0'},
-      ).timeout(_config.proxyTimeout);
-      
+      final response = await _proxiedGet('https://httpbin.org/status/200', proxyUrl);
       return response.statusCode == 200;
     } catch (e) {
       return false;
     }
   }
 
+  /// GET [url] through [proxy], feeding the outcome into the proxy's stats
+  Future<http.Response> _proxiedGet(String url, String proxy) async {
+    final stats = _statsFor(proxy);
+    final stopwatch = Stopwatch()..start();
+    try {
+      final response = await http.get(
+        Uri.parse(_wrapUrlWithProxy(url, proxy)),
+        headers: {
+          'User-Agent': 'ModernDashboard/1.0',
+          'Accept': 'application/rss+xml, application/atom+xml, application/xml, text/xml',
+        },
+      ).timeout(_config.proxyTimeout);
+      // Other 4xx answers are the feed's fault, not the proxy's
+      final code = response.statusCode;
+      final proxyFault = code == 403 || code == 405 || code == 429 || code >= 500;
+      stats.record(stopwatch.elapsedMilliseconds.toDouble(), success: !proxyFault);
+      return response;
+    } on TimeoutException {
+      stats.recordTimeout(_config.proxyTimeout);
+      rethrow;
+    } catch (_) {
+      stats.record(stopwatch.elapsedMilliseconds.toDouble(), success: false);
+      rethrow;
+    }
+  }
+
   /// Get the best available proxy URL
+  ///
+  /// Proxies that are not cooling down after failures and score close to the
+  /// best one are candidates; two of them are drawn at random and the better
+  /// one wins, so load spreads without straying from the fast proxies.
   String? _getBestProxy() {
-    // Check primary proxy first
-    if (_proxyHealthStatus[_config.primaryProxyUrl] == true) {
-      return _config.primaryProxyUrl;
-    }
-    
-    // Check fallback proxies
-    for (final proxy in _config.fallbackProxyUrls) {
-      if (_proxyHealthStatus[proxy] == true) {
-        return proxy;
-      }
-    }
-    
-    // If no proxy is marked as healthy, return primary proxy
-    // (might be first run before health check completed)
-    return _config.primaryProxyUrl;
+    final now = DateTime.now();
+    var candidates = _allProxies.where((proxy) => !_statsFor(proxy).isCooling(now)).toList();
+    // Everything failed recently; try whichever scores best anyway
+    if (candidates.isEmpty) candidates = _allProxies;
+
+    final best = candidates.map((proxy) => _statsFor(proxy).score).reduce(min);
+    candidates = candidates
+        .where((proxy) => _statsFor(proxy).score <= best * _nearBestFactor)
+        .toList();
+    if (candidates.length == 1) return candidates.first;
+
+    final i = _random.nextInt(candidates.length);
+    var j = _random.nextInt(candidates.length - 1);
+    if (j >= i) j++;
+    final a = candidates[i];
+    final b = candidates[j];
+    return _statsFor(a).score <= _statsFor(b).score ? a : b;
   }
 
   /// Wrap a URL with proxy prefix based on proxy type
@@ -150,6 +247,29 @@ class CorsProxyService {
     }
   }
 
+  /// Whether a local CORS gateway is configured
+  bool get hasGateway => _gatewayUrl.isNotEmpty;
+
+  /// Fetch the raw body of [url] through the local gateway
+  Future<String> _fetchViaGateway(String url) async {
+    final stopwatch = Stopwatch()..start();
+    final response = await http.get(
+      Uri.parse('$_gatewayUrl/fetch?url=${Uri.encodeComponent(url)}'),
+    ).timeout(_config.proxyTimeout);
+    stopwatch.stop();
+
+    if (response.statusCode != 200) {
+      throw FeedValidationException.serverError(
+        url,
+        response.statusCode,
+        statusMessage: response.body,
+      );
+    }
+    debugPrint('CorsProxyService: Gateway ${response.headers['x-cache'] ?? '-'} '
+        '${stopwatch.elapsedMilliseconds}ms for $url');
+    return response.body;
+  }
+
   /// Test URL accessibility with proxy
   Future<void> testWithProxy(String url) async {
     if (!kIsWeb) {
@@ -159,6 +279,24 @@ class CorsProxyService {
       );
     }
 
+    if (hasGateway) {
+      try {
+        final content = (await _fetchViaGateway(url)).toLowerCase();
+        if (content.contains('<rss') ||
+            content.contains('<feed') ||
+            content.contains('<atom') ||
+            content.contains('<?xml')) {
+          return;
+        }
+        throw FeedValidationException.notRssFeed(url);
+      } on FeedValidationException catch (e) {
+        if (e.code == 'not_rss_feed') rethrow;
+        debugPrint('CorsProxyService: Gateway failed for $url, trying public proxies: $e');
+      } catch (e) {
+        debugPrint('CorsProxyService: Gateway failed for $url, trying public proxies: $e');
+      }
+    }
+
     final proxy = _getBestProxy();
     if (proxy == null) {
       throw FeedValidationException.networkError(
@@ -168,14 +306,7 @@ class CorsProxyService {
     }
 
     try {
-      final proxiedUrl = _wrapUrlWithProxy(url, proxy);
-      final response = await http.get(
-        Uri.parse(proxiedUrl),
-        headers: {
-          'User-Agent': 'ModernDashboard/1.0',
-          'Accept': 'application/rss+xml, application/atom+xml, application/xml, text/xml',
-        },
-      ).timeout(_config.proxyTimeout);
+      final response = await _proxiedGet(url, proxy);
 
       if (response.statusCode == 200) {
         // Basic validation that this looks like RSS/Atom content
@@ -218,24 +349,15 @@ class CorsProxyService {
       );
     }
 
-    // Try all available proxies, starting with the best one
-    final allProxies = [
-      if (_getBestProxy() != null) _getBestProxy()!,
-      ..._config.fallbackProxyUrls.where((proxy) => proxy != _getBestProxy()),
-    ];
+    // Try every proxy, best scoring first
+    final allProxies = _allProxies
+      ..sort((a, b) => _statsFor(a).score.compareTo(_statsFor(b).score));
 
     Exception? lastException;
 
     for (final proxy in allProxies) {
       try {
-        final proxiedUrl = _wrapUrlWithProxy(url, proxy);
-        final response = await http.get(
-          Uri.parse(proxiedUrl),
-          headers: {
-            'User-Agent': 'ModernDashboard/1.0',
-            'Accept': 'application/rss+xml, application/atom+xml, application/xml, text/xml',
-          },
-        ).timeout(_config.proxyTimeout);
+        final response = await _proxiedGet(url, proxy);
 
         if (response.statusCode == 200) {
           final content = response.body.toLowerCase();
@@ -243,14 +365,11 @@ class CorsProxyService {
               content.contains('<feed') || 
               content.contains('<atom') ||
               content.contains('<?xml')) {
-            // Update proxy health status on success
-            _proxyHealthStatus[proxy] = true;
             return;
           } else {
             throw FeedValidationException.notRssFeed(url);
           }
         } else {
-          _proxyHealthStatus[proxy] = false;
           lastException = FeedValidationException.serverError(
             url, 
             response.statusCode,
@@ -258,7 +377,6 @@ class CorsProxyService {
           );
         }
       } catch (e) {
-        _proxyHealthStatus[proxy] = false;
         lastException = e is Exception ? e : Exception(e.toString());
         continue;
       }
@@ -281,6 +399,14 @@ class CorsProxyService {
 
   /// Fetch RSS content through proxy
   Future<String> fetchWithProxy(String url) async {
+    if (hasGateway) {
+      try {
+        return await _fetchViaGateway(url);
+      } catch (e) {
+        debugPrint('CorsProxyService: Gateway failed for $url, trying public proxies: $e');
+      }
+    }
+
     final proxy = _getBestProxy();
     if (proxy == null) {
       throw FeedValidationException.networkError(
@@ -290,14 +416,7 @@ class CorsProxyService {
     }
 
     try {
-      final proxiedUrl = _wrapUrlWithProxy(url, proxy);
-      final response = await http.get(
-        Uri.parse(proxiedUrl),
-        headers: {
-          'User-Agent': 'ModernDashboard/1.0',
-          'Accept': 'application/rss+xml, application/atom+xml, application/xml, text/xml',
-        },
-      ).timeout(_config.proxyTimeout);
+      final response = await _proxiedGet(url, proxy);
 
       if (response.statusCode == 200) {
         String content = response.body;
@@ -333,13 +452,19 @@ class CorsProxyService {
   }
 
   /// Get proxy health status for debugging
-  Map<String, bool> get proxyHealthStatus => Map.from(_proxyHealthStatus);
+  Map<String, bool> get proxyHealthStatus {
+    final now = DateTime.now();
+    return {
+      for (final entry in _proxyStats.entries)
+        if (entry.value.lastSampleAt != null) entry.key: entry.value.isHealthy(now),
+    };
+  }
 
   /// Get current proxy configuration
   CorsProxyConfig get config => _config;
 
   /// Check if any proxy is currently healthy
-  bool get hasHealthyProxy => _proxyHealthStatus.values.any((isHealthy) => isHealthy);
+  bool get hasHealthyProxy => proxyHealthStatus.values.any((isHealthy) => isHealthy);
 
   /// Dispose resources
   void dispose() {
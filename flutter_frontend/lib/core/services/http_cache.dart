@@ -0,0 +1,585 @@
+import 'dart:async';
+import 'dart:collection';
+import 'dart:convert';
+import 'dart:math';
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+import 'package:http/http.dart' as http;
+import 'network_warmup.dart';
+
+/// Shared private HTTP cache following RFC 9111.
+///
+/// Use [client] wherever `http.get` was used. GET responses are stored with
+/// their headers and served without a request while fresh (`max-age`,
+/// `Expires`, or the Last-Modified heuristic). Stale entries are revalidated
+/// with `If-None-Match` / `If-Modified-Since`, and a 304 only refreshes the
+/// stored headers. `Vary` is honoured for one variant per URL. When the
+/// network fails, a stale entry is served within its `stale-if-error`
+/// window, or for up to [maxOfflineStaleness] unless the response forbids
+/// serving it stale. The same applies to 5xx responses, but only within
+/// `stale-if-error`. A request that runs past the deadline set with
+/// [timeoutHeaders] counts as a network failure. Concurrent requests for the
+/// same resource share one fetch.
+///
+/// Bodies live in the runner's disk store (`modern_dashboard/http_cache`,
+/// see linux/runner/http_cache_store.h), so they survive restarts. On the
+/// web and on runners without the store a bounded in-memory store is used.
+/// Served responses carry an `x-http-cache` header: HIT, REVALIDATED, MISS
+/// or STALE.
+class HttpCache {
+  static HttpCache? _instance;
+  static HttpCache get instance => _instance ??= HttpCache._shared();
+
+  HttpCache._(this._network, this._store);
+
+  HttpCache._shared()
+      : this._(null, kIsWeb ? _MemoryCacheStore(16 << 20) : _NativeCacheStore());
+
+  /// A cache of its own in memory that fetches through [network], for tests
+  @visibleForTesting
+  factory HttpCache.over(http.Client network) =>
+      HttpCache._(network, _MemoryCacheStore(16 << 20));
+
+  /// Longest a stale response is served while the network is unreachable
+  static const Duration maxOfflineStaleness = Duration(days: 7);
+
+  /// Larger bodies are passed through without being stored
+  static const int _maxBodyBytes = 8 << 20;
+
+  /// Status codes that may be stored without explicit freshness
+  static const Set<int> _heuristicallyCacheable = {
+    200, 203, 204, 300, 301, 308, 404, 405, 410, 414, 501,
+  };
+
+  /// Request header carrying the deadline in milliseconds; never forwarded
+  static const String _timeoutHeader = 'x-http-cache-timeout';
+
+  /// Where misses go; the warmed-up client when null
+  final http.Client? _network;
+  final _CacheStore _store;
+  final Map<String, Future<http.Response>> _inflight = {};
+
+  int _hits = 0;
+  int _revalidated = 0;
+  int _misses = 0;
+  int _stale = 0;
+
+  /// Client that answers GET requests through the cache. Other methods go
+  /// straight to the network and invalidate the cached URL on success.
+  late final http.Client client = _CachingClient(this, _network ?? NetworkWarmup.instance.client);
+
+  /// Headers that make [client] give up on the origin after [timeout]. Past
+  /// it a stale entry is served as if offline, otherwise the request fails
+  /// with a [TimeoutException].
+  static Map<String, String> timeoutHeaders(Duration timeout) =>
+      {_timeoutHeader: '${timeout.inMilliseconds}'};
+
+  /// When a response returned by [client] stops being fresh
+  static DateTime freshUntil(http.Response response) {
+    final now = DateTime.now();
+    final entry = _CacheEntry.fromResponse(response, now, now);
+    return now.add(entry.freshnessLifetime - entry.currentAge(now));
+  }
+
+  /// Hit and revalidation counters for the debug panel
+  Map<String, int> get stats => {
+        'hits': _hits,
+        'revalidated': _revalidated,
+        'misses': _misses,
+        'stale': _stale,
+      };
+
+  /// Entry, byte and eviction counters of the disk store
+  Future<Map<String, dynamic>?> storeStats() => _store.stats();
+
+  Future<http.Response> _get(http.BaseRequest request, http.Client inner) async {
+    final requestDirectives = _directives(request.headers['cache-control']);
+    if (requestDirectives.containsKey('no-store')) {
+      return _send(inner, request, timeout: _timeout(request));
+    }
+
+    final key = request.url.toString();
+    var entry = await _load(key);
+    if (entry != null && !entry.matchesVary(request.headers)) entry = null;
+
+    final now = DateTime.now();
+    if (entry != null &&
+        !requestDirectives.containsKey('no-cache') &&
+        entry.isFresh(now, requestDirectives)) {
+      _hits++;
+      return entry.toResponse('HIT', request, now);
+    }
+    if (requestDirectives.containsKey('only-if-cached')) {
+      return http.Response('', 504, request: request, headers: {'x-http-cache': 'MISS'});
+    }
+
+    final flightKey = '$key\n${_headerSignature(request.headers)}';
+    return _inflight[flightKey] ??= _fetch(key, request, entry, inner)
+        .whenComplete(() => _inflight.remove(flightKey));
+  }
+
+  Future<http.Response> _fetch(
+    String key,
+    http.BaseRequest request,
+    _CacheEntry? entry,
+    http.Client inner,
+  ) async {
+    final forward = _copy(request);
+    final etag = entry?.headers['etag'];
+    final lastModified = entry?.headers['last-modified'];
+    if (etag != null) forward.headers['if-none-match'] = etag;
+    if (lastModified != null) forward.headers['if-modified-since'] = lastModified;
+
+    final requestTime = DateTime.now();
+    final http.Response response;
+    try {
+      response = await _send(inner, forward, timeout: _timeout(request));
+    } catch (e) {
+      final now = DateTime.now();
+      if (entry != null && entry.mayServeStale(now, disconnected: true)) {
+        _stale++;
+        debugPrint('HttpCache: Serving stale $key while offline: $e');
+        return entry.toResponse('STALE', request, now);
+      }
+      rethrow;
+    }
+    final responseTime = DateTime.now();
+
+    if (response.statusCode == 304 && entry != null) {
+      entry.freshen(response.headers, requestTime, responseTime);
+      unawaited(_store.updateMeta(key, entry.toMeta()));
+      _revalidated++;
+      return entry.toResponse('REVALIDATED', request, responseTime);
+    }
+    if (response.statusCode >= 500 &&
+        entry != null &&
+        entry.mayServeStale(responseTime, disconnected: false)) {
+      _stale++;
+      return entry.toResponse('STALE', request, responseTime);
+    }
+
+    _misses++;
+    final fresh = _CacheEntry.fromResponse(response, requestTime, responseTime,
+        requestHeaders: request.headers);
+    if (_isStorable(response, _directives(request.headers['cache-control']))) {
+      unawaited(_store.put(key, fresh.toMeta(), response.bodyBytes));
+    } else if (entry != null &&
+        _directives(response.headers['cache-control']).containsKey('no-store')) {
+      // Anything else that is not stored leaves the entry to be served stale
+      unawaited(_store.remove(key));
+    }
+    return fresh.toResponse('MISS', request, responseTime);
+  }
+
+  bool _isStorable(http.Response response, Map<String, String?> requestDirectives) {
+    if (requestDirectives.containsKey('no-store')) return false;
+    if (_directives(response.headers['cache-control']).containsKey('no-store')) return false;
+    if (response.headers['vary']?.trim() == '*') return false;
+    if (response.bodyBytes.length > _maxBodyBytes) return false;
+    return _heuristicallyCacheable.contains(response.statusCode);
+  }
+
+  Future<_CacheEntry?> _load(String key) async {
+    final stored = await _store.get(key);
+    if (stored == null) return null;
+    final entry = _CacheEntry.fromStored(stored.meta, stored.body);
+    if (entry == null) unawaited(_store.remove(key));
+    return entry;
+  }
+
+  /// Drop the stored response for [url] (RFC 9111 §4.4)
+  Future<void> invalidate(Uri url) => _store.remove(url.toString());
+
+  /// The response to [request], or a [TimeoutException] once [timeout] has
+  /// passed without the full body
+  static Future<http.Response> _send(
+    http.Client inner,
+    http.BaseRequest request, {
+    Duration? timeout,
+  }) {
+    final response = inner.send(_copy(request)).then(http.Response.fromStream);
+    return timeout == null ? response : response.timeout(timeout);
+  }
+
+  static Duration? _timeout(http.BaseRequest request) {
+    final milliseconds = int.tryParse(request.headers[_timeoutHeader] ?? '');
+    return milliseconds == null ? null : Duration(milliseconds: max(milliseconds, 0));
+  }
+
+  static http.Request _copy(http.BaseRequest request) {
+    return http.Request('GET', request.url)
+      ..headers.addAll(request.headers)
+      ..headers.remove(_timeoutHeader)
+      ..followRedirects = request.followRedirects
+      ..maxRedirects = request.maxRedirects
+      ..persistentConnection = request.persistentConnection;
+  }
+
+  static String _headerSignature(Map<String, String> headers) {
+    final names = headers.keys
+        .map((name) => name.toLowerCase())
+        .where((name) => name != _timeoutHeader)
+        .toList()
+      ..sort();
+    return names.map((name) => '$name:${headers[name]}').join('\n');
+  }
+}
+
+class _CachingClient extends http.BaseClient {
+  final HttpCache _cache;
+  final http.Client _inner;
+
+  _CachingClient(this._cache, this._inner);
+
+  @override
+  Future<http.StreamedResponse> send(http.BaseRequest request) async {
+    if (request.method != 'GET') {
+      request.headers.remove(HttpCache._timeoutHeader);
+      final response = await _inner.send(request);
+      if (request.method != 'HEAD' && response.statusCode < 400) {
+        unawaited(_cache.invalidate(request.url));
+      }
+      return response;
+    }
+
+    final response = await _cache._get(request, _inner);
+    return http.StreamedResponse(
+      http.ByteStream.fromBytes(response.bodyBytes),
+      response.statusCode,
+      contentLength: response.bodyBytes.length,
+      request: request,
+      headers: response.headers,
+      reasonPhrase: response.reasonPhrase,
+    );
+  }
+}
+
+/// A stored response and what is needed to judge its freshness
+class _CacheEntry {
+  final int statusCode;
+  final String? reasonPhrase;
+  final Map<String, String> headers;
+  final Map<String, String> varyValues;
+  DateTime requestTime;
+  DateTime responseTime;
+  final Uint8List body;
+
+  _CacheEntry({
+    required this.statusCode,
+    required this.reasonPhrase,
+    required this.headers,
+    required this.varyValues,
+    required this.requestTime,
+    required this.responseTime,
+    required this.body,
+  });
+
+  factory _CacheEntry.fromResponse(
+    http.Response response,
+    DateTime requestTime,
+    DateTime responseTime, {
+    Map<String, String> requestHeaders = const {},
+  }) {
+    final headers = {
+      for (final header in response.headers.entries)
+        if (header.key.toLowerCase() != 'x-http-cache') header.key.toLowerCase(): header.value,
+    };
+    final varyValues = <String, String>{};
+    for (final name in (headers['vary'] ?? '').split(',')) {
+      final trimmed = name.trim().toLowerCase();
+      if (trimmed.isNotEmpty) varyValues[trimmed] = _lookup(requestHeaders, trimmed);
+    }
+    return _CacheEntry(
+      statusCode: response.statusCode,
+      reasonPhrase: response.reasonPhrase,
+      headers: headers,
+      varyValues: varyValues,
+      requestTime: requestTime,
+      responseTime: responseTime,
+      body: response.bodyBytes,
+    );
+  }
+
+  static _CacheEntry? fromStored(String meta, Uint8List body) {
+    try {
+      final json = jsonDecode(meta) as Map<String, dynamic>;
+      return _CacheEntry(
+        statusCode: json['status'] as int,
+        reasonPhrase: json['reason'] as String?,
+        headers: Map<String, String>.from(json['headers'] as Map),
+        varyValues: Map<String, String>.from(json['vary'] as Map),
+        requestTime: DateTime.fromMillisecondsSinceEpoch(json['requestTime'] as int),
+        responseTime: DateTime.fromMillisecondsSinceEpoch(json['responseTime'] as int),
+        body: body,
+      );
+    } catch (e) {
+      debugPrint('HttpCache: Discarding unreadable entry: $e');
+      return null;
+    }
+  }
+
+  String toMeta() => jsonEncode({
+        'status': statusCode,
+        'reason': reasonPhrase,
+        'headers': headers,
+        'vary': varyValues,
+        'requestTime': requestTime.millisecondsSinceEpoch,
+        'responseTime': responseTime.millisecondsSinceEpoch,
+      });
+
+  Map<String, String?> get _responseDirectives => _directives(headers['cache-control']);
+
+  DateTime get _dateValue => _parseHttpDate(headers['date']) ?? responseTime;
+
+  /// RFC 9111 §4.2.1; `s-maxage` is for shared caches and ignored here
+  Duration get freshnessLifetime {
+    final maxAge = _seconds(_responseDirectives['max-age']);
+    if (maxAge != null) return Duration(seconds: maxAge);
+
+    final expires = headers['expires'];
+    if (expires != null) {
+      // An invalid Expires means already expired
+      final expiresAt = _parseHttpDate(expires);
+      return expiresAt == null ? Duration.zero : expiresAt.difference(_dateValue);
+    }
+
+    // §4.2.2: a tenth of the time since the last modification, capped at a day
+    final lastModified = _parseHttpDate(headers['last-modified']);
+    if (lastModified != null && HttpCache._heuristicallyCacheable.contains(statusCode)) {
+      final heuristic = _dateValue.difference(lastModified) * 0.1;
+      if (heuristic.isNegative) return Duration.zero;
+      return heuristic > const Duration(days: 1) ? const Duration(days: 1) : heuristic;
+    }
+    return Duration.zero;
+  }
+
+  /// RFC 9111 §4.2.3
+  Duration currentAge(DateTime now) {
+    final ageValue = Duration(seconds: int.tryParse(headers['age'] ?? '') ?? 0);
+    var apparentAge = responseTime.difference(_dateValue);
+    if (apparentAge.isNegative) apparentAge = Duration.zero;
+    final correctedAgeValue = ageValue + responseTime.difference(requestTime);
+    final correctedInitialAge =
+        apparentAge > correctedAgeValue ? apparentAge : correctedAgeValue;
+    return correctedInitialAge + now.difference(responseTime);
+  }
+
+  bool isFresh(DateTime now, Map<String, String?> requestDirectives) {
+    if (_responseDirectives.containsKey('no-cache')) return false;
+    final age = currentAge(now);
+    final maxAge = _seconds(requestDirectives['max-age']);
+    if (maxAge != null && age > Duration(seconds: maxAge)) return false;
+    final minFresh = _seconds(requestDirectives['min-fresh']) ?? 0;
+    return freshnessLifetime - Duration(seconds: minFresh) > age;
+  }
+
+  /// RFC 9111 §4.2.4 and RFC 5861 `stale-if-error`
+  bool mayServeStale(DateTime now, {required bool disconnected}) {
+    final directives = _responseDirectives;
+    if (directives.containsKey('must-revalidate') || directives.containsKey('no-cache')) {
+      return false;
+    }
+    final staleness = currentAge(now) - freshnessLifetime;
+    final staleIfError = _seconds(directives['stale-if-error']);
+    if (staleIfError != null && staleness <= Duration(seconds: staleIfError)) return true;
+    return disconnected && staleness <= HttpCache.maxOfflineStaleness;
+  }
+
+  bool matchesVary(Map<String, String> requestHeaders) {
+    for (final vary in varyValues.entries) {
+      if (_lookup(requestHeaders, vary.key) != vary.value) return false;
+    }
+    return true;
+  }
+
+  /// Merge the headers of a 304 into the stored response (§4.3.4)
+  void freshen(Map<String, String> notModified, DateTime requestTime, DateTime responseTime) {
+    for (final header in notModified.entries) {
+      final name = header.key.toLowerCase();
+      if (name == 'content-length' || name == 'content-encoding' || name == 'transfer-encoding') {
+        continue;
+      }
+      headers[name] = header.value;
+    }
+    this.requestTime = requestTime;
+    this.responseTime = responseTime;
+  }
+
+  http.Response toResponse(String cacheStatus, http.BaseRequest request, DateTime now) {
+    return http.Response.bytes(
+      body,
+      statusCode,
+      request: request,
+      reasonPhrase: reasonPhrase,
+      headers: {
+        ...headers,
+        'age': '${currentAge(now).inSeconds}',
+        'x-http-cache': cacheStatus,
+      },
+    );
+  }
+
+  static String _lookup(Map<String, String> headers, String name) {
+    for (final header in headers.entries) {
+      if (header.key.toLowerCase() == name) return header.value.trim();
+    }
+    return '';
+  }
+}
+
+/// Cache-Control directives, lower-cased, with unquoted values
+Map<String, String?> _directives(String? header) {
+  final directives = <String, String?>{};
+  if (header == null) return directives;
+  for (final part in header.split(',')) {
+    final directive = part.trim();
+    if (directive.isEmpty) continue;
+    final equals = directive.indexOf('=');
+    if (equals < 0) {
+      directives[directive.toLowerCase()] = null;
+    } else {
+      directives[directive.substring(0, equals).trim().toLowerCase()] =
+          directive.substring(equals + 1).trim().replaceAll('"', '');
+    }
+  }
+  return directives;
+}
+
+int? _seconds(String? value) {
+  final seconds = value == null ? null : int.tryParse(value);
+  return seconds == null ? null : max(seconds, 0);
+}
+
+const List<String> _months = [
+  'jan', 'feb', 'mar', 'apr', 'may', 'jun', 'jul', 'aug', 'sep', 'oct', 'nov', 'dec',
+];
+
+final RegExp _httpDate =
+    RegExp(r'(\d{1,2})[ -]([A-Za-z]{3})[ -](\d{2,4}) (\d{2}):(\d{2}):(\d{2})');
+
+/// IMF-fixdate, or the obsolete RFC 850 form; null when unparseable
+DateTime? _parseHttpDate(String? value) {
+  if (value == null) return null;
+  final match = _httpDate.firstMatch(value);
+  if (match == null) return null;
+  final month = _months.indexOf(match.group(2)!.toLowerCase());
+  if (month < 0) return null;
+  var year = int.parse(match.group(3)!);
+  if (year < 100) year += year < 70 ? 2000 : 1900;
+  return DateTime.utc(
+    year,
+    month + 1,
+    int.parse(match.group(1)!),
+    int.parse(match.group(4)!),
+    int.parse(match.group(5)!),
+    int.parse(match.group(6)!),
+  );
+}
+
+typedef _StoredEntry = ({String meta, Uint8List body});
+
+abstract class _CacheStore {
+  Future<_StoredEntry?> get(String key);
+  Future<void> put(String key, String meta, Uint8List body);
+  Future<void> updateMeta(String key, String meta);
+  Future<void> remove(String key);
+  Future<Map<String, dynamic>?> stats();
+}
+
+/// Bounded least-recently-used store for the web and runners without disk
+class _MemoryCacheStore implements _CacheStore {
+  final int maxBytes;
+  final LinkedHashMap<String, _StoredEntry> _entries = LinkedHashMap();
+  int _bytes = 0;
+
+  _MemoryCacheStore(this.maxBytes);
+
+  @override
+  Future<_StoredEntry?> get(String key) async {
+    final entry = _entries.remove(key);
+    if (entry != null) _entries[key] = entry;
+    return entry;
+  }
+
+  @override
+  Future<void> put(String key, String meta, Uint8List body) async {
+    await remove(key);
+    if (body.length > maxBytes) return;
+    _entries[key] = (meta: meta, body: body);
+    _bytes += body.length;
+    while (_bytes > maxBytes && _entries.isNotEmpty) {
+      await remove(_entries.keys.first);
+    }
+  }
+
+  @override
+  Future<void> updateMeta(String key, String meta) async {
+    final entry = _entries[key];
+    if (entry != null) _entries[key] = (meta: meta, body: entry.body);
+  }
+
+  @override
+  Future<void> remove(String key) async {
+    final entry = _entries.remove(key);
+    if (entry != null) _bytes -= entry.body.length;
+  }
+
+  @override
+  Future<Map<String, dynamic>?> stats() async =>
+      {'entries': _entries.length, 'bytes': _bytes, 'maxBytes': maxBytes};
+}
+
+/// Runner disk store; falls back to memory when the runner lacks it
+class _NativeCacheStore implements _CacheStore {
+  static const MethodChannel _channel = MethodChannel('modern_dashboard/http_cache');
+
+  final _MemoryCacheStore _fallback = _MemoryCacheStore(32 << 20);
+  bool _available = true;
+
+  Future<T?> _invoke<T>(String method, Map<String, Object?> args) async {
+    try {
+      return await _channel.invokeMethod<T>(method, args);
+    } on MissingPluginException {
+      _available = false;
+      debugPrint('HttpCache: No disk store in this runner, caching in memory');
+      return null;
+    } on PlatformException catch (e) {
+      debugPrint('HttpCache: Store $method failed: ${e.message}');
+      return null;
+    }
+  }
+
+  @override
+  Future<_StoredEntry?> get(String key) async {
+    if (!_available) return _fallback.get(key);
+    final result = await _invoke<Map<Object?, Object?>>('get', {'key': key});
+    if (!_available) return _fallback.get(key);
+    if (result == null) return null;
+    return (meta: result['meta'] as String, body: result['body'] as Uint8List);
+  }
+
+  @override
+  Future<void> put(String key, String meta, Uint8List body) async {
+    if (_available) await _invoke<bool>('put', {'key': key, 'meta': meta, 'body': body});
+    if (!_available) await _fallback.put(key, meta, body);
+  }
+
+  @override
+  Future<void> updateMeta(String key, String meta) async {
+    if (_available) await _invoke<bool>('updateMeta', {'key': key, 'meta': meta});
+    if (!_available) await _fallback.updateMeta(key, meta);
+  }
+
+  @override
+  Future<void> remove(String key) async {
+    if (_available) await _invoke<void>('remove', {'key': key});
+    if (!_available) await _fallback.remove(key);
+  }
+
+  @override
+  Future<Map<String, dynamic>?> stats() async {
+    if (!_available) return _fallback.stats();
+    final stats = await _invoke<Map<Object?, Object?>>('getStats', const {});
+    return stats?.map((key, value) => MapEntry(key as String, value));
+  }
+}
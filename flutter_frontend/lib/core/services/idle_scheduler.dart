@@ -0,0 +1,323 @@
+import 'dart:async';
+import 'dart:collection';
+import 'dart:io' show ProcessInfo;
+import 'package:flutter/foundation.dart';
+import 'package:flutter/gestures.dart';
+import 'package:flutter/scheduler.dart';
+import 'package:flutter/services.dart';
+import 'package:flutter/widgets.dart';
+import 'resource_budget_service.dart';
+
+/// Time left in one idle slice
+class IdleDeadline {
+  final Duration budget;
+  final Stopwatch _stopwatch = Stopwatch()..start();
+
+  IdleDeadline._(this.budget);
+
+  Duration get elapsed => _stopwatch.elapsed;
+
+  Duration get timeRemaining {
+    final remaining = budget - _stopwatch.elapsed;
+    return remaining.isNegative ? Duration.zero : remaining;
+  }
+
+  /// The slice is used up; stop at the next safe point and return false
+  bool get didTimeout => _stopwatch.elapsed >= budget;
+}
+
+/// One slice of deferrable work. Do a bounded amount, checking [deadline]
+/// between steps, and return true when finished or false to be called
+/// again in a later slice.
+///
+/// Work that has to wait (file or network I/O, the isolate pool) returns a
+/// future instead, right after starting the wait. Other tasks run while it
+/// is pending; completing with false asks for another call, which again
+/// waits for an idle slice. So a task with several waits is split into
+/// steps, one per call, and only the synchronous part of each step runs
+/// in the slice.
+typedef IdleWork = FutureOr<bool> Function(IdleDeadline deadline);
+
+class _IdleTask {
+  final String key;
+  final IdleWork work;
+  final bool reclaimsMemory;
+  final Duration notBefore;
+  final Duration runBy;
+  final Completer<void> done = Completer<void>();
+
+  _IdleTask(this.key, this.work, this.reclaimsMemory, this.notBefore, this.runBy);
+}
+
+/// Runs deferrable housekeeping (compaction, cleanup, persistence, image
+/// decoding) while the UI is idle, in short slices.
+///
+/// The UI counts as busy while a frame is scheduled or was drawn in the
+/// last [frameQuiet], while a pointer or key event arrived in the last
+/// [inputQuiet], and while anyone holds [holdBusy] (the dashboard does
+/// during a scroll). Each slice runs in its own event-loop turn, so input
+/// that arrives in between is handled first and the frame it schedules
+/// ends the idle period. A task that found no idle period before its
+/// `maxDelay` runs anyway, so a screen that never stops animating cannot
+/// starve it.
+///
+/// Under memory pressure (the engine's signal, or the process's RSS past
+/// [memoryPressureRatio] of the container limit) tasks that reclaim memory
+/// start at once, without waiting for their delay or for the UI.
+class IdleScheduler with WidgetsBindingObserver {
+  static IdleScheduler? _instance;
+  static IdleScheduler get instance => _instance ??= IdleScheduler._();
+
+  IdleScheduler._();
+
+  static const Duration frameQuiet = Duration(milliseconds: 100);
+  static const Duration inputQuiet = Duration(milliseconds: 300);
+
+  /// Most of a 16 ms frame, leaving room for the engine
+  static const Duration sliceBudget = Duration(milliseconds: 8);
+  static const double memoryPressureRatio = 0.85;
+
+  static const Duration _defaultMaxDelay = Duration(minutes: 2);
+  static const Duration _busyRecheck = Duration(milliseconds: 50);
+  static const Duration _pressureHold = Duration(seconds: 30);
+
+  final Stopwatch _clock = Stopwatch()..start();
+
+  /// Waiting tasks by key, in scheduling order
+  final Map<String, _IdleTask> _tasks = {};
+
+  /// Started tasks that asked for another slice, in the order they asked
+  final Queue<_IdleTask> _started = Queue();
+
+  /// Started tasks waiting for a step's future
+  int _awaiting = 0;
+
+  /// Started tasks by key, until they finish
+  final Map<String, _IdleTask> _running = {};
+  final Set<Object> _busyHolders = {};
+  Timer? _timer;
+  Duration _timerDue = Duration.zero;
+  bool _attached = false;
+  Duration _lastFrame = Duration.zero;
+  Duration _lastInput = Duration.zero;
+  Duration? _pressureUntil;
+
+  int _completed = 0;
+  int _slices = 0;
+  int _overruns = 0;
+  int _deferrals = 0;
+  int _forced = 0;
+  int _pressureRuns = 0;
+
+  Map<String, dynamic> get stats => {
+        'pending': _tasks.length + _started.length + _awaiting,
+        'completed': _completed,
+        'slices': _slices,
+        'overruns': _overruns,
+        'deferrals': _deferrals,
+        'forced': _forced,
+        'pressureRuns': _pressureRuns,
+      };
+
+  /// Start watching frames and input; [schedule] does this on first use
+  void initialize() {
+    if (_attached) return;
+    _attached = true;
+    final binding = WidgetsBinding.instance;
+    binding.addObserver(this);
+    binding.addPersistentFrameCallback((_) => _lastFrame = _clock.elapsed);
+    GestureBinding.instance.pointerRouter.addGlobalRoute(_onPointer);
+    HardwareKeyboard.instance.addHandler(_onKey);
+  }
+
+  /// Run [work] in idle slices, no earlier than [delay] from now and no
+  /// later than [maxDelay]. While a task with the same [key] is waiting to
+  /// start, that one is kept and its future returned. While one is running,
+  /// [work] starts only after it has finished, so the two never overlap and
+  /// calls meanwhile share that one follow-up run. [reclaimsMemory] marks
+  /// work that frees memory, which memory pressure runs at once.
+  Future<void> schedule(
+    String key,
+    IdleWork work, {
+    Duration delay = Duration.zero,
+    Duration maxDelay = _defaultMaxDelay,
+    bool reclaimsMemory = false,
+  }) {
+    initialize();
+    final waiting = _tasks[key];
+    if (waiting != null) return waiting.done.future;
+    final now = _clock.elapsed;
+    final task = _IdleTask(key, work, reclaimsMemory, now + delay,
+        now + (maxDelay > delay ? maxDelay : delay));
+    _tasks[key] = task;
+    _wake(delay);
+    return task.done.future;
+  }
+
+  /// Keep deferred work waiting while [owner] is busy, e.g. scrolling
+  void holdBusy(Object owner) => _busyHolders.add(owner);
+
+  void releaseBusy(Object owner) {
+    if (!_busyHolders.remove(owner)) return;
+    _lastInput = _clock.elapsed;
+    _wake(inputQuiet);
+  }
+
+  /// Whether nothing is drawing or being interacted with right now
+  bool get isIdle {
+    final scheduler = SchedulerBinding.instance;
+    if (scheduler.hasScheduledFrame || scheduler.schedulerPhase != SchedulerPhase.idle) {
+      return false;
+    }
+    return _busyHolders.isEmpty && _quietRemaining() == Duration.zero;
+  }
+
+  @override
+  void didHaveMemoryPressure() {
+    _pressureUntil = _clock.elapsed + _pressureHold;
+    _wake();
+  }
+
+  void _onPointer(PointerEvent event) => _lastInput = _clock.elapsed;
+
+  bool _onKey(KeyEvent event) {
+    _lastInput = _clock.elapsed;
+    return false;
+  }
+
+  /// Time until the last frame and input are far enough in the past
+  Duration _quietRemaining() {
+    final now = _clock.elapsed;
+    final frame = frameQuiet - (now - _lastFrame);
+    final input = inputQuiet - (now - _lastInput);
+    final remaining = frame > input ? frame : input;
+    return remaining.isNegative ? Duration.zero : remaining;
+  }
+
+  bool _underMemoryPressure() {
+    final until = _pressureUntil;
+    if (until != null && _clock.elapsed < until) return true;
+    if (kIsWeb) return false;
+    final limit = ResourceBudgetService.instance.budget.memoryLimitBytes;
+    return limit > 0 && ProcessInfo.currentRss > limit * memoryPressureRatio;
+  }
+
+  void _wake([Duration after = Duration.zero]) {
+    final due = _clock.elapsed + after;
+    if (_timer != null && _timerDue <= due) return;
+    _timer?.cancel();
+    _timerDue = due;
+    _timer = Timer(after, _pump);
+  }
+
+  /// A waiting task starts only once the running one with its key is done
+  bool _mayStart(_IdleTask task) => !_running.containsKey(task.key);
+
+  /// Next task to run: reclaiming work under pressure, then started work,
+  /// then overdue work, then the oldest task whose delay has passed
+  _IdleTask? _pick(bool pressure, Duration now) {
+    if (pressure) {
+      for (final task in _started) {
+        if (task.reclaimsMemory) return task;
+      }
+      for (final task in _tasks.values) {
+        if (task.reclaimsMemory && _mayStart(task)) return task;
+      }
+    }
+    if (_started.isNotEmpty) return _started.first;
+    _IdleTask? ready;
+    for (final task in _tasks.values) {
+      if (!_mayStart(task)) continue;
+      if (now >= task.runBy) return task;
+      if (ready == null && now >= task.notBefore) ready = task;
+    }
+    return ready;
+  }
+
+  void _pump() {
+    _timer = null;
+    if (_started.isEmpty && _tasks.isEmpty) return;
+
+    final now = _clock.elapsed;
+    // Sampling RSS is a read of /proc, skipped unless it could matter
+    final reclaimable = _started.followedBy(_tasks.values).any((t) => t.reclaimsMemory);
+    final pressure = reclaimable && _underMemoryPressure();
+    final task = _pick(pressure, now);
+    if (task == null) {
+      // Tasks held back by a running one are woken when it finishes
+      Duration? next;
+      for (final waiting in _tasks.values) {
+        if (!_mayStart(waiting)) continue;
+        if (next == null || waiting.notBefore < next) next = waiting.notBefore;
+      }
+      if (next != null) _wake(next - now);
+      return;
+    }
+
+    final forcedByPressure = pressure && task.reclaimsMemory;
+    final overdue = now >= task.runBy;
+    if (!forcedByPressure && !overdue && !isIdle) {
+      _deferrals++;
+      final quiet = _quietRemaining();
+      _wake(quiet > _busyRecheck ? quiet : _busyRecheck);
+      return;
+    }
+
+    if (!_started.remove(task)) {
+      _tasks.remove(task.key);
+      _running[task.key] = task;
+      if (forcedByPressure) {
+        _pressureRuns++;
+      } else if (overdue) {
+        _forced++;
+      }
+    }
+
+    final deadline = IdleDeadline._(sliceBudget);
+    FutureOr<bool> result;
+    try {
+      result = task.work(deadline);
+    } catch (e) {
+      debugPrint('IdleScheduler: ${task.key} failed: $e');
+      result = true;
+    }
+    // Only the synchronous part blocks the UI isolate
+    final blocked = deadline.elapsed;
+    _slices++;
+    if (blocked > sliceBudget * 2) {
+      _overruns++;
+      debugPrint('IdleScheduler: ${task.key} blocked a slice for '
+          '${blocked.inMicroseconds / 1000} ms');
+    }
+
+    if (result is Future<bool>) {
+      _awaiting++;
+      result.then((finished) => _resume(task, finished), onError: (Object e) {
+        debugPrint('IdleScheduler: ${task.key} failed: $e');
+        _resume(task, true);
+      });
+    } else {
+      _stepDone(task, result);
+    }
+    // Next slice in a later event-loop turn, after any pending input
+    _wake();
+  }
+
+  /// A step's wait is over; its next step waits for an idle slice
+  void _resume(_IdleTask task, bool finished) {
+    _awaiting--;
+    _stepDone(task, finished);
+    if (!finished) _wake();
+  }
+
+  void _stepDone(_IdleTask task, bool finished) {
+    if (finished) {
+      _completed++;
+      _running.remove(task.key);
+      task.done.complete();
+      if (_tasks.containsKey(task.key)) _wake();
+    } else {
+      _started.add(task);
+    }
+  }
+}
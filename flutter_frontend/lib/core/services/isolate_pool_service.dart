@@ -0,0 +1,321 @@
+import 'dart:async';
+import 'dart:collection';
+import 'dart:isolate';
+import 'dart:typed_data';
+import 'package:flutter/foundation.dart';
+import 'resource_budget_service.dart';
+
+/// Scheduling lanes, drained in declaration order
+enum TaskPriority {
+  /// Work the user is waiting on (opening a feed, searching)
+  high,
+
+  /// Regular refreshes
+  normal,
+
+  /// Prefetching and housekeeping
+  low,
+}
+
+/// Counters for the pool, exposed for the debug panel
+class IsolatePoolStats {
+  final int workers;
+  final int submitted;
+  final int completed;
+  final int failed;
+  final int queued;
+  final int inlineRuns;
+
+  const IsolatePoolStats({
+    required this.workers,
+    required this.submitted,
+    required this.completed,
+    required this.failed,
+    required this.queued,
+    required this.inlineRuns,
+  });
+
+  @override
+  String toString() {
+    return 'IsolatePoolStats(workers: $workers, submitted: $submitted, '
+        'completed: $completed, failed: $failed, queued: $queued, '
+        'inline: $inlineRuns)';
+  }
+}
+
+/// Long-lived pool of background isolates for repository-level CPU work
+/// (feed parsing, sanitization, sorting).
+///
+/// Unlike `compute()`, workers are spawned once and reused. Tasks wait on this
+/// isolate in one queue per [TaskPriority] and a worker takes the oldest task
+/// of the highest non-empty lane as soon as it is idle, so one slow feed does
+/// not hold up the tasks queued behind it and no worker runs low-priority work
+/// while high-priority work waits. Byte buffers passed through
+/// [runBytes] move between isolates as [TransferableTypedData] instead of
+/// being copied.
+///
+/// On web, or when built with `--dart-define=ISOLATE_POOL=false`, tasks run
+/// inline on the calling isolate; the latter is the baseline for comparing
+/// UI-isolate time per refresh.
+class IsolatePoolService {
+  static IsolatePoolService? _instance;
+  static IsolatePoolService get instance => _instance ??= IsolatePoolService._();
+
+  IsolatePoolService._();
+
+  static const bool _enabled = bool.fromEnvironment('ISOLATE_POOL', defaultValue: true);
+
+  final List<_PoolWorker> _workers = [];
+  final List<ListQueue<_PoolTask>> _lanes =
+      List.generate(TaskPriority.values.length, (_) => ListQueue<_PoolTask>());
+  final Map<int, _PoolTask> _running = {};
+  Future<void>? _starting;
+  int _nextTaskId = 0;
+  int _submitted = 0;
+  int _completed = 0;
+  int _failed = 0;
+  int _inlineRuns = 0;
+
+  /// Whether tasks run on background isolates
+  bool get isEnabled => _enabled && !kIsWeb;
+
+  IsolatePoolStats get stats => IsolatePoolStats(
+        workers: _workers.length,
+        submitted: _submitted,
+        completed: _completed,
+        failed: _failed,
+        queued: _lanes.fold(0, (sum, lane) => sum + lane.length),
+        inlineRuns: _inlineRuns,
+      );
+
+  /// Spawn the workers; called lazily by the first task if not done at startup
+  Future<void> initialize() {
+    if (!isEnabled) return Future.value();
+    return _starting ??= _spawnWorkers(ResourceBudgetService.instance.budget.workerPoolSize);
+  }
+
+  Future<void> _spawnWorkers(int count) async {
+    try {
+      final workers = await Future.wait(
+        List.generate(count, (index) => _PoolWorker.spawn(index, _onResult)),
+      );
+      _workers.addAll(workers);
+      debugPrint('IsolatePoolService: Started ${workers.length} workers');
+    } catch (e) {
+      debugPrint('IsolatePoolService: Failed to start workers, running tasks inline: $e');
+    }
+  }
+
+  /// Run [task] with [argument] on a pool isolate.
+  ///
+  /// [task] must be a top-level or static function; [argument] and the result
+  /// are copied between isolates, so pass large payloads through [runBytes].
+  Future<R> run<A, R>(
+    FutureOr<R> Function(A argument) task,
+    A argument, {
+    TaskPriority priority = TaskPriority.normal,
+  }) async {
+    _submitted++;
+    if (isEnabled) await initialize();
+    if (_workers.isEmpty) {
+      _inlineRuns++;
+      return await task(argument);
+    }
+
+    final pending = _PoolTask(_nextTaskId++, _Invocation<A, R>(task, argument), priority);
+    _lanes[priority.index].addLast(pending);
+    _pumpAll();
+    return await pending.completer.future as R;
+  }
+
+  /// Run a bytes-to-bytes [task] with both buffers transferred rather than
+  /// copied between isolates
+  Future<Uint8List> runBytes(
+    FutureOr<Uint8List> Function(Uint8List input) task,
+    Uint8List input, {
+    TaskPriority priority = TaskPriority.normal,
+  }) async {
+    if (isEnabled) await initialize();
+    if (_workers.isEmpty) {
+      _submitted++;
+      _inlineRuns++;
+      return await task(input);
+    }
+
+    final result = await run<TransferableTypedData, TransferableTypedData>(
+      _BytesInvocation(task).call,
+      TransferableTypedData.fromList([input]),
+      priority: priority,
+    );
+    return result.materialize().asUint8List();
+  }
+
+  void _pumpAll() {
+    for (final worker in _workers) {
+      _pump(worker);
+    }
+  }
+
+  void _pump(_PoolWorker worker) {
+    if (worker.current != null) return;
+    final task = _takeNext();
+    if (task == null) return;
+    worker.current = task;
+    _running[task.id] = task;
+    worker.send(task);
+  }
+
+  /// The oldest task of the highest non-empty lane
+  _PoolTask? _takeNext() {
+    for (final lane in _lanes) {
+      if (lane.isNotEmpty) return lane.removeFirst();
+    }
+    return null;
+  }
+
+  void _onResult(_PoolWorker worker, _PoolResult result) {
+    final task = _running.remove(result.taskId);
+    worker.current = null;
+    if (task != null) {
+      if (result.error != null) {
+        _failed++;
+        final stackTrace = result.stackTrace;
+        task.completer.completeError(
+          result.error!,
+          stackTrace != null ? StackTrace.fromString(stackTrace) : null,
+        );
+      } else {
+        _completed++;
+        task.completer.complete(result.value);
+      }
+    }
+    _pump(worker);
+  }
+
+  /// Kill all workers, failing any queued or running tasks
+  void dispose() {
+    for (final lane in _lanes) {
+      for (final task in lane) {
+        task.completer.completeError(StateError('Isolate pool disposed'));
+      }
+      lane.clear();
+    }
+    for (final worker in _workers) {
+      worker.kill();
+    }
+    for (final task in _running.values) {
+      task.completer.completeError(StateError('Isolate pool disposed'));
+    }
+    _running.clear();
+    _workers.clear();
+    _starting = null;
+  }
+}
+
+class _PoolTask {
+  final int id;
+  final _Invocation invocation;
+  final TaskPriority priority;
+  final Completer<Object?> completer = Completer<Object?>();
+
+  _PoolTask(this.id, this.invocation, this.priority);
+}
+
+/// Function and argument sent to a worker; keeps the type arguments so the
+/// worker calls the task with the right static types
+class _Invocation<A, R> {
+  final FutureOr<R> Function(A) task;
+  final A argument;
+
+  const _Invocation(this.task, this.argument);
+
+  FutureOr<R> call() => task(argument);
+}
+
+class _BytesInvocation {
+  final FutureOr<Uint8List> Function(Uint8List) task;
+
+  const _BytesInvocation(this.task);
+
+  Future<TransferableTypedData> call(TransferableTypedData input) async {
+    final output = await task(input.materialize().asUint8List());
+    return TransferableTypedData.fromList([output]);
+  }
+}
+
+class _PoolRequest {
+  final int taskId;
+  final _Invocation invocation;
+
+  const _PoolRequest(this.taskId, this.invocation);
+}
+
+class _PoolResult {
+  final int taskId;
+  final Object? value;
+  final Object? error;
+  final String? stackTrace;
+
+  const _PoolResult(this.taskId, this.value, this.error, this.stackTrace);
+}
+
+class _PoolWorker {
+  final int index;
+  final Isolate _isolate;
+  final SendPort _port;
+  final ReceivePort _results;
+  _PoolTask? current;
+
+  _PoolWorker._(this.index, this._isolate, this._port, this._results);
+
+  static Future<_PoolWorker> spawn(
+    int index,
+    void Function(_PoolWorker worker, _PoolResult result) onResult,
+  ) async {
+    final results = ReceivePort('isolate-pool-$index');
+    final isolate = await Isolate.spawn(
+      _workerMain,
+      results.sendPort,
+      debugName: 'isolate-pool-$index',
+    );
+    final ready = Completer<SendPort>();
+    late final _PoolWorker worker;
+    results.listen((message) {
+      if (message is SendPort) {
+        ready.complete(message);
+      } else if (message is _PoolResult) {
+        onResult(worker, message);
+      }
+    });
+    worker = _PoolWorker._(index, isolate, await ready.future, results);
+    return worker;
+  }
+
+  void send(_PoolTask task) => _port.send(_PoolRequest(task.id, task.invocation));
+
+  void kill() {
+    _results.close();
+    _isolate.kill(priority: Isolate.immediate);
+  }
+}
+
+/// Worker isolate entrypoint: runs one request at a time and replies with
+/// the result or the error
+Future<void> _workerMain(SendPort results) async {
+  final requests = ReceivePort();
+  results.send(requests.sendPort);
+  await for (final message in requests) {
+    final request = message as _PoolRequest;
+    try {
+      final value = await request.invocation.call();
+      results.send(_PoolResult(request.taskId, value, null, null));
+    } catch (e, stackTrace) {
+      try {
+        results.send(_PoolResult(request.taskId, null, e, stackTrace.toString()));
+      } catch (_) {
+        // The error holds something that can not cross isolates
+        results.send(_PoolResult(request.taskId, null, e.toString(), stackTrace.toString()));
+      }
+    }
+  }
+}
@@ -0,0 +1,82 @@
+import 'dart:async';
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+
+/// Dart end of a runner `NativeBridge`: receives batches of values posted by
+/// native worker threads and acknowledges each one once it has been handled,
+/// which is what lets the runner apply backpressure to its workers
+class NativeBridgeChannel {
+  final String name;
+  final EventChannel _events;
+  final MethodChannel _control;
+
+  StreamController<List<Object?>>? _controller;
+  StreamSubscription<dynamic>? _subscription;
+
+  NativeBridgeChannel(this.name)
+      : _events = EventChannel(name),
+        _control = MethodChannel('$name/control');
+
+  /// Results of the runner's worker threads, each a map tagged with the
+  /// `source` service that posted it
+  static final NativeBridgeChannel workerResults =
+      NativeBridgeChannel('modern_dashboard/worker_results');
+
+  /// Batches in arrival order. Listeners run synchronously for each batch and
+  /// the batch is acknowledged after they return.
+  Stream<List<Object?>> get batches {
+    _controller ??= StreamController<List<Object?>>.broadcast(
+      sync: true,
+      onListen: _start,
+      onCancel: _stop,
+    );
+    return _controller!.stream;
+  }
+
+  /// Individual values, flattened from [batches]
+  Stream<Object?> get values => batches.expand((batch) => batch);
+
+  /// Queue, batching and latency counters from the native side
+  Future<Map<String, dynamic>?> getStats() async {
+    try {
+      return await _control.invokeMapMethod<String, dynamic>('getStats');
+    } on MissingPluginException {
+      return null;
+    }
+  }
+
+  void _start() {
+    _subscription = _events.receiveBroadcastStream().listen(
+      (event) {
+        final batch = event as Map<Object?, Object?>;
+        final items = (batch['items'] as List<Object?>?) ?? const [];
+        try {
+          _controller?.add(items);
+        } finally {
+          _acknowledge();
+        }
+      },
+      onError: (Object error) {
+        debugPrint('NativeBridgeChannel($name): $error');
+      },
+    );
+  }
+
+  void _acknowledge() {
+    _control.invokeMethod<void>('ack').catchError((Object e) {
+      debugPrint('NativeBridgeChannel($name): Failed to acknowledge batch: $e');
+    });
+  }
+
+  void _stop() {
+    _subscription?.cancel();
+    _subscription = null;
+  }
+
+  /// Stop listening and release the native queue
+  Future<void> dispose() async {
+    _stop();
+    await _controller?.close();
+    _controller = null;
+  }
+}
@@ -0,0 +1,198 @@
+import 'dart:async';
+import 'dart:io';
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+import 'package:http/http.dart' as http;
+import 'package:http/io_client.dart';
+
+/// Connection setup for the shared HTTP client, tuned for the first refresh
+/// after a launch.
+///
+/// The runner (linux/runner/host_warmup.h) keeps a DNS cache that honours
+/// record TTLs and is persisted across launches. It also ranks the origins
+/// this client connects to. While the engine boots it re-resolves the
+/// top-ranked hosts. [initialize] then opens keep-alive connections to those
+/// origins, so the first feed refresh finds DNS answered and TCP/TLS already
+/// set up. [client] connects through the cached addresses and reports every
+/// origin it uses back to the runner.
+///
+/// dart:io offers no way to persist TLS sessions, so handshakes are
+/// overlapped with startup rather than resumed. On the web, and on runners
+/// without the host table, [client] is a plain `http.Client`.
+class NetworkWarmup {
+  static NetworkWarmup? _instance;
+  static NetworkWarmup get instance => _instance ??= NetworkWarmup._();
+
+  NetworkWarmup._();
+
+  static const MethodChannel _channel = MethodChannel('modern_dashboard/host_warmup');
+
+  /// Pre-connections opened at once
+  static const int _warmupConcurrency = 6;
+  static const Duration _usageFlushDelay = Duration(seconds: 30);
+
+  /// Time a cached address gets to accept before the next one is tried
+  static const Duration _attemptTimeout = Duration(seconds: 2);
+
+  final Map<String, ({List<InternetAddress> addresses, DateTime expires})> _dns = {};
+  final Map<String, Future<List<InternetAddress>?>> _lookups = {};
+  final Map<String, int> _usage = {};
+  Timer? _usageTimer;
+  bool _available = !kIsWeb;
+
+  DateTime _launchedAt = DateTime.now();
+  Duration? _timeToFirstArticle;
+  int _warmed = 0;
+  int _dnsHits = 0;
+  int _dnsMisses = 0;
+
+  /// Shared client; connections go through the persisted DNS cache
+  late final http.Client client = kIsWeb
+      ? http.Client()
+      : IOClient(HttpClient()
+        // Keep warmed connections until the first refresh picks them up
+        ..idleTimeout = const Duration(seconds: 60)
+        ..connectionFactory = _connect);
+
+  /// Pre-connect to the origins the last sessions used most
+  Future<void> initialize() async {
+    if (!_available) return;
+    final Map<String, dynamic>? warm;
+    try {
+      warm = await _channel.invokeMapMethod<String, dynamic>('getWarmOrigins');
+    } on MissingPluginException {
+      _available = false;
+      return;
+    }
+    if (warm == null) return;
+    _launchedAt = DateTime.fromMillisecondsSinceEpoch(warm['launchedAtMs'] as int);
+
+    final origins = List<String>.from(warm['origins'] as List? ?? const []);
+    final queue = origins.where((origin) => origin.startsWith('https://')).toList();
+    final stopwatch = Stopwatch()..start();
+    Future<void> worker() async {
+      while (queue.isNotEmpty) {
+        final origin = queue.removeAt(0);
+        try {
+          // HEAD leaves a pooled keep-alive connection behind
+          await client.head(Uri.parse('$origin/')).timeout(const Duration(seconds: 5));
+          _warmed++;
+        } catch (e) {
+          debugPrint('NetworkWarmup: Could not pre-connect to $origin: $e');
+        }
+      }
+    }
+    await Future.wait(List.generate(_warmupConcurrency, (_) => worker()));
+    debugPrint('NetworkWarmup: Pre-connected $_warmed/${origins.length} origins '
+        'in ${stopwatch.elapsedMilliseconds}ms');
+  }
+
+  /// Record that the first articles are ready; only the first call counts
+  void markFirstArticle() {
+    if (_timeToFirstArticle != null) return;
+    _timeToFirstArticle = DateTime.now().difference(_launchedAt);
+    debugPrint('NetworkWarmup: First article ${_timeToFirstArticle!.inMilliseconds}ms '
+        'after launch ($_warmed pre-connected, DNS $_dnsHits cached / $_dnsMisses resolved)');
+  }
+
+  /// Time from launch to the first article, once known
+  Duration? get timeToFirstArticle => _timeToFirstArticle;
+
+  Map<String, dynamic> get stats => {
+        'timeToFirstArticleMs': _timeToFirstArticle?.inMilliseconds,
+        'preconnected': _warmed,
+        'dnsHits': _dnsHits,
+        'dnsMisses': _dnsMisses,
+      };
+
+  Future<ConnectionTask<Socket>> _connect(Uri uri, String? proxyHost, int? proxyPort) async {
+    _recordUse(uri);
+    final host = proxyHost ?? uri.host;
+    final port = proxyPort ?? uri.port;
+    // Through a proxy the client wraps the tunnel in TLS itself
+    final secure = uri.scheme == 'https' && proxyHost == null;
+
+    final addresses = await _lookup(host);
+    if (addresses == null || addresses.isEmpty) {
+      return secure ? SecureSocket.startConnect(host, port) : Socket.startConnect(host, port);
+    }
+
+    var cancelled = false;
+    ConnectionTask<Socket>? attempt;
+    Future<Socket> connectAny() async {
+      for (final address in addresses) {
+        if (cancelled) break;
+        final task = attempt = await Socket.startConnect(address, port);
+        try {
+          return await task.socket.timeout(_attemptTimeout);
+        } on TimeoutException {
+          task.cancel();
+        } catch (_) {
+          // Refused or unreachable; try the next address
+        }
+      }
+      if (cancelled) throw SocketException('Connection to $host cancelled');
+      // Every cached address failed and may be stale; let the system resolver decide
+      _dns.remove(host);
+      return Socket.connect(host, port);
+    }
+
+    var socket = connectAny();
+    if (secure) {
+      socket = socket.then((plain) => SecureSocket.secure(plain, host: host));
+    }
+    return ConnectionTask.fromSocket(socket, () {
+      cancelled = true;
+      attempt?.cancel();
+    });
+  }
+
+  Future<List<InternetAddress>?> _lookup(String host) {
+    if (!_available || InternetAddress.tryParse(host) != null) return Future.value(null);
+    final cached = _dns[host];
+    if (cached != null && DateTime.now().isBefore(cached.expires)) {
+      _dnsHits++;
+      return Future.value(cached.addresses);
+    }
+    return _lookups[host] ??= _resolve(host).whenComplete(() => _lookups.remove(host));
+  }
+
+  Future<List<InternetAddress>?> _resolve(String host) async {
+    _dnsMisses++;
+    try {
+      final result = await _channel.invokeMapMethod<String, dynamic>('lookup', {'host': host});
+      if (result == null) return null;
+      final addresses = [
+        for (final address in result['addresses'] as List) InternetAddress(address as String),
+      ];
+      _dns[host] = (
+        addresses: addresses,
+        expires: DateTime.now().add(Duration(seconds: result['ttl'] as int)),
+      );
+      return addresses;
+    } on MissingPluginException {
+      _available = false;
+      return null;
+    } catch (e) {
+      debugPrint('NetworkWarmup: Lookup of $host failed: $e');
+      return null;
+    }
+  }
+
+  void _recordUse(Uri uri) {
+    if (!_available) return;
+    final origin = '${uri.scheme}://${uri.host}:${uri.port}';
+    _usage[origin] = (_usage[origin] ?? 0) + 1;
+    _usageTimer ??= Timer(_usageFlushDelay, _flushUsage);
+  }
+
+  void _flushUsage() {
+    _usageTimer = null;
+    if (_usage.isEmpty) return;
+    final origins = Map<String, int>.from(_usage);
+    _usage.clear();
+    _channel.invokeMethod<void>('recordUsage', {'origins': origins}).catchError((Object e) {
+      debugPrint('NetworkWarmup: Failed to record origin usage: $e');
+    });
+  }
+}
@@ -0,0 +1,115 @@
+import 'dart:io';
+import 'dart:math';
+import 'package:flutter/foundation.dart';
+import 'package:flutter/painting.dart';
+import 'package:flutter/services.dart';
+import '../utils/safe_json_converter.dart';
+
+/// Pool sizes and cache budgets chosen for the machine or container the app
+/// runs in
+class ResourceBudget {
+  final double effectiveCpus;
+  final int memoryLimitBytes;
+  final bool cgroupLimited;
+  final int workerPoolSize;
+  final int fetchConcurrency;
+  final int imageCacheBytes;
+  final int imageCacheEntries;
+  final int typeCacheEntries;
+
+  const ResourceBudget({
+    required this.effectiveCpus,
+    required this.memoryLimitBytes,
+    required this.cgroupLimited,
+    required this.workerPoolSize,
+    required this.fetchConcurrency,
+    required this.imageCacheBytes,
+    required this.imageCacheEntries,
+    required this.typeCacheEntries,
+  });
+
+  /// Budget used when the runner does not provide one (web, mobile, macOS)
+  factory ResourceBudget.defaults() {
+    final cpus = kIsWeb ? 4 : Platform.numberOfProcessors;
+    return ResourceBudget(
+      effectiveCpus: cpus.toDouble(),
+      memoryLimitBytes: 0,
+      cgroupLimited: false,
+      workerPoolSize: max(1, min(cpus - 1, 4)),
+      fetchConcurrency: 6,
+      imageCacheBytes: 100 << 20, // Flutter's default
+      imageCacheEntries: 1000,
+      typeCacheEntries: 100,
+    );
+  }
+
+  /// Create from the map sent by the Linux runner
+  factory ResourceBudget.fromMap(Map<String, dynamic> map) {
+    final defaults = ResourceBudget.defaults();
+    return ResourceBudget(
+      effectiveCpus: (map['effectiveCpus'] as num?)?.toDouble() ?? defaults.effectiveCpus,
+      memoryLimitBytes: map['memoryLimitBytes'] as int? ?? defaults.memoryLimitBytes,
+      cgroupLimited: map['cgroupLimited'] as bool? ?? false,
+      workerPoolSize: map['workerPoolSize'] as int? ?? defaults.workerPoolSize,
+      fetchConcurrency: map['fetchConcurrency'] as int? ?? defaults.fetchConcurrency,
+      imageCacheBytes: map['imageCacheBytes'] as int? ?? defaults.imageCacheBytes,
+      imageCacheEntries: map['imageCacheEntries'] as int? ?? defaults.imageCacheEntries,
+      typeCacheEntries: map['typeCacheEntries'] as int? ?? defaults.typeCacheEntries,
+    );
+  }
+
+  @override
+  String toString() {
+    return 'ResourceBudget(cpus: ${effectiveCpus.toStringAsFixed(2)}, '
+        'memory: ${memoryLimitBytes >> 20} MiB, cgroup: $cgroupLimited, '
+        'workers: $workerPoolSize, fetches: $fetchConcurrency, '
+        'imageCache: ${imageCacheBytes >> 20} MiB/$imageCacheEntries)';
+  }
+}
+
+/// Service that reads the runner's container-aware resource budget and applies
+/// it to the app's pools and caches
+class ResourceBudgetService {
+  static ResourceBudgetService? _instance;
+  static ResourceBudgetService get instance => _instance ??= ResourceBudgetService._();
+
+  ResourceBudgetService._();
+
+  static const MethodChannel _channel = MethodChannel('modern_dashboard/runtime');
+
+  ResourceBudget _budget = ResourceBudget.defaults();
+  bool _isInitialized = false;
+
+  /// Current budget (defaults until [initialize] completes)
+  ResourceBudget get budget => _budget;
+
+  /// Fetch the budget from the runner and apply it to global caches
+  Future<void> initialize() async {
+    if (_isInitialized) return;
+    _isInitialized = true;
+
+    if (!kIsWeb && Platform.isLinux) {
+      try {
+        final map = await _channel.invokeMapMethod<String, dynamic>('getResourceBudget');
+        if (map != null) {
+          _budget = ResourceBudget.fromMap(map);
+        }
+      } on MissingPluginException {
+        debugPrint('ResourceBudgetService: Runner does not provide a budget, using defaults');
+      } catch (e) {
+        debugPrint('ResourceBudgetService: Failed to read budget: $e');
+      }
+    }
+
+    _apply();
+    debugPrint('ResourceBudgetService: $_budget');
+  }
+
+  void _apply() {
+    final imageCache = PaintingBinding.instance.imageCache;
+    imageCache.maximumSizeBytes = _budget.imageCacheBytes;
+    imageCache.maximumSize = _budget.imageCacheEntries;
+
+    SafeJsonConverter.setTypeCacheSize(_budget.typeCacheEntries);
+  }
+}
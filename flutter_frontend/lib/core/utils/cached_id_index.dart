@@ -0,0 +1,81 @@
+import 'dart:convert';
+import 'package:flutter/foundation.dart';
+import 'package:shared_preferences/shared_preferences.dart';
+
+/// Local record of the document IDs already written to a remote collection,
+/// so bulk writers can skip known documents without reading them first.
+///
+/// Each ID keeps the time it was written and is forgotten after [retention],
+/// matching the collection's own cleanup. The index is only a hint: a
+/// missing ID means "write it", and writers must be idempotent for IDs that
+/// exist remotely but not here (another device wrote them, or local storage
+/// was cleared).
+class CachedIdIndex {
+  final String prefsKey;
+  final Duration retention;
+
+  final Map<String, int> _writtenAt = {};
+  Future<void>? _loading;
+  bool _dirty = false;
+
+  CachedIdIndex(this.prefsKey, {this.retention = const Duration(days: 7)});
+
+  int get length => _writtenAt.length;
+
+  /// Load the saved index once; later calls return immediately
+  Future<void> load() => _loading ??= _load();
+
+  Future<void> _load() async {
+    try {
+      final prefs = await SharedPreferences.getInstance();
+      final raw = prefs.getString(prefsKey);
+      if (raw == null) return;
+      final cutoff = DateTime.now().subtract(retention).millisecondsSinceEpoch;
+      (jsonDecode(raw) as Map<String, dynamic>).forEach((id, time) {
+        if (time is int && time >= cutoff) _writtenAt[id] = time;
+      });
+    } catch (e) {
+      debugPrint('CachedIdIndex: Failed to load $prefsKey: $e');
+    }
+  }
+
+  bool contains(String id) => _writtenAt.containsKey(id);
+
+  /// Record [ids] as written at [at] (now by default); existing entries keep
+  /// their original time
+  void addAll(Iterable<String> ids, {DateTime? at}) {
+    final time = (at ?? DateTime.now()).millisecondsSinceEpoch;
+    for (final id in ids) {
+      _writtenAt.putIfAbsent(id, () {
+        _dirty = true;
+        return time;
+      });
+    }
+  }
+
+  void removeAll(Iterable<String> ids) {
+    for (final id in ids) {
+      if (_writtenAt.remove(id) != null) _dirty = true;
+    }
+  }
+
+  /// Forget IDs older than [retention]
+  void prune() {
+    final cutoff = DateTime.now().subtract(retention).millisecondsSinceEpoch;
+    final before = _writtenAt.length;
+    _writtenAt.removeWhere((_, time) => time < cutoff);
+    if (_writtenAt.length != before) _dirty = true;
+  }
+
+  Future<void> save() async {
+    if (!_dirty) return;
+    _dirty = false;
+    try {
+      final prefs = await SharedPreferences.getInstance();
+      await prefs.setString(prefsKey, jsonEncode(_writtenAt));
+    } catch (e) {
+      _dirty = true;
+      debugPrint('CachedIdIndex: Failed to save $prefsKey: $e');
+    }
+  }
+}
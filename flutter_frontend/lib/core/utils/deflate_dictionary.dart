@@ -0,0 +1,120 @@
+import 'dart:convert';
+import 'dart:math';
+import 'dart:typed_data';
+
+/// Shortest substring considered for the dictionary
+const int _k = 12;
+
+/// Cap on the training corpus, to bound time and memory on the worker
+const int _maxCorpusBytes = 512 * 1024;
+
+/// Build a preset dictionary for raw deflate from [samples], small records
+/// of the kind that will later be compressed one at a time.
+///
+/// Every [_k]-byte window of every sample is hashed. A window counts once
+/// per sample, and windows found in at least [minSamples] samples mark their
+/// bytes as shared. Runs of shared bytes become candidate segments. Each
+/// candidate is weighed by the bytes it would save: its length times the
+/// number of samples its rarest window appears in. Candidates are taken best
+/// first until [size] bytes, skipping any already contained in a chosen one.
+///
+/// Deflate reaches matches near the end of the dictionary at the lowest
+/// cost, so the dictionary is laid out worst first and best last. [size]
+/// must stay below the 32 KiB deflate window, which also has to hold the
+/// record itself.
+Uint8List trainDeflateDictionary(
+  List<Uint8List> samples, {
+  int size = 16 * 1024,
+  int minSamples = 3,
+}) {
+  final corpus = <Uint8List>[];
+  var corpusBytes = 0;
+  for (final sample in samples.reversed) {
+    if (sample.length < _k) continue;
+    if (corpusBytes + sample.length > _maxCorpusBytes) break;
+    corpus.add(sample);
+    corpusBytes += sample.length;
+  }
+  if (corpus.length < minSamples) return Uint8List(0);
+
+  // Document frequency of every window hash, packed with the last sample
+  // it was seen in so each window counts once per sample
+  final frequency = <int, int>{};
+  final hashes = <Int64List>[];
+  for (var s = 0; s < corpus.length; s++) {
+    final windowHashes = _windowHashes(corpus[s]);
+    hashes.add(windowHashes);
+    for (final hash in windowHashes) {
+      final packed = frequency[hash];
+      if (packed == null) {
+        frequency[hash] = 1 << 20 | s;
+      } else if (packed & 0xfffff != s) {
+        frequency[hash] = ((packed >> 20) + 1) << 20 | s;
+      }
+    }
+  }
+
+  // Runs of shared windows; a run is worth as much as its rarest window
+  final candidates = <String, int>{};
+  for (var s = 0; s < corpus.length; s++) {
+    final sample = corpus[s];
+    final windowHashes = hashes[s];
+    var start = -1;
+    var runSamples = 0;
+    for (var i = 0; i <= windowHashes.length; i++) {
+      final samplesWithWindow = i < windowHashes.length ? frequency[windowHashes[i]]! >> 20 : 0;
+      if (samplesWithWindow >= minSamples) {
+        if (start < 0) {
+          start = i;
+          runSamples = samplesWithWindow;
+        } else {
+          runSamples = min(runSamples, samplesWithWindow);
+        }
+      } else if (start >= 0) {
+        final segment = latin1.decode(Uint8List.sublistView(sample, start, i - 1 + _k));
+        candidates[segment] = max(candidates[segment] ?? 0, runSamples);
+        start = -1;
+      }
+    }
+  }
+
+  final ranked = candidates.entries.toList()
+    ..sort((a, b) => (b.value * b.key.length).compareTo(a.value * a.key.length));
+
+  final chosen = <String>[];
+  var chosenBytes = 0;
+  for (final entry in ranked) {
+    if (chosenBytes >= size) break;
+    final segment = entry.key;
+    if (chosen.any((c) => c.contains(segment))) continue;
+    final fitted = segment.length > size - chosenBytes
+        ? segment.substring(segment.length - (size - chosenBytes))
+        : segment;
+    chosen.add(fitted);
+    chosenBytes += fitted.length;
+  }
+
+  final builder = BytesBuilder(copy: false);
+  for (final segment in chosen.reversed) {
+    builder.add(latin1.encode(segment));
+  }
+  return builder.takeBytes();
+}
+
+/// Polynomial hash of each [_k]-byte window of [bytes]
+Int64List _windowHashes(Uint8List bytes) {
+  const base = 1000003;
+  final count = max(0, bytes.length - _k + 1);
+  final result = Int64List(count);
+  var power = 1;
+  for (var i = 0; i < _k - 1; i++) {
+    power *= base;
+  }
+  var hash = 0;
+  for (var i = 0; i < bytes.length; i++) {
+    if (i >= _k) hash -= bytes[i - _k] * power;
+    hash = hash * base + bytes[i];
+    if (i >= _k - 1) result[i - _k + 1] = hash;
+  }
+  return result;
+}
@@ -0,0 +1,227 @@
+import 'dart:developer';
+import 'package:flutter/foundation.dart';
+import 'timestamp_converter.dart';
+
+/// How a document field is converted
+enum FieldKind { string, integer, number, timestamp, stringList }
+
+/// One field of a [DocumentSchema]. Fields that are missing, null or of the
+/// wrong type take [fallback]; a [required] field that is missing or null
+/// rejects the document.
+class FieldSpec {
+  final String name;
+  final FieldKind kind;
+  final bool required;
+  final Object? fallback;
+
+  /// Strings (and list items) longer than this are truncated
+  final int maxLength;
+
+  const FieldSpec(
+    this.name,
+    this.kind, {
+    this.required = false,
+    this.fallback,
+    this.maxLength = 10000,
+  });
+}
+
+/// Converted field values of one document, read by slot (the field's index
+/// in the schema) while the model is built
+class DocumentFields {
+  final List<Object?> _values;
+
+  DocumentFields._(int length) : _values = List<Object?>.filled(length, null);
+
+  String string(int slot) => _values[slot] as String;
+  String? optionalString(int slot) => _values[slot] as String?;
+  int integer(int slot) => _values[slot] as int;
+  double number(int slot) => _values[slot] as double;
+  DateTime time(int slot) => _values[slot] as DateTime? ?? DateTime.now();
+  DateTime? optionalTime(int slot) => _values[slot] as DateTime?;
+  List<String> strings(int slot) => _values[slot] as List<String>? ?? const [];
+}
+
+/// Per-document cost and rejection counts of a [DocumentSchema]
+class DocumentSchemaStats {
+  final int documents;
+  final int rejected;
+  final int typeMismatches;
+  final int elapsedMicroseconds;
+
+  const DocumentSchemaStats(
+    this.documents,
+    this.rejected,
+    this.typeMismatches,
+    this.elapsedMicroseconds,
+  );
+
+  double get microsecondsPerDocument => documents == 0 ? 0 : elapsedMicroseconds / documents;
+
+  @override
+  String toString() {
+    return '$documents documents, ${microsecondsPerDocument.toStringAsFixed(2)} us/doc, '
+        'rejected $rejected, type mismatches $typeMismatches';
+  }
+}
+
+/// Validation and conversion plan for one model, compiled once from its
+/// field list.
+///
+/// [decode] walks the document's entries once, converts the fields the
+/// model uses straight into their slots and ignores the rest, so no
+/// sanitized copy of the map is made. Type checks replace the web
+/// sanitizer's runtime type string matching: a JavaScript interop object
+/// where a string is expected is simply a type mismatch and takes the
+/// field's fallback.
+class DocumentSchema<T> {
+  final String name;
+  final List<FieldSpec> fields;
+  final T Function(DocumentFields fields) _build;
+  final Map<String, int> _slots;
+  final int? _idSlot;
+  final List<int> _requiredSlots;
+
+  int _documents = 0;
+  int _rejected = 0;
+  int _typeMismatches = 0;
+  int _elapsedMicroseconds = 0;
+
+  DocumentSchema(this.name, this.fields, this._build)
+      : assert(fields.length <= 30),
+        _slots = {for (var i = 0; i < fields.length; i++) fields[i].name: i},
+        _idSlot = _indexOf(fields, 'id'),
+        _requiredSlots = [
+          for (var i = 0; i < fields.length; i++)
+            if (fields[i].required) i,
+        ];
+
+  static int? _indexOf(List<FieldSpec> fields, String name) {
+    for (var i = 0; i < fields.length; i++) {
+      if (fields[i].name == name) return i;
+    }
+    return null;
+  }
+
+  DocumentSchemaStats get stats =>
+      DocumentSchemaStats(_documents, _rejected, _typeMismatches, _elapsedMicroseconds);
+
+  /// Build a model from [document], or null when it is invalid. [id] (the
+  /// Firestore document ID) takes the place of the document's own id field
+  /// without writing it into the map.
+  T? decode(Map<String, dynamic> document, {String? id, String? context}) {
+    _documents++;
+    final values = DocumentFields._(fields.length);
+    final slots = values._values;
+    // Fields present and non-null, by slot; a required field only has to be
+    // present, a wrong type still falls back
+    var present = 0;
+    for (final entry in document.entries) {
+      final slot = _slots[entry.key];
+      if (slot == null || entry.value == null) continue;
+      present |= 1 << slot;
+      slots[slot] = _convert(fields[slot], entry.value);
+    }
+    final idSlot = _idSlot;
+    if (id != null && idSlot != null) {
+      slots[idSlot] = id;
+      present |= 1 << idSlot;
+    }
+
+    for (final slot in _requiredSlots) {
+      if ((present & (1 << slot)) == 0) {
+        _rejected++;
+        log('DocumentSchema: Missing required field ${fields[slot].name} in $name'
+            '${context != null ? ' ($context)' : ''}');
+        return null;
+      }
+    }
+    for (var slot = 0; slot < slots.length; slot++) {
+      slots[slot] ??= fields[slot].fallback;
+    }
+
+    try {
+      return _build(values);
+    } catch (e) {
+      _rejected++;
+      log('DocumentSchema: Failed to build $name${context != null ? ' ($context)' : ''}: $e');
+      return null;
+    }
+  }
+
+  /// Decode a snapshot's documents, skipping invalid ones, and record the
+  /// per-document cost
+  List<T> decodeAll(Iterable<(String, Map<String, dynamic>)> documents, {String? context}) {
+    final watch = Stopwatch()..start();
+    final results = <T>[];
+    var count = 0;
+    for (final (id, data) in documents) {
+      count++;
+      final item = decode(data, id: id, context: context);
+      if (item != null) results.add(item);
+    }
+    watch.stop();
+    _elapsedMicroseconds += watch.elapsedMicroseconds;
+    if (kDebugMode && count >= 1000) {
+      debugPrint('DocumentSchema: $name decoded $count documents in '
+          '${watch.elapsedMicroseconds} us '
+          '(${(watch.elapsedMicroseconds / count).toStringAsFixed(2)} us/doc)');
+    }
+    return results;
+  }
+
+  Object? _convert(FieldSpec field, Object value) {
+    switch (field.kind) {
+      case FieldKind.string:
+        if (value is String) {
+          return value.length > field.maxLength ? value.substring(0, field.maxLength) : value;
+        }
+      case FieldKind.integer:
+        if (value is num) return value.round();
+      case FieldKind.number:
+        if (value is num) return value.toDouble();
+      case FieldKind.timestamp:
+        // Local time, as the models built from millisecond fields had
+        final time = TimestampConverter.parseTimestamp(value);
+        if (time != null) return time.toLocal();
+      case FieldKind.stringList:
+        if (value is List) {
+          return [
+            for (final item in value.take(50))
+              if (item is String)
+                item.length > field.maxLength ? item.substring(0, field.maxLength) : item,
+          ];
+        }
+    }
+    _typeMismatches++;
+    return null;
+  }
+
+  /// Time this plan against [legacy] (the map-based path it replaces) on
+  /// [documents], in microseconds per document
+  ({double schema, double legacy}) benchmark(
+    List<Map<String, dynamic>> documents,
+    T? Function(Map<String, dynamic>) legacy,
+  ) {
+    final schemaWatch = Stopwatch()..start();
+    for (final document in documents) {
+      decode(document);
+    }
+    schemaWatch.stop();
+
+    final legacyWatch = Stopwatch()..start();
+    for (final document in documents) {
+      legacy(document);
+    }
+    legacyWatch.stop();
+
+    final result = (
+      schema: schemaWatch.elapsedMicroseconds / documents.length,
+      legacy: legacyWatch.elapsedMicroseconds / documents.length,
+    );
+    debugPrint('DocumentSchema: $name on ${documents.length} documents: '
+        '${result.schema.toStringAsFixed(2)} us/doc vs '
+        '${result.legacy.toStringAsFixed(2)} us/doc');
+    return result;
+  }
+}
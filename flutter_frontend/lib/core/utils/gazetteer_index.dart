@@ -0,0 +1,613 @@
+import 'dart:convert';
+import 'dart:math';
+import 'dart:typed_data';
+
+/// A place returned by [GazetteerIndex.search]
+class GazetteerPlace {
+  final String name;
+  final String country;
+  final String admin;
+  final double latitude;
+  final double longitude;
+  final int population;
+
+  /// Edit distance between the query and the matched name prefix (0 for
+  /// prefix matches)
+  final int distance;
+
+  const GazetteerPlace({
+    required this.name,
+    required this.country,
+    required this.admin,
+    required this.latitude,
+    required this.longitude,
+    required this.population,
+    this.distance = 0,
+  });
+
+  @override
+  String toString() => 'GazetteerPlace($name, $admin, $country)';
+}
+
+const int _magic = 0x5a47444d; // "MDGZ"
+const int _version = 1;
+const int _headerSize = 32;
+const int _placeSize = 28;
+const int _keySize = 12;
+const int _shortlistSize = 12;
+const int _coordinateScale = 100000;
+
+/// Queries up to this many bytes are answered from the precomputed shortlist
+const int _shortlistPrefixBytes = 2;
+const int _shortlistLength = 8;
+
+/// Upper bounds on the work a single keystroke may trigger
+const int _maxPrefixScan = 50000;
+const int _maxFuzzyRows = 200000;
+const int _maxFuzzyRange = 64;
+
+/// Read-only place-name index over a single byte buffer.
+///
+/// The buffer holds a fixed-size place table, a table of folded search keys
+/// (names and alternate names) sorted bytewise, a shortlist of the most
+/// populous places for every one- and two-byte prefix, and a UTF-8 string
+/// heap. The sorted key table doubles as a flattened trie: prefix queries are
+/// a binary search plus a range scan, and typo-tolerant queries walk it depth
+/// first with one edit-distance row per shared prefix byte, skipping whole
+/// key ranges once no extension can come within the allowed distance.
+///
+/// Nothing is decoded at load time, so opening a GeoNames-scale index costs a
+/// single read of the file.
+class GazetteerIndex {
+  final Uint8List _bytes;
+  final ByteData _data;
+  final int placeCount;
+  final int keyCount;
+  final int _shortlistCount;
+  final int _placesOffset;
+  final int _keysOffset;
+  final int _shortlistOffset;
+  final int _shortlistIndexOffset;
+  final int _heapOffset;
+
+  GazetteerIndex._(
+    this._bytes,
+    this._data,
+    this.placeCount,
+    this.keyCount,
+    this._shortlistCount,
+    int shortlistIndexCount,
+  )   : _placesOffset = _headerSize,
+        _keysOffset = _headerSize + placeCount * _placeSize,
+        _shortlistOffset = _headerSize + placeCount * _placeSize + keyCount * _keySize,
+        _shortlistIndexOffset = _headerSize +
+            placeCount * _placeSize +
+            keyCount * _keySize +
+            _shortlistCount * _shortlistSize,
+        _heapOffset = _headerSize +
+            placeCount * _placeSize +
+            keyCount * _keySize +
+            _shortlistCount * _shortlistSize +
+            shortlistIndexCount * 4;
+
+  /// Wrap an index produced by [GazetteerBuilder.build] without copying
+  factory GazetteerIndex(Uint8List bytes) {
+    final data = ByteData.sublistView(bytes);
+    if (bytes.lengthInBytes < _headerSize || data.getUint32(0, Endian.little) != _magic) {
+      throw const FormatException('Not a gazetteer index');
+    }
+    final version = data.getUint16(4, Endian.little);
+    if (version != _version) {
+      throw FormatException('Unsupported gazetteer index version $version');
+    }
+    final index = GazetteerIndex._(
+      bytes,
+      data,
+      data.getUint32(8, Endian.little),
+      data.getUint32(12, Endian.little),
+      data.getUint32(16, Endian.little),
+      data.getUint32(20, Endian.little),
+    );
+    if (index._heapOffset + data.getUint32(24, Endian.little) != bytes.lengthInBytes) {
+      throw const FormatException('Corrupt gazetteer index');
+    }
+    return index;
+  }
+
+  /// Size of the index in bytes
+  int get sizeInBytes => _bytes.lengthInBytes;
+
+  /// Ranked places whose name or alternate name starts with [query], topped
+  /// up with typo-tolerant matches when there are fewer than [limit].
+  ///
+  /// Text after the first comma narrows results by country code or admin
+  /// region, e.g. `paris, us`.
+  List<GazetteerPlace> search(String query, {int limit = 5}) {
+    final comma = query.indexOf(',');
+    final nameQuery = fold(comma < 0 ? query : query.substring(0, comma));
+    final qualifier = comma < 0 ? '' : fold(query.substring(comma + 1));
+    if (nameQuery.isEmpty || limit <= 0) return const [];
+
+    final q = Uint8List.fromList(utf8.encode(nameQuery));
+    bool accept(int place) => qualifier.isEmpty || _matchesQualifier(place, qualifier);
+
+    final ranked = _RankedPlaces(limit);
+    if (q.length <= _shortlistPrefixBytes) {
+      _searchShortlist(q, accept, ranked);
+    }
+    if (ranked.length < limit) {
+      _searchPrefix(q, accept, ranked);
+    }
+    if (ranked.length < limit && q.length >= 4) {
+      _searchFuzzy(q, q.length >= 8 ? 2 : 1, accept, ranked);
+    }
+    return ranked.places.map((match) => _place(match.place, match.distance)).toList();
+  }
+
+  // --- Tables ---
+
+  int _placePopulation(int place) =>
+      _data.getUint32(_placesOffset + place * _placeSize + 24, Endian.little);
+
+  String _string(int offset, int length) =>
+      utf8.decode(Uint8List.sublistView(_bytes, _heapOffset + offset, _heapOffset + offset + length));
+
+  GazetteerPlace _place(int place, int distance) {
+    final base = _placesOffset + place * _placeSize;
+    return GazetteerPlace(
+      name: _string(_data.getUint32(base, Endian.little), _data.getUint16(base + 4, Endian.little)),
+      country: String.fromCharCodes(_bytes, base + 6, base + 8).trim(),
+      admin: _string(_data.getUint32(base + 8, Endian.little), _data.getUint16(base + 12, Endian.little)),
+      latitude: _data.getInt32(base + 16, Endian.little) / _coordinateScale,
+      longitude: _data.getInt32(base + 20, Endian.little) / _coordinateScale,
+      population: _data.getUint32(base + 24, Endian.little),
+      distance: distance,
+    );
+  }
+
+  bool _matchesQualifier(int place, String qualifier) {
+    final base = _placesOffset + place * _placeSize;
+    final country = String.fromCharCodes(_bytes, base + 6, base + 8).trim().toLowerCase();
+    if (country.startsWith(qualifier)) return true;
+    final admin = _string(_data.getUint32(base + 8, Endian.little), _data.getUint16(base + 12, Endian.little));
+    return fold(admin).startsWith(qualifier);
+  }
+
+  int _keyOffset(int key) => _heapOffset + _data.getUint32(_keysOffset + key * _keySize, Endian.little);
+
+  int _keyLength(int key) => _data.getUint16(_keysOffset + key * _keySize + 4, Endian.little);
+
+  int _keyPlace(int key) => _data.getUint32(_keysOffset + key * _keySize + 8, Endian.little);
+
+  /// Compare key bytes at [offset] with the first [length] bytes of [q]
+  int _compare(int offset, int keyLength, Uint8List q, int length) {
+    final n = min(keyLength, length);
+    for (var i = 0; i < n; i++) {
+      final diff = _bytes[offset + i] - q[i];
+      if (diff != 0) return diff;
+    }
+    return keyLength - length;
+  }
+
+  bool _keyHasPrefix(int key, Uint8List prefix, int length) {
+    if (_keyLength(key) < length) return false;
+    final offset = _keyOffset(key);
+    for (var i = 0; i < length; i++) {
+      if (_bytes[offset + i] != prefix[i]) return false;
+    }
+    return true;
+  }
+
+  /// First key >= the first [length] bytes of [q]
+  int _lowerBound(Uint8List q, int length) {
+    var lo = 0, hi = keyCount;
+    while (lo < hi) {
+      final mid = (lo + hi) >> 1;
+      if (_compare(_keyOffset(mid), _keyLength(mid), q, length) < 0) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+  }
+
+  /// First key after [from] that does not start with the first [length]
+  /// bytes of [prefix], given that key [from] does
+  int _prefixEnd(int from, Uint8List prefix, int length) {
+    var lo = from + 1, hi = keyCount;
+    while (lo < hi) {
+      final mid = (lo + hi) >> 1;
+      if (_keyHasPrefix(mid, prefix, length)) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+  }
+
+  // --- Search strategies ---
+
+  void _searchShortlist(Uint8List q, bool Function(int) accept, _RankedPlaces ranked) {
+    var lo = 0, hi = _shortlistCount;
+    while (lo < hi) {
+      final mid = (lo + hi) >> 1;
+      final base = _shortlistOffset + mid * _shortlistSize;
+      final cmp = _compare(
+        _heapOffset + _data.getUint32(base, Endian.little),
+        _data.getUint16(base + 4, Endian.little),
+        q,
+        q.length,
+      );
+      if (cmp == 0) {
+        final count = _data.getUint16(base + 6, Endian.little);
+        final first = _data.getUint32(base + 8, Endian.little);
+        for (var i = 0; i < count; i++) {
+          final place = _data.getUint32(_shortlistIndexOffset + (first + i) * 4, Endian.little);
+          if (accept(place)) ranked.offer(place, 0, _placePopulation(place));
+        }
+        return;
+      }
+      if (cmp < 0) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+  }
+
+  void _searchPrefix(Uint8List q, bool Function(int) accept, _RankedPlaces ranked) {
+    final start = _lowerBound(q, q.length);
+    final end = min(keyCount, start + _maxPrefixScan);
+    for (var key = start; key < end; key++) {
+      if (!_keyHasPrefix(key, q, q.length)) break;
+      final place = _keyPlace(key);
+      if (!accept(place)) continue;
+      // Whole-name matches rank above longer names with the same prefix
+      final exact = _keyLength(key) == q.length;
+      ranked.offer(place, 0, _placePopulation(place), exact: exact);
+    }
+  }
+
+  /// Depth-first walk over the sorted keys computing optimal string alignment
+  /// distance between [q] and each key prefix, sharing rows between keys with
+  /// a common prefix as a trie walk would
+  void _searchFuzzy(Uint8List q, int maxDistance, bool Function(int) accept, _RankedPlaces ranked) {
+    final n = q.length;
+    final maxDepth = n + maxDistance + 1;
+    final rows = List.generate(maxDepth + 1, (_) => Int32List(n + 1));
+    for (var j = 0; j <= n; j++) {
+      rows[0][j] = j;
+    }
+
+    var budget = _maxFuzzyRows;
+    var previousOffset = 0, previousLength = 0, computedDepth = 0;
+    var key = 0;
+    while (key < keyCount && budget > 0) {
+      final offset = _keyOffset(key);
+      final length = min(_keyLength(key), maxDepth);
+
+      // Rows are still valid for the prefix shared with the previous key
+      var depth = 0;
+      final shared = min(computedDepth, min(length, previousLength));
+      while (depth < shared && _bytes[offset + depth] == _bytes[previousOffset + depth]) {
+        depth++;
+      }
+
+      var next = key + 1;
+      while (depth < length) {
+        final c = _bytes[offset + depth];
+        final prev = rows[depth];
+        final cur = rows[depth + 1];
+        cur[0] = depth + 1;
+        var rowMin = cur[0];
+        for (var j = 1; j <= n; j++) {
+          var v = prev[j - 1] + (q[j - 1] == c ? 0 : 1);
+          if (prev[j] + 1 < v) v = prev[j] + 1;
+          if (cur[j - 1] + 1 < v) v = cur[j - 1] + 1;
+          if (depth >= 1 && j >= 2 && c == q[j - 2] && _bytes[offset + depth - 1] == q[j - 1]) {
+            final transposed = rows[depth - 1][j - 2] + 1;
+            if (transposed < v) v = transposed;
+          }
+          cur[j] = v;
+          if (v < rowMin) rowMin = v;
+        }
+        depth++;
+        budget--;
+
+        if (cur[n] <= maxDistance) {
+          // Every key under this prefix matches; rank the range by population
+          next = _prefixEnd(key, Uint8List.sublistView(_bytes, offset, offset + depth), depth);
+          for (var k = key; k < next && k < key + _maxFuzzyRange; k++) {
+            final place = _keyPlace(k);
+            if (accept(place)) ranked.offer(place, cur[n], _placePopulation(place));
+          }
+          break;
+        }
+        if (rowMin > maxDistance) {
+          // No extension of this prefix can come within range
+          next = _prefixEnd(key, Uint8List.sublistView(_bytes, offset, offset + depth), depth);
+          break;
+        }
+      }
+
+      previousOffset = offset;
+      previousLength = length;
+      computedDepth = depth;
+      key = next;
+    }
+  }
+
+  // --- Normalization ---
+
+  static const String _foldFrom =
+      'àáâãäåçèéêëìíîïñòóôõöùúûüýÿāăąćĉċčďēĕėęěĝğġģĥĩīĭįĵķĺļľńņňōŏőŕŗřśŝşšţťũūŭůűųŵŷźżžơưșțđħłøıŧ';
+  static const String _foldTo =
+      'aaaaaaceeeeiiiinooooouuuuyyaaaccccdeeeeegggghiiiijklllnnnooorrrssssttuuuuuuwyzzzoustdhloit';
+  static final Map<int, String> _foldMap = {
+    for (var i = 0; i < _foldFrom.length; i++) _foldFrom.codeUnitAt(i): _foldTo[i],
+    0xdf: 'ss', // ß
+    0xe6: 'ae', // æ
+    0x153: 'oe', // œ
+  };
+
+  /// Search key for [text]: lower case, common Latin diacritics removed and
+  /// punctuation collapsed to single spaces
+  static String fold(String text) {
+    final buffer = StringBuffer();
+    var pendingSpace = false;
+    for (final rune in text.toLowerCase().runes) {
+      final isSeparator = rune < 0x80 &&
+          !(rune >= 0x61 && rune <= 0x7a) &&
+          !(rune >= 0x30 && rune <= 0x39);
+      if (isSeparator) {
+        pendingSpace = buffer.isNotEmpty;
+        continue;
+      }
+      if (pendingSpace) {
+        buffer.write(' ');
+        pendingSpace = false;
+      }
+      final folded = _foldMap[rune];
+      if (folded != null) {
+        buffer.write(folded);
+      } else {
+        buffer.writeCharCode(rune);
+      }
+    }
+    return buffer.toString();
+  }
+}
+
+class _RankedMatch {
+  final int place;
+  final int distance;
+  final int population;
+  final bool exact;
+
+  const _RankedMatch(this.place, this.distance, this.population, this.exact);
+
+  /// Fewer edits first, whole-name matches next, then larger places
+  bool betterThan(_RankedMatch other) {
+    if (distance != other.distance) return distance < other.distance;
+    if (exact != other.exact) return exact;
+    return population > other.population;
+  }
+}
+
+/// Keeps the best [limit] distinct places seen so far
+class _RankedPlaces {
+  final int limit;
+  final List<_RankedMatch> places = [];
+
+  _RankedPlaces(this.limit);
+
+  int get length => places.length;
+
+  void offer(int place, int distance, int population, {bool exact = false}) {
+    final match = _RankedMatch(place, distance, population, exact);
+    final existing = places.indexWhere((m) => m.place == place);
+    if (existing >= 0) {
+      if (!match.betterThan(places[existing])) return;
+      places.removeAt(existing);
+    } else if (places.length >= limit && !match.betterThan(places.last)) {
+      return;
+    }
+
+    var i = places.length;
+    while (i > 0 && match.betterThan(places[i - 1])) {
+      i--;
+    }
+    places.insert(i, match);
+    if (places.length > limit) places.removeLast();
+  }
+}
+
+/// Builds the binary format read by [GazetteerIndex]
+class GazetteerBuilder {
+  /// Cap on alternate names indexed per place, to bound the index size
+  static const int maxAlternateNames = 16;
+
+  final List<_PendingPlace> _places = [];
+
+  int get length => _places.length;
+
+  void add({
+    required String name,
+    required String country,
+    String admin = '',
+    required double latitude,
+    required double longitude,
+    int population = 0,
+    Iterable<String> alternateNames = const [],
+  }) {
+    final keys = <String>{fold(name)};
+    for (final alternate in alternateNames) {
+      if (keys.length > maxAlternateNames) break;
+      final key = GazetteerIndex.fold(alternate);
+      if (key.isNotEmpty) keys.add(key);
+    }
+    keys.remove('');
+    if (keys.isEmpty) return;
+    _places.add(_PendingPlace(name, country, admin, latitude, longitude, population, keys));
+  }
+
+  static String fold(String text) => GazetteerIndex.fold(text);
+
+  /// Add places from a GeoNames dump (`cities500.txt` and friends: tab
+  /// separated, one populated place per line)
+  void addGeoNames(String tsv) {
+    for (final line in const LineSplitter().convert(tsv)) {
+      final fields = line.split('\t');
+      if (fields.length < 15) continue;
+      final latitude = double.tryParse(fields[4]);
+      final longitude = double.tryParse(fields[5]);
+      if (latitude == null || longitude == null) continue;
+      add(
+        name: fields[1],
+        country: fields[8],
+        admin: fields[10],
+        latitude: latitude,
+        longitude: longitude,
+        population: int.tryParse(fields[14]) ?? 0,
+        alternateNames: [fields[2], ...fields[3].split(',')],
+      );
+    }
+  }
+
+  Uint8List build() {
+    final heap = BytesBuilder(copy: false);
+    final strings = <String, int>{};
+    int intern(List<int> bytes, String key) {
+      return strings.putIfAbsent(key, () {
+        final offset = heap.length;
+        heap.add(bytes);
+        return offset;
+      });
+    }
+
+    final places = ByteData(_places.length * _placeSize);
+    final keys = <_PendingKey>[];
+    for (var i = 0; i < _places.length; i++) {
+      final place = _places[i];
+      final name = utf8.encode(place.name);
+      final admin = utf8.encode(place.admin);
+      final base = i * _placeSize;
+      final country = '${place.country.toUpperCase()}  '.codeUnits;
+      places
+        ..setUint32(base, intern(name, place.name), Endian.little)
+        ..setUint16(base + 4, min(name.length, 0xffff), Endian.little)
+        ..setUint8(base + 6, country[0] < 0x80 ? country[0] : 0x20)
+        ..setUint8(base + 7, country[1] < 0x80 ? country[1] : 0x20)
+        ..setUint32(base + 8, intern(admin, place.admin), Endian.little)
+        ..setUint16(base + 12, min(admin.length, 0xffff), Endian.little)
+        ..setInt32(base + 16, (place.latitude * _coordinateScale).round(), Endian.little)
+        ..setInt32(base + 20, (place.longitude * _coordinateScale).round(), Endian.little)
+        ..setUint32(base + 24, min(max(place.population, 0), 0xffffffff), Endian.little);
+      for (final key in place.keys) {
+        keys.add(_PendingKey(Uint8List.fromList(utf8.encode(key)), i, place.population));
+      }
+    }
+    keys.sort((a, b) {
+      final cmp = _compareBytes(a.bytes, b.bytes);
+      return cmp != 0 ? cmp : b.population.compareTo(a.population);
+    });
+
+    final keyTable = ByteData(keys.length * _keySize);
+    for (var i = 0; i < keys.length; i++) {
+      final key = keys[i];
+      final text = latin1.decode(key.bytes);
+      keyTable
+        ..setUint32(i * _keySize, intern(key.bytes, '\u0000$text'), Endian.little)
+        ..setUint16(i * _keySize + 4, min(key.bytes.length, 0xffff), Endian.little)
+        ..setUint32(i * _keySize + 8, key.place, Endian.little);
+    }
+
+    // Most populous distinct places for each short prefix
+    final shortlists = <String, List<_PendingKey>>{};
+    for (final key in keys) {
+      for (var length = 1; length <= _shortlistPrefixBytes && length <= key.bytes.length; length++) {
+        final prefix = latin1.decode(Uint8List.sublistView(key.bytes, 0, length));
+        final list = shortlists.putIfAbsent(prefix, () => []);
+        if (list.any((k) => k.place == key.place)) continue;
+        list.add(key);
+        list.sort((a, b) => b.population.compareTo(a.population));
+        if (list.length > _shortlistLength) list.removeLast();
+      }
+    }
+    final prefixes = shortlists.keys.toList()
+      ..sort((a, b) => _compareBytes(latin1.encode(a), latin1.encode(b)));
+    final shortlistTable = ByteData(prefixes.length * _shortlistSize);
+    final shortlistIndices = <int>[];
+    for (var i = 0; i < prefixes.length; i++) {
+      final bytes = latin1.encode(prefixes[i]);
+      final list = shortlists[prefixes[i]]!;
+      shortlistTable
+        ..setUint32(i * _shortlistSize, intern(bytes, '\u0000${prefixes[i]}'), Endian.little)
+        ..setUint16(i * _shortlistSize + 4, bytes.length, Endian.little)
+        ..setUint16(i * _shortlistSize + 6, list.length, Endian.little)
+        ..setUint32(i * _shortlistSize + 8, shortlistIndices.length, Endian.little);
+      shortlistIndices.addAll(list.map((k) => k.place));
+    }
+    final indexTable = ByteData(shortlistIndices.length * 4);
+    for (var i = 0; i < shortlistIndices.length; i++) {
+      indexTable.setUint32(i * 4, shortlistIndices[i], Endian.little);
+    }
+
+    final heapBytes = heap.takeBytes();
+    final header = ByteData(_headerSize)
+      ..setUint32(0, _magic, Endian.little)
+      ..setUint16(4, _version, Endian.little)
+      ..setUint32(8, _places.length, Endian.little)
+      ..setUint32(12, keys.length, Endian.little)
+      ..setUint32(16, prefixes.length, Endian.little)
+      ..setUint32(20, shortlistIndices.length, Endian.little)
+      ..setUint32(24, heapBytes.length, Endian.little);
+    return (BytesBuilder(copy: false)
+          ..add(header.buffer.asUint8List())
+          ..add(places.buffer.asUint8List())
+          ..add(keyTable.buffer.asUint8List())
+          ..add(shortlistTable.buffer.asUint8List())
+          ..add(indexTable.buffer.asUint8List())
+          ..add(heapBytes))
+        .takeBytes();
+  }
+
+  static int _compareBytes(List<int> a, List<int> b) {
+    final n = min(a.length, b.length);
+    for (var i = 0; i < n; i++) {
+      final diff = a[i] - b[i];
+      if (diff != 0) return diff;
+    }
+    return a.length - b.length;
+  }
+}
+
+class _PendingPlace {
+  final String name;
+  final String country;
+  final String admin;
+  final double latitude;
+  final double longitude;
+  final int population;
+  final Set<String> keys;
+
+  const _PendingPlace(
+    this.name,
+    this.country,
+    this.admin,
+    this.latitude,
+    this.longitude,
+    this.population,
+    this.keys,
+  );
+}
+
+class _PendingKey {
+  final Uint8List bytes;
+  final int place;
+  final int population;
+
+  const _PendingKey(this.bytes, this.place, this.population);
+}
@@ -0,0 +1,288 @@
+import 'dart:convert';
+import 'dart:math';
+import 'dart:typed_data';
+
+const int _quote = 0x22;
+const int _backslash = 0x5c;
+const int _comma = 0x2c;
+const int _colon = 0x3a;
+const int _openBrace = 0x7b;
+const int _closeBrace = 0x7d;
+const int _openBracket = 0x5b;
+const int _closeBracket = 0x5d;
+const int _minus = 0x2d;
+const int _plus = 0x2b;
+const int _dot = 0x2e;
+const int _zero = 0x30;
+const int _nine = 0x39;
+
+final List<double> _powersOfTen = List.generate(23, (i) => pow(10, i).toDouble());
+
+/// On-demand JSON reader over UTF-8 bytes.
+///
+/// Instead of building a `Map<String, dynamic>` tree, the caller walks the
+/// document and pulls out only the fields it needs: object keys are matched
+/// against pre-encoded byte strings without allocating, and values that are
+/// not asked for are skipped by bracket counting without being decoded. Any
+/// malformed input throws a [FormatException], like `json.decode`.
+class JsonScanner {
+  final Uint8List _bytes;
+  int _pos = 0;
+
+  JsonScanner(this._bytes);
+
+  /// Encode object keys once for [nextKey]
+  static List<Uint8List> keys(List<String> names) =>
+      [for (final name in names) Uint8List.fromList(utf8.encode(name))];
+
+  /// Result of [nextKey] when the object has no more fields
+  static const int end = -2;
+
+  /// Result of [nextKey] for a key not in the list
+  static const int unknown = -1;
+
+  int get position => _pos;
+
+  Never _fail(String message) => throw FormatException(message, _bytes, _pos);
+
+  int _peek() {
+    final bytes = _bytes;
+    var pos = _pos;
+    while (pos < bytes.length) {
+      final c = bytes[pos];
+      if (c != 0x20 && c != 0x0a && c != 0x0d && c != 0x09) break;
+      pos++;
+    }
+    _pos = pos;
+    if (pos >= bytes.length) _fail('Unexpected end of JSON');
+    return bytes[pos];
+  }
+
+  bool _consumeNull() {
+    if (_pos + 4 <= _bytes.length &&
+        _bytes[_pos] == 0x6e &&
+        _bytes[_pos + 1] == 0x75 &&
+        _bytes[_pos + 2] == 0x6c &&
+        _bytes[_pos + 3] == 0x6c) {
+      _pos += 4;
+      return true;
+    }
+    return false;
+  }
+
+  /// Enter an object; returns false (and consumes the value) for null
+  bool beginObject() {
+    final c = _peek();
+    if (c == _openBrace) {
+      _pos++;
+      return true;
+    }
+    if (_consumeNull()) return false;
+    _fail('Expected an object');
+  }
+
+  /// Advance to the next field of the current object and return the index of
+  /// its key in [keys], [unknown], or [end] after consuming the closing brace.
+  /// The caller must then read or [skipValue] the field's value.
+  int nextKey(List<Uint8List> keys) {
+    var c = _peek();
+    if (c == _closeBrace) {
+      _pos++;
+      return end;
+    }
+    if (c == _comma) {
+      _pos++;
+      c = _peek();
+    }
+    if (c != _quote) _fail('Expected an object key');
+    final start = ++_pos;
+    final stop = _stringEnd();
+    _pos = stop + 1;
+    if (_peek() != _colon) _fail('Expected ":"');
+    _pos++;
+
+    final length = stop - start;
+    for (var k = 0; k < keys.length; k++) {
+      final key = keys[k];
+      if (key.length != length) continue;
+      var i = 0;
+      while (i < length && key[i] == _bytes[start + i]) {
+        i++;
+      }
+      if (i == length) return k;
+    }
+    return unknown;
+  }
+
+  /// Enter an array; returns false (and consumes the value) for null
+  bool beginArray() {
+    final c = _peek();
+    if (c == _openBracket) {
+      _pos++;
+      return true;
+    }
+    if (_consumeNull()) return false;
+    _fail('Expected an array');
+  }
+
+  /// Whether the current array has another element; consumes the closing
+  /// bracket when it does not
+  bool nextElement() {
+    final c = _peek();
+    if (c == _closeBracket) {
+      _pos++;
+      return false;
+    }
+    if (c == _comma) _pos++;
+    return true;
+  }
+
+  /// Skip the remaining elements or fields of the container just entered
+  void skipRest() {
+    _skipContainer(1);
+  }
+
+  /// Skip one value of any type
+  void skipValue() {
+    final c = _peek();
+    if (c == _quote) {
+      _pos++;
+      _pos = _stringEnd() + 1;
+    } else if (c == _openBrace || c == _openBracket) {
+      _pos++;
+      _skipContainer(1);
+    } else {
+      final bytes = _bytes;
+      var pos = _pos;
+      while (pos < bytes.length) {
+        final b = bytes[pos];
+        if (b == _comma || b == _closeBrace || b == _closeBracket || b <= 0x20) break;
+        pos++;
+      }
+      if (pos == _pos) _fail('Expected a value');
+      _pos = pos;
+    }
+  }
+
+  /// Jump past the container [depth] levels up, looking only at quotes and
+  /// brackets
+  void _skipContainer(int depth) {
+    final bytes = _bytes;
+    var pos = _pos;
+    while (depth > 0) {
+      if (pos >= bytes.length) {
+        _pos = pos;
+        _fail('Unexpected end of JSON');
+      }
+      final c = bytes[pos++];
+      if (c == _quote) {
+        while (true) {
+          if (pos >= bytes.length) {
+            _pos = pos;
+            _fail('Unterminated string');
+          }
+          final s = bytes[pos++];
+          if (s == _quote) break;
+          if (s == _backslash) pos++;
+        }
+      } else if (c == _openBrace || c == _openBracket) {
+        depth++;
+      } else if (c == _closeBrace || c == _closeBracket) {
+        depth--;
+      }
+    }
+    _pos = pos;
+  }
+
+  /// Index of the closing quote of the string whose content starts at _pos
+  int _stringEnd() {
+    final bytes = _bytes;
+    var pos = _pos;
+    while (pos < bytes.length) {
+      final c = bytes[pos];
+      if (c == _quote) return pos;
+      pos += c == _backslash ? 2 : 1;
+    }
+    _fail('Unterminated string');
+  }
+
+  /// Read a number; null (and the value is consumed) for JSON null or any
+  /// non-numeric value
+  double? number() {
+    final c = _peek();
+    if (c != _minus && (c < _zero || c > _nine)) {
+      skipValue();
+      return null;
+    }
+    final bytes = _bytes;
+    final start = _pos;
+    var pos = start;
+    final negative = c == _minus;
+    if (negative) pos++;
+
+    // Fast path: up to 15 significant digits and no exponent converts
+    // exactly as mantissa / 10^digits
+    var mantissa = 0;
+    var digits = 0;
+    var fraction = -1;
+    while (pos < bytes.length) {
+      final b = bytes[pos];
+      if (b >= _zero && b <= _nine) {
+        mantissa = mantissa * 10 + (b - _zero);
+        digits++;
+        if (fraction >= 0) fraction++;
+      } else if (b == _dot && fraction < 0) {
+        fraction = 0;
+      } else {
+        break;
+      }
+      pos++;
+    }
+    if (digits == 0) _fail('Invalid number');
+    final exponent = pos < bytes.length && (bytes[pos] | 0x20) == 0x65;
+    if (!exponent && digits <= 15) {
+      _pos = pos;
+      final value = fraction > 0 ? mantissa / _powersOfTen[fraction] : mantissa.toDouble();
+      return negative ? -value : value;
+    }
+
+    if (exponent) {
+      pos++;
+      if (pos < bytes.length && (bytes[pos] == _minus || bytes[pos] == _plus)) pos++;
+      while (pos < bytes.length && bytes[pos] >= _zero && bytes[pos] <= _nine) {
+        pos++;
+      }
+    }
+    _pos = pos;
+    return double.parse(String.fromCharCodes(bytes, start, pos));
+  }
+
+  /// Read a number as an int, rounding fractions; null for JSON null or any
+  /// non-numeric value
+  int? integer() => number()?.round();
+
+  /// Read a string; null (and the value is consumed) for JSON null or any
+  /// non-string value
+  String? string() {
+    if (_peek() != _quote) {
+      skipValue();
+      return null;
+    }
+    final start = ++_pos;
+    final stop = _stringEnd();
+    _pos = stop + 1;
+
+    var ascii = true;
+    for (var i = start; i < stop; i++) {
+      final b = _bytes[i];
+      if (b >= 0x80 || b == _backslash) {
+        ascii = false;
+        break;
+      }
+    }
+    if (ascii) return String.fromCharCodes(_bytes, start, stop);
+    // Escapes and multi-byte text are rare in the fields we read; let the
+    // SDK handle them for this one string
+    return json.decode(utf8.decode(Uint8List.sublistView(_bytes, start - 1, stop + 1))) as String;
+  }
+}
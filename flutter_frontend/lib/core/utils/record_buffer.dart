@@ -0,0 +1,333 @@
+import 'dart:convert';
+import 'dart:typed_data';
+import '../../models/rss_feed.dart';
+import '../../models/weather.dart';
+import '../../repositories/todo_repository.dart';
+
+/// Record schemas of the compact binary format used to hand bulk results
+/// between isolates. Field indices and type ids are part of the format.
+///
+/// Only Dart writes this format; results from the runner arrive through
+/// platform channels as `StandardMessageCodec` values.
+enum RecordType {
+  article(1, 8),
+  todo(2, 11),
+  weather(3, 16);
+
+  final int id;
+  final int fieldCount;
+
+  const RecordType(this.id, this.fieldCount);
+
+  static RecordType fromId(int id) {
+    return RecordType.values.firstWhere(
+      (type) => type.id == id,
+      orElse: () => throw FormatException('Unknown record type $id'),
+    );
+  }
+}
+
+/// Field indices for [RecordType.article]
+class ArticleField {
+  static const id = 0, title = 1, description = 2, url = 3, imageUrl = 4,
+      publishedAt = 5, feedId = 6, feedName = 7;
+}
+
+/// Field indices for [RecordType.todo]
+class TodoField {
+  static const id = 0, title = 1, description = 2, category = 3, priority = 4,
+      status = 5, createdAt = 6, updatedAt = 7, dueDate = 8, tags = 9,
+      userId = 10;
+}
+
+/// Field indices for [RecordType.weather]
+class WeatherField {
+  static const id = 0, location = 1, latitude = 2, longitude = 3,
+      temperature = 4, feelsLike = 5, humidity = 6, pressure = 7,
+      description = 8, icon = 9, windSpeed = 10, windDirection = 11,
+      cloudiness = 12, visibility = 13, timestamp = 14, units = 15;
+}
+
+const int _magic = 0x4244524d; // "MDRB"
+const int _version = 1;
+const int _headerSize = 16;
+const int _slotSize = 8;
+const String _tagSeparator = '\u001f';
+
+/// Read-only view over an encoded record buffer. Nothing is decoded up front:
+/// each accessor reads one fixed-offset slot, and strings are only decoded
+/// when asked for, so a 10k-article buffer costs one allocation to receive.
+class RecordBuffer {
+  final Uint8List bytes;
+  final ByteData _data;
+  final RecordType type;
+  final int length;
+  final int _heapOffset;
+  final int _recordSize;
+
+  RecordBuffer._(this.bytes, this._data, this.type, this.length, this._heapOffset)
+      : _recordSize = (type.fieldCount + 1) * _slotSize;
+
+  /// Wrap [bytes] without copying
+  factory RecordBuffer(Uint8List bytes) {
+    final data = ByteData.sublistView(bytes);
+    if (bytes.lengthInBytes < _headerSize ||
+        data.getUint32(0, Endian.little) != _magic) {
+      throw const FormatException('Not a record buffer');
+    }
+    final version = data.getUint16(4, Endian.little);
+    if (version != _version) {
+      throw FormatException('Unsupported record buffer version $version');
+    }
+    final type = RecordType.fromId(data.getUint16(6, Endian.little));
+    final count = data.getUint32(8, Endian.little);
+    final heapOffset = data.getUint32(12, Endian.little);
+    if (heapOffset != _headerSize + count * (type.fieldCount + 1) * _slotSize ||
+        heapOffset > bytes.lengthInBytes) {
+      throw const FormatException('Corrupt record buffer');
+    }
+    return RecordBuffer._(bytes, data, type, count, heapOffset);
+  }
+
+  int _slot(int record, int field) {
+    RangeError.checkValidIndex(record, this, 'record', length);
+    return _headerSize + record * _recordSize + (field + 1) * _slotSize;
+  }
+
+  /// Whether [field] of [record] is null
+  bool isNull(int record, int field) {
+    final mask = _data.getUint32(
+        _headerSize + record * _recordSize + (field >= 32 ? 4 : 0), Endian.little);
+    return mask & (1 << (field % 32)) != 0;
+  }
+
+  String? string(int record, int field) {
+    if (isNull(record, field)) return null;
+    final slot = _slot(record, field);
+    final offset = _heapOffset + _data.getUint32(slot, Endian.little);
+    final size = _data.getUint32(slot + 4, Endian.little);
+    return utf8.decode(Uint8List.sublistView(bytes, offset, offset + size));
+  }
+
+  /// Read an int64 slot as two 32-bit halves so this also works on web, where
+  /// ByteData has no 64-bit integer accessors (values stay within 2^53)
+  int? integer(int record, int field) {
+    if (isNull(record, field)) return null;
+    final slot = _slot(record, field);
+    final low = _data.getUint32(slot, Endian.little);
+    final high = _data.getInt32(slot + 4, Endian.little);
+    return high * 0x100000000 + low;
+  }
+
+  double? float(int record, int field) {
+    if (isNull(record, field)) return null;
+    return _data.getFloat64(_slot(record, field), Endian.little);
+  }
+
+  DateTime? dateTime(int record, int field) {
+    final millis = integer(record, field);
+    return millis == null ? null : DateTime.fromMillisecondsSinceEpoch(millis);
+  }
+
+  /// Lazily materialize articles, e.g. only the visible page of a list
+  NewsArticle article(int i) {
+    _checkType(RecordType.article);
+    return NewsArticle(
+      id: string(i, ArticleField.id) ?? '',
+      title: string(i, ArticleField.title) ?? '',
+      description: string(i, ArticleField.description) ?? '',
+      url: string(i, ArticleField.url) ?? '',
+      imageUrl: string(i, ArticleField.imageUrl),
+      publishedAt: dateTime(i, ArticleField.publishedAt) ?? DateTime.now(),
+      feedId: string(i, ArticleField.feedId) ?? '',
+      feedName: string(i, ArticleField.feedName) ?? '',
+    );
+  }
+
+  TodoItem todo(int i) {
+    _checkType(RecordType.todo);
+    final tags = string(i, TodoField.tags);
+    return TodoItem(
+      id: string(i, TodoField.id) ?? '',
+      title: string(i, TodoField.title) ?? '',
+      description: string(i, TodoField.description) ?? '',
+      category: string(i, TodoField.category) ?? 'general',
+      priority: string(i, TodoField.priority) ?? 'medium',
+      status: string(i, TodoField.status) ?? 'pending',
+      createdAt: dateTime(i, TodoField.createdAt) ?? DateTime.now(),
+      updatedAt: dateTime(i, TodoField.updatedAt) ?? DateTime.now(),
+      dueDate: dateTime(i, TodoField.dueDate),
+      tags: tags == null || tags.isEmpty ? const [] : tags.split(_tagSeparator),
+      userId: string(i, TodoField.userId),
+    );
+  }
+
+  WeatherData weather(int i) {
+    _checkType(RecordType.weather);
+    return WeatherData(
+      id: string(i, WeatherField.id) ?? 'unknown',
+      location: string(i, WeatherField.location) ?? 'Unknown Location',
+      latitude: float(i, WeatherField.latitude) ?? 0.0,
+      longitude: float(i, WeatherField.longitude) ?? 0.0,
+      temperature: float(i, WeatherField.temperature) ?? 0.0,
+      feelsLike: float(i, WeatherField.feelsLike) ?? 0.0,
+      humidity: integer(i, WeatherField.humidity) ?? 0,
+      pressure: float(i, WeatherField.pressure) ?? 0.0,
+      description: string(i, WeatherField.description) ?? '',
+      icon: string(i, WeatherField.icon) ?? '01d',
+      windSpeed: float(i, WeatherField.windSpeed) ?? 0.0,
+      windDirection: integer(i, WeatherField.windDirection) ?? 0,
+      cloudiness: integer(i, WeatherField.cloudiness) ?? 0,
+      visibility: integer(i, WeatherField.visibility) ?? 0,
+      timestamp: dateTime(i, WeatherField.timestamp) ?? DateTime.now(),
+      units: string(i, WeatherField.units) ?? 'metric',
+    );
+  }
+
+  void _checkType(RecordType expected) {
+    if (type != expected) {
+      throw StateError('Record buffer holds ${type.name} records, not ${expected.name}');
+    }
+  }
+}
+
+/// Encoder for the format, used to hand bulk results between isolates as a
+/// single buffer
+class RecordBufferWriter {
+  final RecordType type;
+  final BytesBuilder _records = BytesBuilder(copy: false);
+  final BytesBuilder _heap = BytesBuilder(copy: false);
+  int _count = 0;
+  ByteData? _current;
+
+  RecordBufferWriter(this.type);
+
+  /// Start a new record with every field null
+  void beginRecord() {
+    _flushRecord();
+    final record = ByteData((type.fieldCount + 1) * _slotSize);
+    final allNull = (1 << type.fieldCount) - 1;
+    record.setUint32(0, allNull & 0xffffffff, Endian.little);
+    _current = record;
+    _count++;
+  }
+
+  ByteData _slot(int field) {
+    final record = _current;
+    if (record == null) throw StateError('beginRecord() not called');
+    RangeError.checkValueInInterval(field, 0, type.fieldCount - 1, 'field');
+    final maskOffset = field >= 32 ? 4 : 0;
+    final mask = record.getUint32(maskOffset, Endian.little);
+    record.setUint32(maskOffset, mask & ~(1 << (field % 32)), Endian.little);
+    return record;
+  }
+
+  void setString(int field, String? value) {
+    if (value == null) return;
+    final encoded = utf8.encode(value);
+    final record = _slot(field);
+    record.setUint32((field + 1) * _slotSize, _heap.length, Endian.little);
+    record.setUint32((field + 1) * _slotSize + 4, encoded.length, Endian.little);
+    _heap.add(encoded);
+  }
+
+  void setInt(int field, int? value) {
+    if (value == null) return;
+    final record = _slot(field);
+    final offset = (field + 1) * _slotSize;
+    record.setUint32(offset, value & 0xffffffff, Endian.little);
+    record.setInt32(offset + 4, (value / 0x100000000).floor(), Endian.little);
+  }
+
+  void setDouble(int field, double? value) {
+    if (value == null) return;
+    _slot(field).setFloat64((field + 1) * _slotSize, value, Endian.little);
+  }
+
+  void setDateTime(int field, DateTime? value) => setInt(field, value?.millisecondsSinceEpoch);
+
+  void _flushRecord() {
+    final record = _current;
+    if (record != null) _records.add(record.buffer.asUint8List());
+    _current = null;
+  }
+
+  /// Assemble the buffer; the writer can not be reused afterwards
+  Uint8List finish() {
+    _flushRecord();
+    final heapOffset = _headerSize + _records.length;
+    final header = ByteData(_headerSize)
+      ..setUint32(0, _magic, Endian.little)
+      ..setUint16(4, _version, Endian.little)
+      ..setUint16(6, type.id, Endian.little)
+      ..setUint32(8, _count, Endian.little)
+      ..setUint32(12, heapOffset, Endian.little);
+    return (BytesBuilder(copy: false)
+          ..add(header.buffer.asUint8List())
+          ..add(_records.takeBytes())
+          ..add(_heap.takeBytes()))
+        .takeBytes();
+  }
+
+  static Uint8List encodeArticles(Iterable<NewsArticle> articles) {
+    final writer = RecordBufferWriter(RecordType.article);
+    for (final article in articles) {
+      writer
+        ..beginRecord()
+        ..setString(ArticleField.id, article.id)
+        ..setString(ArticleField.title, article.title)
+        ..setString(ArticleField.description, article.description)
+        ..setString(ArticleField.url, article.url)
+        ..setString(ArticleField.imageUrl, article.imageUrl)
+        ..setDateTime(ArticleField.publishedAt, article.publishedAt)
+        ..setString(ArticleField.feedId, article.feedId)
+        ..setString(ArticleField.feedName, article.feedName);
+    }
+    return writer.finish();
+  }
+
+  static Uint8List encodeTodos(Iterable<TodoItem> todos) {
+    final writer = RecordBufferWriter(RecordType.todo);
+    for (final todo in todos) {
+      writer
+        ..beginRecord()
+        ..setString(TodoField.id, todo.id)
+        ..setString(TodoField.title, todo.title)
+        ..setString(TodoField.description, todo.description)
+        ..setString(TodoField.category, todo.category)
+        ..setString(TodoField.priority, todo.priority)
+        ..setString(TodoField.status, todo.status)
+        ..setDateTime(TodoField.createdAt, todo.createdAt)
+        ..setDateTime(TodoField.updatedAt, todo.updatedAt)
+        ..setDateTime(TodoField.dueDate, todo.dueDate)
+        ..setString(TodoField.tags, todo.tags.join(_tagSeparator))
+        ..setString(TodoField.userId, todo.userId);
+    }
+    return writer.finish();
+  }
+
+  static Uint8List encodeWeather(Iterable<WeatherData> observations) {
+    final writer = RecordBufferWriter(RecordType.weather);
+    for (final weather in observations) {
+      writer
+        ..beginRecord()
+        ..setString(WeatherField.id, weather.id)
+        ..setString(WeatherField.location, weather.location)
+        ..setDouble(WeatherField.latitude, weather.latitude)
+        ..setDouble(WeatherField.longitude, weather.longitude)
+        ..setDouble(WeatherField.temperature, weather.temperature)
+        ..setDouble(WeatherField.feelsLike, weather.feelsLike)
+        ..setInt(WeatherField.humidity, weather.humidity)
+        ..setDouble(WeatherField.pressure, weather.pressure)
+        ..setString(WeatherField.description, weather.description)
+        ..setString(WeatherField.icon, weather.icon)
+        ..setDouble(WeatherField.windSpeed, weather.windSpeed)
+        ..setInt(WeatherField.windDirection, weather.windDirection)
+        ..setInt(WeatherField.cloudiness, weather.cloudiness)
+        ..setInt(WeatherField.visibility, weather.visibility)
+        ..setDateTime(WeatherField.timestamp, weather.timestamp)
+        ..setString(WeatherField.units, weather.units);
+    }
+    return writer.finish();
+  }
+}
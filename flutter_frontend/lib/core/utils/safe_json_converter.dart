@@ -234,7 +234,15 @@ class SafeJsonConverter {
 
   // Cache for runtime type strings to avoid repeated toString() calls
   static final Map<Type, String> _typeStringCache = <Type, String>{};
-  static const int _maxCacheSize = 100;
+  static int _maxCacheSize = 100;
+
+  /// Resize the runtime type string cache (sized from the resource budget)
+  static void setTypeCacheSize(int maxEntries) {
+    _maxCacheSize = maxEntries < 1 ? 1 : maxEntries;
+    while (_typeStringCache.length > _maxCacheSize) {
+      _typeStringCache.remove(_typeStringCache.keys.first);
+    }
+  }
   
   // Set for known problematic type patterns
   static final Set<String> _problematicTypePatterns = {
@@ -0,0 +1,282 @@
+import 'dart:async';
+import 'dart:math';
+
+/// Geohash encoding helpers
+class Geohash {
+  static const String _alphabet = '0123456789bcdefghjkmnpqrstuvwxyz';
+
+  /// Encode a coordinate as a geohash of [precision] characters
+  static String encode(double latitude, double longitude, {int precision = 6}) {
+    var latMin = -90.0, latMax = 90.0;
+    var lonMin = -180.0, lonMax = 180.0;
+    final buffer = StringBuffer();
+    var bit = 0, value = 0;
+    var evenBit = true;
+
+    while (buffer.length < precision) {
+      if (evenBit) {
+        final mid = (lonMin + lonMax) / 2;
+        if (longitude >= mid) {
+          value = (value << 1) | 1;
+          lonMin = mid;
+        } else {
+          value <<= 1;
+          lonMax = mid;
+        }
+      } else {
+        final mid = (latMin + latMax) / 2;
+        if (latitude >= mid) {
+          value = (value << 1) | 1;
+          latMin = mid;
+        } else {
+          value <<= 1;
+          latMax = mid;
+        }
+      }
+      evenBit = !evenBit;
+
+      if (++bit == 5) {
+        buffer.write(_alphabet[value]);
+        bit = 0;
+        value = 0;
+      }
+    }
+    return buffer.toString();
+  }
+
+  /// Cell size in degrees (latitude, longitude) at [precision]
+  static (double, double) cellSize(int precision) {
+    final bits = precision * 5;
+    final lonBits = (bits + 1) ~/ 2;
+    final latBits = bits ~/ 2;
+    return (180 / (1 << latBits), 360 / (1 << lonBits));
+  }
+
+  /// The cell containing the coordinate and its eight neighbours
+  static Set<String> neighbourhood(double latitude, double longitude, {int precision = 6}) {
+    final (cellLat, cellLon) = cellSize(precision);
+    final cells = <String>{};
+    for (final dy in const [-1, 0, 1]) {
+      for (final dx in const [-1, 0, 1]) {
+        final lat = (latitude + dy * cellLat).clamp(-90.0, 90.0);
+        var lon = longitude + dx * cellLon;
+        if (lon >= 180) lon -= 360;
+        if (lon < -180) lon += 360;
+        cells.add(encode(lat, lon, precision: precision));
+      }
+    }
+    return cells;
+  }
+
+  /// Great-circle distance in metres
+  static double distanceMeters(double lat1, double lon1, double lat2, double lon2) {
+    const earthRadius = 6371000.0;
+    final dLat = (lat2 - lat1) * pi / 180;
+    final dLon = (lon2 - lon1) * pi / 180;
+    final a = sin(dLat / 2) * sin(dLat / 2) +
+        cos(lat1 * pi / 180) * cos(lat2 * pi / 180) * sin(dLon / 2) * sin(dLon / 2);
+    return 2 * earthRadius * asin(min(1.0, sqrt(a)));
+  }
+}
+
+/// Hit/miss counters for a [SpatialCache]
+class SpatialCacheStats {
+  final int hits;
+  final int nearbyHits;
+  final int misses;
+  final int coalesced;
+  final int entries;
+
+  const SpatialCacheStats({
+    required this.hits,
+    required this.nearbyHits,
+    required this.misses,
+    required this.coalesced,
+    required this.entries,
+  });
+
+  /// Fraction of lookups served without a new fetch
+  double get hitRate {
+    final total = hits + misses + coalesced;
+    return total == 0 ? 0 : (hits + coalesced) / total;
+  }
+
+  @override
+  String toString() {
+    return 'hits: $hits ($nearbyHits nearby), coalesced: $coalesced, '
+        'misses: $misses, rate: ${(hitRate * 100).toStringAsFixed(1)}%, '
+        'entries: $entries';
+  }
+}
+
+class _SpatialEntry<T> {
+  final double latitude;
+  final double longitude;
+  final T value;
+  final DateTime storedAt;
+
+  _SpatialEntry(this.latitude, this.longitude, this.value, this.storedAt);
+}
+
+class _InFlight<T> {
+  final double latitude;
+  final double longitude;
+  final String partition;
+  final Future<T> future;
+
+  _InFlight(this.latitude, this.longitude, this.partition, this.future);
+}
+
+/// Cache of location-bound values (weather observations) indexed by geohash.
+///
+/// A lookup returns the freshest entry within [maxDistanceMeters] and
+/// [maxAge] of the requested coordinate, searching the request's cell and its
+/// neighbours, so nearby fixes and differently spelled names of the same
+/// place share one entry. Concurrent fetches for coordinates within range of
+/// each other are merged into one. [partition] separates values that must not
+/// be shared across the same place, such as different units.
+///
+/// The default precision of 5 gives cells of roughly 4.9 x 4.9 km, so the
+/// 3 x 3 neighbourhood always covers the 2 km default tolerance below about
+/// 65 degrees latitude.
+class SpatialCache<T> {
+  final int precision;
+  final double maxDistanceMeters;
+  final Duration maxAge;
+  final int maxEntries;
+
+  final Map<String, List<_SpatialEntry<T>>> _cells = {};
+  final List<_InFlight<T>> _inFlight = [];
+  int _entryCount = 0;
+  int _hits = 0;
+  int _nearbyHits = 0;
+  int _misses = 0;
+  int _coalesced = 0;
+
+  SpatialCache({
+    this.precision = 5,
+    this.maxDistanceMeters = 2000,
+    this.maxAge = const Duration(minutes: 10),
+    this.maxEntries = 256,
+  });
+
+  SpatialCacheStats get stats => SpatialCacheStats(
+        hits: _hits,
+        nearbyHits: _nearbyHits,
+        misses: _misses,
+        coalesced: _coalesced,
+        entries: _entryCount,
+      );
+
+  String _cellKey(String partition, String cell) => '$partition|$cell';
+
+  _SpatialEntry<T>? _find(double latitude, double longitude, String partition, Duration maxAge) {
+    final now = DateTime.now();
+    _SpatialEntry<T>? best;
+    var bestDistance = double.infinity;
+    for (final cell in Geohash.neighbourhood(latitude, longitude, precision: precision)) {
+      final entries = _cells[_cellKey(partition, cell)];
+      if (entries == null) continue;
+      for (final entry in entries) {
+        if (now.difference(entry.storedAt) > maxAge) continue;
+        final distance = Geohash.distanceMeters(latitude, longitude, entry.latitude, entry.longitude);
+        if (distance <= maxDistanceMeters && distance < bestDistance) {
+          best = entry;
+          bestDistance = distance;
+        }
+      }
+    }
+    return best;
+  }
+
+  /// Cached value near the coordinate, or null; counts towards the stats
+  T? lookup(double latitude, double longitude, {String partition = '', Duration? maxAge}) {
+    final entry = _find(latitude, longitude, partition, maxAge ?? this.maxAge);
+    if (entry == null) {
+      _misses++;
+      return null;
+    }
+    _hits++;
+    if (entry.latitude != latitude || entry.longitude != longitude) _nearbyHits++;
+    return entry.value;
+  }
+
+  /// Newest value near the coordinate regardless of age, for serving stale
+  /// data when a refresh fails
+  T? lookupStale(double latitude, double longitude, {String partition = ''}) {
+    return _find(latitude, longitude, partition, const Duration(days: 3650))?.value;
+  }
+
+  void put(double latitude, double longitude, T value, {String partition = ''}) {
+    final key = _cellKey(partition, Geohash.encode(latitude, longitude, precision: precision));
+    final entries = _cells.putIfAbsent(key, () => []);
+    // One entry per exact coordinate; a newer observation replaces the old
+    final before = entries.length;
+    entries.removeWhere((e) => e.latitude == latitude && e.longitude == longitude);
+    _entryCount -= before - entries.length;
+    entries.add(_SpatialEntry(latitude, longitude, value, DateTime.now()));
+    _entryCount++;
+    if (_entryCount > maxEntries) _evictOldest();
+  }
+
+  void _evictOldest() {
+    String? oldestKey;
+    _SpatialEntry<T>? oldest;
+    _cells.forEach((key, entries) {
+      for (final entry in entries) {
+        if (oldest == null || entry.storedAt.isBefore(oldest!.storedAt)) {
+          oldest = entry;
+          oldestKey = key;
+        }
+      }
+    });
+    if (oldestKey == null) return;
+    final entries = _cells[oldestKey]!..remove(oldest);
+    if (entries.isEmpty) _cells.remove(oldestKey);
+    _entryCount--;
+  }
+
+  /// Return a cached value near the coordinate, join a fetch already running
+  /// for a nearby coordinate, or run [fetch] and cache its result
+  Future<T> getOrFetch(
+    double latitude,
+    double longitude,
+    Future<T> Function() fetch, {
+    String partition = '',
+    double Function(T value)? resultLatitude,
+    double Function(T value)? resultLongitude,
+  }) {
+    final cached = lookup(latitude, longitude, partition: partition);
+    if (cached != null) return Future.value(cached);
+
+    for (final pending in _inFlight) {
+      if (pending.partition == partition &&
+          Geohash.distanceMeters(latitude, longitude, pending.latitude, pending.longitude) <=
+              maxDistanceMeters) {
+        // The lookup above counted a miss; this request costs no fetch
+        _misses--;
+        _coalesced++;
+        return pending.future;
+      }
+    }
+
+    final future = fetch().then((value) {
+      put(
+        resultLatitude?.call(value) ?? latitude,
+        resultLongitude?.call(value) ?? longitude,
+        value,
+        partition: partition,
+      );
+      return value;
+    });
+    final pending = _InFlight(latitude, longitude, partition, future);
+    _inFlight.add(pending);
+    future.whenComplete(() => _inFlight.remove(pending)).ignore();
+    return future;
+  }
+
+  void clear() {
+    _cells.clear();
+    _entryCount = 0;
+  }
+}
@@ -0,0 +1,378 @@
+import 'dart:math';
+import 'package:xml/xml_events.dart';
+
+/// Manifest formats understood by [StreamManifest.parse]
+enum ManifestKind { hlsMaster, hlsMedia, dash }
+
+/// One selectable rendition of an adaptive stream
+class StreamVariant {
+  final Uri uri;
+  final int bandwidth;
+  final int? width;
+  final int? height;
+  final String? codecs;
+  final double? frameRate;
+
+  const StreamVariant({
+    required this.uri,
+    required this.bandwidth,
+    this.width,
+    this.height,
+    this.codecs,
+    this.frameRate,
+  });
+
+  /// Audio-only renditions carry codecs but no resolution
+  bool get isAudioOnly => height == null && (codecs?.startsWith('mp4a') ?? false);
+
+  /// '720p', or the bitrate when the resolution is not advertised
+  String get label => height != null ? '${height}p' : '${(bandwidth / 1000).round()} kbps';
+
+  @override
+  String toString() => 'StreamVariant($label, $bandwidth bps, ${codecs ?? '-'})';
+}
+
+/// A segment's position on the presentation timeline, in seconds
+class ManifestSegment {
+  final Uri? uri;
+  final double start;
+  final double duration;
+
+  const ManifestSegment(this.uri, this.start, this.duration);
+}
+
+/// Parsed HLS master/media playlist or DASH MPD
+class StreamManifest {
+  final ManifestKind kind;
+  final List<StreamVariant> variants;
+  final List<ManifestSegment> segments;
+  final bool isLive;
+
+  /// Longest segment duration (HLS target duration, DASH template duration)
+  final double? targetDuration;
+
+  /// Total duration for VOD, null for live
+  final Duration? duration;
+
+  /// First segment's sequence number (HLS media sequence, DASH start number)
+  final int mediaSequence;
+
+  const StreamManifest({
+    required this.kind,
+    this.variants = const [],
+    this.segments = const [],
+    required this.isLive,
+    this.targetDuration,
+    this.duration,
+    this.mediaSequence = 0,
+  });
+
+  /// How often a live manifest should be reloaded
+  Duration get reloadInterval =>
+      Duration(milliseconds: ((targetDuration ?? 6) * 1000).round());
+
+  /// Whether [text] looks like a manifest this class can parse
+  static bool isManifest(String text) {
+    final head = text.trimLeft();
+    return head.startsWith('#EXTM3U') || head.contains('<MPD');
+  }
+
+  /// Parse [text] fetched from [base]; relative URIs resolve against it
+  static StreamManifest parse(String text, Uri base) {
+    final head = text.trimLeft();
+    if (head.startsWith('#EXTM3U')) return _parseHls(head, base);
+    if (head.contains('<MPD')) return _parseDash(head, base);
+    throw const FormatException('Not an HLS playlist or DASH manifest');
+  }
+
+  static StreamManifest _parseHls(String text, Uri base) {
+    final variants = <StreamVariant>[];
+    final segments = <ManifestSegment>[];
+    Map<String, String>? pendingVariant;
+    double? pendingDuration;
+    double? targetDuration;
+    var mediaSequence = 0;
+    var ended = false;
+    var vod = false;
+    var time = 0.0;
+
+    var start = 0;
+    while (start < text.length) {
+      var end = text.indexOf('\n', start);
+      if (end < 0) end = text.length;
+      final line = text.substring(start, end).trim();
+      start = end + 1;
+      if (line.isEmpty) continue;
+
+      if (line.startsWith('#')) {
+        if (line.startsWith('#EXT-X-STREAM-INF:')) {
+          pendingVariant = _hlsAttributes(line.substring(18));
+        } else if (line.startsWith('#EXTINF:')) {
+          final comma = line.indexOf(',');
+          pendingDuration = double.tryParse(line.substring(8, comma < 0 ? line.length : comma));
+        } else if (line.startsWith('#EXT-X-TARGETDURATION:')) {
+          targetDuration = double.tryParse(line.substring(22));
+        } else if (line.startsWith('#EXT-X-MEDIA-SEQUENCE:')) {
+          mediaSequence = int.tryParse(line.substring(22)) ?? 0;
+        } else if (line.startsWith('#EXT-X-ENDLIST')) {
+          ended = true;
+        } else if (line.startsWith('#EXT-X-PLAYLIST-TYPE:')) {
+          vod = line.substring(21) == 'VOD';
+        }
+        continue;
+      }
+
+      // A URI line belongs to the tag before it
+      if (pendingVariant != null) {
+        final resolution = pendingVariant['RESOLUTION']?.split('x');
+        variants.add(StreamVariant(
+          uri: base.resolve(line),
+          bandwidth: int.tryParse(pendingVariant['BANDWIDTH'] ?? '') ?? 0,
+          width: resolution != null && resolution.length == 2 ? int.tryParse(resolution[0]) : null,
+          height: resolution != null && resolution.length == 2 ? int.tryParse(resolution[1]) : null,
+          codecs: pendingVariant['CODECS'],
+          frameRate: double.tryParse(pendingVariant['FRAME-RATE'] ?? ''),
+        ));
+        pendingVariant = null;
+      } else if (pendingDuration != null) {
+        segments.add(ManifestSegment(base.resolve(line), time, pendingDuration));
+        time += pendingDuration;
+        pendingDuration = null;
+      }
+    }
+
+    if (variants.isNotEmpty) {
+      // A master playlist says nothing about liveness; the media playlists do
+      return StreamManifest(kind: ManifestKind.hlsMaster, variants: variants, isLive: false);
+    }
+    final isLive = !ended && !vod;
+    return StreamManifest(
+      kind: ManifestKind.hlsMedia,
+      segments: segments,
+      isLive: isLive,
+      targetDuration: targetDuration,
+      duration: isLive ? null : Duration(milliseconds: (time * 1000).round()),
+      mediaSequence: mediaSequence,
+    );
+  }
+
+  /// Attribute list of an HLS tag; quoted values may contain commas
+  static Map<String, String> _hlsAttributes(String list) {
+    final attributes = <String, String>{};
+    var i = 0;
+    while (i < list.length) {
+      final equals = list.indexOf('=', i);
+      if (equals < 0) break;
+      final name = list.substring(i, equals).trim();
+      var valueStart = equals + 1;
+      int valueEnd;
+      if (valueStart < list.length && list[valueStart] == '"') {
+        valueStart++;
+        valueEnd = list.indexOf('"', valueStart);
+        if (valueEnd < 0) valueEnd = list.length;
+        attributes[name] = list.substring(valueStart, valueEnd);
+        final comma = list.indexOf(',', valueEnd);
+        i = comma < 0 ? list.length : comma + 1;
+      } else {
+        valueEnd = list.indexOf(',', valueStart);
+        if (valueEnd < 0) valueEnd = list.length;
+        attributes[name] = list.substring(valueStart, valueEnd);
+        i = valueEnd + 1;
+      }
+    }
+    return attributes;
+  }
+
+  /// Walk the MPD as a stream of XML events, without building a DOM
+  static StreamManifest _parseDash(String text, Uri base) {
+    final variants = <StreamVariant>[];
+    final segments = <ManifestSegment>[];
+    var isLive = false;
+    Duration? duration;
+    double? templateDuration;
+    var startNumber = 1;
+
+    var baseUri = base;
+    var inBaseUrl = false;
+    Map<String, String> adaptationSet = const {};
+    Map<String, String>? representation;
+    var timescale = 1;
+    var timelineTime = 0;
+    var timelineTaken = false;
+
+    for (final event in parseEvents(text)) {
+      if (event is XmlStartElementEvent) {
+        final name = _localName(event.name);
+        final attributes = {for (final a in event.attributes) _localName(a.name): a.value};
+        switch (name) {
+          case 'MPD':
+            isLive = attributes['type'] == 'dynamic';
+            final presentation = attributes['mediaPresentationDuration'];
+            if (presentation != null) duration = _isoDuration(presentation);
+          case 'BaseURL':
+            inBaseUrl = !event.isSelfClosing;
+          case 'AdaptationSet':
+            adaptationSet = attributes;
+          case 'Representation':
+            representation = attributes;
+            if (event.isSelfClosing) {
+              _addRepresentation(variants, adaptationSet, attributes, baseUri);
+              representation = null;
+            }
+          case 'SegmentTemplate':
+            timescale = int.tryParse(attributes['timescale'] ?? '') ?? timescale;
+            startNumber = int.tryParse(attributes['startNumber'] ?? '') ?? startNumber;
+            final d = int.tryParse(attributes['duration'] ?? '');
+            if (d != null) templateDuration = d / timescale;
+          case 'SegmentTimeline':
+            timelineTime = 0;
+          case 'S':
+            // Timing of the first timeline only; renditions share it
+            if (timelineTaken) break;
+            final t = int.tryParse(attributes['t'] ?? '');
+            final d = int.tryParse(attributes['d'] ?? '') ?? 0;
+            final r = int.tryParse(attributes['r'] ?? '') ?? 0;
+            if (t != null) timelineTime = t;
+            for (var k = 0; k <= max(0, r); k++) {
+              segments.add(ManifestSegment(null, timelineTime / timescale, d / timescale));
+              timelineTime += d;
+            }
+        }
+      } else if (event is XmlTextEvent && inBaseUrl) {
+        final value = event.value.trim();
+        if (value.isNotEmpty) baseUri = baseUri.resolve(value);
+      } else if (event is XmlEndElementEvent) {
+        switch (_localName(event.name)) {
+          case 'BaseURL':
+            inBaseUrl = false;
+          case 'Representation':
+            final attributes = representation;
+            if (attributes != null) {
+              _addRepresentation(variants, adaptationSet, attributes, baseUri);
+            }
+            representation = null;
+          case 'AdaptationSet':
+            adaptationSet = const {};
+          case 'SegmentTimeline':
+            if (segments.isNotEmpty) timelineTaken = true;
+        }
+      }
+    }
+
+    final longest = segments.fold<double>(0, (m, s) => max(m, s.duration));
+    return StreamManifest(
+      kind: ManifestKind.dash,
+      variants: variants,
+      segments: segments,
+      isLive: isLive,
+      targetDuration: templateDuration ?? (longest > 0 ? longest : null),
+      duration: isLive ? null : duration,
+      mediaSequence: startNumber,
+    );
+  }
+
+  static void _addRepresentation(
+    List<StreamVariant> variants,
+    Map<String, String> adaptationSet,
+    Map<String, String> attributes,
+    Uri base,
+  ) {
+    String? inherited(String key) => attributes[key] ?? adaptationSet[key];
+    final mimeType = inherited('mimeType') ?? '';
+    final contentType = inherited('contentType') ?? '';
+    // Text tracks are not variants
+    if (mimeType.startsWith('text/') || mimeType.startsWith('application/') ||
+        contentType == 'text') {
+      return;
+    }
+    final frameRate = inherited('frameRate');
+    double? fps;
+    if (frameRate != null) {
+      final parts = frameRate.split('/');
+      final numerator = double.tryParse(parts[0]);
+      final denominator = parts.length > 1 ? double.tryParse(parts[1]) : 1.0;
+      if (numerator != null && denominator != null && denominator != 0) {
+        fps = numerator / denominator;
+      }
+    }
+    variants.add(StreamVariant(
+      // Segments are addressed through templates; the variant points at the
+      // MPD with the representation as fragment
+      uri: base.replace(fragment: attributes['id']),
+      bandwidth: int.tryParse(attributes['bandwidth'] ?? '') ?? 0,
+      width: int.tryParse(inherited('width') ?? ''),
+      height: int.tryParse(inherited('height') ?? ''),
+      codecs: inherited('codecs'),
+      frameRate: fps,
+    ));
+  }
+
+  static String _localName(String name) {
+    final colon = name.indexOf(':');
+    return colon < 0 ? name : name.substring(colon + 1);
+  }
+
+  static final RegExp _isoDurationPattern =
+      RegExp(r'^P(?:(\d+)D)?(?:T(?:(\d+)H)?(?:(\d+)M)?(?:([\d.]+)S)?)?$');
+
+  /// Parse an xs:duration such as PT1H2M3.5S
+  static Duration? _isoDuration(String value) {
+    final match = _isoDurationPattern.firstMatch(value.trim());
+    if (match == null) return null;
+    final days = int.tryParse(match.group(1) ?? '') ?? 0;
+    final hours = int.tryParse(match.group(2) ?? '') ?? 0;
+    final minutes = int.tryParse(match.group(3) ?? '') ?? 0;
+    final seconds = double.tryParse(match.group(4) ?? '') ?? 0;
+    return Duration(
+      days: days,
+      hours: hours,
+      minutes: minutes,
+      milliseconds: (seconds * 1000).round(),
+    );
+  }
+}
+
+/// Picks the rendition a tile should play.
+///
+/// The tile's physical height sets the resolution worth fetching: the
+/// smallest variant at least that tall, or the tallest one when none is.
+/// The measured bandwidth, shared by every adaptive stream on screen with
+/// headroom for throughput variation, caps the bitrate; when the pick does
+/// not fit, the best variant that does is used instead.
+class VariantSelector {
+  /// Share of the measured bandwidth the streams may use together
+  static const double headroom = 0.8;
+
+  static StreamVariant? select(
+    List<StreamVariant> variants, {
+    required double tileHeightPixels,
+    required double bandwidthBps,
+    int concurrentStreams = 1,
+    int? maxHeight,
+  }) {
+    var candidates = variants.where((v) => !v.isAudioOnly).toList();
+    if (candidates.isEmpty) candidates = [...variants];
+    if (candidates.isEmpty) return null;
+    if (maxHeight != null) {
+      final capped = candidates.where((v) => v.height == null || v.height! <= maxHeight).toList();
+      if (capped.isNotEmpty) candidates = capped;
+    }
+    candidates.sort((a, b) => a.bandwidth.compareTo(b.bandwidth));
+
+    StreamVariant? pick;
+    for (final variant in candidates) {
+      if (variant.height != null && variant.height! >= tileHeightPixels) {
+        pick = variant;
+        break;
+      }
+    }
+    pick ??= candidates.last;
+
+    final budget = bandwidthBps * headroom / max(1, concurrentStreams);
+    if (pick.bandwidth > budget) {
+      final affordable = candidates.where((v) => v.bandwidth <= budget);
+      pick = affordable.isEmpty ? candidates.first : affordable.last;
+    }
+    return pick;
+  }
+}
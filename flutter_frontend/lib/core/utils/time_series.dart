@@ -0,0 +1,471 @@
+import 'dart:math';
+import 'dart:typed_data';
+
+/// One sample of a series
+class TimeSeriesPoint {
+  final DateTime time;
+  final double value;
+
+  const TimeSeriesPoint(this.time, this.value);
+
+  @override
+  String toString() => 'TimeSeriesPoint($time, $value)';
+}
+
+/// Growable MSB-first bit stream. Values are written at most 32 bits at a
+/// time so the codec behaves the same on web, where bitwise operators work on
+/// 32-bit integers.
+class _BitWriter {
+  Uint8List _bytes = Uint8List(32);
+  int bitLength = 0;
+
+  void writeBit(int bit) {
+    final byte = bitLength >> 3;
+    if (byte >= _bytes.length) {
+      final grown = Uint8List(_bytes.length * 2)..setRange(0, _bytes.length, _bytes);
+      _bytes = grown;
+    }
+    if (bit != 0) _bytes[byte] |= 0x80 >> (bitLength & 7);
+    bitLength++;
+  }
+
+  void write(int value, int bits) {
+    for (var i = bits - 1; i >= 0; i--) {
+      writeBit((value >> i) & 1);
+    }
+  }
+
+  /// Write bits [low, high] (inclusive, 0 = least significant) of the 64-bit
+  /// value held as two 32-bit halves
+  void write64(int hi, int lo, int high, int low) {
+    for (var i = high; i >= low; i--) {
+      writeBit(i >= 32 ? (hi >> (i - 32)) & 1 : (lo >> i) & 1);
+    }
+  }
+
+  Uint8List get bytes => Uint8List.sublistView(_bytes, 0, (bitLength + 7) >> 3);
+}
+
+class _BitReader {
+  final Uint8List _bytes;
+  final int _bitLength;
+  int _position = 0;
+
+  _BitReader(this._bytes, this._bitLength);
+
+  bool get hasMore => _position < _bitLength;
+
+  int readBit() {
+    final bit = (_bytes[_position >> 3] >> (7 - (_position & 7))) & 1;
+    _position++;
+    return bit;
+  }
+
+  int read(int bits) {
+    var value = 0;
+    for (var i = 0; i < bits; i++) {
+      value = value * 2 + readBit();
+    }
+    return value;
+  }
+}
+
+/// Per-column state of the XOR float encoder
+class _XorState {
+  int hi = 0;
+  int lo = 0;
+  int leading = -1;
+  int trailing = 0;
+}
+
+final ByteData _scratch = ByteData(8);
+
+int _leadingZeros32(int x) => 32 - x.bitLength;
+
+int _trailingZeros32(int x) {
+  var n = 0;
+  while (n < 32 && (x & 1) == 0) {
+    x >>= 1;
+    n++;
+  }
+  return n;
+}
+
+/// A sealed or open run of samples: one delta-of-delta timestamp stream and
+/// one XOR-compressed stream per column
+class _Block {
+  final int columnCount;
+  final _BitWriter? _timeWriter;
+  final List<_BitWriter>? _valueWriters;
+  final List<_XorState> _states;
+  Uint8List? _timeBytes;
+  int _timeBits = 0;
+  List<Uint8List>? _valueBytes;
+  List<int>? _valueBits;
+
+  int count = 0;
+  int startTime = 0;
+  int endTime = 0;
+  int _previousDelta = 0;
+
+  _Block.open(this.columnCount)
+      : _timeWriter = _BitWriter(),
+        _valueWriters = List.generate(columnCount, (_) => _BitWriter()),
+        _states = List.generate(columnCount, (_) => _XorState());
+
+  _Block.sealed(this.columnCount, this.count, this.startTime, this.endTime, this._timeBytes,
+      this._timeBits, this._valueBytes, this._valueBits)
+      : _timeWriter = null,
+        _valueWriters = null,
+        _states = const [];
+
+  bool get isSealed => _timeWriter == null;
+
+  Uint8List get timeBytes => _timeBytes ?? _timeWriter!.bytes;
+
+  int get timeBits => isSealed ? _timeBits : _timeWriter!.bitLength;
+
+  Uint8List valueBytes(int column) => _valueBytes?[column] ?? _valueWriters![column].bytes;
+
+  int valueBits(int column) => isSealed ? _valueBits![column] : _valueWriters![column].bitLength;
+
+  int get sizeInBytes {
+    var size = 16 + timeBytes.length;
+    for (var c = 0; c < columnCount; c++) {
+      size += 4 + valueBytes(c).length;
+    }
+    return size;
+  }
+
+  void append(int seconds, List<double> values) {
+    final times = _timeWriter!;
+    if (count == 0) {
+      times.write(seconds, 32);
+      startTime = seconds;
+    } else {
+      final delta = seconds - endTime;
+      final dod = delta - _previousDelta;
+      if (dod == 0) {
+        times.writeBit(0);
+      } else if (dod >= -63 && dod <= 64) {
+        times.write(0x2, 2);
+        times.write(dod + 63, 7);
+      } else if (dod >= -255 && dod <= 256) {
+        times.write(0x6, 3);
+        times.write(dod + 255, 9);
+      } else if (dod >= -2047 && dod <= 2048) {
+        times.write(0xe, 4);
+        times.write(dod + 2047, 12);
+      } else {
+        times.write(0xf, 4);
+        times.write(dod & 0xffffffff, 32);
+      }
+      _previousDelta = delta;
+    }
+    endTime = seconds;
+
+    for (var c = 0; c < columnCount; c++) {
+      _appendValue(_valueWriters![c], _states[c], values[c]);
+    }
+    count++;
+  }
+
+  void _appendValue(_BitWriter out, _XorState state, double value) {
+    _scratch.setFloat64(0, value);
+    final hi = _scratch.getUint32(0);
+    final lo = _scratch.getUint32(4);
+    if (count == 0) {
+      out.write(hi, 32);
+      out.write(lo, 32);
+    } else {
+      final xh = hi ^ state.hi;
+      final xl = lo ^ state.lo;
+      if (xh == 0 && xl == 0) {
+        out.writeBit(0);
+      } else {
+        var leading = xh != 0 ? _leadingZeros32(xh) : 32 + _leadingZeros32(xl);
+        final trailing = xl != 0 ? _trailingZeros32(xl) : 32 + _trailingZeros32(xh);
+        if (leading > 31) leading = 31;
+        out.writeBit(1);
+        if (state.leading >= 0 && leading >= state.leading && trailing >= state.trailing) {
+          // Meaningful bits fit in the previous window
+          out.writeBit(0);
+          out.write64(xh, xl, 63 - state.leading, state.trailing);
+        } else {
+          final length = 64 - leading - trailing;
+          out.writeBit(1);
+          out.write(leading, 5);
+          out.write(length & 0x3f, 6);
+          out.write64(xh, xl, 63 - leading, trailing);
+          state.leading = leading;
+          state.trailing = trailing;
+        }
+      }
+    }
+    state.hi = hi;
+    state.lo = lo;
+  }
+
+  /// Decode timestamps and the requested columns
+  void decode(void Function(int seconds, List<double> values) visit, {List<int>? columns}) {
+    final selected = columns ?? List.generate(columnCount, (c) => c);
+    final times = _BitReader(timeBytes, timeBits);
+    final readers = [for (final c in selected) _BitReader(valueBytes(c), valueBits(c))];
+    final states = List.generate(selected.length, (_) => _XorState());
+    final values = List<double>.filled(selected.length, 0);
+
+    var time = 0, delta = 0;
+    for (var i = 0; i < count; i++) {
+      if (i == 0) {
+        time = times.read(32);
+      } else {
+        int dod;
+        if (times.readBit() == 0) {
+          dod = 0;
+        } else if (times.readBit() == 0) {
+          dod = times.read(7) - 63;
+        } else if (times.readBit() == 0) {
+          dod = times.read(9) - 255;
+        } else if (times.readBit() == 0) {
+          dod = times.read(12) - 2047;
+        } else {
+          dod = times.read(32);
+          if (dod >= 0x80000000) dod -= 0x100000000;
+        }
+        delta += dod;
+        time += delta;
+      }
+
+      for (var c = 0; c < selected.length; c++) {
+        values[c] = _readValue(readers[c], states[c], i == 0);
+      }
+      visit(time, values);
+    }
+  }
+
+  double _readValue(_BitReader input, _XorState state, bool first) {
+    if (first) {
+      state.hi = input.read(32);
+      state.lo = input.read(32);
+    } else if (input.readBit() == 1) {
+      int high, low;
+      if (input.readBit() == 0) {
+        high = 63 - state.leading;
+        low = state.trailing;
+      } else {
+        state.leading = input.read(5);
+        var length = input.read(6);
+        if (length == 0) length = 64;
+        state.trailing = 64 - state.leading - length;
+        high = 63 - state.leading;
+        low = state.trailing;
+      }
+      var xh = 0, xl = 0;
+      for (var i = high; i >= low; i--) {
+        if (input.readBit() == 1) {
+          if (i >= 32) {
+            xh |= 1 << (i - 32);
+          } else {
+            xl |= 1 << i;
+          }
+        }
+      }
+      state.hi ^= xh;
+      state.lo ^= xl;
+    }
+    _scratch.setUint32(0, state.hi);
+    _scratch.setUint32(4, state.lo);
+    return _scratch.getFloat64(0);
+  }
+
+  _Block seal() {
+    if (isSealed) return this;
+    return _Block.sealed(
+      columnCount,
+      count,
+      startTime,
+      endTime,
+      Uint8List.fromList(_timeWriter!.bytes),
+      _timeWriter!.bitLength,
+      [for (final w in _valueWriters!) Uint8List.fromList(w.bytes)],
+      [for (final w in _valueWriters!) w.bitLength],
+    );
+  }
+}
+
+/// Columnar Gorilla-style time series: timestamps (second resolution) are
+/// stored as deltas of deltas and each column's values as the XOR with the
+/// previous value, so regular samples of slowly changing readings take a
+/// few bits each. Samples are grouped into blocks that record their time
+/// span, letting range queries skip blocks and retention drop whole blocks.
+class GorillaSeries {
+  static const int _magic = 0x4d44545a; // "MDTZ"
+  static const int _version = 1;
+
+  final int columnCount;
+  final int blockSize;
+  final List<_Block> _blocks = [];
+
+  GorillaSeries(this.columnCount, {this.blockSize = 128});
+
+  int get length => _blocks.fold(0, (sum, block) => sum + block.count);
+
+  int get sizeInBytes => _blocks.fold(0, (sum, block) => sum + block.sizeInBytes);
+
+  DateTime? get lastTime =>
+      _blocks.isEmpty ? null : DateTime.fromMillisecondsSinceEpoch(_blocks.last.endTime * 1000);
+
+  /// Append one sample per column; samples that are not at least a second
+  /// newer than the last one are ignored, as two samples in one second
+  /// could not be told apart
+  bool append(DateTime time, List<double> values) {
+    assert(values.length == columnCount);
+    final seconds = time.millisecondsSinceEpoch ~/ 1000;
+    if (_blocks.isNotEmpty && seconds <= _blocks.last.endTime) return false;
+
+    if (_blocks.isEmpty || _blocks.last.isSealed || _blocks.last.count >= blockSize) {
+      if (_blocks.isNotEmpty) _blocks[_blocks.length - 1] = _blocks.last.seal();
+      _blocks.add(_Block.open(columnCount));
+    }
+    _blocks.last.append(seconds, values);
+    return true;
+  }
+
+  /// Samples of [column] with from <= time <= to
+  List<TimeSeriesPoint> range(int column, DateTime from, DateTime to) {
+    final start = from.millisecondsSinceEpoch ~/ 1000;
+    final end = to.millisecondsSinceEpoch ~/ 1000;
+    final points = <TimeSeriesPoint>[];
+    for (final block in _blocks) {
+      if (block.endTime < start || block.startTime > end) continue;
+      block.decode((seconds, values) {
+        if (seconds >= start && seconds <= end) {
+          points.add(TimeSeriesPoint(DateTime.fromMillisecondsSinceEpoch(seconds * 1000), values[0]));
+        }
+      }, columns: [column]);
+    }
+    return points;
+  }
+
+  /// Drop blocks that end before [cutoff]
+  void dropBefore(DateTime cutoff) {
+    final seconds = cutoff.millisecondsSinceEpoch ~/ 1000;
+    _blocks.removeWhere((block) => block.endTime < seconds);
+  }
+
+  void clear() => _blocks.clear();
+
+  Uint8List toBytes() {
+    final builder = BytesBuilder(copy: false);
+    final header = ByteData(12)
+      ..setUint32(0, _magic)
+      ..setUint16(4, _version)
+      ..setUint16(6, columnCount)
+      ..setUint32(8, _blocks.length);
+    builder.add(header.buffer.asUint8List());
+    // The open block is written as it stands and keeps accepting samples;
+    // it is read back as sealed
+    for (final block in _blocks) {
+      final blockHeader = ByteData(16)
+        ..setUint32(0, block.count)
+        ..setUint32(4, block.startTime)
+        ..setUint32(8, block.endTime)
+        ..setUint32(12, block.timeBits);
+      builder
+        ..add(blockHeader.buffer.asUint8List())
+        ..add(Uint8List.fromList(block.timeBytes));
+      for (var c = 0; c < columnCount; c++) {
+        builder
+          ..add((ByteData(4)..setUint32(0, block.valueBits(c))).buffer.asUint8List())
+          ..add(Uint8List.fromList(block.valueBytes(c)));
+      }
+    }
+    return builder.takeBytes();
+  }
+
+  factory GorillaSeries.fromBytes(Uint8List bytes, {int blockSize = 128}) {
+    final data = ByteData.sublistView(bytes);
+    if (bytes.length < 12 || data.getUint32(0) != _magic) {
+      throw const FormatException('Not a time series');
+    }
+    if (data.getUint16(4) != _version) {
+      throw FormatException('Unsupported time series version ${data.getUint16(4)}');
+    }
+    final series = GorillaSeries(data.getUint16(6), blockSize: blockSize);
+    final blockCount = data.getUint32(8);
+    var offset = 12;
+    Uint8List take(int bits) {
+      final length = (bits + 7) >> 3;
+      final slice = Uint8List.sublistView(bytes, offset, offset + length);
+      offset += length;
+      return slice;
+    }
+
+    for (var b = 0; b < blockCount; b++) {
+      final count = data.getUint32(offset);
+      final startTime = data.getUint32(offset + 4);
+      final endTime = data.getUint32(offset + 8);
+      final timeBits = data.getUint32(offset + 12);
+      offset += 16;
+      final timeBytes = take(timeBits);
+      final valueBits = <int>[];
+      final valueBytes = <Uint8List>[];
+      for (var c = 0; c < series.columnCount; c++) {
+        final bits = data.getUint32(offset);
+        offset += 4;
+        valueBits.add(bits);
+        valueBytes.add(take(bits));
+      }
+      series._blocks.add(_Block.sealed(
+          series.columnCount, count, startTime, endTime, timeBytes, timeBits, valueBytes, valueBits));
+    }
+    return series;
+  }
+}
+
+/// Largest-Triangle-Three-Buckets downsampling: keeps the first and last
+/// points and, from each bucket in between, the point forming the largest
+/// triangle with the previously kept point and the next bucket's average,
+/// which preserves the visual shape of a line chart
+List<TimeSeriesPoint> downsampleLttb(List<TimeSeriesPoint> data, int threshold) {
+  if (threshold >= data.length || threshold < 3) return data;
+
+  final sampled = <TimeSeriesPoint>[data.first];
+  final bucketSize = (data.length - 2) / (threshold - 2);
+  var a = 0;
+
+  for (var i = 0; i < threshold - 2; i++) {
+    final bucketStart = (i * bucketSize).floor() + 1;
+    final bucketEnd = ((i + 1) * bucketSize).floor() + 1;
+
+    final nextStart = bucketEnd;
+    final nextEnd = min(((i + 2) * bucketSize).floor() + 1, data.length);
+    var avgX = 0.0, avgY = 0.0;
+    for (var j = nextStart; j < nextEnd; j++) {
+      avgX += data[j].time.millisecondsSinceEpoch;
+      avgY += data[j].value;
+    }
+    final nextCount = max(1, nextEnd - nextStart);
+    avgX /= nextCount;
+    avgY /= nextCount;
+
+    final ax = data[a].time.millisecondsSinceEpoch.toDouble();
+    final ay = data[a].value;
+    var maxArea = -1.0;
+    var chosen = bucketStart;
+    for (var j = bucketStart; j < bucketEnd; j++) {
+      final area = ((ax - avgX) * (data[j].value - ay) -
+              (ax - data[j].time.millisecondsSinceEpoch) * (avgY - ay))
+          .abs();
+      if (area > maxArea) {
+        maxArea = area;
+        chosen = j;
+      }
+    }
+    sampled.add(data[chosen]);
+    a = chosen;
+  }
+
+  sampled.add(data.last);
+  return sampled;
+}
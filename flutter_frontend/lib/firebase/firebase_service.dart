@@ -338,6 +338,17 @@ class FirebaseService {
       // Enable offline persistence using the new settings approach
       _firestore!.settings = const Settings(persistenceEnabled: true);
 
+      // Local emulator for load testing: --dart-define=FIRESTORE_EMULATOR=localhost:8080
+      const emulator = String.fromEnvironment('FIRESTORE_EMULATOR');
+      if (emulator.isNotEmpty) {
+        final colon = emulator.lastIndexOf(':');
+        _firestore!.useFirestoreEmulator(
+          emulator.substring(0, colon),
+          int.parse(emulator.substring(colon + 1)),
+        );
+        _logger.i('Using Firestore emulator at $emulator');
+      }
+
       // Listen to authentication state changes
       _auth!.authStateChanges().listen((User? user) {
         _currentUser = user;
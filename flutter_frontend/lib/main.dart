@@ -1,4 +1,5 @@
 import 'dart:async';
+import 'dart:convert';
 import 'dart:developer';
 import 'package:flutter/foundation.dart';
 import 'package:flutter/material.dart';
@@ -19,8 +20,14 @@ import 'firebase/auth_service.dart';
 import 'repositories/repository_provider.dart';
 import 'core/exceptions/initialization_exception.dart';
 import 'core/models/initialization_status.dart';
+import 'core/services/idle_scheduler.dart';
+import 'core/services/isolate_pool_service.dart';
+import 'core/services/network_warmup.dart';
+import 'core/services/resource_budget_service.dart';
 import 'core/services/web_compatibility_service.dart';
 import 'core/services/web_performance_debugger.dart';
+import 'services/dashboard_config_service.dart';
+import 'services/gazetteer_service.dart';
 import 'services/rss_service.dart';
 
 Future<void> main() async {
@@ -77,6 +84,25 @@ Future<void> main() async {
         ..initialize()
         ..initializeFlutterToolkit();
       
+      // Size pools and caches from the runner's container-aware budget
+      await ResourceBudgetService.instance.initialize();
+
+      // Spawn background isolates for feed parsing while startup continues
+      unawaited(IsolatePoolService.instance.initialize());
+
+      // Pre-connect to the hosts the last sessions fetched from most
+      unawaited(NetworkWarmup.instance.initialize());
+
+      // Local layout, feed and refresh config; edits apply while running
+      await DashboardConfigService.instance.initialize();
+
+      // Housekeeping waits for idle frames; the place index is built there
+      IdleScheduler.instance.initialize();
+      GazetteerService.instance.warmUp();
+
+      // Lets tool/gc_pauses.dart drive feed refreshes over the VM service
+      if (!kReleaseMode) _registerRefreshBenchmark();
+
       // Initialize WebCompatibilityService early for web platform
       if (kIsWeb) {
         await WebCompatibilityService.instance.initialize();
@@ -131,6 +157,24 @@ Future<void> main() async {
   );
 }
 
+/// `ext.modern_dashboard.refreshFeeds`: one uncached refresh of every feed,
+/// answering its duration
+void _registerRefreshBenchmark() {
+  registerExtension('ext.modern_dashboard.refreshFeeds', (method, parameters) async {
+    final stopwatch = Stopwatch()..start();
+    try {
+      RSSService.clearAllCache();
+      final articles = await RepositoryProvider.instance.rssFeedRepository.getAllArticles();
+      return ServiceExtensionResponse.result(json.encode({
+        'articles': articles.length,
+        'elapsedMs': stopwatch.elapsedMilliseconds,
+      }));
+    } catch (e) {
+      return ServiceExtensionResponse.error(ServiceExtensionResponse.extensionError, '$e');
+    }
+  });
+}
+
 void _logErrorDetails(dynamic error, StackTrace? stackTrace, String context) {
   final errorString = error.toString();
   
@@ -90,6 +90,10 @@ class VideoStream {
   bool get isYouTube => type == 'youtube' || url.contains('youtube.com') || url.contains('youtu.be');
   bool get isTwitch => type == 'twitch' || url.contains('twitch.tv');
   bool get isHLS => type == 'hls' || url.contains('.m3u8');
+  bool get isDash => type == 'dash' || url.contains('.mpd');
+
+  /// Streams with selectable renditions
+  bool get isAdaptive => isHLS || isDash;
 
   @override
   bool operator ==(Object other) {
@@ -124,6 +128,7 @@ class StreamCategories {
 // Common stream types
 class StreamTypes {
   static const String hls = 'hls';
+  static const String dash = 'dash';
   static const String rtmp = 'rtmp';
   static const String youtube = 'youtube';
   static const String twitch = 'twitch';
@@ -131,6 +136,7 @@ class StreamTypes {
 
   static const List<String> all = [
     hls,
+    dash,
     rtmp,
     youtube,
     twitch,
@@ -141,6 +147,8 @@ class StreamTypes {
     switch (type) {
       case hls:
         return 'HLS Stream';
+      case dash:
+        return 'DASH Stream';
       case rtmp:
         return 'RTMP Stream';
       case youtube:
@@ -1,3 +1,4 @@
+import '../core/utils/document_schema.dart';
 
 class WeatherData {
   final String id;
@@ -88,6 +89,47 @@ class WeatherData {
     };
   }
 
+  /// Compiled decoding plan for cached Firestore documents
+  static final DocumentSchema<WeatherData> schema = DocumentSchema<WeatherData>(
+    'WeatherData',
+    const [
+      FieldSpec('id', FieldKind.string, fallback: 'unknown'),
+      FieldSpec('location', FieldKind.string, fallback: 'Unknown Location'),
+      FieldSpec('latitude', FieldKind.number, fallback: 0.0),
+      FieldSpec('longitude', FieldKind.number, fallback: 0.0),
+      FieldSpec('temperature', FieldKind.number, fallback: 0.0),
+      FieldSpec('feels_like', FieldKind.number, fallback: 0.0),
+      FieldSpec('humidity', FieldKind.integer, fallback: 0),
+      FieldSpec('pressure', FieldKind.number, fallback: 0.0),
+      FieldSpec('description', FieldKind.string, fallback: ''),
+      FieldSpec('icon', FieldKind.string, fallback: '01d'),
+      FieldSpec('wind_speed', FieldKind.number, fallback: 0.0),
+      FieldSpec('wind_direction', FieldKind.integer, fallback: 0),
+      FieldSpec('cloudiness', FieldKind.integer, fallback: 0),
+      FieldSpec('visibility', FieldKind.integer, fallback: 0),
+      FieldSpec('timestamp', FieldKind.timestamp),
+      FieldSpec('units', FieldKind.string, fallback: 'metric'),
+    ],
+    (f) => WeatherData(
+      id: f.string(0),
+      location: f.string(1),
+      latitude: f.number(2),
+      longitude: f.number(3),
+      temperature: f.number(4),
+      feelsLike: f.number(5),
+      humidity: f.integer(6),
+      pressure: f.number(7),
+      description: f.string(8),
+      icon: f.string(9),
+      windSpeed: f.number(10),
+      windDirection: f.integer(11),
+      cloudiness: f.integer(12),
+      visibility: f.integer(13),
+      timestamp: f.time(14),
+      units: f.string(15),
+    ),
+  );
+
   /// Create from JSON
   factory WeatherData.fromJson(Map<String, dynamic> json) {
     return WeatherData(
@@ -1,4 +1,6 @@
+import 'dart:async';
 import 'dart:convert';
+import 'dart:math';
 import 'package:flutter/foundation.dart';
 import 'package:http/http.dart' as http;
 import 'package:cloud_firestore/cloud_firestore.dart';
@@ -6,11 +8,36 @@ import 'package:crypto/crypto.dart';
 import '../firebase/firebase_service.dart';
 import '../core/exceptions/feed_validation_exception.dart';
 import '../core/services/cors_proxy_service.dart';
+import '../core/services/idle_scheduler.dart';
+import '../core/services/isolate_pool_service.dart';
+import '../core/utils/cached_id_index.dart';
 import '../services/rss_service.dart';
 import 'news_repository.dart';
 
 class CloudNewsRepository implements NewsRepository {
   final FirebaseService _firebaseService = FirebaseService.instance;
+
+  /// Firestore's limit on writes in one batch
+  static const int _maxBatchWrites = 500;
+
+  /// Batches committed at the same time
+  static const int _concurrentCommits = 4;
+
+  /// Firestore's limit on values in one `whereIn` filter
+  static const int _maxWhereIn = 30;
+
+  CachedIdIndex? _cachedIds;
+  String? _cachedIdsUser;
+
+  /// IDs of articles already in the news cache, per user
+  CachedIdIndex get _cachedIdIndex {
+    final userId = _firebaseService.getUserId() ?? 'anonymous';
+    if (_cachedIds == null || _cachedIdsUser != userId) {
+      _cachedIds = CachedIdIndex('news_cache_ids_v1_$userId');
+      _cachedIdsUser = userId;
+    }
+    return _cachedIds!;
+  }
   
   CollectionReference get _newsCacheCollection => 
       _firebaseService.getUserCollection('news_cache');
@@ -93,7 +120,7 @@ class CloudNewsRepository implements NewsRepository {
       await _newsFeedsCollection.add(feed.toJson());
       
       // Fetch articles from the new feed
-      await _fetchFeedArticles(feedUrl, feedName);
+      await _cacheArticles(await _fetchFeedArticles(feedUrl, feedName));
     } on FeedValidationException {
       rethrow;
     } catch (e) {
@@ -150,10 +177,11 @@ class CloudNewsRepository implements NewsRepository {
   Future<void> refreshFeeds() async {
     try {
       final feeds = await _getActiveFeedsData();
+      final articles = <NewsItem>[];
       
       for (final feed in feeds) {
         try {
-          await _fetchFeedArticles(feed.url, feed.name);
+          articles.addAll(await _fetchFeedArticles(feed.url, feed.name));
           
           // Update last fetched time
           await _newsFeedsCollection.doc(feed.id).update({
@@ -163,9 +191,12 @@ class CloudNewsRepository implements NewsRepository {
           debugPrint('Warning: Failed to refresh feed ${feed.url}: $e');
         }
       }
+
+      // One bulk write for all feeds
+      await _cacheArticles(articles);
       
-      // Clean up old articles
-      await _cleanupOldArticles();
+      // Clean up old articles once the UI is idle; it also shrinks the id index
+      unawaited(IdleScheduler.instance.schedule('CloudNewsRepository.cleanup', _cleanupOldArticles()));
     } catch (e) {
       throw Exception('Failed to refresh feeds: $e');
     }
@@ -195,11 +226,15 @@ class CloudNewsRepository implements NewsRepository {
           .limit(50)
           .get();
       
-      return snapshot.docs.map((doc) {
-        final data = doc.data() as Map<String, dynamic>;
-        data['id'] = doc.id;
-        return NewsItem.fromJson(data);
-      }).toList();
+      final news = NewsItem.schema.decodeAll(
+        snapshot.docs.map((doc) => (doc.id, doc.data() as Map<String, dynamic>)),
+      );
+      // What we just read is known to be cached
+      final index = _cachedIdIndex;
+      for (final article in news) {
+        index.addAll([article.id], at: article.cachedAt);
+      }
+      return news;
     } catch (e) {
       return [];
     }
@@ -301,8 +336,8 @@ class CloudNewsRepository implements NewsRepository {
     }
   }
 
-  /// Fetch articles from a specific feed
-  Future<void> _fetchFeedArticles(String feedUrl, String feedName) async {
+  /// Fetch articles from a specific feed; empty when it cannot be fetched
+  Future<List<NewsItem>> _fetchFeedArticles(String feedUrl, String feedName) async {
     try {
       String? content;
       
@@ -314,7 +349,7 @@ class CloudNewsRepository implements NewsRepository {
         } catch (e) {
           debugPrint('CloudNewsRepository: CORS proxy failed for $feedUrl: $e');
           // Don't throw error, just skip fetching articles for this feed
-          return;
+          return const [];
         }
       } else {
         // Direct fetch for non-web platforms with retry logic
@@ -350,11 +385,9 @@ class CloudNewsRepository implements NewsRepository {
       
       // Only process if we have content
       if (content != null && content.isNotEmpty) {
-        final articles = _parseFeedContent(content, feedUrl, feedName);
-        await _cacheArticles(articles);
-      } else {
-        debugPrint('CloudNewsRepository: No content received for $feedUrl');
+        return _parseFeedContent(content, feedUrl, feedName);
       }
+      debugPrint('CloudNewsRepository: No content received for $feedUrl');
     } on FeedValidationException catch (e) {
       debugPrint('CloudNewsRepository: Feed validation error for $feedUrl: $e');
       // Don't rethrow, just log the error - other feeds should still work
@@ -362,6 +395,7 @@ class CloudNewsRepository implements NewsRepository {
       debugPrint('CloudNewsRepository: Error fetching articles from $feedUrl: $e');
       // Don't rethrow, just log the error - other feeds should still work
     }
+    return const [];
   }
 
   /// Parse RSS/Atom feed content into NewsItem objects
@@ -426,49 +460,132 @@ class CloudNewsRepository implements NewsRepository {
     return articles;
   }
 
-  /// Cache articles in Firestore
+  /// Cache articles in Firestore.
+  ///
+  /// Articles whose IDs are in the local index are skipped without reading
+  /// Firestore. The rest are looked up by ID, and only those Firestore does
+  /// not have yet are written, in batches of at most [_maxBatchWrites],
+  /// [_concurrentCommits] committed at a time. Writing an existing document
+  /// again would reset its cached_at, expires_at and published_date.
   Future<void> _cacheArticles(List<NewsItem> articles) async {
     if (articles.isEmpty) return;
-    
-    try {
-      final batch = FirebaseFirestore.instance.batch();
-      
-      for (final article in articles) {
-        // Check if article already exists
-        final existingDoc = await _newsCacheCollection.doc(article.id).get();
-        
-        if (!existingDoc.exists) {
+    final watch = Stopwatch()..start();
+    final index = _cachedIdIndex;
+    await index.load();
+
+    // Feeds repeat items across refreshes and each other; keep the first
+    final pending = <String, NewsItem>{};
+    for (final article in articles) {
+      if (!index.contains(article.id)) pending.putIfAbsent(article.id, () => article);
+    }
+    if (pending.isEmpty) return;
+
+    final existing = await _existingArticleIds(pending.keys.toList());
+    for (final entry in existing.entries) {
+      index.addAll([entry.key], at: entry.value);
+    }
+    pending.removeWhere((id, _) => existing.containsKey(id));
+    if (pending.isEmpty) {
+      await index.save();
+      return;
+    }
+
+    final items = pending.values.toList();
+    final chunks = [
+      for (var i = 0; i < items.length; i += _maxBatchWrites)
+        items.sublist(i, min(i + _maxBatchWrites, items.length)),
+    ];
+    var failed = 0;
+    for (var i = 0; i < chunks.length; i += _concurrentCommits) {
+      await Future.wait(chunks.skip(i).take(_concurrentCommits).map((chunk) async {
+        final batch = FirebaseFirestore.instance.batch();
+        for (final article in chunk) {
           final articleData = article.toJson();
           articleData.remove('id'); // ID is used as document ID
-          
           batch.set(_newsCacheCollection.doc(article.id), articleData);
         }
-      }
-      
-      await batch.commit();
-    } catch (e) {
-      debugPrint('Warning: Failed to cache some articles: $e');
+        try {
+          await batch.commit();
+          index.addAll(chunk.map((article) => article.id));
+        } catch (e) {
+          // Left out of the index, so the next refresh retries them
+          failed += chunk.length;
+          debugPrint('Warning: Failed to cache ${chunk.length} articles: $e');
+        }
+      }));
     }
+    await index.save();
+
+    watch.stop();
+    debugPrint('CloudNewsRepository: Cached ${items.length - failed} of ${articles.length} articles '
+        '(${articles.length - items.length} already cached, ${existing.length} found in Firestore) '
+        'in ${chunks.length} batches, ${watch.elapsedMilliseconds} ms');
   }
 
-  /// Clean up old cached articles
-  Future<void> _cleanupOldArticles() async {
-    try {
-      final cutoff = DateTime.now().subtract(const Duration(days: 7));
-      
-      final snapshot = await _newsCacheCollection
-          .where('cached_at', isLessThan: cutoff.millisecondsSinceEpoch)
-          .get();
-      
-      final batch = FirebaseFirestore.instance.batch();
-      for (final doc in snapshot.docs) {
-        batch.delete(doc.reference);
-      }
-      
-      await batch.commit();
-    } catch (e) {
-      debugPrint('Warning: Failed to cleanup old articles: $e');
+  /// Which of [ids] already have a document in the news cache, with the
+  /// time each was cached. IDs whose lookup fails count as absent, so at
+  /// worst an article is written again.
+  Future<Map<String, DateTime?>> _existingArticleIds(List<String> ids) async {
+    final chunks = [
+      for (var i = 0; i < ids.length; i += _maxWhereIn)
+        ids.sublist(i, min(i + _maxWhereIn, ids.length)),
+    ];
+    final existing = <String, DateTime?>{};
+    for (var i = 0; i < chunks.length; i += _concurrentCommits) {
+      await Future.wait(chunks.skip(i).take(_concurrentCommits).map((chunk) async {
+        try {
+          final snapshot =
+              await _newsCacheCollection.where(FieldPath.documentId, whereIn: chunk).get();
+          for (final doc in snapshot.docs) {
+            final cachedAt = (doc.data() as Map<String, dynamic>?)?['cached_at'];
+            existing[doc.id] =
+                cachedAt is int ? DateTime.fromMillisecondsSinceEpoch(cachedAt) : null;
+          }
+        } catch (e) {
+          debugPrint('Warning: Failed to check ${chunk.length} cached articles: $e');
+        }
+      }));
     }
+    return existing;
+  }
+
+  /// Idle work that deletes cached articles older than a week
+  IdleWork _cleanupOldArticles() {
+    List<QueryDocumentSnapshot>? docs;
+    var deleted = 0;
+    // One Firestore round trip per step, each started in its own idle slice
+    return (_) async {
+      try {
+        final expired = docs;
+        if (expired == null) {
+          final cutoff = DateTime.now().subtract(const Duration(days: 7));
+          final snapshot = await _newsCacheCollection
+              .where('cached_at', isLessThan: cutoff.millisecondsSinceEpoch)
+              .get();
+          docs = snapshot.docs;
+          return false;
+        }
+
+        if (deleted < expired.length) {
+          final batch = FirebaseFirestore.instance.batch();
+          for (final doc in expired.skip(deleted).take(_maxBatchWrites)) {
+            batch.delete(doc.reference);
+          }
+          deleted += _maxBatchWrites;
+          await batch.commit();
+          return false;
+        }
+
+        final index = _cachedIdIndex;
+        index
+          ..removeAll(expired.map((doc) => doc.id))
+          ..prune();
+        await index.save();
+      } catch (e) {
+        debugPrint('Warning: Failed to cleanup old articles: $e');
+      }
+      return true;
+    };
   }
 
   /// Get news by category
@@ -480,47 +597,45 @@ class CloudNewsRepository implements NewsRepository {
           .limit(20)
           .get();
       
-      return snapshot.docs.map((doc) {
-        final data = doc.data() as Map<String, dynamic>;
-        data['id'] = doc.id;
-        return NewsItem.fromJson(data);
-      }).toList();
+      return NewsItem.schema.decodeAll(
+        snapshot.docs.map((doc) => (doc.id, doc.data() as Map<String, dynamic>)),
+      );
     } catch (e) {
       throw Exception('Failed to get news by category: $e');
     }
   }
 
-  /// Search news articles
+  /// Search news articles. Matching and ranking run on the isolate pool.
   Future<List<NewsItem>> searchNews(String query) async {
     try {
       final snapshot = await _newsCacheCollection.get();
-      final articles = <NewsItem>[];
-      
-      for (final doc in snapshot.docs) {
-        final data = doc.data() as Map<String, dynamic>;
-        data['id'] = doc.id;
-        final article = NewsItem.fromJson(data);
-        
-        if (article.title.toLowerCase().contains(query.toLowerCase()) ||
-            article.description.toLowerCase().contains(query.toLowerCase())) {
-          articles.add(article);
-        }
-      }
-      
-      // Sort by relevance and date
-      articles.sort((a, b) {
-        final aTitle = a.title.toLowerCase().contains(query.toLowerCase());
-        final bTitle = b.title.toLowerCase().contains(query.toLowerCase());
-        
-        if (aTitle && !bTitle) return -1;
-        if (!aTitle && bTitle) return 1;
-        
-        return b.publishedDate.compareTo(a.publishedDate);
-      });
-      
-      return articles;
+      final articles = NewsItem.schema.decodeAll(
+        snapshot.docs.map((doc) => (doc.id, doc.data() as Map<String, dynamic>)),
+      );
+      return await IsolatePoolService.instance.run(
+        _matchArticles,
+        (query: query, articles: articles),
+        priority: TaskPriority.high,
+      );
     } catch (e) {
       throw Exception('Failed to search news: $e');
     }
   }
+
+  /// Pool task: articles containing the query, title matches first, then
+  /// newest first
+  static List<NewsItem> _matchArticles(({String query, List<NewsItem> articles}) search) {
+    final query = search.query.toLowerCase();
+    final inTitle = <NewsItem>[];
+    final inDescription = <NewsItem>[];
+    for (final article in search.articles) {
+      if (article.title.toLowerCase().contains(query)) {
+        inTitle.add(article);
+      } else if (article.description.toLowerCase().contains(query)) {
+        inDescription.add(article);
+      }
+    }
+    int newestFirst(NewsItem a, NewsItem b) => b.publishedDate.compareTo(a.publishedDate);
+    return [...inTitle..sort(newestFirst), ...inDescription..sort(newestFirst)];
+  }
 }
\ No newline at end of file
@@ -1,10 +1,13 @@
-import 'dart:convert';
 import 'package:flutter/foundation.dart';
-import 'package:http/http.dart' as http;
 import 'package:cloud_firestore/cloud_firestore.dart';
+import '../core/services/http_cache.dart';
 import '../firebase/firebase_service.dart';
 import '../firebase/remote_config_service.dart';
+import '../core/utils/gazetteer_index.dart';
 import '../models/weather.dart';
+import '../services/gazetteer_service.dart';
+import '../services/weather_payload_decoder.dart';
+import '../services/weather_service.dart';
 import 'weather_repository.dart';
 import 'mock_weather_repository.dart';
 
@@ -19,8 +22,52 @@ class CloudWeatherRepository implements WeatherRepository {
   DocumentReference get _userPreferencesDoc =>
       _firebaseService.getUserDocument();
 
+  /// Coordinates of location names already resolved through the API, for
+  /// names the gazetteer does not know
+  static final Map<String, (double, double)> _resolvedLocations = {};
+
+  /// Compare the byte scanner with json.decode on the first forecast of a
+  /// debug session
+  static bool _decoderBenchmarked = false;
+
   @override
   Future<WeatherData> getCurrentWeather(String location) async {
+    final units = _remoteConfigService.getDefaultWeatherUnits();
+    final coordinates = await _resolveCoordinates(location);
+    if (coordinates == null) {
+      final weather = await _getCurrentWeatherUncached(location);
+      if (weather.latitude != 0.0 || weather.longitude != 0.0) {
+        _resolvedLocations[GazetteerIndex.fold(location)] = (weather.latitude, weather.longitude);
+        WeatherService.spatialCache.put(weather.latitude, weather.longitude, weather, partition: units);
+      }
+      return weather;
+    }
+
+    // "Amsterdam", "Amsterdam, NL" and a fix around the corner share one
+    // entry, and widgets asking at the same time share one request
+    return WeatherService.spatialCache.getOrFetch(
+      coordinates.$1,
+      coordinates.$2,
+      () => _getCurrentWeatherUncached(location),
+      partition: units,
+    );
+  }
+
+  /// Coordinates for a location name from earlier responses or an exact
+  /// gazetteer match, or null if unknown
+  Future<(double, double)?> _resolveCoordinates(String location) async {
+    final key = GazetteerIndex.fold(location);
+    final known = _resolvedLocations[key];
+    if (known != null) return known;
+
+    final matches = await GazetteerService.instance.search(location, limit: 1);
+    if (matches.isEmpty) return null;
+    final name = location.split(',').first;
+    if (GazetteerIndex.fold(matches.first.name) != GazetteerIndex.fold(name)) return null;
+    return (matches.first.latitude, matches.first.longitude);
+  }
+
+  Future<WeatherData> _getCurrentWeatherUncached(String location) async {
     try {
       // Check cache first
       final cachedWeather = await _getCachedWeather(location);
@@ -118,14 +165,13 @@ class CloudWeatherRepository implements WeatherRepository {
     final language = _remoteConfigService.getDefaultWeatherLanguage();
     
     final url = '$_baseUrl/weather?q=$location&appid=$apiKey&units=$units&lang=$language';
-    final response = await http.get(Uri.parse(url));
+    final response = await HttpCache.instance.client.get(Uri.parse(url));
     
     if (response.statusCode != 200) {
       throw Exception('Weather API error: ${response.statusCode}');
     }
     
-    final data = json.decode(response.body);
-    return _parseWeatherResponse(data, location);
+    return _parseWeatherResponse(OpenWeatherMapDecoder.current(response.bodyBytes), location);
   }
 
   /// Fetch forecast data from OpenWeatherMap API
@@ -139,75 +185,69 @@ class CloudWeatherRepository implements WeatherRepository {
     final language = _remoteConfigService.getDefaultWeatherLanguage();
     
     final url = '$_baseUrl/forecast?q=$location&appid=$apiKey&units=$units&lang=$language';
-    final response = await http.get(Uri.parse(url));
+    final response = await HttpCache.instance.client.get(Uri.parse(url));
     
     if (response.statusCode != 200) {
       throw Exception('Weather API error: ${response.statusCode}');
     }
     
-    final data = json.decode(response.body);
-    return _parseForecastResponse(data, location);
+    if (kDebugMode && !_decoderBenchmarked) {
+      _decoderBenchmarked = true;
+      OpenWeatherMapDecoder.benchmark(response.bodyBytes);
+    }
+    // Only the first five entries are used, so the rest is never scanned
+    return _parseForecastResponse(
+      OpenWeatherMapDecoder.forecast(response.bodyBytes, limit: 5),
+      location,
+    );
   }
 
-  /// Parse OpenWeatherMap current weather response
-  WeatherData _parseWeatherResponse(Map<String, dynamic> data, String location) {
-    final main = data['main'] ?? {};
-    final weather = (data['weather'] as List).isNotEmpty 
-        ? data['weather'][0] 
-        : {};
-    final wind = data['wind'] ?? {};
+  /// Map an OpenWeatherMap current weather response
+  WeatherData _parseWeatherResponse(OwmObservation data, String location) {
     final now = DateTime.now();
     
     return WeatherData(
       id: '${location}_current_${now.millisecondsSinceEpoch}',
       location: location,
-      latitude: 0.0,
-      longitude: 0.0,
-      temperature: (main['temp'] ?? 0).toDouble(),
-      feelsLike: (main['feels_like'] ?? main['temp'] ?? 0).toDouble(),
-      humidity: (main['humidity'] ?? 0).round(),
-      description: weather['description'] ?? '',
-      icon: weather['icon'] ?? '',
+      latitude: data.latitude ?? 0.0,
+      longitude: data.longitude ?? 0.0,
+      temperature: data.temperature ?? 0.0,
+      feelsLike: data.feelsLike ?? data.temperature ?? 0.0,
+      humidity: data.humidity ?? 0,
+      description: data.description ?? '',
+      icon: data.icon ?? '',
       timestamp: now,
-      windSpeed: (wind['speed'] ?? 0).toDouble(),
-      windDirection: (wind['deg'] ?? 0).round(),
-      pressure: (main['pressure'] ?? 0).toDouble(),
-      cloudiness: (data['clouds']?['all'] ?? 0).round(),
-      visibility: ((data['visibility'] ?? 0).toDouble() / 1000).round(), // Convert to km
+      windSpeed: data.windSpeed ?? 0.0,
+      windDirection: data.windDirection ?? 0,
+      pressure: data.pressure ?? 0.0,
+      cloudiness: data.cloudiness ?? 0,
+      visibility: ((data.visibility ?? 0) / 1000).round(), // Convert to km
       units: 'metric',
     );
   }
 
-  /// Parse OpenWeatherMap forecast response
-  List<WeatherData> _parseForecastResponse(Map<String, dynamic> data, String location) {
-    final list = data['list'] as List? ?? [];
+  /// Map OpenWeatherMap forecast entries
+  List<WeatherData> _parseForecastResponse(List<OwmObservation> list, String location) {
     final forecastItems = <WeatherData>[];
     
-    for (int i = 0; i < list.length && i < 5; i++) { // Limit to 5 days
-      final item = list[i];
-      final main = item['main'] ?? {};
-      final weather = (item['weather'] as List).isNotEmpty 
-          ? item['weather'][0] 
-          : {};
-      final wind = item['wind'] ?? {};
-      final dtTxt = item['dt_txt'] ?? '';
-      final forecastTime = DateTime.tryParse(dtTxt) ?? DateTime.now();
+    for (final item in list) {
+      final forecastTime = DateTime.tryParse(item.dtText ?? '') ?? DateTime.now();
       
       forecastItems.add(WeatherData(
-        id: '${location}_forecast_${item['dt']}',
+        id: '${location}_forecast_${item.dt}',
         location: location,
         latitude: 0.0,
         longitude: 0.0,
-        temperature: (main['temp'] ?? 0).toDouble(),
-        feelsLike: (main['feels_like'] ?? main['temp'] ?? 0).toDouble(),
-        humidity: (main['humidity'] ?? 0).round(),
-        description: weather['description'] ?? '',
-        icon: weather['icon'] ?? '',
+        temperature: item.temperature ?? 0.0,
+        feelsLike: item.feelsLike ?? item.temperature ?? 0.0,
+        humidity: item.humidity ?? 0,
+        description: item.description ?? '',
+        icon: item.icon ?? '',
         timestamp: forecastTime,
-        windSpeed: (wind['speed'] ?? 0).toDouble(),
-        windDirection: (wind['deg'] ?? 0).round(),
-        pressure: (main['pressure'] ?? 0).toDouble(),
-        cloudiness: (item['clouds']?['all'] ?? 0).round(),
+        windSpeed: item.windSpeed ?? 0.0,
+        windDirection: item.windDirection ?? 0,
+        pressure: item.pressure ?? 0.0,
+        cloudiness: item.cloudiness ?? 0,
         visibility: 10, // Default visibility for forecast
         units: 'metric',
       ));
@@ -228,9 +268,8 @@ class CloudWeatherRepository implements WeatherRepository {
       
       if (snapshot.docs.isEmpty) return null;
       
-      final data = snapshot.docs.first.data() as Map<String, dynamic>;
-      data['id'] = snapshot.docs.first.id;
-      return WeatherData.fromJson(data);
+      final doc = snapshot.docs.first;
+      return WeatherData.schema.decode(doc.data() as Map<String, dynamic>, id: doc.id);
     } catch (e) {
       return null;
     }
@@ -246,11 +285,9 @@ class CloudWeatherRepository implements WeatherRepository {
           .limit(5)
           .get();
       
-      return snapshot.docs.map((doc) {
-        final data = doc.data() as Map<String, dynamic>;
-        data['id'] = doc.id;
-        return WeatherData.fromJson(data);
-      }).toList();
+      return WeatherData.schema.decodeAll(
+        snapshot.docs.map((doc) => (doc.id, doc.data() as Map<String, dynamic>)),
+      );
     } catch (e) {
       return [];
     }
@@ -404,9 +441,7 @@ class CloudWeatherRepository implements WeatherRepository {
 
   @override
   Future<List<WeatherLocation>> searchLocations(String query) async {
-    // For now, delegate to mock implementation
-    final mockRepo = MockWeatherRepository();
-    return mockRepo.searchLocations(query);
+    return WeatherService.searchLocations(query, _remoteConfigService.getWeatherApiKey());
   }
 
   @override
@@ -2,6 +2,7 @@ import 'dart:async';
 import 'dart:developer';
 import 'package:cloud_firestore/cloud_firestore.dart';
 import '../firebase/firebase_service.dart';
+import '../core/services/isolate_pool_service.dart';
 import '../core/utils/safe_json_converter.dart';
 import 'todo_repository.dart';
 
@@ -19,35 +20,11 @@ class FirestoreTodoRepository implements TodoRepository {
           .snapshots()
           .transform(StreamTransformer<QuerySnapshot, List<TodoItem>>.fromHandlers(
             handleData: (snapshot, sink) {
-              final todos = <TodoItem>[];
-              int skippedCount = 0;
-              
-              for (final doc in snapshot.docs) {
-                try {
-                  final data = doc.data() as Map<String, dynamic>;
-                  data['id'] = doc.id; // Ensure ID is set from document ID
-                  
-                  final todo = SafeJsonConverter.safeFromJson<TodoItem>(
-                    data,
-                    TodoItem.fromJson,
-                    context: 'FirestoreTodoRepository.getTodos - doc: ${doc.id}',
-                  );
-                  
-                  if (todo != null) {
-                    todos.add(todo);
-                  } else {
-                    skippedCount++;
-                    log('FirestoreTodoRepository: Skipping corrupted todo document: ${doc.id}');
-                  }
-                } catch (e, stackTrace) {
-                  skippedCount++;
-                  log(
-                    'FirestoreTodoRepository: Error parsing todo document ${doc.id}: $e',
-                    error: e,
-                    stackTrace: stackTrace,
-                  );
-                }
-              }
+              final todos = TodoItem.schema.decodeAll(
+                snapshot.docs.map((doc) => (doc.id, doc.data() as Map<String, dynamic>)),
+                context: 'FirestoreTodoRepository.getTodos',
+              );
+              final skippedCount = snapshot.docs.length - todos.length;
               
               if (skippedCount > 0) {
                 log('FirestoreTodoRepository: Skipped $skippedCount corrupted todo documents');
@@ -257,30 +234,11 @@ class FirestoreTodoRepository implements TodoRepository {
           .orderBy('updated_at', descending: true)
           .get();
       
-      final todos = <TodoItem>[];
-      int skippedCount = 0;
-      
-      for (final doc in snapshot.docs) {
-        try {
-          final data = doc.data() as Map<String, dynamic>;
-          data['id'] = doc.id;
-          
-          final todo = SafeJsonConverter.safeFromJson<TodoItem>(
-            data,
-            TodoItem.fromJson,
-            context: 'FirestoreTodoRepository.getTodosByCategory - doc: ${doc.id}',
-          );
-          
-          if (todo != null) {
-            todos.add(todo);
-          } else {
-            skippedCount++;
-          }
-        } catch (e) {
-          skippedCount++;
-          log('FirestoreTodoRepository: Error parsing todo in category $category, document ${doc.id}: $e');
-        }
-      }
+      final todos = TodoItem.schema.decodeAll(
+        snapshot.docs.map((doc) => (doc.id, doc.data() as Map<String, dynamic>)),
+        context: 'FirestoreTodoRepository.getTodosByCategory',
+      );
+      final skippedCount = snapshot.docs.length - todos.length;
       
       if (skippedCount > 0) {
         log('FirestoreTodoRepository: Skipped $skippedCount documents in category $category');
@@ -301,50 +259,51 @@ class FirestoreTodoRepository implements TodoRepository {
           .orderBy('updated_at', descending: true)
           .get();
       
-      return snapshot.docs.map((doc) {
-        final data = doc.data() as Map<String, dynamic>;
-        data['id'] = doc.id;
-        return TodoItem.fromJson(data);
-      }).toList();
+      return TodoItem.schema.decodeAll(
+        snapshot.docs.map((doc) => (doc.id, doc.data() as Map<String, dynamic>)),
+        context: 'FirestoreTodoRepository.getTodosByStatus',
+      );
     } catch (e) {
       throw Exception('Failed to get todos by status: $e');
     }
   }
 
-  /// Search todos by title or description
+  /// Search todos by title or description. Matching and ranking run on the
+  /// isolate pool.
   Future<List<TodoItem>> searchTodos(String query) async {
     try {
       final snapshot = await _todosCollection.get();
-      final todos = <TodoItem>[];
-      
-      for (final doc in snapshot.docs) {
-        final data = doc.data() as Map<String, dynamic>;
-        data['id'] = doc.id;
-        final todo = TodoItem.fromJson(data);
-        
-        if (todo.title.toLowerCase().contains(query.toLowerCase()) ||
-            todo.description.toLowerCase().contains(query.toLowerCase())) {
-          todos.add(todo);
-        }
-      }
-      
-      // Sort by relevance (title matches first, then description matches)
-      todos.sort((a, b) {
-        final aTitle = a.title.toLowerCase().contains(query.toLowerCase());
-        final bTitle = b.title.toLowerCase().contains(query.toLowerCase());
-        
-        if (aTitle && !bTitle) return -1;
-        if (!aTitle && bTitle) return 1;
-        
-        return b.updatedAt.compareTo(a.updatedAt);
-      });
-      
-      return todos;
+      final todos = TodoItem.schema.decodeAll(
+        snapshot.docs.map((doc) => (doc.id, doc.data() as Map<String, dynamic>)),
+        context: 'FirestoreTodoRepository.searchTodos',
+      );
+      return await IsolatePoolService.instance.run(
+        _matchTodos,
+        (query: query, todos: todos),
+        priority: TaskPriority.high,
+      );
     } catch (e) {
       throw Exception('Failed to search todos: $e');
     }
   }
 
+  /// Pool task: todos containing the query, title matches first, then most
+  /// recently updated first
+  static List<TodoItem> _matchTodos(({String query, List<TodoItem> todos}) search) {
+    final query = search.query.toLowerCase();
+    final inTitle = <TodoItem>[];
+    final inDescription = <TodoItem>[];
+    for (final todo in search.todos) {
+      if (todo.title.toLowerCase().contains(query)) {
+        inTitle.add(todo);
+      } else if (todo.description.toLowerCase().contains(query)) {
+        inDescription.add(todo);
+      }
+    }
+    int recentFirst(TodoItem a, TodoItem b) => b.updatedAt.compareTo(a.updatedAt);
+    return [...inTitle..sort(recentFirst), ...inDescription..sort(recentFirst)];
+  }
+
   /// Batch update multiple todos
   Future<void> batchUpdateTodos(List<TodoItem> todos) async {
     try {
@@ -1,3 +1,5 @@
+import '../core/utils/document_schema.dart';
+
 abstract class NewsRepository {
   /// Get latest news articles
   Future<List<NewsItem>> getLatestNews();
@@ -49,6 +51,41 @@ class NewsItem {
     this.tags = const [],
   });
 
+  /// Compiled decoding plan for Firestore snapshots
+  static final DocumentSchema<NewsItem> schema = DocumentSchema<NewsItem>(
+    'NewsItem',
+    const [
+      FieldSpec('id', FieldKind.string, fallback: ''),
+      FieldSpec('title', FieldKind.string, fallback: ''),
+      FieldSpec('description', FieldKind.string, fallback: ''),
+      FieldSpec('link', FieldKind.string, fallback: ''),
+      FieldSpec('source', FieldKind.string, fallback: ''),
+      FieldSpec('author', FieldKind.string),
+      FieldSpec('category', FieldKind.string, fallback: 'general'),
+      FieldSpec('published_date', FieldKind.timestamp),
+      FieldSpec('cached_at', FieldKind.timestamp),
+      FieldSpec('expires_at', FieldKind.timestamp),
+      FieldSpec('user_id', FieldKind.string),
+      FieldSpec('image_url', FieldKind.string),
+      FieldSpec('tags', FieldKind.stringList),
+    ],
+    (f) => NewsItem(
+      id: f.string(0),
+      title: f.string(1),
+      description: f.string(2),
+      link: f.string(3),
+      source: f.string(4),
+      author: f.optionalString(5),
+      category: f.string(6),
+      publishedDate: f.time(7),
+      cachedAt: f.optionalTime(8),
+      expiresAt: f.optionalTime(9),
+      userId: f.optionalString(10),
+      imageUrl: f.optionalString(11),
+      tags: f.strings(12),
+    ),
+  );
+
   /// Create NewsItem from JSON (RSS feed or Firestore document)
   factory NewsItem.fromJson(Map<String, dynamic> json) {
     return NewsItem(
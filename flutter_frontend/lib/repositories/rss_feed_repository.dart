@@ -1,7 +1,13 @@
+import 'dart:math';
 import 'package:cloud_firestore/cloud_firestore.dart';
 import 'package:flutter/foundation.dart';
+import '../core/services/isolate_pool_service.dart';
+import '../core/services/resource_budget_service.dart';
 import '../firebase/firebase_service.dart';
 import '../models/rss_feed.dart';
+import '../services/article_store.dart';
+import '../services/dashboard_config_service.dart';
+import '../services/feed_health_service.dart';
 import '../services/rss_service.dart';
 
 abstract class RSSFeedRepository {
@@ -27,15 +33,17 @@ class FirestoreRSSFeedRepository implements RSSFeedRepository {
           .orderBy('updatedAt', descending: true)
           .get();
 
-      return snapshot.docs
-          .map((doc) => RSSFeed.fromMap({
-                ...doc.data() as Map<String, dynamic>,
-                'id': doc.id,
-              }))
-          .toList();
+      return [
+        ...snapshot.docs.map((doc) => RSSFeed.fromMap({
+              ...doc.data() as Map<String, dynamic>,
+              'id': doc.id,
+            })),
+        // Feeds from the local config come after the user's own
+        ...DashboardConfigService.instance.feeds.value,
+      ];
     } catch (e) {
       debugPrint('Error getting feeds: $e');
-      return [];
+      return List.of(DashboardConfigService.instance.feeds.value);
     }
   }
 
@@ -51,6 +59,9 @@ class FirestoreRSSFeedRepository implements RSSFeedRepository {
 
   @override
   Future<RSSFeed> updateFeed(RSSFeed feed) async {
+    if (DashboardConfigService.isConfigFeed(feed.id)) {
+      throw Exception('Feed ${feed.name} is set in the dashboard config file');
+    }
     try {
       await _feedsCollection.doc(feed.id).update(
         feed.copyWith(updatedAt: DateTime.now()).toMap(),
@@ -63,6 +74,9 @@ class FirestoreRSSFeedRepository implements RSSFeedRepository {
 
   @override
   Future<void> deleteFeed(String feedId) async {
+    if (DashboardConfigService.isConfigFeed(feedId)) {
+      throw Exception('Feeds from the dashboard config file are removed there');
+    }
     try {
       await _feedsCollection.doc(feedId).delete();
     } catch (e) {
@@ -97,21 +111,62 @@ class FirestoreRSSFeedRepository implements RSSFeedRepository {
       final activeFeeds = feeds.where((f) => f.isActive).toList();
       
       final List<NewsArticle> allArticles = [];
+
+      // Demoted and quarantined feeds sit this refresh out and show their
+      // last articles; a demoted feed with nothing cached yet is fetched
+      final health = FeedHealthService.instance;
+      await Future.wait([health.initialize(), ArticleStore.instance.initialize()]);
+      final dueFeeds = <RSSFeed>[];
+      final skippedFeeds = <RSSFeed>[];
+      for (final feed in activeFeeds) {
+        final cached = RSSService.hasCachedArticles(feed.id);
+        if (health.isDue(feed.id) || (!cached && !health.isQuarantined(feed.id))) {
+          dueFeeds.add(feed);
+        } else {
+          health.noteSkipped();
+          skippedFeeds.add(feed);
+        }
+      }
+      // Read alongside the fetches; only the skipped feeds are decoded
+      final skipped = Future.wait([for (final feed in skippedFeeds) RSSService.cachedArticles(feed.id)]);
       
-      // Fetch articles from all active feeds
-      await Future.wait(
-        activeFeeds.map((feed) async {
+      // Fetch articles from the due feeds, at most fetchConcurrency at a
+      // time so a long feed list does not saturate a CPU-limited container
+      final pending = dueFeeds.iterator;
+      Future<void> fetchNext() async {
+        while (pending.moveNext()) {
+          final feed = pending.current;
           try {
             final articles = await RSSService.fetchFeed(feed);
             allArticles.addAll(articles);
           } catch (e) {
             debugPrint('Error fetching feed ${feed.name}: $e');
+            // Show what the feed had last time instead of nothing
+            allArticles.addAll(await RSSService.cachedArticles(feed.id) ?? const []);
           }
-        }),
+        }
+      }
+
+      final concurrency = ResourceBudgetService.instance.budget.fetchConcurrency;
+      await Future.wait(
+        List.generate(min(concurrency, dueFeeds.length), (_) => fetchNext()),
       );
+      for (final articles in await skipped) {
+        allArticles.addAll(articles ?? const []);
+      }
 
       // Sort by publication date
+      final sortStopwatch = Stopwatch()..start();
       allArticles.sort((a, b) => b.publishedAt.compareTo(a.publishedAt));
+      sortStopwatch.stop();
+
+      final parseTime = RSSService.takeUiParseTime();
+      debugPrint('RSSFeedRepository: Refreshed ${allArticles.length} articles from '
+          '${dueFeeds.length}/${activeFeeds.length} feeds, UI isolate busy '
+          '${(parseTime + sortStopwatch.elapsed).inMicroseconds / 1000} ms '
+          '(parse ${parseTime.inMicroseconds / 1000} ms, '
+          'sort ${sortStopwatch.elapsedMicroseconds / 1000} ms), '
+          '${IsolatePoolService.instance.stats}');
       
       return allArticles;
     } catch (e) {
@@ -126,12 +181,13 @@ class FirestoreRSSFeedRepository implements RSSFeedRepository {
         .orderBy('updatedAt', descending: true)
         .snapshots()
         .map((snapshot) {
-          return snapshot.docs
-              .map((doc) => RSSFeed.fromMap({
-                    ...doc.data() as Map<String, dynamic>,
-                    'id': doc.id,
-                  }))
-              .toList();
+          return [
+            ...snapshot.docs.map((doc) => RSSFeed.fromMap({
+                  ...doc.data() as Map<String, dynamic>,
+                  'id': doc.id,
+                })),
+            ...DashboardConfigService.instance.feeds.value,
+          ];
         });
   }
 }
@@ -186,10 +242,15 @@ class MockRSSFeedRepository implements RSSFeedRepository {
     ),
   ];
 
+  /// The mock feeds, then the feeds from the local config, as in
+  /// [FirestoreRSSFeedRepository]
+  static List<RSSFeed> get _allFeeds =>
+      [..._feeds, ...DashboardConfigService.instance.feeds.value];
+
   @override
   Future<List<RSSFeed>> getFeeds() async {
     await Future.delayed(const Duration(milliseconds: 500));
-    return List.from(_feeds);
+    return _allFeeds;
   }
 
   @override
@@ -204,6 +265,9 @@ class MockRSSFeedRepository implements RSSFeedRepository {
 
   @override
   Future<RSSFeed> updateFeed(RSSFeed feed) async {
+    if (DashboardConfigService.isConfigFeed(feed.id)) {
+      throw Exception('Feed ${feed.name} is set in the dashboard config file');
+    }
     await Future.delayed(const Duration(milliseconds: 500));
     final index = _feeds.indexWhere((f) => f.id == feed.id);
     if (index != -1) {
@@ -215,12 +279,18 @@ class MockRSSFeedRepository implements RSSFeedRepository {
 
   @override
   Future<void> deleteFeed(String feedId) async {
+    if (DashboardConfigService.isConfigFeed(feedId)) {
+      throw Exception('Feeds from the dashboard config file are removed there');
+    }
     await Future.delayed(const Duration(milliseconds: 500));
     _feeds.removeWhere((f) => f.id == feedId);
   }
 
   @override
   Future<List<NewsArticle>> getFeedArticles(String feedId) async {
+    for (final feed in DashboardConfigService.instance.feeds.value) {
+      if (feed.id == feedId) return feed.isActive ? _fetchConfigFeed(feed) : [];
+    }
     await Future.delayed(const Duration(milliseconds: 500));
     return _mockArticles.where((a) => a.feedId == feedId).toList();
   }
@@ -228,11 +298,29 @@ class MockRSSFeedRepository implements RSSFeedRepository {
   @override
   Future<List<NewsArticle>> getAllArticles() async {
     await Future.delayed(const Duration(milliseconds: 500));
-    return List.from(_mockArticles);
+    final configArticles = await Future.wait([
+      for (final feed in DashboardConfigService.instance.feeds.value)
+        if (feed.isActive) _fetchConfigFeed(feed),
+    ]);
+    return [
+      ..._mockArticles,
+      for (final articles in configArticles) ...articles,
+    ]..sort((a, b) => b.publishedAt.compareTo(a.publishedAt));
+  }
+
+  /// Config feeds are real even offline; a failed fetch shows what the
+  /// feed had last time
+  static Future<List<NewsArticle>> _fetchConfigFeed(RSSFeed feed) async {
+    try {
+      return await RSSService.fetchFeed(feed);
+    } catch (e) {
+      debugPrint('Error fetching feed ${feed.name}: $e');
+      return await RSSService.cachedArticles(feed.id) ?? const [];
+    }
   }
 
   @override
   Stream<List<RSSFeed>> watchFeeds() {
-    return Stream.value(_feeds);
+    return Stream.value(_allFeeds);
   }
 }
\ No newline at end of file
@@ -1,3 +1,4 @@
+import '../core/utils/document_schema.dart';
 import '../core/utils/timestamp_converter.dart';
 import '../core/utils/safe_json_converter.dart';
 
@@ -51,6 +52,37 @@ class TodoItem {
     this.userId,
   });
 
+  /// Compiled decoding plan for Firestore snapshots
+  static final DocumentSchema<TodoItem> schema = DocumentSchema<TodoItem>(
+    'TodoItem',
+    const [
+      FieldSpec('id', FieldKind.string, required: true, fallback: ''),
+      FieldSpec('title', FieldKind.string, required: true, fallback: ''),
+      FieldSpec('description', FieldKind.string, fallback: ''),
+      FieldSpec('category', FieldKind.string, fallback: 'general'),
+      FieldSpec('priority', FieldKind.string, fallback: 'medium'),
+      FieldSpec('status', FieldKind.string, fallback: 'pending'),
+      FieldSpec('created_at', FieldKind.timestamp),
+      FieldSpec('updated_at', FieldKind.timestamp),
+      FieldSpec('due_date', FieldKind.timestamp),
+      FieldSpec('tags', FieldKind.stringList),
+      FieldSpec('user_id', FieldKind.string),
+    ],
+    (f) => TodoItem(
+      id: f.string(0),
+      title: f.string(1),
+      description: f.string(2),
+      category: f.string(3),
+      priority: f.string(4),
+      status: f.string(5),
+      createdAt: f.time(6),
+      updatedAt: f.time(7),
+      dueDate: f.optionalTime(8),
+      tags: f.strings(9),
+      userId: f.optionalString(10),
+    ),
+  );
+
   /// Create TodoItem from JSON (Firestore document)
   factory TodoItem.fromJson(Map<String, dynamic> json) {
     // Validate required fields using SafeJsonConverter
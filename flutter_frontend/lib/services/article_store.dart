@@ -0,0 +1,775 @@
+import 'dart:async';
+import 'dart:convert';
+import 'dart:io';
+import 'dart:isolate';
+import 'dart:typed_data';
+import 'package:flutter/foundation.dart';
+import '../core/services/idle_scheduler.dart';
+import '../core/services/isolate_pool_service.dart';
+import '../core/utils/deflate_dictionary.dart';
+import '../core/utils/record_buffer.dart';
+import '../models/rss_feed.dart';
+
+const int _magic = 0x4341444d; // "MDAC"
+const int _version = 1;
+const int _fileHeaderSize = 8;
+const int _frameHeaderSize = 24;
+const int _kindRecord = 1;
+const int _kindTombstone = 2;
+const int _flagCompressed = 1;
+const String _fieldSeparator = '\u001f';
+const String _logName = 'articles.log';
+const String _compactName = 'articles.log.compact';
+
+/// One frame of the log, as read back
+class _Frame {
+  final int kind;
+  final bool compressed;
+  final int generation;
+  final int storedLength;
+  final int rawLength;
+  final int publishedAtMs;
+  final String id;
+  final String feedId;
+
+  /// Offsets of the frame and its payload in the file
+  final int frameOffset;
+  final int payloadOffset;
+
+  const _Frame(this.kind, this.compressed, this.generation, this.storedLength, this.rawLength,
+      this.publishedAtMs, this.id, this.feedId, this.frameOffset, this.payloadOffset);
+
+  int get frameEnd => payloadOffset + storedLength;
+}
+
+/// Where a stored article lives in the log
+class _Slot {
+  final int offset;
+  final int length;
+  final int rawLength;
+  final bool compressed;
+  final int generation;
+  final int publishedAtMs;
+  final int frameLength;
+
+  const _Slot(this.offset, this.length, this.rawLength, this.compressed, this.generation,
+      this.publishedAtMs, this.frameLength);
+}
+
+/// Arguments for [ArticleStore._compactLog]
+class _CompactionRequest {
+  final String directory;
+  final int snapshotEnd;
+  final Map<int, Uint8List> dictionaries;
+  final int generation;
+  final int dictionarySize;
+
+  const _CompactionRequest(
+      this.directory, this.snapshotEnd, this.dictionaries, this.generation, this.dictionarySize);
+}
+
+/// Arguments for [ArticleStore._readArticles]
+class _ReadRequest {
+  final String path;
+  final String feedId;
+  final List<String> ids;
+  final List<_Slot> slots;
+  final Map<int, Uint8List> dictionaries;
+
+  const _ReadRequest(this.path, this.feedId, this.ids, this.slots, this.dictionaries);
+}
+
+/// Articles read by [ArticleStore._readArticles], as one record buffer
+class _ReadResult {
+  final TransferableTypedData records;
+  final List<String> unreadable;
+  final int micros;
+
+  const _ReadResult(this.records, this.unreadable, this.micros);
+}
+
+/// Outcome of a compaction, applied on the UI isolate
+class _CompactionResult {
+  final Uint8List dictionary;
+  final Map<String, Map<String, _Slot>> feeds;
+  final int end;
+  final _TrainingReport report;
+
+  const _CompactionResult(this.dictionary, this.feeds, this.end, this.report);
+}
+
+/// Sizes and inflate times measured over the whole store at training time
+class _TrainingReport {
+  final int records;
+  final int rawBytes;
+  final int plainBytes;
+  final int dictionaryBytes;
+  final double plainInflateMicros;
+  final double dictionaryInflateMicros;
+
+  const _TrainingReport(this.records, this.rawBytes, this.plainBytes, this.dictionaryBytes,
+      this.plainInflateMicros, this.dictionaryInflateMicros);
+
+  double get plainRatio => plainBytes == 0 ? 1 : rawBytes / plainBytes;
+  double get dictionaryRatio => dictionaryBytes == 0 ? 1 : rawBytes / dictionaryBytes;
+}
+
+/// On-disk copy of the articles of every feed, so a launch can show the last
+/// session's articles before any network fetch and a failing feed still shows
+/// what it had.
+///
+/// Articles are appended to one log under
+/// `$XDG_CACHE_HOME/modern_dashboard/articles`. Each article is its own
+/// frame, compressed with raw deflate and a preset dictionary trained on the
+/// local articles (see [trainDeflateDictionary]). Titles, descriptions and
+/// links repeat a lot within and across publishers, but one article is too
+/// short for plain deflate to find those repeats. The dictionary supplies
+/// them, so any single article can be read back with one positioned read
+/// and one small inflate. An in-memory index maps each feed's article IDs to
+/// their frames.
+///
+/// Retraining runs on the isolate pool once enough articles have arrived
+/// since the last dictionary. It rewrites the log with the new dictionary,
+/// which also drops replaced and deleted frames. Frames appended meanwhile
+/// are carried over when the new log is swapped in. [stats] reports the
+/// compression ratio with and without the dictionary, and the read cost.
+class ArticleStore {
+  static ArticleStore? _instance;
+  static ArticleStore get instance => _instance ??= ArticleStore._();
+
+  ArticleStore._([this._root]);
+
+  /// A store of its own under [path], for tests
+  @visibleForTesting
+  factory ArticleStore.at(String path) => ArticleStore._(path);
+
+  /// Directory of the log; the user's cache directory when null
+  final String? _root;
+
+  /// Articles kept per feed; older ones are dropped
+  static const int maxPerFeed = 200;
+  static const int _dictionarySize = 16 * 1024;
+
+  /// Articles needed before the first dictionary, and new articles needed
+  /// before the next one
+  static const int _minTrainingRecords = 200;
+
+  Directory? _directory;
+  RandomAccessFile? _log;
+  int _end = 0;
+  final Map<String, Map<String, _Slot>> _feeds = {};
+  final Map<int, Uint8List> _dictionaries = {};
+  int _generation = 0;
+  int _deadBytes = 0;
+  int _appendedSinceTraining = 0;
+  bool _compacting = false;
+
+  /// Logs swapped in so far; slots taken before a swap are stale after it
+  int _swaps = 0;
+
+  /// A rewritten log waiting for its idle slice to be swapped in
+  ({int generation, int snapshotEnd, _CompactionResult result})? _rewritten;
+  Future<void>? _loaded;
+
+  int _reads = 0;
+  int _readMicros = 0;
+  _TrainingReport? _lastTraining;
+
+  /// Open the store and index the log; a no-op on the web
+  Future<void> initialize() => _loaded ??= _load();
+
+  int get _recordCount => _feeds.values.fold(0, (sum, slots) => sum + slots.length);
+
+  Map<String, dynamic> get stats {
+    var raw = 0;
+    var stored = 0;
+    for (final slots in _feeds.values) {
+      for (final slot in slots.values) {
+        raw += slot.rawLength;
+        stored += slot.length;
+      }
+    }
+    final training = _lastTraining;
+    return {
+      'articles': _recordCount,
+      'storedKB': stored >> 10,
+      'ratio': stored == 0 ? null : (raw / stored).toStringAsFixed(2),
+      'ratioWithoutDictionary': training?.plainRatio.toStringAsFixed(2),
+      'readMicros': _reads == 0 ? null : (_readMicros / _reads).toStringAsFixed(1),
+      'dictionary': _generation == 0 ? null : 'gen $_generation',
+    };
+  }
+
+  /// Whether articles of [feedId] are stored, answered from the index
+  bool hasArticles(String feedId) => _log != null && (_feeds[feedId]?.isNotEmpty ?? false);
+
+  /// Articles stored for [feedId], newest first, or null when there are
+  /// none. The reads and inflates run on the isolate pool.
+  Future<List<NewsArticle>?> articlesOf(String feedId) async {
+    final slots = _feeds[feedId];
+    final directory = _directory;
+    if (slots == null || slots.isEmpty || _log == null || directory == null) return null;
+
+    final entries = slots.entries.toList()
+      ..sort((a, b) => b.value.publishedAtMs.compareTo(a.value.publishedAtMs));
+    final swaps = _swaps;
+    final _ReadResult read;
+    try {
+      read = await IsolatePoolService.instance.run(
+        _readArticles,
+        _ReadRequest(
+          '${directory.path}/$_logName',
+          feedId,
+          [for (final entry in entries) entry.key],
+          [for (final entry in entries) entry.value],
+          {
+            for (final generation in {for (final entry in entries) entry.value.generation})
+              if (_dictionaries[generation] case final dictionary?) generation: dictionary,
+          },
+        ),
+        priority: TaskPriority.high,
+      );
+    } catch (e) {
+      debugPrint('ArticleStore: Failed to read the articles of $feedId: $e');
+      return null;
+    }
+    // The offsets belong to the log a compaction replaced meanwhile
+    if (swaps != _swaps) return articlesOf(feedId);
+
+    _reads += entries.length;
+    _readMicros += read.micros;
+    for (final id in read.unreadable) {
+      debugPrint('ArticleStore: Dropping unreadable article $id');
+      slots.remove(id);
+    }
+    final buffer = RecordBuffer(read.records.materialize().asUint8List());
+    return buffer.length == 0 ? null : List.generate(buffer.length, buffer.article);
+  }
+
+  /// Store the articles of [feedId] that are not stored yet, keeping the
+  /// newest [maxPerFeed]
+  void putFeed(String feedId, List<NewsArticle> articles) {
+    final log = _log;
+    if (log == null) return;
+    final slots = _feeds.putIfAbsent(feedId, () => {});
+    final dictionary = _dictionaries[_generation];
+    final frames = BytesBuilder(copy: false);
+    final added = <String, _Slot>{};
+
+    for (final article in articles) {
+      if (slots.containsKey(article.id) || added.containsKey(article.id)) continue;
+      final raw = utf8.encode(_encodePayload(article));
+      final frame = _encodeFrame(_kindRecord, article.id, feedId,
+          article.publishedAt.millisecondsSinceEpoch, raw, _generation, dictionary);
+      added[article.id] = frame.slotAt(_end + frames.length);
+      frames.add(frame.bytes);
+    }
+
+    // Drop the oldest beyond the per-feed limit
+    final all = {...slots, ...added};
+    if (all.length > maxPerFeed) {
+      final oldest = all.entries.toList()
+        ..sort((a, b) => a.value.publishedAtMs.compareTo(b.value.publishedAtMs));
+      for (final entry in oldest.take(all.length - maxPerFeed)) {
+        frames.add(_tombstone(entry.key, feedId));
+        _deadBytes += entry.value.frameLength;
+        slots.remove(entry.key);
+        added.remove(entry.key);
+      }
+    }
+    if (frames.isEmpty) return;
+
+    if (!_append(log, frames.takeBytes())) return;
+    slots.addAll(added);
+    _appendedSinceTraining += added.length;
+    _maybeCompact();
+  }
+
+  /// Forget every article of [feedId]
+  void removeFeed(String feedId) {
+    final log = _log;
+    final slots = _feeds.remove(feedId);
+    if (log == null || slots == null || slots.isEmpty) return;
+    final frames = BytesBuilder(copy: false);
+    for (final entry in slots.entries) {
+      frames.add(_tombstone(entry.key, feedId));
+      _deadBytes += entry.value.frameLength;
+    }
+    _append(log, frames.takeBytes());
+    _maybeCompact();
+  }
+
+  Future<void> _load() async {
+    if (kIsWeb) return;
+    final stopwatch = Stopwatch()..start();
+    try {
+      final cacheHome = Platform.environment['XDG_CACHE_HOME'] ??
+          (Platform.environment['HOME'] != null ? '${Platform.environment['HOME']}/.cache' : null);
+      final root = _root ?? (cacheHome == null ? null : '$cacheHome/modern_dashboard/articles');
+      if (root == null) return;
+      final directory = await Directory(root).create(recursive: true);
+      _directory = directory;
+
+      await for (final entity in directory.list()) {
+        final name = entity.uri.pathSegments.last;
+        final generation = _dictionaryGeneration(name);
+        if (generation != null) {
+          _dictionaries[generation] = await File(entity.path).readAsBytes();
+          if (generation > _generation) _generation = generation;
+        } else if (name == _compactName) {
+          await entity.delete();
+        }
+      }
+
+      final file = File('${directory.path}/$_logName');
+      final bytes = await file.exists() ? await file.readAsBytes() : Uint8List(0);
+      final log = await file.open(mode: FileMode.append);
+      var end = _scan(bytes, (frame) => _apply(_feeds, frame));
+      if (end == null) {
+        // Missing or foreign file: start over
+        _feeds.clear();
+        log.truncateSync(0);
+        log.setPositionSync(0);
+        log.writeFromSync(_fileHeader());
+        end = _fileHeaderSize;
+      } else if (end < bytes.length) {
+        log.truncateSync(end);
+      }
+      _log = log;
+      _end = end;
+      _deadBytes = _end - _fileHeaderSize - _liveBytes();
+      // Without a dictionary yet, everything stored counts toward the first
+      if (_generation == 0) _appendedSinceTraining = _recordCount;
+      debugPrint('ArticleStore: Indexed $_recordCount articles of ${_feeds.length} feeds '
+          '(${_end >> 10} KiB) in ${stopwatch.elapsedMilliseconds} ms');
+      _maybeCompact();
+    } catch (e) {
+      debugPrint('ArticleStore: Disabled, could not open the article log: $e');
+      _log = null;
+    }
+  }
+
+  /// Apply [frame] to an index; frames of an unknown dictionary are unreadable
+  void _apply(Map<String, Map<String, _Slot>> feeds, _Frame frame) {
+    if (frame.kind == _kindTombstone) {
+      feeds[frame.feedId]?.remove(frame.id);
+      return;
+    }
+    if (frame.compressed && frame.generation != 0 && !_dictionaries.containsKey(frame.generation)) {
+      return;
+    }
+    feeds.putIfAbsent(frame.feedId, () => {})[frame.id] = _Slot(
+        frame.payloadOffset,
+        frame.storedLength,
+        frame.rawLength,
+        frame.compressed,
+        frame.generation,
+        frame.publishedAtMs,
+        frame.frameEnd - frame.frameOffset);
+  }
+
+  int _liveBytes() => _feeds.values
+      .fold(0, (sum, slots) => sum + slots.values.fold(0, (s, slot) => s + slot.frameLength));
+
+  bool _append(RandomAccessFile log, Uint8List bytes) {
+    try {
+      log.setPositionSync(_end);
+      log.writeFromSync(bytes);
+      _end += bytes.length;
+      return true;
+    } catch (e) {
+      debugPrint('ArticleStore: Failed to append to the article log: $e');
+      return false;
+    }
+  }
+
+  /// Pool task: one positioned read and inflate per article, returned as
+  /// an article record buffer
+  static _ReadResult _readArticles(_ReadRequest request) {
+    final stopwatch = Stopwatch()..start();
+    final articles = <NewsArticle>[];
+    final unreadable = <String>[];
+    final log = File(request.path).openSync();
+    try {
+      for (var i = 0; i < request.ids.length; i++) {
+        final slot = request.slots[i];
+        try {
+          log.setPositionSync(slot.offset);
+          final stored = log.readSync(slot.length);
+          final raw =
+              slot.compressed ? _inflate(stored, request.dictionaries[slot.generation]) : stored;
+          articles.add(
+              _decodePayload(utf8.decode(raw), request.ids[i], request.feedId, slot.publishedAtMs));
+        } catch (_) {
+          unreadable.add(request.ids[i]);
+        }
+      }
+    } finally {
+      log.closeSync();
+    }
+    return _ReadResult(
+      TransferableTypedData.fromList([RecordBufferWriter.encodeArticles(articles)]),
+      unreadable,
+      stopwatch.elapsedMicroseconds,
+    );
+  }
+
+  void _maybeCompact() {
+    if (_compacting || _log == null) return;
+    final records = _recordCount;
+    final retrain = records >= _minTrainingRecords && _appendedSinceTraining >= _minTrainingRecords;
+    final reclaim = _deadBytes > 1024 * 1024 && _deadBytes > _end ~/ 2;
+    if (!retrain && !reclaim) return;
+    // The pool does the rewrite, but swapping the log in is file I/O here,
+    // so it waits for an idle slice of its own
+    unawaited(IdleScheduler.instance.schedule('ArticleStore.compact', _compactStep));
+  }
+
+  /// Rewrite the log on the pool, then swap the result in on the next call
+  FutureOr<bool> _compactStep(IdleDeadline deadline) {
+    final rewritten = _rewritten;
+    if (rewritten == null) return _rewrite();
+    _rewritten = null;
+    final directory = _directory;
+    try {
+      if (directory != null && _log != null) {
+        _swapIn(directory, rewritten.generation, rewritten.snapshotEnd, rewritten.result);
+      }
+    } catch (e) {
+      debugPrint('ArticleStore: Compaction failed: $e');
+      _appendedSinceTraining = 0;
+    } finally {
+      _compacting = false;
+    }
+    return true;
+  }
+
+  /// Completes with false when there is a rewritten log to swap in
+  Future<bool> _rewrite() async {
+    final directory = _directory;
+    if (directory == null) return true;
+    _compacting = true;
+    final snapshotEnd = _end;
+    final generation = _generation + 1;
+    try {
+      final result = await IsolatePoolService.instance.run(
+        _compactLog,
+        _CompactionRequest(directory.path, snapshotEnd, Map.of(_dictionaries), generation,
+            _dictionarySize),
+        priority: TaskPriority.low,
+      );
+      if (result != null) {
+        _rewritten = (generation: generation, snapshotEnd: snapshotEnd, result: result);
+        return false;
+      }
+      _appendedSinceTraining = 0;
+    } catch (e) {
+      debugPrint('ArticleStore: Compaction failed: $e');
+      _appendedSinceTraining = 0;
+    }
+    _compacting = false;
+    return true;
+  }
+
+  /// Carry frames appended during compaction over to the new log and make it
+  /// current; runs without awaiting so no append can slip in between
+  void _swapIn(Directory directory, int generation, int snapshotEnd, _CompactionResult result) {
+    final oldLog = _log!;
+    final compact = File('${directory.path}/$_compactName').openSync(mode: FileMode.append);
+    var end = result.end;
+    final feeds = result.feeds;
+
+    if (_end > snapshotEnd) {
+      oldLog.setPositionSync(snapshotEnd);
+      final tail = oldLog.readSync(_end - snapshotEnd);
+      final carried = BytesBuilder(copy: false);
+      _scanFrames(tail, 0, snapshotEnd, (frame) {
+        if (frame.kind == _kindTombstone) {
+          feeds[frame.feedId]?.remove(frame.id);
+          carried.add(_tombstone(frame.id, frame.feedId));
+          return;
+        }
+        final stored = Uint8List.sublistView(
+            tail, frame.payloadOffset - snapshotEnd, frame.frameEnd - snapshotEnd);
+        final raw = frame.compressed ? _inflate(stored, _dictionaries[frame.generation]) : stored;
+        final encoded = _encodeFrame(_kindRecord, frame.id, frame.feedId, frame.publishedAtMs,
+            raw, generation, result.dictionary);
+        feeds.putIfAbsent(frame.feedId, () => {})[frame.id] =
+            encoded.slotAt(end + carried.length);
+        carried.add(encoded.bytes);
+      });
+      compact
+        ..setPositionSync(end)
+        ..writeFromSync(carried.toBytes());
+      end += carried.length;
+    }
+
+    oldLog.closeSync();
+    compact.closeSync();
+    File('${directory.path}/$_compactName').renameSync('${directory.path}/$_logName');
+    _log = File('${directory.path}/$_logName').openSync(mode: FileMode.append);
+    _end = end;
+    _feeds
+      ..clear()
+      ..addAll(feeds);
+    for (final old in _dictionaries.keys) {
+      final file = File('${directory.path}/${_dictionaryName(old)}');
+      if (file.existsSync()) file.deleteSync();
+    }
+    _dictionaries
+      ..clear()
+      ..[generation] = result.dictionary;
+    _generation = generation;
+    _swaps++;
+    _deadBytes = _end - _fileHeaderSize - _liveBytes();
+    _appendedSinceTraining = 0;
+
+    final report = result.report;
+    _lastTraining = report;
+    debugPrint('ArticleStore: Trained dictionary gen $generation '
+        '(${result.dictionary.length >> 10} KiB) on ${report.records} articles: '
+        '${report.rawBytes >> 10} KiB stored in ${report.dictionaryBytes >> 10} KiB, '
+        'ratio ${report.dictionaryRatio.toStringAsFixed(2)} with dictionary vs '
+        '${report.plainRatio.toStringAsFixed(2)} without; inflate '
+        '${report.dictionaryInflateMicros.toStringAsFixed(1)} us vs '
+        '${report.plainInflateMicros.toStringAsFixed(1)} us per article');
+  }
+
+  /// Pool task: train a dictionary on the live articles below the snapshot
+  /// end and rewrite them into a compacted log with it
+  static _CompactionResult? _compactLog(_CompactionRequest request) {
+    final file = File('${request.directory}/$_logName').openSync();
+    final Uint8List bytes;
+    try {
+      bytes = file.readSync(request.snapshotEnd);
+    } finally {
+      file.closeSync();
+    }
+
+    final frames = <String, _Frame>{};
+    _scan(bytes, (frame) {
+      // Re-inserted so the map stays in write order, oldest first
+      final key = '${frame.feedId}$_fieldSeparator${frame.id}';
+      frames.remove(key);
+      if (frame.kind == _kindRecord) frames[key] = frame;
+    });
+
+    final raws = <Uint8List>[];
+    final live = <_Frame>[];
+    for (final frame in frames.values) {
+      if (frame.compressed && frame.generation != 0 &&
+          !request.dictionaries.containsKey(frame.generation)) {
+        continue;
+      }
+      final stored = Uint8List.sublistView(bytes, frame.payloadOffset, frame.frameEnd);
+      raws.add(frame.compressed ? _inflate(stored, request.dictionaries[frame.generation]) : stored);
+      live.add(frame);
+    }
+
+    final dictionary = trainDeflateDictionary(raws, size: request.dictionarySize);
+    if (dictionary.isEmpty) return null;
+    File('${request.directory}/${_dictionaryName(request.generation)}')
+        .writeAsBytesSync(dictionary, flush: true);
+
+    final feeds = <String, Map<String, _Slot>>{};
+    final out = BytesBuilder(copy: false)..add(_fileHeader());
+    final plain = <Uint8List>[];
+    final withDictionary = <Uint8List>[];
+    var rawBytes = 0;
+    var plainBytes = 0;
+    var dictionaryBytes = 0;
+    for (var i = 0; i < live.length; i++) {
+      final frame = live[i];
+      final raw = raws[i];
+      final encoded = _encodeFrame(_kindRecord, frame.id, frame.feedId, frame.publishedAtMs, raw,
+          request.generation, dictionary);
+      feeds.putIfAbsent(frame.feedId, () => {})[frame.id] = encoded.slotAt(out.length);
+      out.add(encoded.bytes);
+
+      final plainStored = _deflate(raw, null);
+      plain.add(plainStored);
+      withDictionary.add(encoded.stored);
+      rawBytes += raw.length;
+      plainBytes += plainStored.length;
+      dictionaryBytes += encoded.stored.length;
+    }
+
+    // Read cost of each layout, inflating every article once
+    final stopwatch = Stopwatch()..start();
+    for (final stored in plain) {
+      _inflate(stored, null);
+    }
+    final plainMicros = stopwatch.elapsedMicroseconds;
+    stopwatch.reset();
+    for (final stored in withDictionary) {
+      _inflate(stored, dictionary);
+    }
+    final dictionaryMicros = stopwatch.elapsedMicroseconds;
+
+    final end = out.length;
+    File('${request.directory}/$_compactName').writeAsBytesSync(out.takeBytes(), flush: true);
+    final count = live.isEmpty ? 1 : live.length;
+    return _CompactionResult(
+      dictionary,
+      feeds,
+      end,
+      _TrainingReport(live.length, rawBytes, plainBytes, dictionaryBytes, plainMicros / count,
+          dictionaryMicros / count),
+    );
+  }
+
+  /// Walk the frames of a log, returning where the last complete frame ends,
+  /// or null when [bytes] is not an article log
+  static int? _scan(Uint8List bytes, void Function(_Frame frame) onFrame) {
+    if (bytes.length < _fileHeaderSize) return null;
+    final data = ByteData.sublistView(bytes);
+    if (data.getUint32(0, Endian.little) != _magic ||
+        data.getUint16(4, Endian.little) != _version) {
+      return null;
+    }
+    return _scanFrames(bytes, _fileHeaderSize, 0, onFrame);
+  }
+
+  /// Walk the frames in [bytes] from [offset]; [bytes] starts at file offset
+  /// [base], which reported offsets include
+  static int _scanFrames(Uint8List bytes, int offset, int base, void Function(_Frame frame) onFrame) {
+    final data = ByteData.sublistView(bytes);
+    while (offset + _frameHeaderSize <= bytes.length) {
+      final kind = data.getUint8(offset);
+      final flags = data.getUint8(offset + 1);
+      final generation = data.getUint16(offset + 2, Endian.little);
+      final storedLength = data.getUint32(offset + 4, Endian.little);
+      final rawLength = data.getUint32(offset + 8, Endian.little);
+      final publishedAtMs = data.getInt64(offset + 12, Endian.little);
+      final idLength = data.getUint16(offset + 20, Endian.little);
+      final feedIdLength = data.getUint16(offset + 22, Endian.little);
+      final keyOffset = offset + _frameHeaderSize;
+      final payloadOffset = keyOffset + idLength + feedIdLength;
+      if ((kind != _kindRecord && kind != _kindTombstone) ||
+          payloadOffset + storedLength > bytes.length) {
+        break; // Torn write at the end
+      }
+      onFrame(_Frame(
+        kind,
+        flags & _flagCompressed != 0,
+        generation,
+        storedLength,
+        rawLength,
+        publishedAtMs,
+        utf8.decode(Uint8List.sublistView(bytes, keyOffset, keyOffset + idLength)),
+        utf8.decode(Uint8List.sublistView(bytes, keyOffset + idLength, payloadOffset)),
+        base + offset,
+        base + payloadOffset,
+      ));
+      offset = payloadOffset + storedLength;
+    }
+    return base + offset;
+  }
+
+  static Uint8List _fileHeader() {
+    return (ByteData(_fileHeaderSize)
+          ..setUint32(0, _magic, Endian.little)
+          ..setUint16(4, _version, Endian.little))
+        .buffer
+        .asUint8List();
+  }
+
+  /// Frame for an article, stored uncompressed when deflate does not help
+  static _EncodedFrame _encodeFrame(int kind, String id, String feedId, int publishedAtMs,
+      List<int> raw, int generation, Uint8List? dictionary) {
+    final deflated = _deflate(raw, dictionary);
+    final compressed = deflated.length < raw.length;
+    final stored = compressed ? deflated : Uint8List.fromList(raw);
+    final idBytes = utf8.encode(id);
+    final feedIdBytes = utf8.encode(feedId);
+    final header = ByteData(_frameHeaderSize)
+      ..setUint8(0, kind)
+      ..setUint8(1, compressed ? _flagCompressed : 0)
+      ..setUint16(2, generation, Endian.little)
+      ..setUint32(4, stored.length, Endian.little)
+      ..setUint32(8, raw.length, Endian.little)
+      ..setInt64(12, publishedAtMs, Endian.little)
+      ..setUint16(20, idBytes.length, Endian.little)
+      ..setUint16(22, feedIdBytes.length, Endian.little);
+    final bytes = (BytesBuilder(copy: false)
+          ..add(header.buffer.asUint8List())
+          ..add(idBytes)
+          ..add(feedIdBytes)
+          ..add(stored))
+        .takeBytes();
+    return _EncodedFrame(bytes, stored, raw.length, compressed, generation, publishedAtMs,
+        _frameHeaderSize + idBytes.length + feedIdBytes.length);
+  }
+
+  static Uint8List _tombstone(String id, String feedId) {
+    final idBytes = utf8.encode(id);
+    final feedIdBytes = utf8.encode(feedId);
+    final header = ByteData(_frameHeaderSize)
+      ..setUint8(0, _kindTombstone)
+      ..setUint16(20, idBytes.length, Endian.little)
+      ..setUint16(22, feedIdBytes.length, Endian.little);
+    return (BytesBuilder(copy: false)
+          ..add(header.buffer.asUint8List())
+          ..add(idBytes)
+          ..add(feedIdBytes))
+        .takeBytes();
+  }
+
+  static Uint8List _deflate(List<int> raw, Uint8List? dictionary) {
+    return Uint8List.fromList(
+        ZLibEncoder(raw: true, level: 6, dictionary: dictionary).convert(raw));
+  }
+
+  static Uint8List _inflate(List<int> stored, Uint8List? dictionary) {
+    return Uint8List.fromList(ZLibDecoder(raw: true, dictionary: dictionary).convert(stored));
+  }
+
+  static String _encodePayload(NewsArticle article) {
+    return [
+      article.title,
+      article.description,
+      article.url,
+      article.imageUrl ?? '',
+      article.feedName,
+    ].join(_fieldSeparator);
+  }
+
+  static NewsArticle _decodePayload(String payload, String id, String feedId, int publishedAtMs) {
+    final fields = payload.split(_fieldSeparator);
+    if (fields.length != 5) throw const FormatException('Corrupt article record');
+    return NewsArticle(
+      id: id,
+      title: fields[0],
+      description: fields[1],
+      url: fields[2],
+      imageUrl: fields[3].isEmpty ? null : fields[3],
+      publishedAt: DateTime.fromMillisecondsSinceEpoch(publishedAtMs),
+      feedId: feedId,
+      feedName: fields[4],
+    );
+  }
+
+  static String _dictionaryName(int generation) => 'dict-$generation.bin';
+
+  static int? _dictionaryGeneration(String name) {
+    final match = RegExp(r'^dict-(\d+)\.bin$').firstMatch(name);
+    return match == null ? null : int.parse(match.group(1)!);
+  }
+}
+
+/// An encoded record frame and the slot it gets once written at an offset
+class _EncodedFrame {
+  final Uint8List bytes;
+  final Uint8List stored;
+  final int rawLength;
+  final bool compressed;
+  final int generation;
+  final int publishedAtMs;
+  final int headerLength;
+
+  const _EncodedFrame(this.bytes, this.stored, this.rawLength, this.compressed, this.generation,
+      this.publishedAtMs, this.headerLength);
+
+  _Slot slotAt(int frameOffset) => _Slot(frameOffset + headerLength, stored.length, rawLength,
+      compressed, generation, publishedAtMs, bytes.length);
+}
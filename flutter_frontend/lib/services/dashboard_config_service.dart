@@ -0,0 +1,181 @@
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+import '../models/rss_feed.dart';
+
+/// Refresh intervals from the local config; null leaves the app's default
+@immutable
+class RefreshPolicy {
+  final Duration? dashboard;
+  final Duration? weatherCurrent;
+  final Duration? weatherForecast;
+  final int? weatherMaxCallsPerHour;
+
+  const RefreshPolicy({
+    this.dashboard,
+    this.weatherCurrent,
+    this.weatherForecast,
+    this.weatherMaxCallsPerHour,
+  });
+
+  static Duration? _seconds(Object? value) =>
+      value == null ? null : Duration(seconds: value as int);
+
+  factory RefreshPolicy.fromMap(Map<String, dynamic> map) {
+    return RefreshPolicy(
+      dashboard: _seconds(map['dashboardSeconds']),
+      weatherCurrent: _seconds(map['weatherCurrentSeconds']),
+      weatherForecast: _seconds(map['weatherForecastSeconds']),
+      weatherMaxCallsPerHour: map['weatherMaxCallsPerHour'] as int?,
+    );
+  }
+}
+
+/// Dashboard layout, extra feeds and refresh policy from the runner's local
+/// config (linux/runner/config_watcher.h), applied while the app runs.
+///
+/// The runner watches the config directory, validates every edit and sends
+/// only the options that changed. Each section is its own listenable, so a
+/// refresh policy edit reschedules timers without rebuilding the layout,
+/// and a feed edit only reloads the news widget. Nothing restarts, so the
+/// engine, Firebase session and caches stay warm. On the web and on runners
+/// without the watcher every section keeps the app's default.
+class DashboardConfigService {
+  static DashboardConfigService? _instance;
+  static DashboardConfigService get instance => _instance ??= DashboardConfigService._();
+
+  DashboardConfigService._();
+
+  static const MethodChannel _channel = MethodChannel('modern_dashboard/config');
+
+  /// Feed ids from the config carry this prefix so they cannot collide with
+  /// the user's own feeds
+  static const String feedIdPrefix = 'config:';
+
+  static const List<String> _sections = ['layout', 'refresh', 'feeds'];
+
+  /// Widget ids in display order, or null for the built-in layout
+  final ValueNotifier<List<String>?> widgets = ValueNotifier(null);
+
+  final ValueNotifier<RefreshPolicy> refresh = ValueNotifier(const RefreshPolicy());
+
+  /// Feeds defined in the config, shown alongside the user's own
+  final ValueNotifier<List<RSSFeed>> feeds = ValueNotifier(const []);
+
+  final Map<String, Map<String, dynamic>> _config = {
+    for (final section in _sections) section: <String, dynamic>{},
+  };
+  bool _available = !kIsWeb;
+  Future<void>? _initializing;
+  int _generation = -1;
+  int _applied = 0;
+  Duration? _lastLatency;
+  String? _lastError;
+
+  Future<void> initialize() => _initializing ??= _initialize();
+
+  /// Why the config on disk is not in force, if it was rejected
+  String? get lastError => _lastError;
+
+  static bool isConfigFeed(String feedId) => feedId.startsWith(feedIdPrefix);
+
+  Map<String, dynamic> get stats => {
+        'generation': _generation,
+        'applied': _applied,
+        'lastLatencyMs': _lastLatency == null ? null : _lastLatency!.inMicroseconds / 1000,
+        'lastError': _lastError,
+      };
+
+  Future<void> _initialize() async {
+    if (!_available) return;
+    _channel.setMethodCallHandler(_handleCall);
+    await _fetch();
+  }
+
+  /// Replace everything with the runner's current config
+  Future<void> _fetch() async {
+    try {
+      final result = await _channel.invokeMapMethod<String, dynamic>('getConfig');
+      if (result == null) return;
+      final config = result['config'] as Map;
+      for (final section in _sections) {
+        _config[section] = Map<String, dynamic>.from(config[section] as Map? ?? const {});
+      }
+      _generation = result['generation'] as int;
+      _lastError = result['error'] as String?;
+      _apply(_sections);
+    } on MissingPluginException {
+      _available = false;
+      _channel.setMethodCallHandler(null);
+    } catch (e) {
+      debugPrint('DashboardConfigService: Failed to load config: $e');
+    }
+  }
+
+  Future<void> _handleCall(MethodCall call) async {
+    final args = Map<String, dynamic>.from(call.arguments as Map);
+    switch (call.method) {
+      case 'configChanged':
+        final generation = args['generation'] as int;
+        // Already part of the last getConfig answer
+        if (generation <= _generation) return;
+        // A change went missing (one sent before the handler was set)
+        if (generation != _generation + 1) {
+          await _fetch();
+          return;
+        }
+
+        final changes = Map<String, dynamic>.from(args['changes'] as Map);
+        for (final change in changes.entries) {
+          final section = _config[change.key];
+          if (section == null) continue;
+          (change.value as Map).forEach((key, value) {
+            if (value == null) {
+              section.remove(key);
+            } else {
+              section[key as String] = value;
+            }
+          });
+        }
+        _generation = generation;
+        _lastError = null;
+        _apply(changes.keys);
+        _lastLatency = Duration(microseconds: args['latencyUs'] as int);
+        debugPrint('DashboardConfigService: Applied config $generation '
+            '(${changes.keys.join(', ')}) ${_lastLatency!.inMicroseconds / 1000} ms '
+            'after the edit');
+      case 'configRejected':
+        _lastError = args['error'] as String?;
+        debugPrint('DashboardConfigService: Kept the current config, the edit is invalid: '
+            '$_lastError');
+    }
+  }
+
+  /// Publish the changed sections; listeners of the others are not notified
+  void _apply(Iterable<String> sections) {
+    _applied++;
+    for (final section in sections) {
+      final values = _config[section]!;
+      switch (section) {
+        case 'layout':
+          final ids = values['widgets'] as List?;
+          widgets.value = ids == null ? null : List<String>.unmodifiable(ids.cast<String>());
+        case 'refresh':
+          refresh.value = RefreshPolicy.fromMap(values);
+        case 'feeds':
+          final now = DateTime.now();
+          feeds.value = List.unmodifiable([
+            for (final entry in values.entries)
+              RSSFeed(
+                id: '$feedIdPrefix${entry.key}',
+                name: entry.value['name'] as String,
+                url: entry.value['url'] as String,
+                category: entry.value['category'] as String,
+                isActive: entry.value['active'] as bool,
+                createdAt: now,
+                updatedAt: now,
+              ),
+          ]);
+      }
+    }
+  }
+}
@@ -0,0 +1,306 @@
+import 'dart:async';
+import 'dart:convert';
+import 'dart:math';
+import 'package:flutter/foundation.dart';
+import 'package:shared_preferences/shared_preferences.dart';
+import '../core/services/idle_scheduler.dart';
+
+/// How often a feed is refreshed, from its score and failures
+enum FeedHealthState {
+  healthy('Healthy'),
+  demoted('Demoted'),
+  quarantined('Quarantined');
+
+  final String label;
+
+  const FeedHealthState(this.label);
+}
+
+/// Fetch history and score of one feed
+class FeedHealth {
+  /// Latency samples kept for the percentiles
+  static const int _latencyWindow = 20;
+  static const double _alpha = 0.2;
+
+  int attempts;
+  int failures;
+  int consecutiveFailures;
+  double successRate;
+  double payloadBytes;
+  double parseMs;
+
+  /// New articles per successful fetch
+  double freshnessYield;
+  final List<int> latenciesMs;
+  String? lastError;
+  DateTime? lastAttemptAt;
+  DateTime? lastSuccessAt;
+  DateTime? quarantinedUntil;
+
+  FeedHealth({
+    this.attempts = 0,
+    this.failures = 0,
+    this.consecutiveFailures = 0,
+    this.successRate = 1.0,
+    this.payloadBytes = 0,
+    this.parseMs = 0,
+    this.freshnessYield = 1.0,
+    List<int>? latenciesMs,
+    this.lastError,
+    this.lastAttemptAt,
+    this.lastSuccessAt,
+    this.quarantinedUntil,
+  }) : latenciesMs = latenciesMs ?? [];
+
+  factory FeedHealth.fromJson(Map<String, dynamic> json) {
+    DateTime? time(String key) =>
+        json[key] is int ? DateTime.fromMillisecondsSinceEpoch(json[key] as int) : null;
+    double number(String key, double fallback) => (json[key] as num?)?.toDouble() ?? fallback;
+    return FeedHealth(
+      attempts: json['attempts'] as int? ?? 0,
+      failures: json['failures'] as int? ?? 0,
+      consecutiveFailures: json['consecutive_failures'] as int? ?? 0,
+      successRate: number('success_rate', 1.0),
+      payloadBytes: number('payload_bytes', 0),
+      parseMs: number('parse_ms', 0),
+      freshnessYield: number('yield', 1.0),
+      latenciesMs: (json['latencies'] as List?)?.whereType<int>().toList(),
+      lastError: json['last_error'] as String?,
+      lastAttemptAt: time('last_attempt'),
+      lastSuccessAt: time('last_success'),
+      quarantinedUntil: time('quarantined_until'),
+    );
+  }
+
+  Map<String, dynamic> toJson() => {
+        'attempts': attempts,
+        'failures': failures,
+        'consecutive_failures': consecutiveFailures,
+        'success_rate': successRate,
+        'payload_bytes': payloadBytes,
+        'parse_ms': parseMs,
+        'yield': freshnessYield,
+        'latencies': latenciesMs,
+        'last_error': lastError,
+        'last_attempt': lastAttemptAt?.millisecondsSinceEpoch,
+        'last_success': lastSuccessAt?.millisecondsSinceEpoch,
+        'quarantined_until': quarantinedUntil?.millisecondsSinceEpoch,
+      };
+
+  int? get p50LatencyMs => _percentile(0.5);
+  int? get p95LatencyMs => _percentile(0.95);
+
+  int? _percentile(double p) {
+    if (latenciesMs.isEmpty) return null;
+    final sorted = List<int>.from(latenciesMs)..sort();
+    return sorted[((sorted.length - 1) * p).round()];
+  }
+
+  /// 0-100; reliability weighs most, then tail latency, then how often a
+  /// fetch brings something new, then payload and parse cost
+  double get score {
+    final p95 = p95LatencyMs ?? 0;
+    final speed = 1 - ((p95 - 1000) / 9000).clamp(0.0, 1.0);
+    final yieldScore = 1 - exp(-freshnessYield);
+    final cost = 1 - ((payloadBytes / (1024 * 1024) + parseMs / 500) / 2).clamp(0.0, 1.0);
+    return 100 * (0.45 * successRate + 0.25 * speed + 0.15 * yieldScore + 0.15 * cost);
+  }
+
+  bool isQuarantined(DateTime now) => quarantinedUntil?.isAfter(now) ?? false;
+
+  FeedHealthState state(DateTime now) {
+    if (isQuarantined(now)) return FeedHealthState.quarantined;
+    return score >= FeedHealthService.demoteBelow ? FeedHealthState.healthy : FeedHealthState.demoted;
+  }
+
+  void _addLatency(Duration latency) {
+    latenciesMs.add(latency.inMilliseconds);
+    if (latenciesMs.length > _latencyWindow) latenciesMs.removeAt(0);
+  }
+
+  void _recordSuccess(DateTime now, Duration latency, int bytes, Duration parseTime, int? newArticles) {
+    attempts++;
+    consecutiveFailures = 0;
+    quarantinedUntil = null;
+    lastError = null;
+    lastAttemptAt = now;
+    lastSuccessAt = now;
+    successRate += _alpha * (1 - successRate);
+    payloadBytes += _alpha * (bytes - payloadBytes);
+    parseMs += _alpha * (parseTime.inMicroseconds / 1000 - parseMs);
+    if (newArticles != null) freshnessYield += _alpha * (newArticles - freshnessYield);
+    _addLatency(latency);
+  }
+
+  void _recordFailure(DateTime now, Duration latency, String code) {
+    attempts++;
+    failures++;
+    consecutiveFailures++;
+    lastError = code;
+    lastAttemptAt = now;
+    successRate -= _alpha * successRate;
+    _addLatency(latency);
+  }
+}
+
+/// Per-feed health for the news refresh, so a few slow or broken feeds do
+/// not set the cost of every refresh.
+///
+/// [RSSService.fetchFeed] reports each network fetch: latency, payload size,
+/// parse time and how many articles were new. Each feed gets a [FeedHealth]
+/// score from those. Feeds scoring below [demoteBelow] are demoted: they
+/// are fetched at most every [demotedInterval], or [poorInterval] below
+/// [poorBelow]. After [quarantineAfter] failures in a row a feed is
+/// quarantined, starting at [quarantineBase] and doubling up to
+/// [quarantineMax]; when it ends, one probe fetch decides whether it comes
+/// back. Feeds that are not due contribute their last articles instead.
+/// Tail latency also shortens the timeout of feeds known to answer quickly.
+class FeedHealthService {
+  static FeedHealthService? _instance;
+  static FeedHealthService get instance => _instance ??= FeedHealthService._();
+
+  FeedHealthService._();
+
+  static const String _prefsKey = 'feed_health_v1';
+
+  static const double demoteBelow = 70;
+  static const double poorBelow = 45;
+  static const Duration demotedInterval = Duration(minutes: 15);
+  static const Duration poorInterval = Duration(hours: 1);
+  static const int quarantineAfter = 3;
+  static const Duration quarantineBase = Duration(minutes: 15);
+  static const Duration quarantineMax = Duration(hours: 12);
+
+  /// Samples needed before the timeout adapts to a feed's latency
+  static const int _minTimeoutSamples = 5;
+  static const Duration _minTimeout = Duration(seconds: 4);
+
+  final Map<String, FeedHealth> _feeds = {};
+  Future<void>? _loaded;
+  int _skipped = 0;
+
+  /// Load the saved history; fetches recorded before this completes are kept
+  Future<void> initialize() {
+    return _loaded ??= () async {
+      try {
+        final prefs = await SharedPreferences.getInstance();
+        final stored = prefs.getString(_prefsKey);
+        if (stored == null) return;
+        final data = json.decode(stored) as Map<String, dynamic>;
+        data.forEach((feedId, value) {
+          _feeds.putIfAbsent(feedId, () => FeedHealth.fromJson(value as Map<String, dynamic>));
+        });
+      } catch (e) {
+        debugPrint('FeedHealthService: Discarding unreadable feed health: $e');
+      }
+    }();
+  }
+
+  FeedHealth? healthOf(String feedId) => _feeds[feedId];
+
+  /// Whether [feedId] should be fetched in this refresh
+  bool isDue(String feedId) {
+    final health = _feeds[feedId];
+    final last = health?.lastAttemptAt;
+    if (health == null || last == null) return true;
+    final now = DateTime.now();
+    if (health.isQuarantined(now)) return false;
+    if (health.quarantinedUntil != null) return true; // Probe after quarantine
+    final score = health.score;
+    final interval = score >= demoteBelow
+        ? Duration.zero
+        : score >= poorBelow
+            ? demotedInterval
+            : poorInterval;
+    return !now.isBefore(last.add(interval));
+  }
+
+  bool isQuarantined(String feedId) => _feeds[feedId]?.isQuarantined(DateTime.now()) ?? false;
+
+  /// Count a feed left out of a refresh, for the refresh log
+  void noteSkipped() => _skipped++;
+
+  /// Three times the feed's p95 latency, within [_minTimeout] and [fallback]
+  Duration timeoutFor(String feedId, Duration fallback) {
+    final health = _feeds[feedId];
+    final p95 = health?.p95LatencyMs;
+    if (health == null || p95 == null || health.latenciesMs.length < _minTimeoutSamples) {
+      return fallback;
+    }
+    final adaptive = Duration(milliseconds: p95 * 3);
+    if (adaptive < _minTimeout) return _minTimeout;
+    return adaptive > fallback ? fallback : adaptive;
+  }
+
+  /// Record a fetch that returned articles; [newArticles] is null when
+  /// there was nothing to compare with
+  void recordSuccess(
+    String feedId, {
+    required Duration latency,
+    required int bytes,
+    required Duration parseTime,
+    int? newArticles,
+  }) {
+    _feeds
+        .putIfAbsent(feedId, () => FeedHealth())
+        ._recordSuccess(DateTime.now(), latency, bytes, parseTime, newArticles);
+    _scheduleSave();
+  }
+
+  /// Record a failed fetch with its [FeedValidationException] code
+  void recordFailure(String feedId, Duration latency, String code) {
+    final now = DateTime.now();
+    final health = _feeds.putIfAbsent(feedId, () => FeedHealth())
+      .._recordFailure(now, latency, code);
+    if (health.consecutiveFailures >= quarantineAfter) {
+      final doublings = min(health.consecutiveFailures - quarantineAfter, 10);
+      final length = quarantineBase * pow(2, doublings).toInt();
+      health.quarantinedUntil = now.add(length > quarantineMax ? quarantineMax : length);
+      debugPrint('FeedHealthService: Quarantined $feedId for '
+          '${health.quarantinedUntil!.difference(now).inMinutes} min '
+          'after ${health.consecutiveFailures} failures ($code)');
+    }
+    _scheduleSave();
+  }
+
+  /// Make [feedId] due on the next refresh, keeping its history
+  void retryNow(String feedId) {
+    final health = _feeds[feedId];
+    if (health == null) return;
+    health
+      ..quarantinedUntil = null
+      ..consecutiveFailures = 0
+      ..lastAttemptAt = null;
+    _scheduleSave();
+  }
+
+  /// Drop the history of a deleted or re-pointed feed
+  void forget(String feedId) {
+    if (_feeds.remove(feedId) != null) _scheduleSave();
+  }
+
+  Map<String, dynamic> get stats {
+    final now = DateTime.now();
+    final states = _feeds.values.map((h) => h.state(now)).toList();
+    return {
+      'feeds': _feeds.length,
+      'demoted': states.where((s) => s == FeedHealthState.demoted).length,
+      'quarantined': states.where((s) => s == FeedHealthState.quarantined).length,
+      'skippedFetches': _skipped,
+    };
+  }
+
+  void _scheduleSave() {
+    unawaited(IdleScheduler.instance.schedule('FeedHealthService.save', (_) async {
+      try {
+        // Encoded in the idle slice, before the first await
+        final encoded = json.encode(_feeds.map((feedId, health) => MapEntry(feedId, health.toJson())));
+        final prefs = await SharedPreferences.getInstance();
+        await prefs.setString(_prefsKey, encoded);
+      } catch (e) {
+        debugPrint('FeedHealthService: Failed to save feed health: $e');
+      }
+      return true;
+    }, delay: const Duration(seconds: 10)));
+  }
+}
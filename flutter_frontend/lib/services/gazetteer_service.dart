@@ -0,0 +1,194 @@
+import 'dart:async';
+import 'dart:convert';
+import 'dart:io';
+import 'dart:typed_data';
+import 'package:flutter/foundation.dart';
+import '../core/services/idle_scheduler.dart';
+import '../core/services/isolate_pool_service.dart';
+import '../core/utils/gazetteer_index.dart';
+import '../models/weather.dart';
+
+/// Offline place-name search backing the weather location dialog.
+///
+/// On desktop the index is read from `MODERN_DASHBOARD_GAZETTEER` or
+/// `$XDG_DATA_HOME/modern_dashboard/gazetteer.bin`. A GeoNames dump (`.txt`)
+/// at either location is indexed on the isolate pool at first use. Without a
+/// data file, and on web, a small built-in list of major cities is indexed so
+/// common searches still work offline.
+class GazetteerService {
+  static GazetteerService? _instance;
+  static GazetteerService get instance => _instance ??= GazetteerService._();
+
+  GazetteerService._();
+
+  static const String _environmentPath = 'MODERN_DASHBOARD_GAZETTEER';
+
+  GazetteerIndex? _index;
+  Future<void>? _loading;
+
+  /// Whether an index is loaded and [searchLocal] can answer
+  bool get isLoaded => _index != null;
+
+  /// Load the index; safe to call repeatedly
+  Future<void> initialize() => _loading ??= _load();
+
+  /// Load the index once the UI is idle, ahead of the first search
+  void warmUp() {
+    if (_loading != null) return;
+    unawaited(IdleScheduler.instance.schedule('GazetteerService.warmUp', (_) async {
+      await initialize();
+      return true;
+    }, delay: const Duration(seconds: 5), maxDelay: const Duration(minutes: 10)));
+  }
+
+  Future<void> _load() async {
+    final stopwatch = Stopwatch()..start();
+    try {
+      _index = await _loadFromDisk();
+    } catch (e) {
+      debugPrint('GazetteerService: Failed to load gazetteer, using built-in cities: $e');
+    }
+    _index ??= GazetteerIndex(_buildSeedIndex());
+    debugPrint('GazetteerService: Indexed ${_index!.placeCount} places '
+        '(${_index!.keyCount} names, ${_index!.sizeInBytes >> 10} KiB) '
+        'in ${stopwatch.elapsedMilliseconds} ms');
+  }
+
+  Future<GazetteerIndex?> _loadFromDisk() async {
+    if (kIsWeb) return null;
+
+    final path = _dataPath();
+    if (path == null) return null;
+    final file = File(path);
+    if (!await file.exists()) return null;
+
+    final bytes = await file.readAsBytes();
+    if (path.endsWith('.txt')) {
+      return GazetteerIndex(await IsolatePoolService.instance.runBytes(
+        _buildGeoNamesIndex,
+        bytes,
+        priority: TaskPriority.low,
+      ));
+    }
+    return GazetteerIndex(bytes);
+  }
+
+  String? _dataPath() {
+    final configured = Platform.environment[_environmentPath];
+    if (configured != null && configured.isNotEmpty) return configured;
+
+    final dataHome = Platform.environment['XDG_DATA_HOME'] ??
+        (Platform.environment['HOME'] != null
+            ? '${Platform.environment['HOME']}/.local/share'
+            : null);
+    return dataHome != null ? '$dataHome/modern_dashboard/gazetteer.bin' : null;
+  }
+
+  /// Ranked suggestions from the local index only; empty until loaded
+  List<WeatherLocation> searchLocal(String query, {int limit = 5}) {
+    final index = _index;
+    if (index == null) return const [];
+    final now = DateTime.now();
+    return index.search(query, limit: limit).map((place) => _location(place, now)).toList();
+  }
+
+  /// Ranked suggestions, loading the index first if needed
+  Future<List<WeatherLocation>> search(String query, {int limit = 5}) async {
+    await initialize();
+    return searchLocal(query, limit: limit);
+  }
+
+  /// Like [search], split into places whose name (or an alternate name)
+  /// starts with the query and typo-tolerant guesses. A guess may be the
+  /// wrong place entirely ("Bern" finds Berlin when only Berlin is
+  /// indexed), so callers with another source should not stop at guesses.
+  Future<({List<WeatherLocation> matches, List<WeatherLocation> guesses})> searchSplit(
+    String query, {
+    int limit = 5,
+  }) async {
+    await initialize();
+    final matches = <WeatherLocation>[];
+    final guesses = <WeatherLocation>[];
+    final now = DateTime.now();
+    for (final place in _index!.search(query, limit: limit)) {
+      (place.distance == 0 ? matches : guesses).add(_location(place, now));
+    }
+    return (matches: matches, guesses: guesses);
+  }
+
+  static WeatherLocation _location(GazetteerPlace place, DateTime now) {
+    return WeatherLocation(
+      id: '${place.latitude}_${place.longitude}',
+      name: place.name,
+      country: place.country,
+      state: place.admin,
+      latitude: place.latitude,
+      longitude: place.longitude,
+      createdAt: now,
+    );
+  }
+
+  static Uint8List _buildSeedIndex() {
+    final builder = GazetteerBuilder();
+    for (final city in _seedCities) {
+      builder.add(
+        name: city.$1,
+        country: city.$2,
+        admin: city.$3,
+        latitude: city.$4,
+        longitude: city.$5,
+        population: city.$6,
+      );
+    }
+    return builder.build();
+  }
+
+  /// Major cities indexed when no GeoNames data is installed
+  static const List<(String, String, String, double, double, int)> _seedCities = [
+    ('Tokyo', 'JP', '', 35.6762, 139.6503, 37400000),
+    ('Delhi', 'IN', 'DL', 28.7041, 77.1025, 31000000),
+    ('Shanghai', 'CN', '', 31.2304, 121.4737, 27000000),
+    ('São Paulo', 'BR', 'SP', -23.5505, -46.6333, 22000000),
+    ('Mexico City', 'MX', '', 19.4326, -99.1332, 21800000),
+    ('Cairo', 'EG', '', 30.0444, 31.2357, 21300000),
+    ('Mumbai', 'IN', 'MH', 19.0760, 72.8777, 20400000),
+    ('Beijing', 'CN', '', 39.9042, 116.4074, 20400000),
+    ('Osaka', 'JP', '', 34.6937, 135.5023, 19100000),
+    ('New York', 'US', 'NY', 40.7128, -74.0060, 18800000),
+    ('Buenos Aires', 'AR', '', -34.6037, -58.3816, 15200000),
+    ('Istanbul', 'TR', '', 41.0082, 28.9784, 15100000),
+    ('Lagos', 'NG', '', 6.5244, 3.3792, 14900000),
+    ('Manila', 'PH', '', 14.5995, 120.9842, 14100000),
+    ('Rio de Janeiro', 'BR', 'RJ', -22.9068, -43.1729, 13500000),
+    ('Los Angeles', 'US', 'CA', 34.0522, -118.2437, 12400000),
+    ('Moscow', 'RU', '', 55.7558, 37.6173, 12500000),
+    ('Paris', 'FR', '', 48.8566, 2.3522, 11100000),
+    ('Bangkok', 'TH', '', 13.7563, 100.5018, 10700000),
+    ('Jakarta', 'ID', '', -6.2088, 106.8456, 10600000),
+    ('London', 'GB', '', 51.5074, -0.1278, 9500000),
+    ('Lima', 'PE', '', -12.0464, -77.0428, 10700000),
+    ('Seoul', 'KR', '', 37.5665, 126.9780, 9900000),
+    ('Chicago', 'US', 'IL', 41.8781, -87.6298, 8900000),
+    ('Hong Kong', 'HK', '', 22.3193, 114.1694, 7500000),
+    ('Madrid', 'ES', '', 40.4168, -3.7038, 6600000),
+    ('Toronto', 'CA', 'ON', 43.6532, -79.3832, 6200000),
+    ('Singapore', 'SG', '', 1.3521, 103.8198, 5700000),
+    ('Sydney', 'AU', 'NSW', -33.8688, 151.2093, 5300000),
+    ('Melbourne', 'AU', 'VIC', -37.8136, 144.9631, 5100000),
+    ('Berlin', 'DE', '', 52.5200, 13.4050, 3600000),
+    ('Rome', 'IT', '', 41.9028, 12.4964, 4300000),
+    ('Dubai', 'AE', '', 25.2048, 55.2708, 3400000),
+    ('Johannesburg', 'ZA', '', -26.2041, 28.0473, 5800000),
+    ('San Francisco', 'US', 'CA', 37.7749, -122.4194, 3300000),
+    ('Amsterdam', 'NL', '', 52.3676, 4.9041, 1200000),
+    ('Vienna', 'AT', '', 48.2082, 16.3738, 1900000),
+    ('Stockholm', 'SE', '', 59.3293, 18.0686, 1600000),
+    ('Zürich', 'CH', '', 47.3769, 8.5417, 1400000),
+    ('Vancouver', 'CA', 'BC', 49.2827, -123.1207, 2600000),
+  ];
+}
+
+/// Pool task: index a GeoNames dump
+Uint8List _buildGeoNamesIndex(Uint8List tsv) {
+  return (GazetteerBuilder()..addGeoNames(utf8.decode(tsv, allowMalformed: true))).build();
+}
@@ -0,0 +1,449 @@
+import 'dart:async';
+import 'dart:convert';
+import 'dart:io';
+import 'dart:math';
+import 'dart:typed_data';
+
+class ImapException implements Exception {
+  final String message;
+
+  const ImapException(this.message);
+
+  @override
+  String toString() => 'ImapException: $message';
+}
+
+/// One server response. [tag] is '*' for untagged data, '+' for a
+/// continuation request, or the tag of the command it completes. [data]
+/// holds the tokens after the tag: atoms and strings as [String], NIL as
+/// null, parenthesized and bracketed lists as [List]. Status responses
+/// (OK, NO, BAD, BYE, PREAUTH) are the status, the response code list if
+/// there is one, and the remaining text as a single string.
+class ImapResponse {
+  final String tag;
+  final List<Object?> data;
+
+  const ImapResponse(this.tag, this.data);
+
+  /// 'OK', 'NO', ... for status responses, else the first token
+  String get status => data.isNotEmpty && data.first is String ? (data.first as String).toUpperCase() : '';
+
+  /// Response code, e.g. `[UIDVALIDITY, 3857529045]`
+  List<Object?>? get code => data.length > 1 && data[1] is List ? data[1] as List<Object?> : null;
+
+  String get text => data.isNotEmpty && data.last is String ? data.last as String : '';
+
+  @override
+  String toString() => '$tag $data';
+}
+
+/// Completion of a command and the untagged data received while it ran
+class ImapResult {
+  final ImapResponse completion;
+  final List<ImapResponse> untagged;
+
+  const ImapResult(this.completion, this.untagged);
+}
+
+class _PendingCommand {
+  final String name;
+  final Completer<ImapResult> completer = Completer();
+  final List<ImapResponse> untagged = [];
+
+  _PendingCommand(this.name);
+}
+
+/// Minimal IMAP4rev1 client connection: tagged commands, literal-aware
+/// response framing and IDLE. Untagged responses are handed to
+/// [onUntagged] as they arrive, whether they answer a command or are pushed
+/// by the server during IDLE, so the caller can keep its mailbox state in
+/// one place.
+class ImapClient {
+  final Socket _socket;
+  final void Function(ImapResponse response) onUntagged;
+
+  Uint8List _buffer = Uint8List(16 * 1024);
+  int _start = 0;
+  int _end = 0;
+
+  int _nextTag = 1;
+  final Map<String, _PendingCommand> _pending = {};
+  final Completer<ImapResponse> _greeting = Completer();
+  final Completer<void> _closed = Completer();
+  Completer<void>? _continuation;
+  Future<ImapResult>? _idle;
+
+  /// Upper-cased capabilities from the greeting, CAPABILITY responses and
+  /// response codes
+  final Set<String> capabilities = {};
+
+  ImapClient._(this._socket, this.onUntagged) {
+    _socket.listen(_onData, onError: _onError, onDone: _onDone, cancelOnError: true);
+  }
+
+  /// Open a connection and wait for the server greeting
+  static Future<ImapClient> connect(
+    String host,
+    int port, {
+    bool secure = true,
+    required void Function(ImapResponse response) onUntagged,
+    Duration timeout = const Duration(seconds: 15),
+  }) async {
+    final socket = secure
+        ? await SecureSocket.connect(host, port, timeout: timeout)
+        : await Socket.connect(host, port, timeout: timeout);
+    socket.setOption(SocketOption.tcpNoDelay, true);
+    final client = ImapClient._(socket, onUntagged);
+    final greeting = await client._greeting.future.timeout(timeout);
+    if (greeting.status == 'BYE') {
+      client.destroy();
+      throw ImapException('Server refused connection: ${greeting.text}');
+    }
+    return client;
+  }
+
+  bool has(String capability) => capabilities.contains(capability);
+
+  /// Whether credentials sent on this connection stay private: it is
+  /// encrypted, or it never leaves this machine
+  bool get isPrivate => _socket is SecureSocket || allowsPlaintextLogin(_socket.remoteAddress);
+
+  /// Plaintext LOGIN is only allowed to a server on this machine
+  static bool allowsPlaintextLogin(InternetAddress address) => address.isLoopback;
+
+  /// Authenticate with LOGIN. Refused without sending anything unless the
+  /// connection [isPrivate].
+  Future<ImapResult> login(String user, String password) {
+    if (!isPrivate) {
+      return Future.error(ImapException(
+          'Refusing to send the password without TLS to ${_socket.remoteAddress.address}'));
+    }
+    return command('LOGIN ${quote(user)} ${quote(password)}');
+  }
+
+  bool get isClosed => _closed.isCompleted;
+
+  /// Completes when the connection is closed from either side
+  Future<void> get done => _closed.future;
+
+  /// Send [command] and wait for its completion. Completes with an
+  /// [ImapException] on NO or BAD.
+  Future<ImapResult> command(String command) {
+    if (isClosed) return Future.error(const ImapException('Connection closed'));
+    final tag = 'A${_nextTag++}';
+    final space = command.indexOf(' ');
+    final pending = _PendingCommand(space < 0 ? command : command.substring(0, space));
+    _pending[tag] = pending;
+    _socket.write('$tag $command\r\n');
+    return pending.completer.future;
+  }
+
+  /// Enter IDLE; completes once the server has accepted it. Pushed updates
+  /// reach [onUntagged] until [endIdle].
+  Future<void> startIdle() async {
+    final continuation = Completer<void>();
+    _continuation = continuation;
+    final idle = command('IDLE');
+    // Awaited by endIdle; a rejected IDLE is reported through the
+    // continuation instead
+    idle.ignore();
+    _idle = idle;
+    await continuation.future;
+  }
+
+  Future<void> endIdle() async {
+    final idle = _idle;
+    if (idle == null) return;
+    _idle = null;
+    if (isClosed) throw const ImapException('Connection closed during IDLE');
+    _socket.write('DONE\r\n');
+    await idle;
+  }
+
+  Future<void> logout() async {
+    try {
+      await command('LOGOUT').timeout(const Duration(seconds: 5));
+    } catch (_) {
+      // Closing anyway
+    }
+    destroy();
+  }
+
+  void destroy() {
+    _socket.destroy();
+    _onDone();
+  }
+
+  /// [value] as an IMAP quoted string
+  static String quote(String value) =>
+      '"${value.replaceAll('\\', '\\\\').replaceAll('"', '\\"')}"';
+
+  void _onData(Uint8List chunk) {
+    _append(chunk);
+    while (true) {
+      final end = _responseEnd(_start);
+      if (end < 0) break;
+      final response = _ResponseReader(_buffer, _start, end).response();
+      _start = end;
+      _dispatch(response);
+    }
+    if (_start == _end) {
+      _start = 0;
+      _end = 0;
+    }
+  }
+
+  void _append(Uint8List chunk) {
+    if (_end + chunk.length > _buffer.length) {
+      final live = _end - _start;
+      if (live + chunk.length > _buffer.length) {
+        final grown = Uint8List(max(_buffer.length * 2, live + chunk.length));
+        grown.setRange(0, live, _buffer, _start);
+        _buffer = grown;
+      } else {
+        _buffer.setRange(0, live, _buffer, _start);
+      }
+      _start = 0;
+      _end = live;
+    }
+    _buffer.setRange(_end, _end + chunk.length, chunk);
+    _end += chunk.length;
+  }
+
+  /// End of the complete response starting at [start], or -1 when more
+  /// bytes are needed. A line ending in `{n}` is followed by an n-byte
+  /// literal and then the rest of the response.
+  int _responseEnd(int start) {
+    var i = start;
+    while (true) {
+      var lf = i;
+      while (lf < _end && _buffer[lf] != 10) {
+        lf++;
+      }
+      if (lf >= _end) return -1;
+
+      var j = lf - 1;
+      if (j >= i && _buffer[j] == 13) j--;
+      if (j < i || _buffer[j] != 125) return lf + 1; // '}'
+      j--;
+      if (j >= i && _buffer[j] == 43) j--; // non-synchronizing '+'
+      var length = 0;
+      var scale = 1;
+      var digits = 0;
+      while (j >= i && _buffer[j] >= 48 && _buffer[j] <= 57) {
+        length += (_buffer[j] - 48) * scale;
+        scale *= 10;
+        digits++;
+        j--;
+      }
+      if (digits == 0 || j < i || _buffer[j] != 123) return lf + 1; // '{'
+      i = lf + 1 + length;
+      if (i > _end) return -1;
+    }
+  }
+
+  void _dispatch(ImapResponse response) {
+    switch (response.tag) {
+      case '+':
+        _continuation?.complete();
+        _continuation = null;
+      case '*':
+        if (!_greeting.isCompleted) {
+          _readCapabilities(response);
+          _greeting.complete(response);
+          return;
+        }
+        _readCapabilities(response);
+        for (final pending in _pending.values) {
+          pending.untagged.add(response);
+        }
+        onUntagged(response);
+      default:
+        _readCapabilities(response);
+        final pending = _pending.remove(response.tag);
+        if (pending == null) return;
+        final status = response.status;
+        if (pending.name == 'IDLE' && _continuation != null) {
+          _continuation!.completeError(ImapException('IDLE rejected: ${response.text}'));
+          _continuation = null;
+        }
+        if (status == 'OK') {
+          pending.completer.complete(ImapResult(response, pending.untagged));
+        } else {
+          pending.completer.completeError(ImapException('${pending.name} $status: ${response.text}'));
+        }
+    }
+  }
+
+  void _readCapabilities(ImapResponse response) {
+    List<Object?>? list;
+    if (response.status == 'CAPABILITY') {
+      list = response.data.skip(1).toList();
+    } else {
+      final code = response.code;
+      if (code != null && code.isNotEmpty && '${code.first}'.toUpperCase() == 'CAPABILITY') {
+        list = code.skip(1).toList();
+      }
+    }
+    if (list == null) return;
+    capabilities
+      ..clear()
+      ..addAll(list.whereType<String>().map((c) => c.toUpperCase()));
+  }
+
+  void _onError(Object error) {
+    _fail(ImapException('Connection error: $error'));
+  }
+
+  void _onDone() {
+    _fail(const ImapException('Connection closed'));
+  }
+
+  void _fail(ImapException error) {
+    if (_closed.isCompleted) return;
+    _closed.complete();
+    if (!_greeting.isCompleted) _greeting.completeError(error);
+    _continuation?.completeError(error);
+    _continuation = null;
+    for (final pending in _pending.values) {
+      pending.completer.completeError(error);
+    }
+    _pending.clear();
+  }
+}
+
+/// Tokenizes one complete response held in [_bytes] from [_i] to [_end]
+class _ResponseReader {
+  static const Set<String> _statusWords = {'OK', 'NO', 'BAD', 'BYE', 'PREAUTH'};
+
+  final Uint8List _bytes;
+  int _i;
+  final int _end;
+
+  _ResponseReader(this._bytes, this._i, this._end);
+
+  ImapResponse response() {
+    final tag = _atom();
+    _skipSpaces();
+    if (tag == '+') return ImapResponse(tag, [_rest()]);
+
+    final data = <Object?>[];
+    while (!_atLineEnd) {
+      final token = _token();
+      data.add(token);
+      _skipSpaces();
+      // Status text is free-form and is not tokenized
+      if (data.length == 1 && token is String && _statusWords.contains(token.toUpperCase())) {
+        if (_i < _end && _bytes[_i] == 91) {
+          data.add(_list(93));
+          _skipSpaces();
+        }
+        data.add(_rest());
+        break;
+      }
+    }
+    return ImapResponse(tag, data);
+  }
+
+  bool get _atLineEnd => _i >= _end || _bytes[_i] == 13 || _bytes[_i] == 10;
+
+  void _skipSpaces() {
+    while (_i < _end && _bytes[_i] == 32) {
+      _i++;
+    }
+  }
+
+  String _rest() {
+    final start = _i;
+    while (!_atLineEnd) {
+      _i++;
+    }
+    return _text(start, _i);
+  }
+
+  Object? _token() {
+    switch (_bytes[_i]) {
+      case 40: // (
+        return _list(41);
+      case 91: // [
+        return _list(93);
+      case 34: // "
+        return _quoted();
+      case 123: // {
+        return _literal();
+    }
+    final atom = _atom();
+    return atom == 'NIL' ? null : atom;
+  }
+
+  List<Object?> _list(int close) {
+    _i++;
+    final items = <Object?>[];
+    while (true) {
+      _skipSpaces();
+      if (_atLineEnd) return items;
+      if (_bytes[_i] == close) {
+        _i++;
+        return items;
+      }
+      items.add(_token());
+    }
+  }
+
+  /// An atom; a `[...]` section inside it, as in `BODY[HEADER.FIELDS (FROM)]`,
+  /// is kept whole
+  String _atom() {
+    final start = _i;
+    while (_i < _end) {
+      final c = _bytes[_i];
+      if (c == 91) {
+        var depth = 0;
+        while (_i < _end && _bytes[_i] != 13 && _bytes[_i] != 10) {
+          final d = _bytes[_i++];
+          if (d == 91) depth++;
+          if (d == 93 && --depth == 0) break;
+        }
+        continue;
+      }
+      if (c == 32 || c == 40 || c == 41 || c == 93 || c == 13 || c == 10) break;
+      _i++;
+    }
+    // Stray delimiter: consume it so the caller always makes progress
+    if (_i == start) _i++;
+    return _text(start, _i);
+  }
+
+  String _quoted() {
+    _i++;
+    final out = <int>[];
+    while (_i < _end) {
+      final c = _bytes[_i++];
+      if (c == 34) break;
+      if (c == 92 && _i < _end) {
+        out.add(_bytes[_i++]);
+      } else {
+        out.add(c);
+      }
+    }
+    return utf8.decode(out, allowMalformed: true);
+  }
+
+  String _literal() {
+    _i++;
+    var length = 0;
+    while (_i < _end && _bytes[_i] >= 48 && _bytes[_i] <= 57) {
+      length = length * 10 + _bytes[_i] - 48;
+      _i++;
+    }
+    while (_i < _end && _bytes[_i] != 10) {
+      _i++;
+    }
+    _i++;
+    final start = min(_i, _end);
+    _i = min(start + length, _end);
+    return _text(start, _i);
+  }
+
+  String _text(int start, int end) =>
+      utf8.decode(Uint8List.sublistView(_bytes, start, end), allowMalformed: true);
+}
@@ -0,0 +1,735 @@
+import 'dart:async';
+import 'dart:collection';
+import 'dart:convert';
+import 'dart:io';
+import 'dart:math';
+import 'package:flutter/foundation.dart';
+import 'package:shared_preferences/shared_preferences.dart';
+import 'imap_client.dart';
+
+/// Headers and snippet of one indexed message
+class MailSummary {
+  final int uid;
+  final String from;
+  final String subject;
+  final String snippet;
+  final DateTime receivedAt;
+  bool seen;
+
+  MailSummary({
+    required this.uid,
+    required this.from,
+    required this.subject,
+    required this.snippet,
+    required this.receivedAt,
+    this.seen = false,
+  });
+
+  factory MailSummary.fromJson(Map<String, dynamic> json) {
+    return MailSummary(
+      uid: json['uid'] as int,
+      from: json['from'] as String? ?? '',
+      subject: json['subject'] as String? ?? '',
+      snippet: json['snippet'] as String? ?? '',
+      receivedAt: DateTime.fromMillisecondsSinceEpoch(json['received'] as int? ?? 0),
+      seen: json['seen'] as bool? ?? false,
+    );
+  }
+
+  Map<String, dynamic> toJson() => {
+        'uid': uid,
+        'from': from,
+        'subject': subject,
+        'snippet': snippet,
+        'received': receivedAt.millisecondsSinceEpoch,
+        'seen': seen,
+      };
+}
+
+/// What the mail widget shows
+class MailboxSnapshot {
+  final String account;
+  final int unread;
+  final int total;
+
+  /// Newest first
+  final List<MailSummary> messages;
+  final bool connected;
+  final DateTime? syncedAt;
+  final String? error;
+
+  const MailboxSnapshot({
+    required this.account,
+    required this.unread,
+    required this.total,
+    required this.messages,
+    required this.connected,
+    this.syncedAt,
+    this.error,
+  });
+}
+
+/// The IMAP account, read at runtime from `imap.json` in the dashboard's
+/// config directory (the runner's, see linux/runner/config_watcher.h):
+///
+///     {"host": "imap.example.com", "port": 993, "tls": true,
+///      "user": "me@example.com", "password": "...", "mailbox": "INBOX"}
+///
+/// port, tls and mailbox are optional. The file holds a password, so it is
+/// ignored unless only its owner can read it (chmod 600).
+@immutable
+class MailAccount {
+  final String host;
+  final int port;
+  final bool secure;
+  final String user;
+  final String password;
+  final String mailbox;
+
+  const MailAccount({
+    required this.host,
+    this.port = 993,
+    this.secure = true,
+    required this.user,
+    required this.password,
+    this.mailbox = 'INBOX',
+  });
+
+  static const String fileName = 'imap.json';
+
+  /// Group and other permission bits (octal 077)
+  static const int _sharedModeBits = 0x3f;
+
+  factory MailAccount.fromJson(Map<String, dynamic> json) {
+    return MailAccount(
+      host: json['host'] as String,
+      port: json['port'] as int? ?? 993,
+      secure: json['tls'] as bool? ?? true,
+      user: json['user'] as String,
+      password: json['password'] as String? ?? '',
+      mailbox: json['mailbox'] as String? ?? 'INBOX',
+    );
+  }
+
+  /// Same directory as the runner's ConfigWatcher
+  static String get directory {
+    final env = Platform.environment;
+    final override = env['MODERN_DASHBOARD_CONFIG_DIR'];
+    if (override != null && override.isNotEmpty) return override;
+    final xdg = env['XDG_CONFIG_HOME'];
+    final base = xdg != null && xdg.isNotEmpty ? xdg : '${env['HOME']}/.config';
+    return '$base/com.example.modern_dashboard';
+  }
+
+  /// The account in [file], or null when there is none or it cannot be
+  /// used
+  static MailAccount? load([File? file]) {
+    if (kIsWeb) return null;
+    file ??= File('$directory/$fileName');
+    try {
+      final stat = file.statSync();
+      if (stat.type == FileSystemEntityType.notFound) return null;
+      if (stat.mode & _sharedModeBits != 0) {
+        debugPrint('MailSyncEngine: Ignoring ${file.path}: readable by others, chmod 600 it');
+        return null;
+      }
+      final account = MailAccount.fromJson(jsonDecode(file.readAsStringSync()) as Map<String, dynamic>);
+      return account.host.isEmpty || account.user.isEmpty ? null : account;
+    } catch (e) {
+      debugPrint('MailSyncEngine: Cannot read ${file.path}: $e');
+      return null;
+    }
+  }
+}
+
+/// Keeps a local index of the newest messages of one IMAP mailbox in sync
+/// over a single long-lived connection.
+///
+/// The first sync fetches headers and a short text snippet of the newest
+/// [indexLimit] messages; after that only UIDs above the highest indexed one
+/// are fetched. With QRESYNC the server reports flag changes and expunges
+/// since the last session when the mailbox is selected; with CONDSTORE alone
+/// the indexed range is checked with CHANGEDSINCE. Between syncs the
+/// connection sits in IDLE (or polls with NOOP) and pushed changes trigger
+/// the next incremental sync. The index is persisted, so the widget shows
+/// the last known unread count and subjects before the connection is up.
+///
+/// The account comes from [MailAccount]. LOGIN is only sent over TLS, or
+/// in plain text to a server on this machine, which is enough for testing.
+class MailSyncEngine {
+  static MailSyncEngine? _instance;
+  static MailSyncEngine get instance => _instance ??= MailSyncEngine._();
+
+  MailSyncEngine._();
+
+  /// Read once, on first use
+  static final MailAccount? _account = MailAccount.load();
+
+  /// Messages kept in the local index
+  static const int indexLimit = 200;
+  static const int _snippetBytes = 256;
+  static const int _snippetLength = 140;
+
+  /// RFC 2177: clients should re-issue IDLE at least every 29 minutes
+  static const Duration _idleRestart = Duration(minutes: 25);
+  static const Duration _pollInterval = Duration(minutes: 2);
+  static const Duration _maxBackoff = Duration(minutes: 5);
+
+  static bool get isConfigured => _account != null;
+
+  String get account => _account?.user ?? '';
+  String get _prefsKey => 'mail_index_v1_${_account!.user}@${_account!.host}/${_account!.mailbox}';
+
+  final SplayTreeMap<int, MailSummary> _messages = SplayTreeMap();
+  int? _uidValidity;
+  int? _highestModSeq;
+  int _exists = 0;
+  int _unread = 0;
+  DateTime? _syncedAt;
+  String? _error;
+
+  /// Seen flags set locally and not yet stored on the server
+  final Map<int, bool> _pendingSeen = {};
+
+  ImapClient? _client;
+  bool _running = false;
+  bool _qresync = false;
+  bool _condstore = false;
+
+  /// Check the indexed range for flag changes and expunges on the next sync
+  bool _checkRange = true;
+  int? _flagsSince;
+
+  /// Something changed since the current sync started
+  bool _dirty = false;
+  bool _idling = false;
+  Completer<void>? _wake;
+  Timer? _saveTimer;
+
+  final StreamController<MailboxSnapshot> _changes = StreamController.broadcast();
+
+  /// A new snapshot after every sync and local change
+  Stream<MailboxSnapshot> get changes => _changes.stream;
+
+  MailboxSnapshot get snapshot => MailboxSnapshot(
+        account: account,
+        unread: _unread,
+        total: _exists,
+        messages: _messages.values.toList().reversed.toList(),
+        connected: _client != null && !_client!.isClosed,
+        syncedAt: _syncedAt,
+        error: _error,
+      );
+
+  /// Restore the saved index and start syncing
+  Future<void> start() async {
+    if (_running || !isConfigured) return;
+    _running = true;
+    await _restore();
+    _publish();
+    unawaited(_run());
+  }
+
+  Future<void> stop() async {
+    _running = false;
+    _wakeUp();
+    await _client?.logout();
+    _saveTimer?.cancel();
+    await _save();
+  }
+
+  /// Sync now instead of waiting for a push or the next poll
+  void refresh() => _wakeUp();
+
+  /// Mark a message read or unread; shown immediately, stored on the server
+  /// by the next sync
+  void setSeen(int uid, bool seen) {
+    final message = _messages[uid];
+    if (message == null || message.seen == seen) return;
+    message.seen = seen;
+    _unread = max(0, _unread + (seen ? -1 : 1));
+    _pendingSeen[uid] = seen;
+    _publish();
+    _wakeUp();
+  }
+
+  void _wakeUp() {
+    _dirty = true;
+    final wake = _wake;
+    _wake = null;
+    if (wake != null && !wake.isCompleted) wake.complete();
+  }
+
+  void _publish() {
+    if (!_changes.isClosed) _changes.add(snapshot);
+  }
+
+  Future<void> _run() async {
+    var backoff = const Duration(seconds: 5);
+    while (_running) {
+      ImapClient? client;
+      try {
+        final settings = _account!;
+        client = await ImapClient.connect(settings.host, settings.port,
+            secure: settings.secure, onUntagged: _handle);
+        _client = client;
+        await client.login(settings.user, settings.password);
+        // Capabilities may change after authentication
+        await client.command('CAPABILITY');
+        _qresync = client.has('QRESYNC');
+        _condstore = _qresync || client.has('CONDSTORE');
+        if (_qresync) await client.command('ENABLE QRESYNC');
+        await _select(client);
+        _error = null;
+        backoff = const Duration(seconds: 5);
+
+        while (_running) {
+          await _sync(client);
+          _publish();
+          _scheduleSave();
+          await _waitForChanges(client);
+        }
+      } catch (e) {
+        debugPrint('MailSyncEngine: Sync failed: $e');
+        _error = '$e';
+      } finally {
+        client?.destroy();
+        _client = null;
+      }
+      if (!_running) break;
+      _publish();
+      await Future.delayed(backoff);
+      backoff = Duration(seconds: min(backoff.inSeconds * 2, _maxBackoff.inSeconds));
+    }
+  }
+
+  Future<void> _select(ImapClient client) async {
+    _exists = 0;
+    _checkRange = true;
+    // Flag changes are requested relative to what the index has seen, not
+    // to the HIGHESTMODSEQ the SELECT is about to report
+    _flagsSince = _highestModSeq;
+
+    var parameters = '';
+    final validity = _uidValidity;
+    final modSeq = _highestModSeq;
+    if (_qresync && validity != null && modSeq != null && _messages.isNotEmpty) {
+      parameters = ' (QRESYNC ($validity $modSeq ${_messages.firstKey()}:${_messages.lastKey()}))';
+      _checkRange = false;
+    } else if (_condstore) {
+      parameters = ' (CONDSTORE)';
+    }
+    await client.command('SELECT ${ImapClient.quote(_account!.mailbox)}$parameters');
+  }
+
+  String get _summaryItems => '(UID FLAGS INTERNALDATE${_condstore ? ' MODSEQ' : ''} '
+      'BODY.PEEK[HEADER.FIELDS (FROM SUBJECT CONTENT-TYPE CONTENT-TRANSFER-ENCODING)] '
+      'BODY.PEEK[TEXT]<0.$_snippetBytes>)';
+
+  Future<void> _sync(ImapClient client) async {
+    _dirty = false;
+    for (final entry in _pendingSeen.entries.toList()) {
+      await client.command('UID STORE ${entry.key} ${entry.value ? '+' : '-'}FLAGS.SILENT (\\Seen)');
+      _pendingSeen.remove(entry.key);
+    }
+
+    if (_messages.isEmpty) {
+      // First sync: only the newest messages, addressed by sequence number
+      if (_exists > 0) {
+        await client.command('FETCH ${max(1, _exists - indexLimit + 1)}:* $_summaryItems');
+      }
+    } else {
+      if (_checkRange) await _checkIndexedRange(client);
+      await client.command('UID FETCH ${_messages.lastKey()! + 1}:* $_summaryItems');
+    }
+    while (_messages.length > indexLimit) {
+      _messages.remove(_messages.firstKey());
+    }
+    _checkRange = false;
+
+    await _countUnread(client);
+    _syncedAt = DateTime.now();
+  }
+
+  /// Without QRESYNC the server does not replay what changed while we were
+  /// away, so re-read the flags of the indexed range and drop UIDs that no
+  /// longer exist
+  Future<void> _checkIndexedRange(ImapClient client) async {
+    final range = '${_messages.firstKey()}:${_messages.lastKey()}';
+    final since = _flagsSince;
+    if (_condstore && since != null) {
+      await client.command('UID FETCH $range (UID FLAGS) (CHANGEDSINCE $since)');
+    } else {
+      await client.command('UID FETCH $range (UID FLAGS)');
+    }
+    final result = await client.command('UID SEARCH UID $range');
+    final alive = <int>{};
+    for (final response in result.untagged) {
+      if (response.status != 'SEARCH') continue;
+      for (final token in response.data.skip(1)) {
+        final uid = token is String ? int.tryParse(token) : null;
+        if (uid != null) alive.add(uid);
+      }
+    }
+    _messages.removeWhere((uid, _) => !alive.contains(uid));
+  }
+
+  Future<void> _countUnread(ImapClient client) async {
+    if (client.has('ESEARCH')) {
+      final result = await client.command('UID SEARCH RETURN (COUNT) UNSEEN');
+      for (final response in result.untagged) {
+        if (response.status != 'ESEARCH') continue;
+        final data = response.data;
+        for (var i = 1; i + 1 < data.length; i++) {
+          if ('${data[i]}'.toUpperCase() == 'COUNT') _unread = int.tryParse('${data[i + 1]}') ?? _unread;
+        }
+      }
+      return;
+    }
+    final result = await client.command('UID SEARCH UNSEEN');
+    var count = 0;
+    for (final response in result.untagged) {
+      if (response.status == 'SEARCH') count += response.data.skip(1).whereType<String>().length;
+    }
+    _unread = count;
+  }
+
+  /// Idle (or poll) until the server reports a change, a local change needs
+  /// the connection, or the IDLE has to be renewed
+  Future<void> _waitForChanges(ImapClient client) async {
+    if (!_running || _dirty) return;
+    final wake = Completer<void>();
+    _wake = wake;
+
+    if (client.has('IDLE')) {
+      await client.startIdle();
+      _idling = true;
+      final timer = Timer(_idleRestart, _wakeUp);
+      await Future.any([wake.future, client.done]);
+      timer.cancel();
+      _idling = false;
+      await client.endIdle();
+    } else {
+      final timer = Timer(_pollInterval, _wakeUp);
+      await Future.any([wake.future, client.done]);
+      timer.cancel();
+      await client.command('NOOP');
+    }
+    _wake = null;
+  }
+
+  /// Mailbox state from untagged responses, whether they answer a command
+  /// or were pushed during IDLE
+  void _handle(ImapResponse response) {
+    final data = response.data;
+    if (data.isEmpty) return;
+    final number = data.first is String ? int.tryParse(data.first as String) : null;
+
+    if (number != null && data.length > 1) {
+      switch ('${data[1]}'.toUpperCase()) {
+        case 'EXISTS':
+          final grew = number > _exists;
+          _exists = number;
+          if (grew) _wakeUp();
+        case 'EXPUNGE':
+          _exists = max(0, _exists - 1);
+          _checkRange = true;
+          _wakeUp();
+        case 'FETCH':
+          if (data.length > 2 && data[2] is List) _applyFetch(data[2] as List<Object?>);
+          // Pushed flag changes may touch messages outside the index, so
+          // the unread count is re-read
+          if (_idling) _wakeUp();
+      }
+      return;
+    }
+
+    switch (response.status) {
+      case 'OK':
+        final code = response.code;
+        if (code == null || code.length < 2) return;
+        final value = int.tryParse('${code[1]}');
+        if (value == null) return;
+        switch ('${code[0]}'.toUpperCase()) {
+          case 'UIDVALIDITY':
+            if (_uidValidity != null && _uidValidity != value) {
+              // UIDs were reassigned; nothing in the index is valid
+              _messages.clear();
+              _highestModSeq = null;
+              _flagsSince = null;
+            }
+            _uidValidity = value;
+          case 'HIGHESTMODSEQ':
+            _highestModSeq = max(_highestModSeq ?? 0, value);
+        }
+      case 'VANISHED':
+        if (data.length < 2 || data.last is! String) return;
+        final uids = _parseUidSet(data.last as String);
+        for (final uid in uids) {
+          _messages.remove(uid);
+        }
+        if (data[1] is! List) {
+          // Live expunge rather than a VANISHED (EARLIER) replay
+          _exists = max(0, _exists - uids.length);
+          _wakeUp();
+        }
+    }
+  }
+
+  void _applyFetch(List<Object?> items) {
+    int? uid;
+    List<Object?>? flags;
+    String? internalDate;
+    String? header;
+    String? text;
+    for (var i = 0; i + 1 < items.length; i += 2) {
+      final key = '${items[i]}'.toUpperCase();
+      final value = items[i + 1];
+      if (key == 'UID') {
+        uid = int.tryParse('$value');
+      } else if (key == 'FLAGS' && value is List) {
+        flags = value;
+      } else if (key == 'INTERNALDATE' && value is String) {
+        internalDate = value;
+      } else if (key == 'MODSEQ' && value is List && value.isNotEmpty) {
+        final modSeq = int.tryParse('${value.first}');
+        if (modSeq != null) _highestModSeq = max(_highestModSeq ?? 0, modSeq);
+      } else if (key.startsWith('BODY[HEADER') && value is String) {
+        header = value;
+      } else if (key.startsWith('BODY[TEXT]') && value is String) {
+        text = value;
+      }
+    }
+    if (uid == null) return;
+
+    final seen = flags?.any((f) => '$f'.toLowerCase() == r'\seen');
+    final existing = _messages[uid];
+    if (existing != null) {
+      if (seen != null && !_pendingSeen.containsKey(uid)) existing.seen = seen;
+      return;
+    }
+    if (header == null) return;
+
+    final headers = _parseHeaders(header);
+    _messages[uid] = MailSummary(
+      uid: uid,
+      from: _displayName(_decodeWords(headers['from'] ?? '')),
+      subject: _decodeWords(headers['subject'] ?? '(no subject)'),
+      snippet: _snippet(text ?? '', headers),
+      receivedAt: _parseInternalDate(internalDate) ?? DateTime.now(),
+      seen: seen ?? false,
+    );
+  }
+
+  Future<void> _restore() async {
+    try {
+      final prefs = await SharedPreferences.getInstance();
+      final raw = prefs.getString(_prefsKey);
+      if (raw == null) return;
+      final json = jsonDecode(raw) as Map<String, dynamic>;
+      _uidValidity = json['uid_validity'] as int?;
+      _highestModSeq = json['modseq'] as int?;
+      _exists = json['exists'] as int? ?? 0;
+      _unread = json['unread'] as int? ?? 0;
+      final synced = json['synced_at'] as int?;
+      _syncedAt = synced != null ? DateTime.fromMillisecondsSinceEpoch(synced) : null;
+      for (final item in (json['messages'] as List? ?? const [])) {
+        final message = MailSummary.fromJson(item as Map<String, dynamic>);
+        _messages[message.uid] = message;
+      }
+    } catch (e) {
+      debugPrint('MailSyncEngine: Failed to restore mail index: $e');
+      _messages.clear();
+      _uidValidity = null;
+      _highestModSeq = null;
+    }
+  }
+
+  void _scheduleSave() {
+    _saveTimer?.cancel();
+    _saveTimer = Timer(const Duration(seconds: 5), _save);
+  }
+
+  Future<void> _save() async {
+    try {
+      final prefs = await SharedPreferences.getInstance();
+      await prefs.setString(
+        _prefsKey,
+        jsonEncode({
+          'uid_validity': _uidValidity,
+          'modseq': _highestModSeq,
+          'exists': _exists,
+          'unread': _unread,
+          'synced_at': _syncedAt?.millisecondsSinceEpoch,
+          'messages': [for (final message in _messages.values) message.toJson()],
+        }),
+      );
+    } catch (e) {
+      debugPrint('MailSyncEngine: Failed to save mail index: $e');
+    }
+  }
+
+  /// UIDs of a sequence set such as `1:5,9`
+  static List<int> _parseUidSet(String set) {
+    final uids = <int>[];
+    for (final part in set.split(',')) {
+      final colon = part.indexOf(':');
+      if (colon < 0) {
+        final uid = int.tryParse(part);
+        if (uid != null) uids.add(uid);
+        continue;
+      }
+      final a = int.tryParse(part.substring(0, colon));
+      final b = int.tryParse(part.substring(colon + 1));
+      if (a == null || b == null) continue;
+      for (var uid = min(a, b); uid <= max(a, b); uid++) {
+        uids.add(uid);
+      }
+    }
+    return uids;
+  }
+
+  /// Header fields by lower-cased name, folded lines joined
+  static Map<String, String> _parseHeaders(String raw) {
+    final headers = <String, String>{};
+    String? name;
+    for (final line in raw.split(RegExp(r'\r?\n'))) {
+      if (line.isEmpty) continue;
+      if ((line.startsWith(' ') || line.startsWith('\t')) && name != null) {
+        headers[name] = '${headers[name]} ${line.trim()}';
+        continue;
+      }
+      final colon = line.indexOf(':');
+      if (colon <= 0) continue;
+      name = line.substring(0, colon).trim().toLowerCase();
+      headers[name] = line.substring(colon + 1).trim();
+    }
+    return headers;
+  }
+
+  static final RegExp _encodedWord = RegExp(r'=\?([^?]+)\?([BbQq])\?([^?]*)\?=');
+  static final RegExp _betweenEncodedWords = RegExp(r'\?=\s+=\?');
+
+  /// Decode RFC 2047 encoded words
+  static String _decodeWords(String value) {
+    if (!value.contains('=?')) return value;
+    return value.replaceAll(_betweenEncodedWords, '?==?').replaceAllMapped(_encodedWord, (match) {
+      try {
+        final charset = match.group(1)!.toLowerCase();
+        final encoded = match.group(3)!;
+        final bytes = match.group(2)!.toUpperCase() == 'B'
+            ? base64.decode(base64.normalize(encoded))
+            : _decodeQuotedPrintable(encoded.replaceAll('_', ' '));
+        return _decodeCharset(bytes, charset);
+      } catch (_) {
+        return match.group(0)!;
+      }
+    });
+  }
+
+  static String _decodeCharset(List<int> bytes, String charset) {
+    if (charset.contains('8859-1') || charset == 'us-ascii' || charset == 'windows-1252') {
+      return latin1.decode(bytes, allowInvalid: true);
+    }
+    return utf8.decode(bytes, allowMalformed: true);
+  }
+
+  static List<int> _decodeQuotedPrintable(String value) {
+    final bytes = <int>[];
+    for (var i = 0; i < value.length; i++) {
+      final c = value.codeUnitAt(i);
+      if (c == 61 && i + 2 < value.length) {
+        final byte = int.tryParse(value.substring(i + 1, i + 3), radix: 16);
+        if (byte != null) {
+          bytes.add(byte);
+          i += 2;
+          continue;
+        }
+      }
+      bytes.add(c & 0xff);
+    }
+    return bytes;
+  }
+
+  /// `"Jane Doe" <jane@example.com>` becomes `Jane Doe`
+  static String _displayName(String from) {
+    final angle = from.indexOf('<');
+    if (angle > 0) {
+      final name = from.substring(0, angle).trim().replaceAll('"', '');
+      if (name.isNotEmpty) return name;
+    }
+    return from.replaceAll(RegExp(r'[<>]'), '').trim();
+  }
+
+  static final RegExp _htmlTag = RegExp(r'<[^>]*>?');
+  static final RegExp _whitespace = RegExp(r'\s+');
+
+  /// Readable start of a (possibly truncated) message body. For multipart
+  /// messages the first part is used, with its own headers.
+  static String _snippet(String body, Map<String, String> headers) {
+    final type = headers['content-type']?.toLowerCase() ?? '';
+    if (type.startsWith('multipart')) {
+      final boundary = body.indexOf('--');
+      if (boundary < 0) return '';
+      // Boundary line, then the part's headers up to a blank line
+      final lines = body.substring(boundary).split('\n');
+      var i = 1;
+      while (i < lines.length && lines[i].trim().isNotEmpty) {
+        i++;
+      }
+      if (i >= lines.length) return '';
+      var part = lines.sublist(i + 1).join('\n');
+      final next = part.indexOf('\n--');
+      if (next >= 0) part = part.substring(0, next);
+      return _snippet(part, _parseHeaders(lines.sublist(1, i).join('\n')));
+    }
+
+    var text = body;
+    final encoding = headers['content-transfer-encoding']?.toLowerCase() ?? '';
+    if (encoding == 'quoted-printable') {
+      text = utf8.decode(_decodeQuotedPrintable(text.replaceAll(RegExp(r'=\r?\n'), '')),
+          allowMalformed: true);
+    } else if (encoding == 'base64') {
+      // Only whole 4-character groups of the truncated body decode
+      final compact = text.replaceAll(_whitespace, '');
+      try {
+        text = utf8.decode(base64.decode(compact.substring(0, compact.length - compact.length % 4)),
+            allowMalformed: true);
+      } catch (_) {
+        return '';
+      }
+    }
+    if (type.contains('html')) {
+      text = text.replaceAll(_htmlTag, ' ').replaceAll('&nbsp;', ' ').replaceAll('&amp;', '&');
+    }
+    text = text.replaceAll(_whitespace, ' ').trim();
+    return text.length > _snippetLength ? '${text.substring(0, _snippetLength)}...' : text;
+  }
+
+  static const List<String> _months = [
+    'jan', 'feb', 'mar', 'apr', 'may', 'jun', 'jul', 'aug', 'sep', 'oct', 'nov', 'dec',
+  ];
+  static final RegExp _internalDate =
+      RegExp(r'(\d{1,2})-(\w{3})-(\d{4}) (\d\d):(\d\d):(\d\d) ([+-])(\d\d)(\d\d)');
+
+  /// `17-Jul-1996 02:44:25 -0700`
+  static DateTime? _parseInternalDate(String? value) {
+    final match = value == null ? null : _internalDate.firstMatch(value);
+    if (match == null) return null;
+    final month = _months.indexOf(match.group(2)!.toLowerCase()) + 1;
+    if (month == 0) return null;
+    final sign = match.group(7) == '-' ? -1 : 1;
+    final offset = Duration(
+      hours: sign * int.parse(match.group(8)!),
+      minutes: sign * int.parse(match.group(9)!),
+    );
+    return DateTime.utc(
+      int.parse(match.group(3)!),
+      month,
+      int.parse(match.group(1)!),
+      int.parse(match.group(4)!),
+      int.parse(match.group(5)!),
+      int.parse(match.group(6)!),
+    ).subtract(offset).toLocal();
+  }
+}
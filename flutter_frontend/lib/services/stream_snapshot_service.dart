@@ -0,0 +1,197 @@
+import 'dart:async';
+import 'dart:collection';
+import 'dart:io';
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+import '../core/services/native_bridge_channel.dart';
+import '../core/utils/stream_manifest.dart';
+import '../models/video_stream.dart';
+import 'video_stream_service.dart';
+
+/// A still frame of a live stream
+class StreamSnapshot {
+  final Uint8List jpeg;
+  final DateTime capturedAt;
+
+  /// Rendition the frame was taken from
+  final String variantLabel;
+
+  const StreamSnapshot(this.jpeg, this.capturedAt, this.variantLabel);
+}
+
+/// Tile thumbnails for HLS streams that have no provider thumbnail.
+///
+/// For each stream the cheapest variant that still covers the tile is
+/// picked, and only the newest segment of its media playlist is handed to
+/// the runner's `modern_dashboard/stream_snapshot` channel. The runner decodes
+/// that segment's first frame on a worker thread and posts it, scaled to the
+/// tile height, to the worker results bridge under the capture's id. Frames are cached in memory and refreshed at most once per
+/// [refreshInterval]; at most [maxConcurrent] captures run at a time.
+class StreamSnapshotService {
+  static StreamSnapshotService? _instance;
+  static StreamSnapshotService get instance => _instance ??= StreamSnapshotService._();
+
+  StreamSnapshotService._();
+
+  static const MethodChannel _channel = MethodChannel('modern_dashboard/stream_snapshot');
+
+  /// Override with --dart-define=STREAM_SNAPSHOT_SECONDS=...
+  static const Duration refreshInterval =
+      Duration(seconds: int.fromEnvironment('STREAM_SNAPSHOT_SECONDS', defaultValue: 90));
+
+  static const int maxConcurrent = 2;
+  static const int _maxCached = 32;
+
+  /// Longer than the runner's own capture timeout
+  static const Duration _frameTimeout = Duration(seconds: 15);
+
+  /// Snapshots by stream URL, least recently used first
+  final LinkedHashMap<String, StreamSnapshot> _cache = LinkedHashMap();
+  final Map<String, Future<StreamSnapshot?>> _inFlight = {};
+  final Map<String, DateTime> _lastAttempt = {};
+  final Queue<Completer<void>> _waiting = Queue();
+  int _running = 0;
+
+  /// Captures the runner accepted, by id, waiting for their frame
+  final Map<int, Completer<Uint8List?>> _pendingFrames = {};
+  StreamSubscription<Object?>? _frames;
+
+  /// Snapshots need the Linux runner; cleared when it has no decoder
+  bool _available = !kIsWeb && Platform.isLinux;
+
+  bool get isAvailable => _available;
+
+  /// Latest snapshot of [url], if any
+  StreamSnapshot? cached(String url) {
+    final snapshot = _cache.remove(url);
+    if (snapshot != null) _cache[url] = snapshot;
+    return snapshot;
+  }
+
+  /// Whether [stream] gets snapshots instead of its icon placeholder
+  bool supports(VideoStream stream) => _available && stream.isHLS && stream.thumbnailUrl == null;
+
+  /// Capture a frame of [stream] [heightPixels] tall, unless the cached one
+  /// is younger than [refreshInterval]. Resolves to the newest snapshot, or
+  /// null when none could be taken.
+  Future<StreamSnapshot?> snapshot(VideoStream stream, {required double heightPixels}) {
+    if (!supports(stream)) return Future.value(null);
+    final url = stream.url;
+    final lastAttempt = _lastAttempt[url];
+    if (lastAttempt != null && DateTime.now().difference(lastAttempt) < refreshInterval) {
+      return Future.value(_cache[url]);
+    }
+    return _inFlight.putIfAbsent(url, () async {
+      _lastAttempt[url] = DateTime.now();
+      await _acquire();
+      try {
+        final snapshot = await _capture(stream, heightPixels.round());
+        if (snapshot != null) {
+          _cache.remove(url);
+          _cache[url] = snapshot;
+          while (_cache.length > _maxCached) {
+            _cache.remove(_cache.keys.first);
+          }
+        }
+        return snapshot ?? _cache[url];
+      } finally {
+        _release();
+        _inFlight.remove(url);
+      }
+    });
+  }
+
+  Future<StreamSnapshot?> _capture(VideoStream stream, int height) async {
+    var manifest = await VideoStreamService.loadManifest(stream.url);
+    if (manifest == null || !_available) return null;
+
+    var label = 'source';
+    if (manifest.kind == ManifestKind.hlsMaster) {
+      // One concurrent stream: the thumbnail fetch is a single segment
+      final variant = VariantSelector.select(
+        manifest.variants,
+        tileHeightPixels: height.toDouble(),
+        bandwidthBps: VideoStreamService.estimatedBandwidthBps,
+      );
+      if (variant == null) return null;
+      label = variant.label;
+      manifest = await VideoStreamService.loadManifest(variant.uri.toString());
+      if (manifest == null) return null;
+    }
+
+    final segment = manifest.segments.lastWhere((s) => s.uri != null,
+        orElse: () => const ManifestSegment(null, 0, 0));
+    if (segment.uri == null) return null;
+
+    try {
+      _listenForFrames();
+      final ticket = await _channel.invokeMapMethod<String, dynamic>('capture', {
+        'url': segment.uri.toString(),
+        'height': height,
+      });
+      if (ticket == null) return null;
+      final id = ticket['id'] as int;
+      final frame = Completer<Uint8List?>();
+      _pendingFrames[id] = frame;
+      final jpeg = await frame.future.timeout(_frameTimeout, onTimeout: () {
+        _pendingFrames.remove(id);
+        return null;
+      });
+      if (jpeg == null) return null;
+      return StreamSnapshot(jpeg, DateTime.now(), label);
+    } on MissingPluginException {
+      _available = false;
+      debugPrint('StreamSnapshotService: Runner cannot decode streams, snapshots disabled');
+    } on PlatformException catch (e) {
+      debugPrint('StreamSnapshotService: Capture of ${stream.url} failed: ${e.code} ${e.message}');
+    }
+    return null;
+  }
+
+  /// The runner only posts to the bridge while Dart listens, so this runs
+  /// before the first capture is queued
+  void _listenForFrames() {
+    _frames ??= NativeBridgeChannel.workerResults.values.listen((value) {
+      final result = value as Map<Object?, Object?>;
+      if (result['source'] != 'stream_snapshot') return;
+      final frame = _pendingFrames.remove(result['id']);
+      if (frame == null) return;
+      final error = result['error'];
+      if (error != null) {
+        debugPrint('StreamSnapshotService: Capture ${result['id']} failed: $error');
+        frame.complete(null);
+      } else {
+        frame.complete(result['frame'] as Uint8List?);
+      }
+    });
+  }
+
+  Future<void> _acquire() async {
+    if (_running < maxConcurrent) {
+      _running++;
+      return;
+    }
+    final turn = Completer<void>();
+    _waiting.add(turn);
+    await turn.future;
+  }
+
+  /// Hands the slot straight to the next waiter, if any
+  void _release() {
+    if (_waiting.isNotEmpty) {
+      _waiting.removeFirst().complete();
+    } else {
+      _running--;
+    }
+  }
+
+  /// Capture counters from the runner
+  Future<Map<String, dynamic>?> getStats() async {
+    if (!_available) return null;
+    try {
+      return await _channel.invokeMapMethod<String, dynamic>('getStats');
+    } on MissingPluginException {
+      return null;
+    }
+  }
+}
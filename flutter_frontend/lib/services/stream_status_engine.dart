@@ -0,0 +1,386 @@
+import 'dart:async';
+import 'dart:convert';
+import 'dart:math';
+import 'package:flutter/foundation.dart';
+import 'package:http/http.dart' as http;
+import 'package:shared_preferences/shared_preferences.dart';
+import '../core/services/idle_scheduler.dart';
+import '../core/utils/stream_manifest.dart';
+import '../models/video_stream.dart';
+import '../repositories/video_stream_repository.dart';
+import 'video_stream_service.dart';
+
+/// Cached metadata and liveness of one stream URL
+class StreamStatus {
+  String? title;
+  String? thumbnailUrl;
+  bool? isLive;
+  DateTime? metadataAt;
+  DateTime? checkedAt;
+  DateTime nextCheck;
+  int offlineChecks;
+  int failures;
+
+  /// Minutes into the week at which the stream went live, most recent last
+  final List<int> liveStarts;
+
+  StreamStatus({
+    this.title,
+    this.thumbnailUrl,
+    this.isLive,
+    this.metadataAt,
+    this.checkedAt,
+    DateTime? nextCheck,
+    this.offlineChecks = 0,
+    this.failures = 0,
+    List<int>? liveStarts,
+  })  : nextCheck = nextCheck ?? DateTime.fromMillisecondsSinceEpoch(0),
+        liveStarts = liveStarts ?? [];
+
+  factory StreamStatus.fromJson(Map<String, dynamic> json) {
+    DateTime? time(String key) =>
+        json[key] is int ? DateTime.fromMillisecondsSinceEpoch(json[key] as int) : null;
+    return StreamStatus(
+      title: json['title'] as String?,
+      thumbnailUrl: json['thumbnail'] as String?,
+      isLive: json['live'] as bool?,
+      metadataAt: time('metadata_at'),
+      checkedAt: time('checked_at'),
+      nextCheck: time('next_check'),
+      offlineChecks: json['offline_checks'] as int? ?? 0,
+      failures: json['failures'] as int? ?? 0,
+      liveStarts: (json['live_starts'] as List?)?.whereType<int>().toList(),
+    );
+  }
+
+  Map<String, dynamic> toJson() => {
+        'title': title,
+        'thumbnail': thumbnailUrl,
+        'live': isLive,
+        'metadata_at': metadataAt?.millisecondsSinceEpoch,
+        'checked_at': checkedAt?.millisecondsSinceEpoch,
+        'next_check': nextCheck.millisecondsSinceEpoch,
+        'offline_checks': offlineChecks,
+        'failures': failures,
+        'live_starts': liveStarts,
+      };
+}
+
+/// A stream whose live flag or metadata changed
+class StreamStatusChange {
+  final String url;
+  final StreamStatus status;
+  final bool liveChanged;
+
+  const StreamStatusChange(this.url, this.status, this.liveChanged);
+}
+
+/// Request and cache counters for the debug panel
+class StreamStatusStats {
+  final int tracked;
+  final int checks;
+  final int metadataFetches;
+  final int metadataHits;
+  final int flips;
+
+  const StreamStatusStats(this.tracked, this.checks, this.metadataFetches, this.metadataHits, this.flips);
+
+  @override
+  String toString() {
+    return '$tracked streams, $checks liveness checks, $flips flips, '
+        'metadata $metadataFetches fetched / $metadataHits cached';
+  }
+}
+
+/// Keeps stream titles, thumbnails and live flags current for the stream
+/// grid without a request per stream per refresh.
+///
+/// Metadata is cached per URL and persisted, and is only refetched after
+/// the provider's TTL. Liveness is checked with the cheapest request each
+/// provider allows: a HEAD for the live thumbnail on YouTube and Twitch, a
+/// manifest reload for HLS/DASH. Due checks go out in batches of
+/// [batchSize] per tick. Each stream's next check is adaptive:
+/// - live streams are rechecked every [liveInterval];
+/// - offline streams near a time they went live before in the week are
+///   checked every [upcomingInterval];
+/// - other offline streams back off from [offlineInterval] to
+///   [deadInterval].
+/// Listeners on [changes] only hear about flips and changed metadata; the
+/// new live flag is also written back to the repository.
+class StreamStatusEngine {
+  static StreamStatusEngine? _instance;
+  static StreamStatusEngine get instance => _instance ??= StreamStatusEngine._();
+
+  StreamStatusEngine._();
+
+  static const String _prefsKey = 'stream_status_v1';
+  static const Duration _tickInterval = Duration(seconds: 30);
+  static const Map<String, Duration> _metadataTtl = {
+    StreamTypes.youtube: Duration(hours: 24),
+    StreamTypes.twitch: Duration(hours: 12),
+    StreamTypes.hls: Duration(hours: 6),
+    StreamTypes.dash: Duration(hours: 6),
+  };
+
+  int batchSize = 6;
+  Duration liveInterval = const Duration(minutes: 3);
+  Duration upcomingInterval = const Duration(minutes: 1);
+  Duration offlineInterval = const Duration(minutes: 5);
+  Duration deadInterval = const Duration(hours: 1);
+
+  /// How close to a previous go-live time counts as about to go live
+  static const int _upcomingWindowMinutes = 20;
+
+  final Map<String, StreamStatus> _statuses = {};
+  final Map<String, VideoStream> _tracked = {};
+  final Map<String, Future<Map<String, String?>>> _metadataLoads = {};
+  final StreamController<StreamStatusChange> _changes = StreamController.broadcast();
+  VideoStreamRepository? _repository;
+  Future<void>? _loaded;
+  Timer? _timer;
+  bool _running = false;
+  int _checks = 0;
+  int _metadataFetches = 0;
+  int _metadataHits = 0;
+  int _flips = 0;
+
+  Stream<StreamStatusChange> get changes => _changes.stream;
+
+  StreamStatusStats get stats =>
+      StreamStatusStats(_tracked.length, _checks, _metadataFetches, _metadataHits, _flips);
+
+  StreamStatus? statusOf(String url) => _statuses[url];
+
+  /// Write live flag flips back through [repository]
+  void attach(VideoStreamRepository repository) {
+    _repository = repository;
+  }
+
+  /// Follow exactly [streams]; others stop being checked but stay cached
+  Future<void> track(List<VideoStream> streams) async {
+    await _load();
+    _tracked
+      ..clear()
+      ..addEntries(streams.map((s) => MapEntry(s.url, s)));
+    if (_tracked.isEmpty) {
+      _timer?.cancel();
+      _timer = null;
+      return;
+    }
+    _timer ??= Timer.periodic(_tickInterval, (_) => _tick());
+    unawaited(_tick());
+  }
+
+  /// Title, thumbnail and type of [url], from the cache while within the
+  /// provider's TTL
+  Future<Map<String, String?>> metadata(String url) async {
+    await _load();
+    final type = VideoStreamService.detectStreamType(url);
+    final status = _statuses[url];
+    final ttl = _metadataTtl[type] ?? const Duration(hours: 6);
+    final at = status?.metadataAt;
+    if (status != null && at != null && DateTime.now().difference(at) < ttl) {
+      _metadataHits++;
+      return {'title': status.title, 'thumbnail': status.thumbnailUrl, 'type': type};
+    }
+    return _metadataLoads.putIfAbsent(url, () async {
+      try {
+        _metadataFetches++;
+        final info = await VideoStreamService.fetchStreamInfo(url);
+        final entry = _statuses.putIfAbsent(url, () => StreamStatus());
+        final changed = entry.title != info['title'] || entry.thumbnailUrl != info['thumbnail'];
+        entry
+          ..title = info['title']
+          ..thumbnailUrl = info['thumbnail']
+          ..metadataAt = DateTime.now();
+        if (changed) _changes.add(StreamStatusChange(url, entry, false));
+        _scheduleSave();
+        return info;
+      } finally {
+        _metadataLoads.remove(url);
+      }
+    });
+  }
+
+  Future<void> _load() {
+    return _loaded ??= () async {
+      try {
+        final prefs = await SharedPreferences.getInstance();
+        final stored = prefs.getString(_prefsKey);
+        if (stored == null) return;
+        final data = json.decode(stored) as Map<String, dynamic>;
+        data.forEach((url, value) {
+          _statuses[url] = StreamStatus.fromJson(value as Map<String, dynamic>);
+        });
+      } catch (e) {
+        debugPrint('StreamStatusEngine: Discarding unreadable status cache: $e');
+      }
+    }();
+  }
+
+  void _scheduleSave() {
+    unawaited(IdleScheduler.instance.schedule('StreamStatusEngine.save', (_) async {
+      try {
+        // The encoding is the slow part; do it inside the slice
+        final encoded = json.encode(_statuses.map((url, status) => MapEntry(url, status.toJson())));
+        final prefs = await SharedPreferences.getInstance();
+        await prefs.setString(_prefsKey, encoded);
+      } catch (e) {
+        debugPrint('StreamStatusEngine: Failed to save status cache: $e');
+      }
+      return true;
+    }, delay: const Duration(seconds: 10)));
+  }
+
+  Future<void> _tick() async {
+    if (_running) return;
+    _running = true;
+    try {
+      final now = DateTime.now();
+      final due = _tracked.values
+          .where((s) => _checkable(s) && !(_statuses[s.url]?.nextCheck.isAfter(now) ?? false))
+          .toList()
+        ..sort((a, b) => (_statuses[a.url]?.nextCheck ?? DateTime(0))
+            .compareTo(_statuses[b.url]?.nextCheck ?? DateTime(0)));
+      // One batch per tick; a large grid spreads its checks over a few ticks
+      await Future.wait(due.take(batchSize).map(_check));
+    } finally {
+      _running = false;
+    }
+  }
+
+  bool _checkable(VideoStream stream) {
+    final type = VideoStreamService.detectStreamType(stream.url);
+    if (type == StreamTypes.hls || type == StreamTypes.dash) return true;
+    // Browsers hide the status of cross-origin thumbnail requests
+    return !kIsWeb && (type == StreamTypes.youtube || type == StreamTypes.twitch);
+  }
+
+  Future<void> _check(VideoStream stream) async {
+    final url = stream.url;
+    final status = _statuses.putIfAbsent(url, () => StreamStatus(isLive: stream.isLive));
+    final now = DateTime.now();
+    _checks++;
+
+    bool? live;
+    try {
+      live = await _probe(url);
+    } catch (e) {
+      debugPrint('StreamStatusEngine: Liveness check failed for $url: $e');
+    }
+    // Best effort and separate, so a metadata outage cannot stop liveness
+    // checks; refetches only once the provider's metadata TTL has passed
+    try {
+      await metadata(url);
+    } catch (e) {
+      debugPrint('StreamStatusEngine: Metadata fetch failed for $url: $e');
+    }
+
+    if (live == null) {
+      status.failures++;
+      status.nextCheck = now.add(_backoff(offlineInterval, status.failures));
+      _scheduleSave();
+      return;
+    }
+
+    status
+      ..failures = 0
+      ..checkedAt = now;
+    final flipped = status.isLive != null && status.isLive != live;
+    if (live) {
+      if (status.isLive == false) {
+        status.liveStarts.add(_minuteOfWeek(now));
+        if (status.liveStarts.length > 8) status.liveStarts.removeAt(0);
+      }
+      status.offlineChecks = 0;
+      status.nextCheck = now.add(liveInterval);
+    } else {
+      status.offlineChecks++;
+      status.nextCheck = now.add(_upcoming(status, now)
+          ? upcomingInterval
+          : _backoff(offlineInterval, status.offlineChecks - 1));
+    }
+    status.isLive = live;
+    _scheduleSave();
+
+    if (flipped || stream.isLive != live) {
+      if (flipped) _flips++;
+      _changes.add(StreamStatusChange(url, status, true));
+      // The next check compares against this, saved or not
+      final updated = stream.copyWith(isLive: live, updatedAt: now);
+      if (_tracked.containsKey(url)) _tracked[url] = updated;
+      final repository = _repository;
+      if (repository != null && stream.id.isNotEmpty) {
+        unawaited(repository.updateStream(updated).then((_) {}, onError: (Object e) {
+          debugPrint('StreamStatusEngine: Failed to save live flag for $url: $e');
+        }));
+      }
+    }
+  }
+
+  /// [base] doubled per step, capped at [deadInterval]
+  Duration _backoff(Duration base, int steps) {
+    final factor = pow(2, min(steps, 10)).toInt();
+    final delay = base * factor;
+    return delay > deadInterval ? deadInterval : delay;
+  }
+
+  int _minuteOfWeek(DateTime time) =>
+      ((time.weekday - 1) * 24 + time.hour) * 60 + time.minute;
+
+  /// Whether [now] is shortly before or after a time the stream went live
+  /// in a previous week
+  bool _upcoming(StreamStatus status, DateTime now) {
+    const week = 7 * 24 * 60;
+    final current = _minuteOfWeek(now);
+    for (final start in status.liveStarts) {
+      final distance = (start - current) % week;
+      if (distance <= _upcomingWindowMinutes || distance >= week - _upcomingWindowMinutes) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// True/false when the provider answered, null when it could not tell
+  Future<bool?> _probe(String url) async {
+    switch (VideoStreamService.detectStreamType(url)) {
+      case StreamTypes.youtube:
+        // The "_live" thumbnail only exists while a broadcast is on air
+        final id = VideoStreamService.extractYouTubeVideoId(url);
+        if (id == null) return null;
+        final code = await _headStatus(Uri.parse('https://i.ytimg.com/vi/$id/hqdefault_live.jpg'));
+        return code == null ? null : code == 200;
+      case StreamTypes.twitch:
+        // Offline channels redirect their preview to a placeholder image
+        final channel = VideoStreamService.extractTwitchChannelName(url);
+        if (channel == null) return null;
+        final code = await _headStatus(Uri.parse(
+            'https://static-cdn.jtvnw.net/previews-ttv/live_user_${channel.toLowerCase()}-80x45.jpg'));
+        return code == null ? null : code == 200;
+      case StreamTypes.hls:
+      case StreamTypes.dash:
+        var manifest = await VideoStreamService.loadManifest(url);
+        if (manifest == null) return false;
+        if (manifest.kind == ManifestKind.hlsMaster && manifest.variants.isNotEmpty) {
+          manifest = await VideoStreamService.loadManifest(manifest.variants.first.uri.toString());
+          if (manifest == null) return false;
+        }
+        return manifest.isLive;
+    }
+    return null;
+  }
+
+  Future<int?> _headStatus(Uri uri) async {
+    final client = http.Client();
+    try {
+      final request = http.Request('HEAD', uri)..followRedirects = false;
+      final response = await client.send(request).timeout(const Duration(seconds: 10));
+      return response.statusCode;
+    } on TimeoutException {
+      return null;
+    } finally {
+      client.close();
+    }
+  }
+}
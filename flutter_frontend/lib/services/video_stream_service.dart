@@ -1,9 +1,43 @@
 import 'dart:convert';
+import 'package:flutter/foundation.dart';
 import 'package:http/http.dart' as http;
+import '../core/services/http_cache.dart';
+import '../core/utils/stream_manifest.dart';
 import '../models/video_stream.dart';
+import 'stream_status_engine.dart';
+
+class _CachedManifest {
+  final StreamManifest manifest;
+  final DateTime fetchedAt;
+
+  _CachedManifest(this.manifest, this.fetchedAt);
+}
 
 class VideoStreamService {
   static const int _timeoutSeconds = 10;
+
+  /// Parsed manifests by URL; VOD manifests and master playlists do not
+  /// change, live media playlists expire after their target duration
+  static final Map<String, _CachedManifest> _manifests = {};
+  static final Map<String, Future<StreamManifest?>> _manifestLoads = {};
+
+  /// Bandwidth assumed before anything has been measured; override with
+  /// --dart-define=STREAM_BANDWIDTH_KBPS=...
+  static const int _initialBandwidthKbps =
+      int.fromEnvironment('STREAM_BANDWIDTH_KBPS', defaultValue: 8000);
+
+  static double _bandwidthBps = _initialBandwidthKbps * 1000.0;
+
+  /// Smoothed download throughput in bits per second
+  static double get estimatedBandwidthBps => _bandwidthBps;
+
+  /// Feed a download's throughput into the bandwidth estimate. Transfers
+  /// under 32 KB mostly measure latency and are ignored.
+  static void recordThroughput(int bytes, Duration elapsed) {
+    if (bytes < 32 * 1024 || elapsed.inMicroseconds <= 0) return;
+    final sample = bytes * 8 / (elapsed.inMicroseconds / 1e6);
+    _bandwidthBps = _bandwidthBps * 0.7 + sample * 0.3;
+  }
   
   /// Validate stream URL
   static Future<bool> validateStreamUrl(String url, String type) async {
@@ -15,6 +49,8 @@ class VideoStreamService {
           return _validateTwitchUrl(url);
         case StreamTypes.hls:
           return await _validateHLSUrl(url);
+        case StreamTypes.dash:
+          return await _validateDashUrl(url);
         case StreamTypes.rtmp:
           // RTMP validation is complex, just check URL format
           return _validateRTMPUrl(url);
@@ -50,23 +86,85 @@ class VideoStreamService {
     return twitchPatterns.any((pattern) => pattern.hasMatch(url));
   }
 
-  /// Validate HLS URL
+  /// Validate HLS URL by parsing the playlist it serves
   static Future<bool> _validateHLSUrl(String url) async {
-    try {
-      if (!url.contains('.m3u8')) return false;
+    if (!url.contains('.m3u8')) return false;
+    final manifest = await loadManifest(url);
+    return manifest != null && manifest.kind != ManifestKind.dash &&
+        (manifest.variants.isNotEmpty || manifest.segments.isNotEmpty);
+  }
 
-      final response = await http
-          .head(Uri.parse(url))
-          .timeout(const Duration(seconds: _timeoutSeconds));
+  /// Validate DASH URL by parsing the MPD it serves
+  static Future<bool> _validateDashUrl(String url) async {
+    final manifest = await loadManifest(url);
+    return manifest != null && manifest.kind == ManifestKind.dash && manifest.variants.isNotEmpty;
+  }
 
-      return response.statusCode == 200 &&
-          ((response.headers['content-type']?.contains('application/vnd.apple.mpegurl') ?? false) ||
-           (response.headers['content-type']?.contains('application/x-mpegURL') ?? false));
+  /// Fetch and parse the HLS playlist or DASH MPD at [url]; null when it
+  /// cannot be loaded or is not a manifest
+  static Future<StreamManifest?> loadManifest(String url) {
+    final cached = _manifests[url];
+    if (cached != null) {
+      final manifest = cached.manifest;
+      final fresh = !manifest.isLive ||
+          DateTime.now().difference(cached.fetchedAt) < manifest.reloadInterval;
+      if (fresh) return Future.value(manifest);
+    }
+    final pending = _manifestLoads[url];
+    if (pending != null) return pending;
+    // Registered before it can settle and removed once it has, so a load
+    // that fails synchronously is not cached as in flight
+    final load = _fetchManifest(url);
+    _manifestLoads[url] = load;
+    load.whenComplete(() {
+      if (identical(_manifestLoads[url], load)) _manifestLoads.remove(url);
+    });
+    return load;
+  }
+
+  /// One fetch of [url]; caches the parsed manifest on success
+  static Future<StreamManifest?> _fetchManifest(String url) async {
+    try {
+      final uri = Uri.parse(url);
+      final watch = Stopwatch()..start();
+      final response = await http.get(uri).timeout(const Duration(seconds: _timeoutSeconds));
+      watch.stop();
+      if (response.statusCode != 200) return null;
+      recordThroughput(response.bodyBytes.length, watch.elapsed);
+
+      final text = utf8.decode(response.bodyBytes, allowMalformed: true);
+      if (!StreamManifest.isManifest(text)) return null;
+      final manifest = StreamManifest.parse(text, response.request?.url ?? uri);
+      _manifests[url] = _CachedManifest(manifest, DateTime.now());
+      return manifest;
     } catch (e) {
-      return false;
+      debugPrint('VideoStreamService: Failed to load manifest $url: $e');
+      return null;
     }
   }
 
+  /// Variant of [manifest] for a tile [tileHeightPixels] physical pixels
+  /// tall, with [concurrentStreams] adaptive streams sharing the bandwidth.
+  /// A fixed quality on the stream ('720p') caps the resolution.
+  static StreamVariant? selectVariant(
+    VideoStream stream,
+    StreamManifest manifest, {
+    required double tileHeightPixels,
+    int concurrentStreams = 1,
+  }) {
+    final quality = stream.quality;
+    final maxHeight = quality != null && quality.endsWith('p')
+        ? int.tryParse(quality.substring(0, quality.length - 1))
+        : null;
+    return VariantSelector.select(
+      manifest.variants,
+      tileHeightPixels: tileHeightPixels,
+      bandwidthBps: _bandwidthBps,
+      concurrentStreams: concurrentStreams,
+      maxHeight: maxHeight,
+    );
+  }
+
   /// Validate RTMP URL
   static bool _validateRTMPUrl(String url) {
     return url.startsWith('rtmp://') || url.startsWith('rtmps://');
@@ -85,8 +183,14 @@ class VideoStreamService {
     }
   }
 
-  /// Extract stream info from URL
-  static Future<Map<String, String?>> extractStreamInfo(String url) async {
+  /// Extract stream info from URL, answering from the stream status cache
+  /// while its entry is within the provider's metadata TTL
+  static Future<Map<String, String?>> extractStreamInfo(String url) {
+    return StreamStatusEngine.instance.metadata(url);
+  }
+
+  /// Fetch stream info from the provider, bypassing the cache
+  static Future<Map<String, String?>> fetchStreamInfo(String url) async {
     try {
       if (_validateYouTubeUrl(url)) {
         return await _extractYouTubeInfo(url);
@@ -96,14 +200,14 @@ class VideoStreamService {
         return {
           'title': _extractTitleFromUrl(url),
           'thumbnail': null,
-          'type': _detectStreamType(url),
+          'type': detectStreamType(url),
         };
       }
     } catch (e) {
       return {
         'title': _extractTitleFromUrl(url),
         'thumbnail': null,
-        'type': _detectStreamType(url),
+        'type': detectStreamType(url),
       };
     }
   }
@@ -111,7 +215,7 @@ class VideoStreamService {
   /// Extract YouTube video info
   static Future<Map<String, String?>> _extractYouTubeInfo(String url) async {
     try {
-      final videoId = _extractYouTubeVideoId(url);
+      final videoId = extractYouTubeVideoId(url);
       if (videoId == null) {
         return {
           'title': 'YouTube Stream',
@@ -123,9 +227,10 @@ class VideoStreamService {
       // Use YouTube oEmbed API for basic info
       final oembedUrl = 'https://www.youtube.com/oembed?url=https://www.youtube.com/watch?v=$videoId&format=json';
       
-      final response = await http
-          .get(Uri.parse(oembedUrl))
-          .timeout(const Duration(seconds: _timeoutSeconds));
+      final response = await HttpCache.instance.client.get(
+        Uri.parse(oembedUrl),
+        headers: HttpCache.timeoutHeaders(const Duration(seconds: _timeoutSeconds)),
+      );
 
       if (response.statusCode == 200) {
         final data = json.decode(response.body);
@@ -148,7 +253,7 @@ class VideoStreamService {
 
   /// Extract Twitch stream info
   static Future<Map<String, String?>> _extractTwitchInfo(String url) async {
-    final channelName = _extractTwitchChannelName(url);
+    final channelName = extractTwitchChannelName(url);
     
     return {
       'title': channelName != null ? 'Twitch - $channelName' : 'Twitch Stream',
@@ -158,7 +263,7 @@ class VideoStreamService {
   }
 
   /// Extract YouTube video ID from URL
-  static String? _extractYouTubeVideoId(String url) {
+  static String? extractYouTubeVideoId(String url) {
     final patterns = [
       RegExp(r'youtube\.com/watch\?v=([\w-]+)'),
       RegExp(r'youtube\.com/embed/([\w-]+)'),
@@ -176,7 +281,7 @@ class VideoStreamService {
   }
 
   /// Extract Twitch channel name from URL
-  static String? _extractTwitchChannelName(String url) {
+  static String? extractTwitchChannelName(String url) {
     final patterns = [
       RegExp(r'twitch\.tv/([\w-]+)'),
       RegExp(r'player\.twitch\.tv/\?channel=([\w-]+)'),
@@ -211,8 +316,9 @@ class VideoStreamService {
   }
 
   /// Detect stream type from URL
-  static String _detectStreamType(String url) {
+  static String detectStreamType(String url) {
     if (url.contains('.m3u8')) return StreamTypes.hls;
+    if (url.contains('.mpd')) return StreamTypes.dash;
     if (url.startsWith('rtmp')) return StreamTypes.rtmp;
     if (_validateYouTubeUrl(url)) return StreamTypes.youtube;
     if (_validateTwitchUrl(url)) return StreamTypes.twitch;
@@ -253,13 +359,13 @@ class VideoStreamService {
   static String? convertToEmbedUrl(String url, String type) {
     switch (type) {
       case StreamTypes.youtube:
-        final videoId = _extractYouTubeVideoId(url);
+        final videoId = extractYouTubeVideoId(url);
         if (videoId != null) {
           return 'https://www.youtube.com/embed/$videoId?autoplay=1&mute=1';
         }
         break;
       case StreamTypes.twitch:
-        final channelName = _extractTwitchChannelName(url);
+        final channelName = extractTwitchChannelName(url);
         if (channelName != null) {
           return 'https://player.twitch.tv/?channel=$channelName&parent=localhost';
         }
@@ -0,0 +1,185 @@
+import 'dart:async';
+import 'dart:convert';
+import 'package:flutter/foundation.dart';
+import 'package:shared_preferences/shared_preferences.dart';
+import '../core/services/idle_scheduler.dart';
+import '../core/utils/gazetteer_index.dart';
+import '../core/utils/time_series.dart';
+import '../models/weather.dart';
+
+/// Columns of a location's history series
+enum WeatherMetric { temperature, feelsLike, humidity, pressure, windSpeed, cloudiness }
+
+class _LocationHistory {
+  final GorillaSeries observations;
+  GorillaSeries forecast;
+  String units;
+  bool dirty = false;
+
+  _LocationHistory(this.observations, this.forecast, this.units);
+}
+
+/// Observation and forecast history per location for trend display.
+///
+/// Samples are kept in [GorillaSeries] (one column per [WeatherMetric]), so
+/// a sample of six readings costs a few bytes instead of a full [WeatherData]:
+/// a week of ten-minute observations for 20 locations stays in the low
+/// hundreds of KB. Observations older than [retention] are dropped; the
+/// forecast series is replaced on every refresh. Series are persisted to
+/// SharedPreferences a while after they change.
+class WeatherHistoryStore {
+  static WeatherHistoryStore? _instance;
+  static WeatherHistoryStore get instance => _instance ??= WeatherHistoryStore._();
+
+  WeatherHistoryStore._();
+
+  static const String _keyPrefix = 'weather_history_v1_';
+  static const Duration _saveDelay = Duration(seconds: 30);
+
+  Duration retention = const Duration(days: 7);
+
+  final Map<String, _LocationHistory> _histories = {};
+  final Map<String, Future<_LocationHistory>> _loading = {};
+
+  /// Record a current-conditions observation for [location]
+  Future<void> record(String location, WeatherData weather) async {
+    final history = await _load(location, weather.units);
+    if (history.units != weather.units) {
+      // Mixing units in one series would make the trend meaningless
+      history.observations.clear();
+      history.forecast.clear();
+      history.units = weather.units;
+    }
+    if (!history.observations.append(weather.timestamp, _columns(weather))) return;
+    history.observations.dropBefore(DateTime.now().subtract(retention));
+    _markDirty(history);
+  }
+
+  /// Replace the forecast for [location]
+  Future<void> recordForecast(String location, List<WeatherData> forecast) async {
+    if (forecast.isEmpty) return;
+    final history = await _load(location, forecast.first.units);
+    final series = GorillaSeries(WeatherMetric.values.length);
+    final sorted = [...forecast]..sort((a, b) => a.timestamp.compareTo(b.timestamp));
+    for (final point in sorted) {
+      series.append(point.timestamp, _columns(point));
+    }
+    history.forecast = series;
+    _markDirty(history);
+  }
+
+  /// Observed [metric] for [location] between [from] and [to] (default: the
+  /// last 24 hours), downsampled to at most [maxPoints]
+  Future<List<TimeSeriesPoint>> history(
+    String location,
+    WeatherMetric metric, {
+    DateTime? from,
+    DateTime? to,
+    int? maxPoints,
+  }) async {
+    final history = await _load(location, null);
+    final end = to ?? DateTime.now();
+    final points = history.observations.range(
+      metric.index,
+      from ?? end.subtract(const Duration(hours: 24)),
+      end,
+    );
+    return maxPoints == null ? points : downsampleLttb(points, maxPoints);
+  }
+
+  /// Forecast [metric] for [location], downsampled to at most [maxPoints]
+  Future<List<TimeSeriesPoint>> forecast(String location, WeatherMetric metric, {int? maxPoints}) async {
+    final history = await _load(location, null);
+    final points = history.forecast.range(
+      metric.index,
+      DateTime.fromMillisecondsSinceEpoch(0),
+      DateTime.now().add(const Duration(days: 365)),
+    );
+    return maxPoints == null ? points : downsampleLttb(points, maxPoints);
+  }
+
+  /// Compressed size of every loaded series
+  int get sizeInBytes => _histories.values
+      .fold(0, (sum, h) => sum + h.observations.sizeInBytes + h.forecast.sizeInBytes);
+
+  List<double> _columns(WeatherData weather) => [
+        weather.temperature,
+        weather.feelsLike,
+        weather.humidity.toDouble(),
+        weather.pressure,
+        weather.windSpeed,
+        weather.cloudiness.toDouble(),
+      ];
+
+  Future<_LocationHistory> _load(String location, String? units) {
+    final key = GazetteerIndex.fold(location);
+    final loaded = _histories[key];
+    if (loaded != null) return Future.value(loaded);
+    return _loading.putIfAbsent(key, () async {
+      _LocationHistory history;
+      try {
+        history = await _read(key) ?? _empty(units);
+      } catch (e) {
+        debugPrint('WeatherHistoryStore: Discarding unreadable history for $location: $e');
+        history = _empty(units);
+      }
+      _histories[key] = history;
+      _loading.remove(key);
+      return history;
+    });
+  }
+
+  _LocationHistory _empty(String? units) => _LocationHistory(
+        GorillaSeries(WeatherMetric.values.length),
+        GorillaSeries(WeatherMetric.values.length),
+        units ?? 'metric',
+      );
+
+  Future<_LocationHistory?> _read(String key) async {
+    final prefs = await SharedPreferences.getInstance();
+    final stored = prefs.getString('$_keyPrefix$key');
+    if (stored == null) return null;
+    final parts = stored.split(':');
+    if (parts.length != 3) return null;
+    final observations = GorillaSeries.fromBytes(base64Decode(parts[1]));
+    final forecast = GorillaSeries.fromBytes(base64Decode(parts[2]));
+    if (observations.columnCount != WeatherMetric.values.length ||
+        forecast.columnCount != WeatherMetric.values.length) {
+      return null;
+    }
+    return _LocationHistory(observations, forecast, parts[0])
+      ..observations.dropBefore(DateTime.now().subtract(retention));
+  }
+
+  void _markDirty(_LocationHistory history) {
+    history.dirty = true;
+    unawaited(IdleScheduler.instance.schedule('WeatherHistoryStore.flush', (_) async {
+      await flush();
+      return true;
+    }, delay: _saveDelay));
+  }
+
+  /// Persist every changed series now
+  Future<void> flush() async {
+    final dirty = _histories.entries.where((e) => e.value.dirty).toList();
+    if (dirty.isEmpty) return;
+    // Encoded before the first await, which is the part an idle slice covers
+    final encoded = {
+      for (final entry in dirty)
+        '$_keyPrefix${entry.key}': '${entry.value.units}:'
+            '${base64Encode(entry.value.observations.toBytes())}'
+            ':${base64Encode(entry.value.forecast.toBytes())}',
+    };
+    for (final entry in dirty) {
+      entry.value.dirty = false;
+    }
+    try {
+      final prefs = await SharedPreferences.getInstance();
+      for (final entry in encoded.entries) {
+        await prefs.setString(entry.key, entry.value);
+      }
+    } catch (e) {
+      debugPrint('WeatherHistoryStore: Failed to save history: $e');
+    }
+  }
+}
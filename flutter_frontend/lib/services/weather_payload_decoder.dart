@@ -0,0 +1,221 @@
+import 'dart:convert';
+import 'dart:typed_data';
+import 'package:flutter/foundation.dart';
+import '../core/utils/json_scanner.dart';
+import '../models/weather.dart';
+
+/// The fields we use from one OpenWeatherMap observation or forecast entry.
+/// Missing fields are null so call sites keep their own defaults.
+class OwmObservation {
+  int? id;
+  String? name;
+  double? latitude;
+  double? longitude;
+  double? temperature;
+  double? feelsLike;
+  int? humidity;
+  double? pressure;
+  String? description;
+  String? icon;
+  double? windSpeed;
+  int? windDirection;
+  int? cloudiness;
+  int? visibility;
+  int? dt;
+  String? dtText;
+
+  /// Same mapping as [WeatherData.fromOpenWeatherMapJson]
+  WeatherData toWeatherData(String units) {
+    return WeatherData(
+      id: id?.toString() ?? 'unknown',
+      location: name ?? 'Unknown Location',
+      latitude: latitude ?? 0.0,
+      longitude: longitude ?? 0.0,
+      temperature: temperature ?? 0.0,
+      feelsLike: feelsLike ?? 0.0,
+      humidity: humidity ?? 0,
+      pressure: pressure ?? 0.0,
+      description: description ?? '',
+      icon: icon ?? '01d',
+      windSpeed: windSpeed ?? 0.0,
+      windDirection: windDirection ?? 0,
+      cloudiness: cloudiness ?? 0,
+      visibility: visibility ?? 0,
+      timestamp: DateTime.fromMillisecondsSinceEpoch((dt ?? 0) * 1000),
+      units: units,
+    );
+  }
+}
+
+/// Decodes OpenWeatherMap current-weather and forecast responses straight
+/// from the response bytes with [JsonScanner], reading only the fields of
+/// [OwmObservation]. Nothing else in the payload is materialized, and a
+/// forecast read with a limit stops scanning after the last wanted entry.
+class OpenWeatherMapDecoder {
+  static final List<Uint8List> _rootKeys = JsonScanner.keys(
+      ['coord', 'weather', 'main', 'wind', 'clouds', 'visibility', 'dt', 'dt_txt', 'id', 'name']);
+  static final List<Uint8List> _coordKeys = JsonScanner.keys(['lat', 'lon']);
+  static final List<Uint8List> _weatherKeys = JsonScanner.keys(['description', 'icon']);
+  static final List<Uint8List> _mainKeys =
+      JsonScanner.keys(['temp', 'feels_like', 'humidity', 'pressure']);
+  static final List<Uint8List> _windKeys = JsonScanner.keys(['speed', 'deg']);
+  static final List<Uint8List> _cloudKeys = JsonScanner.keys(['all']);
+  static final List<Uint8List> _forecastKeys = JsonScanner.keys(['list']);
+
+  /// Decode a /weather response
+  static OwmObservation current(Uint8List bytes) {
+    final scanner = JsonScanner(bytes);
+    final observation = OwmObservation();
+    if (!scanner.beginObject()) throw FormatException('Empty weather response');
+    _readObservation(scanner, observation);
+    return observation;
+  }
+
+  /// Decode the first [limit] entries (all when null) of a /forecast response
+  static List<OwmObservation> forecast(Uint8List bytes, {int? limit}) {
+    final scanner = JsonScanner(bytes);
+    final entries = <OwmObservation>[];
+    if (!scanner.beginObject()) return entries;
+    while (true) {
+      final key = scanner.nextKey(_forecastKeys);
+      if (key == JsonScanner.end) break;
+      if (key != 0) {
+        scanner.skipValue();
+        continue;
+      }
+      if (!scanner.beginArray()) continue;
+      while (scanner.nextElement()) {
+        if (limit != null && entries.length >= limit) {
+          // Everything after the wanted entries is left unread
+          return entries;
+        }
+        final entry = OwmObservation();
+        if (scanner.beginObject()) _readObservation(scanner, entry);
+        entries.add(entry);
+      }
+    }
+    return entries;
+  }
+
+  /// Read the fields of the object just entered, through its closing brace
+  static void _readObservation(JsonScanner scanner, OwmObservation out) {
+    while (true) {
+      switch (scanner.nextKey(_rootKeys)) {
+        case JsonScanner.end:
+          return;
+        case 0:
+          if (!scanner.beginObject()) break;
+          _readFields(scanner, _coordKeys, (key) {
+            if (key == 0) {
+              out.latitude = scanner.number();
+            } else {
+              out.longitude = scanner.number();
+            }
+          });
+        case 1:
+          if (!scanner.beginArray()) break;
+          if (scanner.nextElement()) {
+            if (scanner.beginObject()) {
+              _readFields(scanner, _weatherKeys, (key) {
+                if (key == 0) {
+                  out.description = scanner.string();
+                } else {
+                  out.icon = scanner.string();
+                }
+              });
+            }
+            scanner.skipRest();
+          }
+        case 2:
+          if (!scanner.beginObject()) break;
+          _readFields(scanner, _mainKeys, (key) {
+            switch (key) {
+              case 0:
+                out.temperature = scanner.number();
+              case 1:
+                out.feelsLike = scanner.number();
+              case 2:
+                out.humidity = scanner.integer();
+              case 3:
+                out.pressure = scanner.number();
+            }
+          });
+        case 3:
+          if (!scanner.beginObject()) break;
+          _readFields(scanner, _windKeys, (key) {
+            if (key == 0) {
+              out.windSpeed = scanner.number();
+            } else {
+              out.windDirection = scanner.integer();
+            }
+          });
+        case 4:
+          if (!scanner.beginObject()) break;
+          _readFields(scanner, _cloudKeys, (_) => out.cloudiness = scanner.integer());
+        case 5:
+          out.visibility = scanner.integer();
+        case 6:
+          out.dt = scanner.integer();
+        case 7:
+          out.dtText = scanner.string();
+        case 8:
+          out.id = scanner.integer();
+        case 9:
+          out.name = scanner.string();
+        default:
+          scanner.skipValue();
+      }
+    }
+  }
+
+  static void _readFields(JsonScanner scanner, List<Uint8List> keys, void Function(int key) read) {
+    while (true) {
+      final key = scanner.nextKey(keys);
+      if (key == JsonScanner.end) return;
+      if (key == JsonScanner.unknown) {
+        scanner.skipValue();
+      } else {
+        read(key);
+      }
+    }
+  }
+
+  /// Time [iterations] full decodes of a forecast payload with the scanner
+  /// and with `json.decode` plus the map walk it replaced
+  static ({Duration scanner, Duration jsonDecode}) benchmark(Uint8List bytes, {int iterations = 20}) {
+    final scannerWatch = Stopwatch()..start();
+    for (var i = 0; i < iterations; i++) {
+      forecast(bytes);
+    }
+    scannerWatch.stop();
+
+    final decodeWatch = Stopwatch()..start();
+    for (var i = 0; i < iterations; i++) {
+      final data = json.decode(utf8.decode(bytes)) as Map<String, dynamic>;
+      for (final item in data['list'] as List? ?? const []) {
+        final main = item['main'] ?? {};
+        final weather = (item['weather'] as List).isNotEmpty ? item['weather'][0] : {};
+        final wind = item['wind'] ?? {};
+        OwmObservation()
+          ..temperature = (main['temp'] ?? 0).toDouble()
+          ..feelsLike = (main['feels_like'] ?? 0).toDouble()
+          ..humidity = (main['humidity'] ?? 0).round()
+          ..pressure = (main['pressure'] ?? 0).toDouble()
+          ..description = weather['description']
+          ..icon = weather['icon']
+          ..windSpeed = (wind['speed'] ?? 0).toDouble()
+          ..windDirection = (wind['deg'] ?? 0).round()
+          ..cloudiness = (item['clouds']?['all'] ?? 0).round()
+          ..dt = item['dt']
+          ..dtText = item['dt_txt'];
+      }
+    }
+    decodeWatch.stop();
+
+    final result = (scanner: scannerWatch.elapsed, jsonDecode: decodeWatch.elapsed);
+    debugPrint('OpenWeatherMapDecoder: ${bytes.length} bytes x $iterations, '
+        'scanner ${result.scanner.inMicroseconds} us, '
+        'json.decode ${result.jsonDecode.inMicroseconds} us');
+    return result;
+  }
+}
@@ -0,0 +1,375 @@
+import 'dart:async';
+import 'dart:math';
+import 'package:flutter/foundation.dart';
+import '../core/utils/gazetteer_index.dart';
+import '../core/utils/spatial_cache.dart';
+import '../models/weather.dart';
+import '../repositories/weather_repository.dart';
+import 'dashboard_config_service.dart';
+import 'gazetteer_service.dart';
+import 'weather_history_store.dart';
+
+/// Refresh plan and budget usage, exposed for logging and the debug panel
+class WeatherRefreshStats {
+  final int trackedLocations;
+  final int refreshGroups;
+  final double plannedCallsPerHour;
+  final double unbatchedCallsPerHour;
+  final int callsLastHour;
+  final int maxCallsPerHour;
+  final int deferred;
+
+  const WeatherRefreshStats({
+    required this.trackedLocations,
+    required this.refreshGroups,
+    required this.plannedCallsPerHour,
+    required this.unbatchedCallsPerHour,
+    required this.callsLastHour,
+    required this.maxCallsPerHour,
+    required this.deferred,
+  });
+
+  @override
+  String toString() {
+    return '$trackedLocations locations in $refreshGroups groups, '
+        '~${plannedCallsPerHour.toStringAsFixed(0)} calls/hour '
+        '(${unbatchedCallsPerHour.toStringAsFixed(0)} if refreshed separately), '
+        '$callsLastHour in the last hour, budget $maxCallsPerHour, deferred $deferred';
+  }
+}
+
+class _TrackedLocation {
+  final String name;
+  (double, double)? coordinates;
+  final StreamController<WeatherData> current = StreamController<WeatherData>.broadcast();
+  final StreamController<List<WeatherData>> forecast =
+      StreamController<List<WeatherData>>.broadcast();
+  WeatherData? latestCurrent;
+  List<WeatherData>? latestForecast;
+  DateTime? currentAt;
+  DateTime? forecastAt;
+  Future<void> resolving = Future.value();
+
+  _TrackedLocation(this.name);
+
+  bool get isIdle => !current.hasListener && !forecast.hasListener;
+}
+
+enum _RefreshKind { current, forecast }
+
+/// Locations close enough to share one API call
+class _RefreshGroup {
+  final List<_TrackedLocation> members = [];
+
+  _TrackedLocation get primary => members.first;
+
+  DateTime? lastRefresh(_RefreshKind kind) {
+    DateTime? newest;
+    for (final member in members) {
+      final at = kind == _RefreshKind.current ? member.currentAt : member.forecastAt;
+      if (at != null && (newest == null || at.isAfter(newest))) newest = at;
+    }
+    return newest;
+  }
+
+  bool wants(_RefreshKind kind) => members.any((member) =>
+      kind == _RefreshKind.current ? member.current.hasListener : member.forecast.hasListener);
+}
+
+class _RefreshJob {
+  final _RefreshGroup group;
+  final _RefreshKind kind;
+  final Duration overdue;
+
+  const _RefreshJob(this.group, this.kind, this.overdue);
+}
+
+/// Single scheduler for every weather card on the dashboard.
+///
+/// Widgets subscribe to [watchCurrent] / [watchForecast] instead of polling
+/// the repository themselves. Tracked locations within [groupDistanceMeters]
+/// of each other, or with the same name, form one group refreshed by a single
+/// call whose result fans out to every member. Current conditions and
+/// forecasts run on their own intervals. Due refreshes go out in batches of
+/// [batchSize], most overdue first, and draw from a token bucket that caps
+/// the call rate at [maxCallsPerHour]; what does not fit waits for the next
+/// tick. The intervals and budget follow the local config's refresh policy.
+class WeatherRefreshEngine {
+  static WeatherRefreshEngine? _instance;
+  static WeatherRefreshEngine get instance => _instance ??= WeatherRefreshEngine._();
+
+  WeatherRefreshEngine._() {
+    DashboardConfigService.instance.refresh.addListener(_applyRefreshPolicy);
+    _applyRefreshPolicy();
+  }
+
+  static const Duration _defaultCurrentInterval = Duration(minutes: 10);
+  static const Duration _defaultForecastInterval = Duration(hours: 1);
+  static const int _defaultMaxCallsPerHour = 120;
+
+  Duration currentInterval = _defaultCurrentInterval;
+  Duration forecastInterval = _defaultForecastInterval;
+  int maxCallsPerHour = _defaultMaxCallsPerHour;
+  int batchSize = 4;
+  double groupDistanceMeters = 2000;
+
+  static const Duration _tickInterval = Duration(seconds: 30);
+
+  WeatherRepository? _repository;
+  final Map<String, _TrackedLocation> _tracked = {};
+  final List<DateTime> _callTimes = [];
+  Timer? _timer;
+  bool _tickScheduled = false;
+  bool _running = false;
+  int _deferred = 0;
+  late double _tokens = (batchSize * 2).toDouble();
+  DateTime _tokensAt = DateTime.now();
+  String? _lastPlan;
+
+  /// Use [repository] for refreshes (the active repository can change when
+  /// the app falls back to offline mode)
+  void attach(WeatherRepository repository) {
+    _repository = repository;
+  }
+
+  /// Current conditions for [location], replaying the latest value to new
+  /// listeners
+  Stream<WeatherData> watchCurrent(String location) {
+    final tracked = _track(location);
+    return _replaying(tracked.current, () => tracked.latestCurrent, tracked);
+  }
+
+  /// Forecast for [location], replaying the latest value to new listeners
+  Stream<List<WeatherData>> watchForecast(String location) {
+    final tracked = _track(location);
+    return _replaying(tracked.forecast, () => tracked.latestForecast, tracked);
+  }
+
+  /// Refresh [location]'s group on the next tick regardless of age
+  void refreshNow(String location) {
+    final tracked = _tracked[GazetteerIndex.fold(location)];
+    if (tracked == null) return;
+    for (final member in _groups().firstWhere((g) => g.members.contains(tracked)).members) {
+      member.currentAt = null;
+      member.forecastAt = null;
+    }
+    _scheduleTick();
+  }
+
+  void _applyRefreshPolicy() {
+    final policy = DashboardConfigService.instance.refresh.value;
+    currentInterval = policy.weatherCurrent ?? _defaultCurrentInterval;
+    forecastInterval = policy.weatherForecast ?? _defaultForecastInterval;
+    maxCallsPerHour = policy.weatherMaxCallsPerHour ?? _defaultMaxCallsPerHour;
+    // Groups a shorter interval made due refresh now, not on the next tick
+    if (_tracked.isNotEmpty) _scheduleTick();
+  }
+
+  WeatherRefreshStats get stats {
+    final groups = _groups();
+    double perHour(Iterable<_RefreshGroup> groups) {
+      var calls = 0.0;
+      for (final group in groups) {
+        if (group.wants(_RefreshKind.current)) calls += 3600 / currentInterval.inSeconds;
+        if (group.wants(_RefreshKind.forecast)) calls += 3600 / forecastInterval.inSeconds;
+      }
+      return calls;
+    }
+
+    final separate = _tracked.values.map((t) => _RefreshGroup()..members.add(t));
+    _trimCallTimes();
+    return WeatherRefreshStats(
+      trackedLocations: _tracked.length,
+      refreshGroups: groups.length,
+      plannedCallsPerHour: min(perHour(groups), maxCallsPerHour.toDouble()),
+      unbatchedCallsPerHour: perHour(separate),
+      callsLastHour: _callTimes.length,
+      maxCallsPerHour: maxCallsPerHour,
+      deferred: _deferred,
+    );
+  }
+
+  _TrackedLocation _track(String location) {
+    final key = GazetteerIndex.fold(location);
+    return _tracked.putIfAbsent(key, () {
+      final tracked = _TrackedLocation(location);
+      tracked.resolving = _resolve(tracked);
+      return tracked;
+    });
+  }
+
+  Future<void> _resolve(_TrackedLocation tracked) async {
+    final matches = await GazetteerService.instance.search(tracked.name, limit: 1);
+    if (matches.isNotEmpty &&
+        GazetteerIndex.fold(matches.first.name) ==
+            GazetteerIndex.fold(tracked.name.split(',').first)) {
+      tracked.coordinates = (matches.first.latitude, matches.first.longitude);
+    }
+  }
+
+  Stream<T> _replaying<T>(StreamController<T> controller, T? Function() latest, _TrackedLocation tracked) {
+    late StreamController<T> view;
+    StreamSubscription<T>? subscription;
+    view = StreamController<T>(
+      onListen: () {
+        final value = latest();
+        if (value != null) view.add(value);
+        subscription = controller.stream.listen(view.add, onError: view.addError);
+        _scheduleTick();
+      },
+      onCancel: () async {
+        await subscription?.cancel();
+        if (tracked.isIdle) _untrack(tracked);
+      },
+    );
+    return view.stream;
+  }
+
+  void _untrack(_TrackedLocation tracked) {
+    _tracked.remove(GazetteerIndex.fold(tracked.name));
+    tracked.current.close();
+    tracked.forecast.close();
+    if (_tracked.isEmpty) {
+      _timer?.cancel();
+      _timer = null;
+    }
+  }
+
+  /// Coalesce subscriptions made in the same frame into one tick
+  void _scheduleTick() {
+    _timer ??= Timer.periodic(_tickInterval, (_) => _tick());
+    if (_tickScheduled) return;
+    _tickScheduled = true;
+    scheduleMicrotask(() {
+      _tickScheduled = false;
+      _tick();
+    });
+  }
+
+  List<_RefreshGroup> _groups() {
+    final groups = <_RefreshGroup>[];
+    for (final tracked in _tracked.values) {
+      final coordinates = tracked.coordinates;
+      _RefreshGroup? home;
+      if (coordinates != null) {
+        for (final group in groups) {
+          final other = group.primary.coordinates;
+          if (other != null &&
+              Geohash.distanceMeters(coordinates.$1, coordinates.$2, other.$1, other.$2) <=
+                  groupDistanceMeters) {
+            home = group;
+            break;
+          }
+        }
+      }
+      (home ?? (groups..add(_RefreshGroup())).last).members.add(tracked);
+    }
+    return groups;
+  }
+
+  void _trimCallTimes() {
+    final cutoff = DateTime.now().subtract(const Duration(hours: 1));
+    _callTimes.removeWhere((time) => time.isBefore(cutoff));
+  }
+
+  /// Refill the bucket; it holds at most two batches so an idle period does
+  /// not turn into a burst
+  void _refillTokens() {
+    final now = DateTime.now();
+    final elapsed = now.difference(_tokensAt).inMilliseconds / 1000;
+    _tokensAt = now;
+    _tokens = min((batchSize * 2).toDouble(), _tokens + elapsed * maxCallsPerHour / 3600);
+  }
+
+  Future<void> _tick() async {
+    final repository = _repository;
+    if (_running || repository == null || _tracked.isEmpty) return;
+    _running = true;
+    try {
+      // Group on coordinates, so wait for new names to be looked up
+      await Future.wait(_tracked.values.map((tracked) => tracked.resolving));
+      final groups = _groups();
+      final now = DateTime.now();
+      final due = <_RefreshJob>[];
+      for (final group in groups) {
+        for (final kind in _RefreshKind.values) {
+          if (!group.wants(kind)) continue;
+          final interval = kind == _RefreshKind.current ? currentInterval : forecastInterval;
+          final last = group.lastRefresh(kind);
+          final overdue = last == null ? interval : now.difference(last) - interval;
+          if (last == null || !overdue.isNegative) {
+            due.add(_RefreshJob(group, kind, overdue));
+          }
+        }
+      }
+      // Never-loaded and most overdue first; current conditions before
+      // forecasts since they are what the cards show
+      due.sort((a, b) {
+        if (a.kind != b.kind) return a.kind.index - b.kind.index;
+        return b.overdue.compareTo(a.overdue);
+      });
+
+      _refillTokens();
+      var index = 0;
+      while (index < due.length && _tokens >= 1) {
+        final batch = <_RefreshJob>[];
+        while (index < due.length && batch.length < batchSize && _tokens >= 1) {
+          batch.add(due[index++]);
+          _tokens -= 1;
+        }
+        await Future.wait(batch.map((job) => _run(repository, job)));
+      }
+      _deferred = due.length - index;
+
+      final plan = stats.toString();
+      if (plan != _lastPlan) {
+        _lastPlan = plan;
+        debugPrint('WeatherRefreshEngine: $plan');
+      }
+    } finally {
+      _running = false;
+    }
+  }
+
+  Future<void> _run(WeatherRepository repository, _RefreshJob job) async {
+    final location = job.group.primary.name;
+    _callTimes.add(DateTime.now());
+    try {
+      if (job.kind == _RefreshKind.current) {
+        final weather = await repository.getCurrentWeather(location);
+        final at = DateTime.now();
+        for (final member in job.group.members) {
+          member.latestCurrent = weather;
+          member.currentAt = at;
+          if (!member.current.isClosed) member.current.add(weather);
+          unawaited(WeatherHistoryStore.instance.record(member.name, weather));
+        }
+      } else {
+        final forecast = await repository.getForecast(location);
+        final at = DateTime.now();
+        for (final member in job.group.members) {
+          member.latestForecast = forecast;
+          member.forecastAt = at;
+          if (!member.forecast.isClosed) member.forecast.add(forecast);
+          unawaited(WeatherHistoryStore.instance.recordForecast(member.name, forecast));
+        }
+      }
+    } catch (e) {
+      debugPrint('WeatherRefreshEngine: Failed to refresh $location: $e');
+      for (final member in job.group.members) {
+        final controller = job.kind == _RefreshKind.current ? member.current : member.forecast;
+        if (!controller.isClosed) controller.addError(e);
+      }
+      // Retry after a full interval rather than on every tick, also for
+      // members that had succeeded before and are now stale
+      final at = DateTime.now();
+      for (final member in job.group.members) {
+        if (job.kind == _RefreshKind.current) {
+          member.currentAt = at;
+        } else {
+          member.forecastAt = at;
+        }
+      }
+    }
+  }
+}
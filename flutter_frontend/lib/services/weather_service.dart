@@ -2,17 +2,27 @@ import 'dart:convert';
 import 'dart:math';
 import 'package:flutter/foundation.dart';
 import 'package:http/http.dart' as http;
+import '../core/services/http_cache.dart';
+import '../core/utils/gazetteer_index.dart';
+import '../core/utils/spatial_cache.dart';
 import '../models/weather.dart';
+import 'gazetteer_service.dart';
+import 'weather_payload_decoder.dart';
 
 class WeatherService {
   static const String _baseUrl = 'https://api.openweathermap.org/data/2.5';
   static const String _geocodingUrl = 'https://api.openweathermap.org/geo/1.0';
   static const int _timeoutSeconds = 10;
   
-  // Cache management
-  static final Map<String, WeatherData> _weatherCache = {};
-  static final Map<String, DateTime> _cacheTimestamps = {};
-  static const Duration _cacheExpiry = Duration(minutes: 10);
+  /// Current observations keyed by coordinate, shared by every repository
+  /// and widget so nearby locations and repeated requests cost one API call.
+  /// Partitioned by units.
+  static final SpatialCache<WeatherData> spatialCache = SpatialCache<WeatherData>(
+    maxAge: const Duration(minutes: 10),
+  );
+
+  /// Hit rates of the coordinate-keyed weather cache
+  static SpatialCacheStats get cacheStats => spatialCache.stats;
 
   /// Get current weather for a location
   static Future<WeatherData> getCurrentWeather(
@@ -24,24 +34,31 @@ class WeatherService {
       return _getMockWeatherData(location, config.units);
     }
 
-    // Check cache first
-    final cacheKey = '${location.latitude}_${location.longitude}_${config.units}';
-    if (_isCacheValid(cacheKey)) {
-      return _weatherCache[cacheKey]!;
-    }
-
     // For web platform, use mock data to avoid CORS issues
     if (kIsWeb) {
       return _getMockWeatherData(location, config.units);
     }
 
+    return spatialCache.getOrFetch(
+      location.latitude,
+      location.longitude,
+      () => _fetchCurrentWeather(location, config),
+      partition: config.units,
+    );
+  }
+
+  static Future<WeatherData> _fetchCurrentWeather(
+    WeatherLocation location,
+    WeatherApiConfig config,
+  ) async {
     try {
       final url = Uri.parse(
         '$_baseUrl/weather?lat=${location.latitude}&lon=${location.longitude}&appid=${config.apiKey}&units=${config.units}&lang=${config.language}',
       );
 
-      final response = await http.get(url).timeout(
-        const Duration(seconds: _timeoutSeconds),
+      final response = await HttpCache.instance.client.get(
+        url,
+        headers: HttpCache.timeoutHeaders(const Duration(seconds: _timeoutSeconds)),
       );
 
       if (response.statusCode != 200) {
@@ -51,14 +68,7 @@ class WeatherService {
         );
       }
 
-      final data = json.decode(response.body) as Map<String, dynamic>;
-      final weatherData = WeatherData.fromOpenWeatherMapJson(data, config.units);
-
-      // Cache the result
-      _weatherCache[cacheKey] = weatherData;
-      _cacheTimestamps[cacheKey] = DateTime.now();
-
-      return weatherData;
+      return OpenWeatherMapDecoder.current(response.bodyBytes).toWeatherData(config.units);
     } catch (e) {
       if (e is WeatherException) {
         rethrow;
@@ -76,14 +86,23 @@ class WeatherService {
     String apiKey, {
     int limit = 5,
   }) async {
+    // Answer from the offline gazetteer when a place name starts with the
+    // query. Its typo-tolerant guesses only pad out the geocoding results:
+    // "Bern" must not stop at Berlin just because Bern is not indexed.
+    final local = await GazetteerService.instance.searchSplit(query, limit: limit);
+    if (local.matches.isNotEmpty) {
+      return [...local.matches, ...local.guesses];
+    }
+    final guesses = local.guesses;
+
     if (apiKey.isEmpty) {
       // Return mock locations if no API key
-      return _getMockLocations(query);
+      return _mergeLocations(_getMockLocations(query), guesses, limit);
     }
 
     // For web platform, return mock data to avoid CORS issues
     if (kIsWeb) {
-      return _getMockLocations(query);
+      return _mergeLocations(_getMockLocations(query), guesses, limit);
     }
 
     try {
@@ -91,8 +110,9 @@ class WeatherService {
         '$_geocodingUrl/direct?q=${Uri.encodeComponent(query)}&limit=$limit&appid=$apiKey',
       );
 
-      final response = await http.get(url).timeout(
-        const Duration(seconds: _timeoutSeconds),
+      final response = await HttpCache.instance.client.get(
+        url,
+        headers: HttpCache.timeoutHeaders(const Duration(seconds: _timeoutSeconds)),
       );
 
       if (response.statusCode != 200) {
@@ -103,7 +123,7 @@ class WeatherService {
       }
 
       final data = json.decode(response.body) as List;
-      return data.map((item) {
+      final remote = data.map((item) {
         final location = item as Map<String, dynamic>;
         return WeatherLocation(
           id: '${location['lat']}_${location['lon']}',
@@ -115,7 +135,13 @@ class WeatherService {
           createdAt: DateTime.now(),
         );
       }).toList();
+      return _mergeLocations(remote, guesses, limit);
     } catch (e) {
+      // The guesses are still better than an error
+      if (guesses.isNotEmpty) {
+        debugPrint('WeatherService: Location search failed, showing local guesses: $e');
+        return guesses;
+      }
       if (e is WeatherException) {
         rethrow;
       }
@@ -258,6 +284,22 @@ class WeatherService {
   }
 
   /// Get mock locations for search
+  /// [primary] followed by the [guesses] it does not already contain
+  static List<WeatherLocation> _mergeLocations(
+    List<WeatherLocation> primary,
+    List<WeatherLocation> guesses,
+    int limit,
+  ) {
+    String key(WeatherLocation location) =>
+        '${GazetteerIndex.fold(location.name)}|${location.country.toUpperCase()}';
+    final seen = primary.map(key).toSet();
+    return [
+      ...primary,
+      for (final guess in guesses)
+        if (seen.add(key(guess))) guess,
+    ].take(limit).toList();
+  }
+
   static List<WeatherLocation> _getMockLocations(String query) {
     final mockCities = [
       {'name': 'London', 'country': 'GB', 'state': '', 'lat': 51.5074, 'lon': -0.1278},
@@ -290,25 +332,9 @@ class WeatherService {
     )).toList();
   }
 
-  /// Check if cached data is still valid
-  static bool _isCacheValid(String cacheKey) {
-    final timestamp = _cacheTimestamps[cacheKey];
-    if (timestamp == null || !_weatherCache.containsKey(cacheKey)) {
-      return false;
-    }
-    return DateTime.now().difference(timestamp) < _cacheExpiry;
-  }
-
-  /// Clear cache for specific location
-  static void clearCache(String cacheKey) {
-    _weatherCache.remove(cacheKey);
-    _cacheTimestamps.remove(cacheKey);
-  }
-
   /// Clear all cache
   static void clearAllCache() {
-    _weatherCache.clear();
-    _cacheTimestamps.clear();
+    spatialCache.clear();
   }
 
   /// Get available units
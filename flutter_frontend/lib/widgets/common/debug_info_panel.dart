@@ -3,8 +3,21 @@ import 'package:flutter/material.dart';
 import 'package:flutter/services.dart';
 import '../../core/theme/dark_theme.dart';
 import '../../core/services/error_reporting_service.dart';
+import '../../core/services/http_cache.dart';
+import '../../core/services/idle_scheduler.dart';
+import '../../core/services/network_warmup.dart';
+import '../../core/utils/safe_json_converter.dart';
+import '../../models/weather.dart';
+import '../../repositories/news_repository.dart';
 import '../../repositories/repository_provider.dart';
+import '../../repositories/todo_repository.dart';
 import '../../firebase/firebase_service.dart';
+import '../../services/article_store.dart';
+import '../../services/dashboard_config_service.dart';
+import '../../services/feed_health_service.dart';
+import '../../services/stream_status_engine.dart';
+import '../../services/weather_refresh_engine.dart';
+import '../../services/weather_service.dart';
 
 class DebugInfoPanel extends StatefulWidget {
   final VoidCallback? onClose;
@@ -280,6 +293,30 @@ class _DebugInfoPanelState extends State<DebugInfoPanel> with TickerProviderStat
             'Cloud Functions: ${repositoryInfo['cloud_functions']}',
             'Offline Enabled: ${repositoryInfo['offline_mode_enabled']}',
             'Current Mode: ${repositoryInfo['repository_type']}',
+            'Local config: ${DashboardConfigService.instance.stats}',
+          ]),
+          _buildInfoGroup('Weather Cache', [
+            'Lookups: ${WeatherService.cacheStats}',
+            'Refresh: ${WeatherRefreshEngine.instance.stats}',
+          ]),
+          _buildInfoGroup('HTTP Cache', [
+            '${HttpCache.instance.stats}',
+            'Warmup: ${NetworkWarmup.instance.stats}',
+          ]),
+          _buildInfoGroup('Feed Health', [
+            '${FeedHealthService.instance.stats}',
+            'Article store: ${ArticleStore.instance.stats}',
+          ]),
+          _buildInfoGroup('Stream Status', [
+            '${StreamStatusEngine.instance.stats}',
+          ]),
+          _buildInfoGroup('Idle Work', [
+            '${IdleScheduler.instance.stats}',
+          ]),
+          _buildInfoGroup('Document Decoding', [
+            'Todo: ${TodoItem.schema.stats}',
+            'News: ${NewsItem.schema.stats}',
+            'Weather: ${WeatherData.schema.stats}',
           ]),
           _buildInfoGroup('Health Check', [
             'Click "Run Health Check" to test repository connectivity',
@@ -292,6 +329,11 @@ class _DebugInfoPanelState extends State<DebugInfoPanel> with TickerProviderStat
             ),
             child: const Text('Run Health Check'),
           ),
+          const SizedBox(height: 8),
+          ElevatedButton(
+            onPressed: _runDecodeBenchmark,
+            child: const Text('Benchmark Todo Decoding (10k)'),
+          ),
         ],
       ),
     );
@@ -478,6 +520,35 @@ class _DebugInfoPanelState extends State<DebugInfoPanel> with TickerProviderStat
     }
   }
 
+  /// Compare the compiled todo plan with the sanitize + fromJson path on a
+  /// synthetic 10k-document snapshot
+  void _runDecodeBenchmark() {
+    final now = DateTime.now().millisecondsSinceEpoch;
+    final documents = List.generate(10000, (i) => <String, dynamic>{
+          'id': 'todo_$i',
+          'title': 'Task $i',
+          'description': 'Description for task $i',
+          'category': i.isEven ? 'work' : 'personal',
+          'priority': 'medium',
+          'status': i % 3 == 0 ? 'completed' : 'pending',
+          'created_at': now - i * 60000,
+          'updated_at': now - i * 30000,
+          'due_date': i % 5 == 0 ? now + i * 60000 : null,
+          'tags': ['tag${i % 7}', 'tag${i % 11}'],
+          'user_id': 'user',
+          'extra_$i': i,
+        });
+    final result = TodoItem.schema.benchmark(
+      documents,
+      (json) => SafeJsonConverter.safeFromJson<TodoItem>(
+        SafeJsonConverter.sanitizeForWeb(json),
+        TodoItem.fromJson,
+      ),
+    );
+    _showSnackBar('Todo decoding: ${result.schema.toStringAsFixed(2)} us/doc '
+        '(was ${result.legacy.toStringAsFixed(2)} us/doc)');
+  }
+
   String _generateDebugInfo() {
     final buffer = StringBuffer();
     buffer.writeln('=== Debug Information ===');
@@ -0,0 +1,58 @@
+import 'dart:async';
+import 'dart:ui' as ui;
+import 'package:flutter/foundation.dart';
+import 'package:flutter/widgets.dart';
+import '../../core/services/http_cache.dart';
+
+/// Network image loaded through the shared [HttpCache], so thumbnails and
+/// icons follow their servers' caching headers and survive restarts
+@immutable
+class HttpCacheImage extends ImageProvider<HttpCacheImage> {
+  final String url;
+  final double scale;
+
+  const HttpCacheImage(this.url, {this.scale = 1.0});
+
+  /// [HttpCacheImage] on native platforms; on the web the browser already
+  /// caches images and loads them without CORS, so a [NetworkImage]
+  static ImageProvider provider(String url) => kIsWeb ? NetworkImage(url) : HttpCacheImage(url);
+
+  @override
+  Future<HttpCacheImage> obtainKey(ImageConfiguration configuration) {
+    return SynchronousFuture<HttpCacheImage>(this);
+  }
+
+  @override
+  ImageStreamCompleter loadImage(HttpCacheImage key, ImageDecoderCallback decode) {
+    return MultiFrameImageStreamCompleter(
+      codec: _load(key, decode),
+      scale: key.scale,
+      debugLabel: key.url,
+    );
+  }
+
+  Future<ui.Codec> _load(HttpCacheImage key, ImageDecoderCallback decode) async {
+    final uri = Uri.parse(key.url);
+    try {
+      final response = await HttpCache.instance.client.get(uri);
+      if (response.statusCode != 200 || response.bodyBytes.isEmpty) {
+        throw NetworkImageLoadException(statusCode: response.statusCode, uri: uri);
+      }
+      return decode(await ui.ImmutableBuffer.fromUint8List(response.bodyBytes));
+    } catch (e) {
+      // Let a later frame retry instead of caching the failure
+      scheduleMicrotask(() => PaintingBinding.instance.imageCache.evict(key));
+      rethrow;
+    }
+  }
+
+  @override
+  bool operator ==(Object other) =>
+      other is HttpCacheImage && other.url == url && other.scale == scale;
+
+  @override
+  int get hashCode => Object.hash(url, scale);
+
+  @override
+  String toString() => 'HttpCacheImage("$url", scale: $scale)';
+}
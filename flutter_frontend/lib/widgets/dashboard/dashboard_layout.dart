@@ -7,9 +7,11 @@ import '../todo_widget/todo_widget.dart';
 import '../mail_widget/mail_widget.dart';
 import '../stream_widget/video_stream_widget.dart';
 import '../common/glass_card.dart';
+import '../../core/services/idle_scheduler.dart';
 import '../../core/theme/dark_theme.dart';
 import '../../firebase/firebase_service.dart';
 import '../../repositories/repository_provider.dart';
+import '../../services/dashboard_config_service.dart';
 
 // PERFORMANCE OPTIMIZATIONS:
 // 1. RepaintBoundary widgets isolate expensive repaints during scrolling
@@ -45,6 +47,8 @@ typedef DashboardLayoutState = _DashboardLayoutState;
 
 class _DashboardLayoutState extends State<DashboardLayout> 
     with TickerProviderStateMixin {
+  /// Every widget the dashboard can show; the local config may pick and
+  /// reorder them
   final List<WidgetConfig> _widgets = const [
     WidgetConfig(
       id: 'news', 
@@ -78,6 +82,10 @@ class _DashboardLayoutState extends State<DashboardLayout>
     ),
   ];
   
+  // Increased refresh interval from 30 seconds to 2 minutes to reduce interference
+  static const Duration _defaultUpdateInterval = Duration(minutes: 2);
+
+  final DashboardConfigService _config = DashboardConfigService.instance;
   Timer? _updateTimer;
   late AnimationController _slideAnimationController;
   late Animation<Offset> _slideAnimation;
@@ -106,6 +114,8 @@ class _DashboardLayoutState extends State<DashboardLayout>
     
     _initializeBackend();
     _startPeriodicUpdates();
+    _config.widgets.addListener(_onLayoutChanged);
+    _config.refresh.addListener(_onRefreshPolicyChanged);
     
     // Start slide animation
     _slideAnimationController.forward();
@@ -138,10 +148,27 @@ class _DashboardLayoutState extends State<DashboardLayout>
     }
   }
 
+  void _onLayoutChanged() {
+    if (mounted) setState(() {});
+  }
+
+  void _onRefreshPolicyChanged() {
+    // A paused timer picks the new interval up when scrolling ends
+    if (_updateTimer != null) _startPeriodicUpdates();
+  }
+
+  /// The configured widgets in their configured order, unknown ids skipped
+  List<WidgetConfig> get _visibleWidgets {
+    final ids = _config.widgets.value;
+    if (ids == null) return _widgets;
+    final byId = {for (final widget in _widgets) widget.id: widget};
+    return [for (final id in ids) if (byId[id] != null) byId[id]!];
+  }
+
   void _startPeriodicUpdates() {
     _updateTimer?.cancel();
-    // Increased refresh interval from 30 seconds to 2 minutes to reduce interference
-    _updateTimer = Timer.periodic(const Duration(minutes: 2), (_) {
+    final interval = _config.refresh.value.dashboard ?? _defaultUpdateInterval;
+    _updateTimer = Timer.periodic(interval, (_) {
       if (mounted && !_isScrolling && !_isRefreshing) {
         // Only refresh if not currently scrolling and enough time has passed
         final timeSinceLastScroll = DateTime.now().difference(_lastScrollTime);
@@ -209,9 +236,12 @@ class _DashboardLayoutState extends State<DashboardLayout>
 
   @override
   void dispose() {
+    _config.widgets.removeListener(_onLayoutChanged);
+    _config.refresh.removeListener(_onRefreshPolicyChanged);
     _updateTimer?.cancel();
     _debounceTimer?.cancel();
     _scrollEndTimer?.cancel();
+    IdleScheduler.instance.releaseBusy(this);
     _slideAnimationController.dispose();
     _refreshController.close();
     // No need to shutdown Firebase services as they are managed globally
@@ -222,8 +252,9 @@ class _DashboardLayoutState extends State<DashboardLayout>
   void _onScrollStart() {
     _isScrolling = true;
     _lastScrollTime = DateTime.now();
-    // Pause periodic updates during scrolling
+    // Pause periodic updates and deferred housekeeping during scrolling
     _pausePeriodicUpdates();
+    IdleScheduler.instance.holdBusy(this);
     // Cancel any pending scroll end timer to debounce rapid scroll gestures
     _scrollEndTimer?.cancel();
   }
@@ -233,6 +264,7 @@ class _DashboardLayoutState extends State<DashboardLayout>
     // Debounce scroll end to avoid rapid pause/resume cycles
     _scrollEndTimer?.cancel();
     _scrollEndTimer = Timer(const Duration(seconds: 1), () {
+      IdleScheduler.instance.releaseBusy(this);
       if (mounted) {
         _isScrolling = false;
         // Resume periodic updates after a delay to avoid immediate refresh
@@ -274,9 +306,10 @@ class _DashboardLayoutState extends State<DashboardLayout>
         );
     }
 
-    // Optimized widget wrapping with reduced animation complexity
+    // Optimized widget wrapping with reduced animation complexity. Keyed by
+    // id alone so a reordered layout keeps each widget's state.
     return RepaintBoundary(
-      key: ValueKey('widget_${cfg.id}_$index'),
+      key: ValueKey('widget_${cfg.id}'),
       child: AnimatedOpacity(
         duration: const Duration(milliseconds: 200), // Reduced animation duration
         opacity: _isInitialized ? 1.0 : 0.7,
@@ -344,6 +377,7 @@ class _DashboardLayoutState extends State<DashboardLayout>
                   crossAxisCount = 1;
                   childAspectRatio = 0.8;
                 }
+                final widgets = _visibleWidgets;
 
                 return Stack(
                   children: [
@@ -369,8 +403,13 @@ class _DashboardLayoutState extends State<DashboardLayout>
                             crossAxisSpacing: 20,
                             mainAxisSpacing: 20,
                           ),
-                          itemCount: _widgets.length,
-                          itemBuilder: (context, index) => _buildWidget(_widgets[index], index),
+                          itemCount: widgets.length,
+                          itemBuilder: (context, index) => _buildWidget(widgets[index], index),
+                          findChildIndexCallback: (key) {
+                            final index = widgets.indexWhere(
+                                (widget) => key == ValueKey('widget_${widget.id}'));
+                            return index < 0 ? null : index;
+                          },
                           // Dynamic cache extent based on screen height for optimal performance
                           cacheExtent: constraints.maxHeight * 1.5,
                           // Optimize memory usage for off-screen widgets
@@ -1,8 +1,10 @@
+import 'dart:async';
 import 'package:flutter/material.dart';
 import 'package:provider/provider.dart';
 import '../common/glass_card.dart';
 import '../../core/theme/dark_theme.dart';
 import '../../firebase/firebase_service.dart';
+import '../../services/mail_sync_engine.dart';
 
 class MailWidget extends StatefulWidget {
   const MailWidget({super.key});
@@ -11,8 +13,8 @@ class MailWidget extends StatefulWidget {
   State<MailWidget> createState() => _MailWidgetState();
 }
 
-// Enhanced mock mail message for demonstration
-class MockMailMessage {
+/// A message row, from the IMAP index or the demo data
+class MailMessage {
   final String id;
   final String from;
   final String subject;
@@ -21,7 +23,7 @@ class MockMailMessage {
   final DateTime receivedAt;
   final String category;
   
-  const MockMailMessage({
+  const MailMessage({
     required this.id,
     required this.from,
     required this.subject,
@@ -30,6 +32,17 @@ class MockMailMessage {
     required this.receivedAt,
     this.category = 'inbox',
   });
+
+  factory MailMessage.fromSummary(MailSummary summary) {
+    return MailMessage(
+      id: summary.uid.toString(),
+      from: summary.from,
+      subject: summary.subject,
+      preview: summary.snippet,
+      read: summary.seen,
+      receivedAt: summary.receivedAt,
+    );
+  }
   
   String getTimeAgo() {
     final now = DateTime.now();
@@ -48,14 +61,20 @@ class MockMailMessage {
 }
 
 class _MailWidgetState extends State<MailWidget> {
-  List<MockMailMessage> _mailMessages = [];
+  List<MailMessage> _mailMessages = [];
   final TextEditingController _accountController = TextEditingController();
   bool _isLoading = false;
   String? _error;
   String _currentAccount = 'demo@example.com';
 
+  /// Server-side unread count when synced over IMAP; it covers messages
+  /// beyond the local index
+  int? _serverUnread;
+  StreamSubscription<MailboxSnapshot>? _mailSubscription;
+
   @override
   void dispose() {
+    _mailSubscription?.cancel();
     _accountController.dispose();
     super.dispose();
   }
@@ -63,7 +82,42 @@ class _MailWidgetState extends State<MailWidget> {
   @override
   void initState() {
     super.initState();
-    _loadMockMail();
+    if (MailSyncEngine.isConfigured) {
+      _startSync();
+    } else {
+      _loadMockMail();
+    }
+  }
+
+  /// Show the saved index right away and follow the sync engine's pushes
+  void _startSync() {
+    final engine = MailSyncEngine.instance;
+    _currentAccount = engine.account;
+    _isLoading = true;
+    _mailSubscription = engine.changes.listen(_applySnapshot);
+    final snapshot = engine.snapshot;
+    if (snapshot.messages.isNotEmpty || snapshot.syncedAt != null) _takeSnapshot(snapshot);
+    engine.start();
+  }
+
+  void _applySnapshot(MailboxSnapshot snapshot) {
+    if (!mounted) return;
+    setState(() => _takeSnapshot(snapshot));
+  }
+
+  void _takeSnapshot(MailboxSnapshot snapshot) {
+    _mailMessages = snapshot.messages.map(MailMessage.fromSummary).toList();
+    _serverUnread = snapshot.unread;
+    _isLoading = snapshot.messages.isEmpty && snapshot.syncedAt == null && snapshot.error == null;
+    _error = snapshot.error != null && !snapshot.connected ? 'Mail sync failed: ${snapshot.error}' : null;
+  }
+
+  Future<void> _reload() async {
+    if (MailSyncEngine.isConfigured) {
+      MailSyncEngine.instance.refresh();
+    } else {
+      await _loadMockMail();
+    }
   }
 
   Future<void> _loadMockMail() async {
@@ -99,13 +153,13 @@ class _MailWidgetState extends State<MailWidget> {
     }
   }
 
-  List<MockMailMessage> _generateMockMails(String userId) {
+  List<MailMessage> _generateMockMails(String userId) {
     // Generate consistent mock data based on user ID
     final baseTime = DateTime.now();
     final userSeed = userId.hashCode.abs();
     
     return [
-      MockMailMessage(
+      MailMessage(
         id: '1',
         from: 'Flutter Team',
         subject: 'Welcome to Modern Dashboard!',
@@ -113,7 +167,7 @@ class _MailWidgetState extends State<MailWidget> {
         read: userSeed % 3 == 0,
         receivedAt: baseTime.subtract(const Duration(hours: 2)),
       ),
-      MockMailMessage(
+      MailMessage(
         id: '2',
         from: 'Firebase Updates',
         subject: 'New Firebase Features Available',
@@ -121,7 +175,7 @@ class _MailWidgetState extends State<MailWidget> {
         read: userSeed % 2 == 0,
         receivedAt: baseTime.subtract(const Duration(hours: 6)),
       ),
-      MockMailMessage(
+      MailMessage(
         id: '3',
         from: 'System Notification',
         subject: 'Your data has been successfully migrated',
@@ -129,7 +183,7 @@ class _MailWidgetState extends State<MailWidget> {
         read: true,
         receivedAt: baseTime.subtract(const Duration(days: 1)),
       ),
-      MockMailMessage(
+      MailMessage(
         id: '4',
         from: 'Development Team',
         subject: 'Feature Request: Real Email Integration',
@@ -137,7 +191,7 @@ class _MailWidgetState extends State<MailWidget> {
         read: userSeed % 4 != 0,
         receivedAt: baseTime.subtract(const Duration(days: 2)),
       ),
-      MockMailMessage(
+      MailMessage(
         id: '5',
         from: 'Security Alert',
         subject: 'New device logged into your account',
@@ -148,12 +202,17 @@ class _MailWidgetState extends State<MailWidget> {
     ];
   }
 
-  Future<void> _toggleReadStatus(MockMailMessage message) async {
+  Future<void> _toggleReadStatus(MailMessage message) async {
+    if (MailSyncEngine.isConfigured) {
+      MailSyncEngine.instance.setSeen(int.parse(message.id), !message.read);
+      return;
+    }
+
     // Simulate toggling read status with Firebase storage
     setState(() {
       final index = _mailMessages.indexWhere((m) => m.id == message.id);
       if (index != -1) {
-        _mailMessages[index] = MockMailMessage(
+        _mailMessages[index] = MailMessage(
           id: message.id,
           from: message.from,
           subject: message.subject,
@@ -193,7 +252,7 @@ class _MailWidgetState extends State<MailWidget> {
     await _loadMockMail();
   }
 
-  int get _unreadCount => _mailMessages.where((m) => !m.read).length;
+  int get _unreadCount => _serverUnread ?? _mailMessages.where((m) => !m.read).length;
 
   @override
   Widget build(BuildContext context) {
@@ -262,7 +321,7 @@ class _MailWidgetState extends State<MailWidget> {
                   ),
                   const SizedBox(height: 16),
                   ElevatedButton(
-                    onPressed: _loadMockMail,
+                    onPressed: _reload,
                     style: ElevatedButton.styleFrom(
                       backgroundColor: const Color(0xFF8B5CF6),
                       foregroundColor: Colors.white,
@@ -292,43 +351,46 @@ class _MailWidgetState extends State<MailWidget> {
                   ),
                   textAlign: TextAlign.center,
                 ),
-                const SizedBox(height: 16),
-                Row(
-                  children: [
-                    Expanded(
-                      child: TextField(
-                        controller: _accountController,
-                        decoration: InputDecoration(
-                          hintText: 'Enter email account...',
-                          border: OutlineInputBorder(
-                            borderRadius: BorderRadius.circular(8),
-                            borderSide: const BorderSide(color: Color(0xFF334155)),
-                          ),
-                          enabledBorder: OutlineInputBorder(
-                            borderRadius: BorderRadius.circular(8),
-                            borderSide: const BorderSide(color: Color(0xFF334155)),
-                          ),
-                          focusedBorder: OutlineInputBorder(
-                            borderRadius: BorderRadius.circular(8),
-                            borderSide: const BorderSide(color: Color(0xFF8B5CF6)),
+                // The IMAP account comes from imap.json in the config directory
+                if (!MailSyncEngine.isConfigured) ...[
+                  const SizedBox(height: 16),
+                  Row(
+                    children: [
+                      Expanded(
+                        child: TextField(
+                          controller: _accountController,
+                          decoration: InputDecoration(
+                            hintText: 'Enter email account...',
+                            border: OutlineInputBorder(
+                              borderRadius: BorderRadius.circular(8),
+                              borderSide: const BorderSide(color: Color(0xFF334155)),
+                            ),
+                            enabledBorder: OutlineInputBorder(
+                              borderRadius: BorderRadius.circular(8),
+                              borderSide: const BorderSide(color: Color(0xFF334155)),
+                            ),
+                            focusedBorder: OutlineInputBorder(
+                              borderRadius: BorderRadius.circular(8),
+                              borderSide: const BorderSide(color: Color(0xFF8B5CF6)),
+                            ),
+                            contentPadding: const EdgeInsets.symmetric(horizontal: 12, vertical: 8),
                           ),
-                          contentPadding: const EdgeInsets.symmetric(horizontal: 12, vertical: 8),
+                          onSubmitted: (_) => _configureAccount(),
                         ),
-                        onSubmitted: (_) => _configureAccount(),
                       ),
-                    ),
-                    const SizedBox(width: 8),
-                    IconButton(
-                      onPressed: _configureAccount,
-                      icon: const Icon(Icons.settings_rounded),
-                      style: IconButton.styleFrom(
-                        backgroundColor: const Color(0xFF8B5CF6),
-                        foregroundColor: Colors.white,
-                        padding: const EdgeInsets.all(8),
+                      const SizedBox(width: 8),
+                      IconButton(
+                        onPressed: _configureAccount,
+                        icon: const Icon(Icons.settings_rounded),
+                        style: IconButton.styleFrom(
+                          backgroundColor: const Color(0xFF8B5CF6),
+                          foregroundColor: Colors.white,
+                          padding: const EdgeInsets.all(8),
+                        ),
                       ),
-                    ),
-                  ],
-                ),
+                    ],
+                  ),
+                ],
               ],
             );
           }
@@ -372,7 +434,7 @@ class _MailWidgetState extends State<MailWidget> {
                       ),
                     const SizedBox(width: 8),
                     IconButton(
-                      onPressed: _loadMockMail,
+                      onPressed: _reload,
                       icon: const Icon(Icons.refresh_rounded),
                       iconSize: 18,
                       style: IconButton.styleFrom(
@@ -1,11 +1,15 @@
+import 'dart:async';
 import 'package:flutter/material.dart';
 import 'package:provider/provider.dart';
 import 'package:url_launcher/url_launcher.dart';
 import '../common/glass_card.dart';
+import '../common/http_cache_image.dart';
 import '../../core/theme/dark_theme.dart';
 import '../../core/exceptions/feed_validation_exception.dart';
 import '../../core/services/cors_proxy_service.dart';
+import '../../core/services/idle_scheduler.dart';
 import '../../repositories/repository_provider.dart';
+import '../../services/dashboard_config_service.dart';
 import '../../models/rss_feed.dart';
 import '../../services/rss_service.dart';
 import 'rss_feed_management_dialog.dart';
@@ -27,14 +31,20 @@ class _EnhancedNewsWidgetState extends State<EnhancedNewsWidget> {
   String _selectedCategory = 'All';
   FeedValidationException? _lastValidationError;
 
+  /// Thumbnails from the top of the list decoded ahead of scrolling
+  static const int _predecodeCount = 24;
+
   @override
   void initState() {
     super.initState();
     _loadData();
+    // Feeds added or dropped in the local config show up without a restart
+    DashboardConfigService.instance.feeds.addListener(_loadData);
   }
 
   @override
   void dispose() {
+    DashboardConfigService.instance.feeds.removeListener(_loadData);
     _quickAddController.dispose();
     super.dispose();
   }
@@ -65,6 +75,7 @@ class _EnhancedNewsWidgetState extends State<EnhancedNewsWidget> {
           _articles = results[1] as List<NewsArticle>;
           _isLoading = false;
         });
+        _predecodeThumbnails();
       }
     } catch (e) {
       if (mounted) {
@@ -76,6 +87,27 @@ class _EnhancedNewsWidgetState extends State<EnhancedNewsWidget> {
     }
   }
 
+  /// Fetch and decode upcoming thumbnails while the UI is idle, a few per
+  /// slice, so scrolling to them does not wait on the network or the codec
+  void _predecodeThumbnails() {
+    List<String>? urls;
+    var next = 0;
+    unawaited(IdleScheduler.instance.schedule('EnhancedNewsWidget.thumbnails', (deadline) {
+      if (!mounted) return true;
+      // Read when the task starts, so a queued task sees the latest list
+      urls ??= _filteredArticles
+          .map((article) => article.imageUrl)
+          .whereType<String>()
+          .take(_predecodeCount)
+          .toList();
+      while (next < urls!.length && !deadline.didTimeout) {
+        precacheImage(HttpCacheImage.provider(urls![next++]), context,
+            size: const Size(60, 60), onError: (_, __) {});
+      }
+      return next >= urls!.length;
+    }));
+  }
+
   Future<void> _refreshNews() async {
     if (_isRefreshing || !mounted) return;
     
@@ -98,6 +130,7 @@ class _EnhancedNewsWidgetState extends State<EnhancedNewsWidget> {
           _articles = articles;
           _isRefreshing = false;
         });
+        _predecodeThumbnails();
       }
     } catch (e) {
       if (mounted) {
@@ -628,8 +661,8 @@ class _EnhancedNewsWidgetState extends State<EnhancedNewsWidget> {
               child: article.imageUrl != null
                   ? ClipRRect(
                       borderRadius: BorderRadius.circular(8),
-                      child: Image.network(
-                        article.imageUrl!,
+                      child: Image(
+                        image: HttpCacheImage.provider(article.imageUrl!),
                         width: 60,
                         height: 60,
                         fit: BoxFit.cover,
@@ -3,6 +3,8 @@ import 'package:provider/provider.dart';
 import '../../core/theme/dark_theme.dart';
 import '../../repositories/repository_provider.dart';
 import '../../models/rss_feed.dart';
+import '../../services/article_store.dart';
+import '../../services/feed_health_service.dart';
 import '../../services/rss_service.dart';
 
 class RSSFeedManagementDialog extends StatefulWidget {
@@ -27,6 +29,7 @@ class _RSSFeedManagementDialogState extends State<RSSFeedManagementDialog> {
   String? _error;
   RSSFeed? _editingFeed;
   bool _showAddForm = false;
+  bool _rankByHealth = false;
 
   @override
   void initState() {
@@ -109,6 +112,10 @@ class _RSSFeedManagementDialogState extends State<RSSFeedManagementDialog> {
         );
 
         await repositoryProvider.rssFeedRepository.updateFeed(updatedFeed);
+        if (updatedFeed.url != _editingFeed!.url) {
+          FeedHealthService.instance.forget(updatedFeed.id);
+          ArticleStore.instance.removeFeed(updatedFeed.id);
+        }
         
         final index = _feeds.indexWhere((f) => f.id == _editingFeed!.id);
         if (index != -1) {
@@ -155,6 +162,8 @@ class _RSSFeedManagementDialogState extends State<RSSFeedManagementDialog> {
     try {
       final repositoryProvider = Provider.of<RepositoryProvider>(context, listen: false);
       await repositoryProvider.rssFeedRepository.deleteFeed(feed.id);
+      FeedHealthService.instance.forget(feed.id);
+      ArticleStore.instance.removeFeed(feed.id);
       
       setState(() {
         _feeds.removeWhere((f) => f.id == feed.id);
@@ -267,7 +276,21 @@ class _RSSFeedManagementDialogState extends State<RSSFeedManagementDialog> {
                       ),
                     ),
                   ),
-                  if (!_showAddForm)
+                  if (!_showAddForm && _feeds.length > 1)
+                    IconButton(
+                      onPressed: () => setState(() => _rankByHealth = !_rankByHealth),
+                      icon: const Icon(Icons.leaderboard_rounded),
+                      style: IconButton.styleFrom(
+                        foregroundColor: _rankByHealth
+                            ? DarkThemeData.accentColor
+                            : Colors.white.withValues(alpha: 0.7),
+                        padding: const EdgeInsets.all(8),
+                        minimumSize: const Size(36, 36),
+                      ),
+                      tooltip: _rankByHealth ? 'Show in saved order' : 'Rank by health, worst first',
+                    ),
+                  if (!_showAddForm) ...[
+                    const SizedBox(width: 8),
                     IconButton(
                       onPressed: _showAddFeedForm,
                       icon: const Icon(Icons.add_rounded),
@@ -279,6 +302,7 @@ class _RSSFeedManagementDialogState extends State<RSSFeedManagementDialog> {
                       ),
                       tooltip: 'Add RSS Feed',
                     ),
+                  ],
                   const SizedBox(width: 8),
                   IconButton(
                     onPressed: () => Navigator.of(context).pop(true),
@@ -604,16 +628,24 @@ class _RSSFeedManagementDialogState extends State<RSSFeedManagementDialog> {
       );
     }
 
+    final health = FeedHealthService.instance;
+    final feeds = List<RSSFeed>.from(_feeds);
+    if (_rankByHealth) {
+      // Feeds without history have no score yet and go last
+      double score(RSSFeed feed) => health.healthOf(feed.id)?.score ?? double.infinity;
+      feeds.sort((a, b) => score(a).compareTo(score(b)));
+    }
+
     return ListView.separated(
       padding: const EdgeInsets.all(20),
-      itemCount: _feeds.length,
+      itemCount: feeds.length,
       separatorBuilder: (context, index) => Divider(
         height: 1,
         thickness: 0.5,
         color: Colors.white.withValues(alpha: 0.1),
       ),
       itemBuilder: (context, index) {
-        final feed = _feeds[index];
+        final feed = feeds[index];
         return Container(
           padding: const EdgeInsets.symmetric(vertical: 16),
           child: Row(
@@ -679,6 +711,7 @@ class _RSSFeedManagementDialogState extends State<RSSFeedManagementDialog> {
                         fontSize: 12,
                       ),
                     ),
+                    _buildHealthLine(feed),
                   ],
                 ),
               ),
@@ -715,6 +748,74 @@ class _RSSFeedManagementDialogState extends State<RSSFeedManagementDialog> {
     );
   }
 
+  /// Score, state and fetch figures of [feed], once it has been fetched
+  Widget _buildHealthLine(RSSFeed feed) {
+    final health = FeedHealthService.instance.healthOf(feed.id);
+    if (health == null) return const SizedBox.shrink();
+
+    final now = DateTime.now();
+    final state = health.state(now);
+    final color = switch (state) {
+      FeedHealthState.healthy => DarkThemeData.accentColor,
+      FeedHealthState.demoted => Colors.orange,
+      FeedHealthState.quarantined => DarkThemeData.errorColor,
+    };
+    final details = [
+      '${(health.successRate * 100).round()}% ok',
+      if (health.p50LatencyMs != null) 'p50 ${health.p50LatencyMs}ms / p95 ${health.p95LatencyMs}ms',
+      '${(health.payloadBytes / 1024).round()} KB',
+      '${health.freshnessYield.toStringAsFixed(1)} new/fetch',
+      if (state == FeedHealthState.quarantined)
+        'retry in ${health.quarantinedUntil!.difference(now).inMinutes + 1}m',
+      if (health.lastError != null) 'last error: ${health.lastError}',
+    ].join(' · ');
+
+    return Padding(
+      padding: const EdgeInsets.only(top: 6),
+      child: Row(
+        children: [
+          Container(
+            padding: const EdgeInsets.symmetric(horizontal: 6, vertical: 2),
+            decoration: BoxDecoration(
+              color: color.withValues(alpha: 0.2),
+              borderRadius: BorderRadius.circular(4),
+            ),
+            child: Text(
+              '${state.label} ${health.score.round()}',
+              style: TextStyle(
+                color: color,
+                fontSize: 10,
+                fontWeight: FontWeight.w500,
+              ),
+            ),
+          ),
+          const SizedBox(width: 8),
+          Expanded(
+            child: Text(
+              details,
+              style: TextStyle(
+                color: Colors.white.withValues(alpha: 0.5),
+                fontSize: 11,
+              ),
+              maxLines: 1,
+              overflow: TextOverflow.ellipsis,
+            ),
+          ),
+          if (state != FeedHealthState.healthy)
+            TextButton(
+              onPressed: () => setState(() => FeedHealthService.instance.retryNow(feed.id)),
+              style: TextButton.styleFrom(
+                padding: const EdgeInsets.symmetric(horizontal: 8),
+                minimumSize: const Size(0, 24),
+                textStyle: const TextStyle(fontSize: 11),
+              ),
+              child: const Text('Retry now'),
+            ),
+        ],
+      ),
+    );
+  }
+
   String _getTimeAgo(DateTime dateTime) {
     final now = DateTime.now();
     final difference = now.difference(dateTime);
@@ -113,6 +113,8 @@ class _VideoStreamManagementDialogState extends State<VideoStreamManagementDialo
           finalType = StreamTypes.twitch;
         } else if (url.endsWith('.m3u8')) {
           finalType = StreamTypes.hls;
+        } else if (url.endsWith('.mpd')) {
+          finalType = StreamTypes.dash;
         } else if (url.contains('rtmp://')) {
           finalType = StreamTypes.rtmp;
         }
@@ -553,6 +555,10 @@ class _VideoStreamManagementDialogState extends State<VideoStreamManagementDialo
                 value: StreamTypes.hls,
                 child: Text('HLS (.m3u8)', style: TextStyle(color: Colors.white)),
               ),
+              DropdownMenuItem(
+                value: StreamTypes.dash,
+                child: Text('DASH (.mpd)', style: TextStyle(color: Colors.white)),
+              ),
               DropdownMenuItem(
                 value: StreamTypes.rtmp,
                 child: Text('RTMP', style: TextStyle(color: Colors.white)),
@@ -767,6 +773,7 @@ class _VideoStreamManagementDialogState extends State<VideoStreamManagementDialo
       case StreamTypes.twitch:
         return const Color(0xFF9146FF);
       case StreamTypes.hls:
+      case StreamTypes.dash:
         return const Color(0xFF00BCD4);
       case StreamTypes.rtmp:
         return const Color(0xFFFF9800);
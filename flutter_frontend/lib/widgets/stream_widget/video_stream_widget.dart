@@ -1,11 +1,16 @@
+import 'dart:async';
 import 'package:flutter/material.dart';
 import 'package:provider/provider.dart';
 import 'package:url_launcher/url_launcher.dart';
-import 'package:cached_network_image/cached_network_image.dart';
 import '../common/glass_card.dart';
+import '../common/http_cache_image.dart';
 import '../../core/theme/dark_theme.dart';
+import '../../core/utils/stream_manifest.dart';
 import '../../repositories/repository_provider.dart';
 import '../../models/video_stream.dart';
+import '../../services/stream_snapshot_service.dart';
+import '../../services/stream_status_engine.dart';
+import '../../services/video_stream_service.dart';
 import 'video_stream_management_dialog.dart';
 
 class VideoStreamWidget extends StatefulWidget {
@@ -22,19 +27,50 @@ class _VideoStreamWidgetState extends State<VideoStreamWidget> {
   bool _isRefreshing = false;
   String? _error;
   String _selectedCategory = 'All';
+  final Map<String, StreamManifest?> _manifests = {};
+  StreamSubscription<StreamStatusChange>? _statusSubscription;
+  Timer? _snapshotTimer;
+
+  /// Physical height of a grid tile, known after the first layout
+  double? _tileHeightPixels;
 
   @override
   void initState() {
     super.initState();
+    _statusSubscription = StreamStatusEngine.instance.changes.listen(_onStatusChange);
+    if (StreamSnapshotService.instance.isAvailable) {
+      _snapshotTimer =
+          Timer.periodic(StreamSnapshotService.refreshInterval, (_) => _refreshSnapshots());
+    }
     _loadData();
   }
 
   @override
   void dispose() {
+    _statusSubscription?.cancel();
+    _snapshotTimer?.cancel();
     _quickAddController.dispose();
     super.dispose();
   }
 
+  /// Apply a live flip or new metadata pushed by the status engine
+  void _onStatusChange(StreamStatusChange change) {
+    if (!mounted) return;
+    final index = _streams.indexWhere((s) => s.url == change.url);
+    if (index < 0) return;
+    setState(() {
+      _streams[index] = _withStatus(_streams[index], change.status);
+    });
+  }
+
+  VideoStream _withStatus(VideoStream stream, StreamStatus? status) {
+    if (status == null) return stream;
+    return stream.copyWith(
+      isLive: status.isLive ?? stream.isLive,
+      thumbnailUrl: stream.thumbnailUrl ?? status.thumbnailUrl,
+    );
+  }
+
   Future<void> _loadData() async {
     if (!mounted) return;
     
@@ -50,12 +86,17 @@ class _VideoStreamWidgetState extends State<VideoStreamWidget> {
       }
 
       final streams = await repositoryProvider.videoStreamRepository.getStreams();
+      final engine = StreamStatusEngine.instance..attach(repositoryProvider.videoStreamRepository);
 
       if (mounted) {
         setState(() {
-          _streams = streams;
+          // Show cached liveness right away; the engine pushes flips later
+          _streams = [for (final stream in streams) _withStatus(stream, engine.statusOf(stream.url))];
           _isLoading = false;
         });
+        _loadManifests();
+        _refreshSnapshots();
+        unawaited(engine.track(streams));
       }
     } catch (e) {
       if (mounted) {
@@ -67,6 +108,42 @@ class _VideoStreamWidgetState extends State<VideoStreamWidget> {
     }
   }
 
+  /// Parse the manifests of adaptive streams so each tile can pick a
+  /// rendition for its size
+  void _loadManifests() {
+    for (final stream in _streams) {
+      if (!stream.isAdaptive || _manifests.containsKey(stream.url)) continue;
+      _manifests[stream.url] = null;
+      VideoStreamService.loadManifest(stream.url).then((manifest) {
+        if (!mounted) return;
+        // Forget failures so the next load tries again
+        if (manifest == null) {
+          _manifests.remove(stream.url);
+          return;
+        }
+        setState(() => _manifests[stream.url] = manifest);
+      });
+    }
+  }
+
+  /// Capture frames for HLS tiles without a provider thumbnail: live
+  /// streams on every refresh, others once
+  void _refreshSnapshots() {
+    final height = _tileHeightPixels;
+    final snapshots = StreamSnapshotService.instance;
+    if (!mounted || height == null || !snapshots.isAvailable) return;
+    for (final stream in _filteredStreams) {
+      if (!snapshots.supports(stream)) continue;
+      final previous = snapshots.cached(stream.url);
+      if (!stream.isLive && previous != null) continue;
+      snapshots.snapshot(stream, heightPixels: height).then((snapshot) {
+        if (mounted && snapshot != null && !identical(snapshot, previous)) {
+          setState(() {});
+        }
+      });
+    }
+  }
+
   Future<void> _refreshStreams() async {
     if (_isRefreshing || !mounted) return;
     
@@ -117,6 +194,8 @@ class _VideoStreamWidgetState extends State<VideoStreamWidget> {
         streamType = StreamTypes.twitch;
       } else if (url.endsWith('.m3u8')) {
         streamType = StreamTypes.hls;
+      } else if (url.endsWith('.mpd')) {
+        streamType = StreamTypes.dash;
       }
 
       final newStream = VideoStream(
@@ -187,9 +266,11 @@ class _VideoStreamWidgetState extends State<VideoStreamWidget> {
     }
   }
 
-  Future<void> _openStream(VideoStream stream) async {
+  /// Open [stream] in the system player, at the [variant] its tile shows
+  /// when one was picked
+  Future<void> _openStream(VideoStream stream, [StreamVariant? variant]) async {
     try {
-      final uri = Uri.parse(stream.url);
+      final uri = variant?.uri ?? Uri.parse(stream.url);
       if (await canLaunchUrl(uri)) {
         await launchUrl(uri, mode: LaunchMode.externalApplication);
       } else {
@@ -508,24 +589,57 @@ class _VideoStreamWidgetState extends State<VideoStreamWidget> {
   }
 
   Widget _buildStreamsGrid() {
+    const crossAxisCount = 2;
+    const spacing = 12.0;
+    const aspectRatio = 16 / 10;
+    final streams = _filteredStreams;
+    // Adaptive streams on screen share the measured bandwidth
+    final adaptiveCount = streams.where((s) => _manifests[s.url] != null).length;
+
     return Expanded(
-      child: GridView.builder(
-        physics: const BouncingScrollPhysics(),
-        gridDelegate: const SliverGridDelegateWithFixedCrossAxisCount(
-          crossAxisCount: 2,
-          childAspectRatio: 16 / 10,
-          crossAxisSpacing: 12,
-          mainAxisSpacing: 12,
-        ),
-        itemCount: _filteredStreams.length,
-        itemBuilder: (context, index) => _buildStreamCard(_filteredStreams[index]),
+      child: LayoutBuilder(
+        builder: (context, constraints) {
+          final tileWidth = (constraints.maxWidth - spacing * (crossAxisCount - 1)) / crossAxisCount;
+          final tileHeightPixels =
+              tileWidth / aspectRatio * MediaQuery.of(context).devicePixelRatio;
+          final firstLayout = _tileHeightPixels == null;
+          _tileHeightPixels = tileHeightPixels;
+          if (firstLayout) {
+            WidgetsBinding.instance.addPostFrameCallback((_) => _refreshSnapshots());
+          }
+
+          return GridView.builder(
+            physics: const BouncingScrollPhysics(),
+            gridDelegate: const SliverGridDelegateWithFixedCrossAxisCount(
+              crossAxisCount: crossAxisCount,
+              childAspectRatio: aspectRatio,
+              crossAxisSpacing: spacing,
+              mainAxisSpacing: spacing,
+            ),
+            itemCount: streams.length,
+            itemBuilder: (context, index) {
+              final stream = streams[index];
+              final manifest = _manifests[stream.url];
+              final variant = manifest == null
+                  ? null
+                  : VideoStreamService.selectVariant(
+                      stream,
+                      manifest,
+                      tileHeightPixels: tileHeightPixels,
+                      concurrentStreams: adaptiveCount,
+                    );
+              return _buildStreamCard(stream, variant);
+            },
+          );
+        },
       ),
     );
   }
 
-  Widget _buildStreamCard(VideoStream stream) {
+  Widget _buildStreamCard(VideoStream stream, [StreamVariant? variant]) {
+    final snapshot = StreamSnapshotService.instance.cached(stream.url);
     return InkWell(
-      onTap: () => _openStream(stream),
+      onTap: () => _openStream(stream, variant),
       borderRadius: BorderRadius.circular(12),
       child: Container(
         decoration: BoxDecoration(
@@ -545,22 +659,33 @@ class _VideoStreamWidgetState extends State<VideoStreamWidget> {
           child: Stack(
             children: [
               // Thumbnail/background
-              if (stream.thumbnailUrl != null)
+              if (snapshot != null)
                 Positioned.fill(
-                  child: CachedNetworkImage(
-                    imageUrl: stream.thumbnailUrl!,
+                  child: Image.memory(
+                    snapshot.jpeg,
                     fit: BoxFit.cover,
-                    placeholder: (context, url) => Container(
-                      color: DarkThemeData.accentColor.withValues(alpha: 0.1),
-                      child: Center(
-                        child: Icon(
-                          _getStreamTypeIcon(stream.type),
-                          color: DarkThemeData.accentColor.withValues(alpha: 0.5),
-                          size: 32,
+                    gaplessPlayback: true,
+                  ),
+                )
+              else if (stream.thumbnailUrl != null)
+                Positioned.fill(
+                  child: Image(
+                    image: HttpCacheImage.provider(stream.thumbnailUrl!),
+                    fit: BoxFit.cover,
+                    frameBuilder: (context, child, frame, wasSynchronouslyLoaded) {
+                      if (frame != null || wasSynchronouslyLoaded) return child;
+                      return Container(
+                        color: DarkThemeData.accentColor.withValues(alpha: 0.1),
+                        child: Center(
+                          child: Icon(
+                            _getStreamTypeIcon(stream.type),
+                            color: DarkThemeData.accentColor.withValues(alpha: 0.5),
+                            size: 32,
+                          ),
                         ),
-                      ),
-                    ),
-                    errorWidget: (context, url, error) => Container(
+                      );
+                    },
+                    errorBuilder: (context, error, stackTrace) => Container(
                       color: DarkThemeData.accentColor.withValues(alpha: 0.1),
                       child: Center(
                         child: Icon(
@@ -662,6 +787,28 @@ class _VideoStreamWidgetState extends State<VideoStreamWidget> {
                             ),
                           ),
                         ),
+                        if (variant != null) ...[
+                          const SizedBox(width: 4),
+                          Tooltip(
+                            message: '${variant.bandwidth ~/ 1000} kbps'
+                                '${variant.codecs != null ? ', ${variant.codecs}' : ''}',
+                            child: Container(
+                              padding: const EdgeInsets.symmetric(horizontal: 4, vertical: 2),
+                              decoration: BoxDecoration(
+                                color: Colors.white.withValues(alpha: 0.15),
+                                borderRadius: BorderRadius.circular(3),
+                              ),
+                              child: Text(
+                                variant.label,
+                                style: const TextStyle(
+                                  color: Colors.white,
+                                  fontSize: 9,
+                                  fontWeight: FontWeight.w500,
+                                ),
+                              ),
+                            ),
+                          ),
+                        ],
                         const SizedBox(width: 6),
                         Expanded(
                           child: Text(
@@ -710,6 +857,7 @@ class _VideoStreamWidgetState extends State<VideoStreamWidget> {
       case StreamTypes.twitch:
         return Icons.videocam_rounded;
       case StreamTypes.hls:
+      case StreamTypes.dash:
         return Icons.live_tv_rounded;
       case StreamTypes.rtmp:
         return Icons.cast_rounded;
@@ -725,6 +873,7 @@ class _VideoStreamWidgetState extends State<VideoStreamWidget> {
       case StreamTypes.twitch:
         return const Color(0xFF9146FF);
       case StreamTypes.hls:
+      case StreamTypes.dash:
         return const Color(0xFF00BCD4);
       case StreamTypes.rtmp:
         return const Color(0xFFFF9800);
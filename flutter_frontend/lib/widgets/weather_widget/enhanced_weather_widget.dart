@@ -1,6 +1,7 @@
 import 'package:flutter/material.dart';
 import 'package:provider/provider.dart';
 import '../common/glass_card.dart';
+import '../common/http_cache_image.dart';
 import '../../core/theme/dark_theme.dart';
 import '../../repositories/repository_provider.dart';
 import '../../models/weather.dart';
@@ -144,8 +145,8 @@ class _EnhancedWeatherWidgetState extends State<EnhancedWeatherWidget> {
       ),
       child: ClipRRect(
         borderRadius: BorderRadius.circular(12),
-        child: Image.network(
-          _getWeatherIconUrl(iconCode),
+        child: Image(
+          image: HttpCacheImage.provider(_getWeatherIconUrl(iconCode)),
           width: 80,
           height: 80,
           fit: BoxFit.cover,
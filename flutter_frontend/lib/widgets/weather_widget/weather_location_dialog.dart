@@ -3,6 +3,7 @@ import 'package:provider/provider.dart';
 import '../../core/theme/dark_theme.dart';
 import '../../models/weather.dart';
 import '../../repositories/repository_provider.dart';
+import '../../services/gazetteer_service.dart';
 
 class WeatherLocationDialog extends StatefulWidget {
   final List<WeatherLocation> locations;
@@ -27,6 +28,7 @@ class _WeatherLocationDialogState extends State<WeatherLocationDialog> {
   void initState() {
     super.initState();
     _locations = List.from(widget.locations);
+    GazetteerService.instance.initialize();
   }
 
   @override
@@ -35,6 +37,16 @@ class _WeatherLocationDialogState extends State<WeatherLocationDialog> {
     super.dispose();
   }
 
+  /// Suggest places from the offline gazetteer as the user types
+  void _onQueryChanged(String text) {
+    final query = text.trim();
+    if (query.length < 2 || !GazetteerService.instance.isLoaded) return;
+    setState(() {
+      _error = null;
+      _searchResults = GazetteerService.instance.searchLocal(query);
+    });
+  }
+
   Future<void> _searchLocations() async {
     final query = _searchController.text.trim();
     if (query.isEmpty) return;
@@ -202,6 +214,7 @@ class _WeatherLocationDialogState extends State<WeatherLocationDialog> {
                       isDense: true,
                     ),
                     style: const TextStyle(color: Colors.white),
+                    onChanged: _onQueryChanged,
                     onSubmitted: (_) => _searchLocations(),
                   ),
                 ),
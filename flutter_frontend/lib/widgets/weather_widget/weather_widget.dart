@@ -1,9 +1,13 @@
+import 'dart:async';
 import 'package:flutter/material.dart';
 import 'package:provider/provider.dart';
 import '../common/glass_card.dart';
 import '../../core/theme/dark_theme.dart';
 import '../../models/weather.dart';
 import '../../repositories/repository_provider.dart';
+import '../../core/utils/time_series.dart';
+import '../../services/weather_history_store.dart';
+import '../../services/weather_refresh_engine.dart';
 
 class WeatherWidget extends StatefulWidget {
   const WeatherWidget({super.key});
@@ -17,47 +21,109 @@ class _WeatherWidgetState extends State<WeatherWidget> {
   String? _error;
   WeatherData? _currentWeather;
   bool _isLoadingWeather = false;
+  String _location = 'London'; // Default location
+  StreamSubscription<WeatherData>? _subscription;
+  StreamSubscription<List<WeatherData>>? _forecastSubscription;
+  List<TimeSeriesPoint> _trend = const [];
+  List<WeatherData> _forecast = const [];
+
+  /// Forecast entries shown under the current conditions
+  static const int _forecastEntries = 4;
+  static const List<String> _weekdays = ['Mon', 'Tue', 'Wed', 'Thu', 'Fri', 'Sat', 'Sun'];
 
   @override
   void dispose() {
+    _subscription?.cancel();
+    _forecastSubscription?.cancel();
     _locationController.dispose();
     super.dispose();
   }
 
+  /// Follow [location] through the shared refresh engine, which batches and
+  /// deduplicates refreshes across every weather card
   Future<void> _loadWeather([String? location]) async {
-    if (_isLoadingWeather) return;
-    
+    final weatherRepository = Provider.of<RepositoryProvider>(context, listen: false).weatherRepository;
+    final engine = WeatherRefreshEngine.instance..attach(weatherRepository);
+
+    // Use provided location or default location
+    final searchLocation = location ?? _location;
+    if (searchLocation == _location && _subscription != null) {
+      setState(() => _error = null);
+      engine.refreshNow(searchLocation);
+      return;
+    }
+
     setState(() {
       _isLoadingWeather = true;
       _error = null;
     });
 
-    try {
-      final weatherRepository = Provider.of<RepositoryProvider>(context, listen: false).weatherRepository;
-      
-      // Use provided location or default location
-      String searchLocation = location ?? 'London'; // Default location
-      
-      final weather = await weatherRepository.getCurrentWeather(searchLocation);
-      
-      setState(() {
-        _currentWeather = weather;
-        _isLoadingWeather = false;
-        _error = null;
-      });
-      
-      // Update user's location preference if a new location was searched
-      if (location != null && location.isNotEmpty) {
+    _location = searchLocation;
+    _forecast = const [];
+    await _subscription?.cancel();
+    await _forecastSubscription?.cancel();
+    _subscription = engine.watchCurrent(searchLocation).listen(
+      (weather) {
+        if (!mounted) return;
+        setState(() {
+          _currentWeather = weather;
+          _isLoadingWeather = false;
+          _error = null;
+        });
+        _loadTrend(searchLocation);
+      },
+      onError: (Object e) {
+        if (!mounted) return;
+        setState(() {
+          _isLoadingWeather = false;
+          _error = 'Failed to load weather: $e';
+        });
+      },
+    );
+    // The forecast is optional; a failed refresh keeps the last one
+    _forecastSubscription = engine.watchForecast(searchLocation).listen(
+      (forecast) {
+        if (!mounted) return;
+        setState(() => _forecast = forecast);
+      },
+      onError: (Object e) => debugPrint('WeatherWidget: Forecast refresh failed: $e'),
+    );
+
+    // Update user's location preference if a new location was searched
+    if (location != null && location.isNotEmpty) {
+      try {
         await weatherRepository.updateLocation(location);
+      } catch (e) {
+        debugPrint('WeatherWidget: Failed to save location: $e');
       }
-    } catch (e) {
-      setState(() {
-        _isLoadingWeather = false;
-        _error = 'Failed to load weather: $e';
-      });
     }
   }
 
+  /// Last 24 hours of temperatures, thinned to what the sparkline can show
+  Future<void> _loadTrend(String location) async {
+    final trend = await WeatherHistoryStore.instance.history(
+      location,
+      WeatherMetric.temperature,
+      maxPoints: 48,
+    );
+    if (!mounted || location != _location) return;
+    setState(() => _trend = trend);
+  }
+
+  /// The next few forecast entries as "15:00 12°C · 18:00 10°C", by hour
+  /// for today and by weekday after that
+  String? _forecastSummary() {
+    final now = DateTime.now();
+    final upcoming = _forecast.where((entry) => entry.timestamp.isAfter(now)).take(_forecastEntries);
+    if (upcoming.isEmpty) return null;
+    return upcoming.map((entry) {
+      final at = entry.timestamp.toLocal();
+      final sameDay = at.year == now.year && at.month == now.month && at.day == now.day;
+      final label = sameDay ? '${at.hour.toString().padLeft(2, '0')}:00' : _weekdays[at.weekday - 1];
+      return '$label ${entry.formattedTemperature}';
+    }).join(' · ');
+  }
+
   Future<void> _searchLocation() async {
     final location = _locationController.text.trim();
     if (location.isEmpty) return;
@@ -287,6 +353,15 @@ class _WeatherWidgetState extends State<WeatherWidget> {
                           color: DarkThemeData.warningColor,
                         ),
                       ),
+                      if (_forecastSummary() case final summary?) ...[
+                        const SizedBox(height: 4),
+                        Text(
+                          summary,
+                          style: Theme.of(context).textTheme.bodySmall,
+                          maxLines: 1,
+                          overflow: TextOverflow.ellipsis,
+                        ),
+                      ],
                     ],
                   ),
                 ),
@@ -334,6 +409,20 @@ class _WeatherWidgetState extends State<WeatherWidget> {
                             _currentWeather!.isRecent ? 'Live' : 'Cached',
                             style: Theme.of(context).textTheme.bodySmall,
                           ),
+                          if (_trend.length > 1) ...[
+                            const SizedBox(width: 8),
+                            Expanded(
+                              child: SizedBox(
+                                height: 16,
+                                child: CustomPaint(
+                                  painter: _TemperatureTrendPainter(
+                                    _trend,
+                                    DarkThemeData.warningColor,
+                                  ),
+                                ),
+                              ),
+                            ),
+                          ],
                         ],
                       ),
                     ],
@@ -346,4 +435,45 @@ class _WeatherWidgetState extends State<WeatherWidget> {
       ),
     );
   }
-}
\ No newline at end of file
+}
+
+/// 24-hour temperature sparkline
+class _TemperatureTrendPainter extends CustomPainter {
+  final List<TimeSeriesPoint> points;
+  final Color color;
+
+  _TemperatureTrendPainter(this.points, this.color);
+
+  @override
+  void paint(Canvas canvas, Size size) {
+    final first = points.first.time.millisecondsSinceEpoch;
+    final span = (points.last.time.millisecondsSinceEpoch - first).toDouble();
+    var low = points.first.value, high = points.first.value;
+    for (final point in points) {
+      if (point.value < low) low = point.value;
+      if (point.value > high) high = point.value;
+    }
+    final range = high - low < 1 ? 1.0 : high - low;
+
+    final path = Path();
+    for (var i = 0; i < points.length; i++) {
+      final x = span == 0 ? 0.0 : (points[i].time.millisecondsSinceEpoch - first) / span * size.width;
+      final y = size.height - (points[i].value - low) / range * size.height;
+      if (i == 0) {
+        path.moveTo(x, y);
+      } else {
+        path.lineTo(x, y);
+      }
+    }
+    canvas.drawPath(
+      path,
+      Paint()
+        ..color = color.withValues(alpha: 0.8)
+        ..style = PaintingStyle.stroke
+        ..strokeWidth = 1.5,
+    );
+  }
+
+  @override
+  bool shouldRepaint(_TemperatureTrendPainter oldDelegate) => oldDelegate.points != points;
+}
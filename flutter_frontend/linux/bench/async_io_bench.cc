@@ -0,0 +1,269 @@
+// Benchmark for the runner's AsyncIo (runner/async_io.cc). Built when the
+// runner is configured with -DMODERN_DASHBOARD_BENCHMARKS=ON.
+//
+//   async_io_bench [--dir DIR] [--records N] [--record-size BYTES]
+//                  [--reads N] [--depth N] [--backend io_uring|threads|both]
+//
+// Two workloads run on each backend, against a file in --dir:
+//
+//  - append: --records records written one after another at the end of the
+//    file. Like writers to a log that each want their record durable, every
+//    record is followed by an fsync request; --depth records are in flight
+//    at a time, so the fsyncs of one batch coalesce into one.
+//  - random reads: --reads single-record reads at random offsets of that
+//    file, --depth in flight at a time, each checked against what was
+//    written.
+//
+// The reads are served from the page cache unless it is dropped between
+// the phases (e.g. `echo 1 > /proc/sys/vm/drop_caches`).
+
+#include <fcntl.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <string.h>
+
+#include "runner/async_io.h"
+
+namespace {
+
+struct Bench {
+  AsyncIo* io;
+  GMainLoop* loop;
+  int fd;
+  guint records;
+  gsize record_size;
+  guint reads;
+  guint depth;
+
+  // The current phase.
+  guint target;
+  guint issued;
+  guint completed;
+  guint failed;
+  gint64 latency_us;
+};
+
+struct ReadRequest {
+  Bench* bench;
+  guint index;
+  gint64 started_us;
+};
+
+// Each record starts with its index so a read can be checked.
+GBytes* make_record(guint index, gsize size) {
+  guint8* data = static_cast<guint8*>(g_malloc0(size));
+  for (gsize i = 0; i < size; i++) data[i] = static_cast<guint8>(index + i);
+  guint32 tag = GUINT32_TO_LE(index);
+  memcpy(data, &tag, MIN(size, sizeof(tag)));
+  return g_bytes_new_take(data, size);
+}
+
+void reset(Bench* bench, guint target) {
+  bench->target = target;
+  bench->issued = bench->completed = bench->failed = 0;
+}
+
+// Runs the main loop until every request issued so far has completed.
+void wait_all(Bench* bench) {
+  if (bench->completed < bench->issued) g_main_loop_run(bench->loop);
+}
+
+void done_cb(gssize result, const guint8* data, gpointer user_data) {
+  Bench* bench = static_cast<Bench*>(user_data);
+  if (result < 0) bench->failed++;
+  if (++bench->completed == bench->issued) g_main_loop_quit(bench->loop);
+}
+
+void open_cb(gssize result, const guint8* data, gpointer user_data) {
+  Bench* bench = static_cast<Bench*>(user_data);
+  bench->fd = result;
+  done_cb(result, data, user_data);
+}
+
+gboolean open_file(Bench* bench, const gchar* path, int flags) {
+  reset(bench, 1);
+  bench->issued = 1;
+  async_io_open(bench->io, path, flags, 0600, open_cb, bench);
+  wait_all(bench);
+  if (bench->fd < 0) {
+    g_printerr("cannot open %s: %s\n", path, g_strerror(-bench->fd));
+    return FALSE;
+  }
+  return TRUE;
+}
+
+void close_file(Bench* bench) {
+  reset(bench, 1);
+  bench->issued = 1;
+  async_io_close(bench->io, bench->fd, done_cb, bench);
+  wait_all(bench);
+}
+
+// Returns the seconds taken, or a negative value on failure.
+double run_append(Bench* bench, const gchar* path) {
+  if (!open_file(bench, path, O_WRONLY | O_CREAT | O_TRUNC)) return -1;
+  reset(bench, bench->records * 2);
+
+  gint64 start = g_get_monotonic_time();
+  for (guint index = 0; index < bench->records;) {
+    guint batch_end = MIN(index + bench->depth, bench->records);
+    for (; index < batch_end; index++) {
+      g_autoptr(GBytes) record = make_record(index, bench->record_size);
+      bench->issued += 2;
+      async_io_write(bench->io, bench->fd, record,
+                     static_cast<goffset>(index) * bench->record_size, done_cb,
+                     bench);
+      async_io_fsync(bench->io, bench->fd, done_cb, bench);
+    }
+    wait_all(bench);
+  }
+  gint64 elapsed = g_get_monotonic_time() - start;
+  guint failed = bench->failed;
+  close_file(bench);
+  return failed > 0 ? -1 : elapsed / 1e6;
+}
+
+void issue_read(Bench* bench);
+
+void read_cb(gssize result, const guint8* data, gpointer user_data) {
+  ReadRequest* request = static_cast<ReadRequest*>(user_data);
+  Bench* bench = request->bench;
+  bench->latency_us += g_get_monotonic_time() - request->started_us;
+  guint32 tag = 0;
+  gboolean complete = result == static_cast<gssize>(bench->record_size);
+  if (complete) memcpy(&tag, data, MIN(bench->record_size, sizeof(tag)));
+  if (!complete || GUINT32_FROM_LE(tag) != request->index) bench->failed++;
+  g_free(request);
+
+  bench->completed++;
+  issue_read(bench);
+  if (bench->completed == bench->target) g_main_loop_quit(bench->loop);
+}
+
+void issue_read(Bench* bench) {
+  if (bench->issued == bench->target) return;
+  bench->issued++;
+  ReadRequest* request = g_new0(ReadRequest, 1);
+  request->bench = bench;
+  request->index = g_random_int_range(0, bench->records);
+  request->started_us = g_get_monotonic_time();
+  async_io_read(bench->io, bench->fd, bench->record_size,
+                static_cast<goffset>(request->index) * bench->record_size,
+                read_cb, request);
+}
+
+// Returns the seconds taken, or a negative value on failure.
+double run_reads(Bench* bench, const gchar* path) {
+  if (!open_file(bench, path, O_RDONLY)) return -1;
+  reset(bench, bench->reads);
+  bench->latency_us = 0;
+
+  gint64 start = g_get_monotonic_time();
+  for (guint i = 0; i < bench->depth; i++) issue_read(bench);
+  wait_all(bench);
+  gint64 elapsed = g_get_monotonic_time() - start;
+  guint failed = bench->failed;
+  close_file(bench);
+  return failed > 0 ? -1 : elapsed / 1e6;
+}
+
+gboolean run_backend(Bench* bench, const gchar* backend, const gchar* dir) {
+  g_setenv("MODERN_DASHBOARD_ASYNC_IO", backend, TRUE);
+  bench->io = async_io_new(bench->depth, 4);
+  if (g_strcmp0(async_io_get_backend(bench->io), backend) != 0) {
+    g_printerr("%s: not available, skipped\n", backend);
+    g_clear_object(&bench->io);
+    return TRUE;
+  }
+
+  g_autofree gchar* path = g_build_filename(dir, "async_io_bench.dat", nullptr);
+  double append_seconds = run_append(bench, path);
+  AsyncIoStats append_stats;
+  async_io_get_stats(bench->io, &append_stats);
+  double read_seconds =
+      append_seconds >= 0 ? run_reads(bench, path) : -1;
+  gint64 latency_us = bench->latency_us;
+  AsyncIoStats stats;
+  async_io_get_stats(bench->io, &stats);
+  g_unlink(path);
+  g_clear_object(&bench->io);
+
+  if (append_seconds < 0 || read_seconds < 0) {
+    g_printerr("%s: requests failed\n", backend);
+    return FALSE;
+  }
+  double megabytes = bench->records * bench->record_size / 1e6;
+  g_print("%-8s append  %9.0f records/s  %7.1f MB/s  "
+          "%" G_GUINT64_FORMAT " fsyncs for %" G_GUINT64_FORMAT " requests\n",
+          backend, bench->records / append_seconds, megabytes / append_seconds,
+          append_stats.fsyncs, append_stats.fsync_requests);
+  g_print("%-8s reads   %9.0f reads/s    %7.1f us mean latency\n", backend,
+          bench->reads / read_seconds,
+          static_cast<double>(latency_us) / MAX(bench->reads, 1u));
+  g_print("%-8s         %" G_GUINT64_FORMAT " ring submits, %" G_GUINT64_FORMAT
+          " fixed-buffer and %" G_GUINT64_FORMAT " pool requests\n",
+          backend, stats.ring_submits, stats.fixed_buffer_ops, stats.pool_ops);
+  return TRUE;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  gchar* dir = nullptr;
+  gint records = 20000;
+  gint record_size = 512;
+  gint reads = 100000;
+  gint depth = 32;
+  gchar* backend = nullptr;
+
+  GOptionEntry entries[] = {
+      {"dir", 'd', 0, G_OPTION_ARG_FILENAME, &dir,
+       "Directory for the test file (the cache directory)", "DIR"},
+      {"records", 'n', 0, G_OPTION_ARG_INT, &records,
+       "Records to append (20000)", "N"},
+      {"record-size", 's', 0, G_OPTION_ARG_INT, &record_size,
+       "Bytes per record (512)", "BYTES"},
+      {"reads", 'r', 0, G_OPTION_ARG_INT, &reads,
+       "Random record reads (100000)", "N"},
+      {"depth", 'q', 0, G_OPTION_ARG_INT, &depth,
+       "Requests in flight (32)", "N"},
+      {"backend", 'b', 0, G_OPTION_ARG_STRING, &backend,
+       "io_uring, threads or both (both)", "NAME"},
+      {nullptr},
+  };
+
+  g_autoptr(GOptionContext) context =
+      g_option_context_new("- benchmark the runner's async file I/O");
+  g_option_context_add_main_entries(context, entries, nullptr);
+  g_autoptr(GError) error = nullptr;
+  if (!g_option_context_parse(context, &argc, &argv, &error)) {
+    g_printerr("%s\n", error->message);
+    return 1;
+  }
+  if (records <= 0 || record_size <= 0 || reads <= 0 || depth <= 0) {
+    g_printerr("--records, --record-size, --reads and --depth must be positive\n");
+    return 1;
+  }
+
+  Bench bench = {};
+  bench.loop = g_main_loop_new(nullptr, FALSE);
+  bench.records = records;
+  bench.record_size = record_size;
+  bench.reads = reads;
+  bench.depth = depth;
+  const gchar* directory = dir != nullptr ? dir : g_get_user_cache_dir();
+
+  gboolean ok = TRUE;
+  const gchar* backends[] = {"io_uring", "threads"};
+  for (const gchar* name : backends) {
+    if (backend == nullptr || g_strcmp0(backend, "both") == 0 ||
+        g_strcmp0(backend, name) == 0) {
+      ok = run_backend(&bench, name, directory) && ok;
+    }
+  }
+
+  g_main_loop_unref(bench.loop);
+  g_free(dir);
+  g_free(backend);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,228 @@
+// Benchmark for the runner's NativeBridge (runner/native_bridge.cc). Built
+// when the runner is configured with -DMODERN_DASHBOARD_BENCHMARKS=ON.
+//
+//   native_bridge_bench [--rate N] [--seconds N] [--producers N]
+//                       [--batch N] [--capacity N] [--mode bridge|invoke|both]
+//
+// --producers threads post --rate results per second in total, paced
+// evenly, for --seconds. Each result carries its posting time, and the main
+// loop records how long it took to arrive. Two ways of handing the results
+// to the main thread are compared:
+//
+//  - bridge: native_bridge_post() into a bridge with a native handler,
+//    drained in batches of up to --batch;
+//  - invoke: one g_main_context_invoke() per result, which is what the
+//    workers did before the bridge.
+//
+// The main loop is otherwise idle, so the numbers are the cost of the
+// handoff itself; with a busy UI thread the difference in wakeups matters
+// more.
+
+#include <flutter_linux/flutter_linux.h>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "runner/native_bridge.h"
+
+namespace {
+
+struct Bench {
+  GMainLoop* loop;
+  NativeBridge* bridge;
+  gboolean use_bridge;
+  guint rate;
+  guint seconds;
+  guint producers;
+
+  // Shared with producer threads.
+  std::atomic<guint64> sent;
+  std::atomic<guint64> rejected;
+  std::atomic<guint> producers_done;
+
+  // Main thread only.
+  guint64 received;
+  guint64 dispatches;
+  std::vector<gint64> latencies_us;
+};
+
+struct Producer {
+  Bench* bench;
+  guint index;
+};
+
+void receive(Bench* bench, gint64 posted_us) {
+  bench->latencies_us.push_back(g_get_monotonic_time() - posted_us);
+  bench->received++;
+}
+
+void batch_cb(FlValue* batch, gpointer user_data) {
+  Bench* bench = static_cast<Bench*>(user_data);
+  bench->dispatches++;
+  for (size_t i = 0; i < fl_value_get_length(batch); i++) {
+    receive(bench, fl_value_get_int(fl_value_get_list_value(batch, i)));
+  }
+}
+
+struct Invoked {
+  Bench* bench;
+  gint64 posted_us;
+};
+
+gboolean invoke_cb(gpointer user_data) {
+  Invoked* invoked = static_cast<Invoked*>(user_data);
+  invoked->bench->dispatches++;
+  receive(invoked->bench, invoked->posted_us);
+  delete invoked;
+  return G_SOURCE_REMOVE;
+}
+
+// Posts this producer's share of the rate, sleeping whenever it is ahead of
+// schedule.
+gpointer producer_run(gpointer data) {
+  Producer* producer = static_cast<Producer*>(data);
+  Bench* bench = producer->bench;
+  double interval_us = 1e6 * bench->producers / bench->rate;
+  guint64 count = static_cast<guint64>(bench->rate) * bench->seconds /
+                  bench->producers;
+
+  gint64 start = g_get_monotonic_time();
+  for (guint64 i = 0; i < count; i++) {
+    // Stagger the producers within one interval.
+    gint64 due = start + static_cast<gint64>(
+                             (i + static_cast<double>(producer->index) /
+                                      bench->producers) *
+                             interval_us);
+    gint64 now = g_get_monotonic_time();
+    if (due - now > 200) g_usleep(due - now);
+
+    now = g_get_monotonic_time();
+    if (bench->use_bridge) {
+      if (!native_bridge_post(bench->bridge, fl_value_new_int(now))) {
+        bench->rejected.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+    } else {
+      g_main_context_invoke(nullptr, invoke_cb, new Invoked{bench, now});
+    }
+    bench->sent.fetch_add(1, std::memory_order_relaxed);
+  }
+  bench->producers_done.fetch_add(1, std::memory_order_release);
+  return nullptr;
+}
+
+// Ends the run once every producer is done and everything sent arrived.
+gboolean check_done_cb(gpointer user_data) {
+  Bench* bench = static_cast<Bench*>(user_data);
+  if (bench->producers_done.load(std::memory_order_acquire) ==
+          bench->producers &&
+      bench->received == bench->sent.load(std::memory_order_relaxed)) {
+    g_main_loop_quit(bench->loop);
+    return G_SOURCE_REMOVE;
+  }
+  return G_SOURCE_CONTINUE;
+}
+
+gint64 percentile(const std::vector<gint64>& sorted, double q) {
+  if (sorted.empty()) return 0;
+  return sorted[static_cast<size_t>((sorted.size() - 1) * q)];
+}
+
+void run_mode(const gchar* mode, gboolean use_bridge, guint rate,
+              guint seconds, guint producers, guint batch, guint capacity) {
+  Bench bench;
+  bench.loop = g_main_loop_new(nullptr, FALSE);
+  bench.use_bridge = use_bridge;
+  bench.bridge = use_bridge ? native_bridge_new_with_handler(capacity, batch,
+                                                             batch_cb, &bench)
+                            : nullptr;
+  bench.rate = rate;
+  bench.seconds = seconds;
+  bench.producers = producers;
+  bench.sent = 0;
+  bench.rejected = 0;
+  bench.producers_done = 0;
+  bench.received = 0;
+  bench.dispatches = 0;
+  bench.latencies_us.reserve(static_cast<size_t>(rate) * seconds);
+
+  std::vector<Producer> configs(producers);
+  std::vector<GThread*> threads;
+  gint64 start = g_get_monotonic_time();
+  for (guint i = 0; i < producers; i++) {
+    configs[i] = Producer{&bench, i};
+    threads.push_back(g_thread_new("producer", producer_run, &configs[i]));
+  }
+  g_timeout_add(10, check_done_cb, &bench);
+  g_main_loop_run(bench.loop);
+  gint64 elapsed = g_get_monotonic_time() - start;
+  for (GThread* thread : threads) g_thread_join(thread);
+
+  if (bench.bridge != nullptr) {
+    native_bridge_close(bench.bridge);
+    g_object_unref(bench.bridge);
+  }
+  g_main_loop_unref(bench.loop);
+
+  std::sort(bench.latencies_us.begin(), bench.latencies_us.end());
+  g_print("%-7s %9.0f results/s  %8" G_GUINT64_FORMAT " wakeups  "
+          "%6" G_GUINT64_FORMAT " rejected  latency us p50 %" G_GINT64_FORMAT
+          " p99 %" G_GINT64_FORMAT " max %" G_GINT64_FORMAT "\n",
+          mode, bench.received / (elapsed / 1e6), bench.dispatches,
+          bench.rejected.load(), percentile(bench.latencies_us, 0.5),
+          percentile(bench.latencies_us, 0.99),
+          percentile(bench.latencies_us, 1.0));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  gint rate = 100000;
+  gint seconds = 5;
+  gint producers = 4;
+  gint batch = 64;
+  gint capacity = 65536;
+  gchar* mode = nullptr;
+
+  GOptionEntry entries[] = {
+      {"rate", 'r', 0, G_OPTION_ARG_INT, &rate,
+       "Results per second over all producers (100000)", "N"},
+      {"seconds", 's', 0, G_OPTION_ARG_INT, &seconds, "Run time (5)", "N"},
+      {"producers", 'p', 0, G_OPTION_ARG_INT, &producers,
+       "Producer threads (4)", "N"},
+      {"batch", 'b', 0, G_OPTION_ARG_INT, &batch,
+       "Results per bridge dispatch (64)", "N"},
+      {"capacity", 'c', 0, G_OPTION_ARG_INT, &capacity,
+       "Bridge queue capacity (65536)", "N"},
+      {"mode", 'm', 0, G_OPTION_ARG_STRING, &mode,
+       "bridge, invoke or both (both)", "NAME"},
+      {nullptr},
+  };
+
+  g_autoptr(GOptionContext) context =
+      g_option_context_new("- benchmark worker-to-main-thread handoff");
+  g_option_context_add_main_entries(context, entries, nullptr);
+  g_autoptr(GError) error = nullptr;
+  if (!g_option_context_parse(context, &argc, &argv, &error)) {
+    g_printerr("%s\n", error->message);
+    return 1;
+  }
+  if (rate <= 0 || seconds <= 0 || producers <= 0 || batch <= 0 ||
+      capacity <= 0) {
+    g_printerr("all numeric options must be positive\n");
+    return 1;
+  }
+
+  if (mode == nullptr || g_strcmp0(mode, "both") == 0 ||
+      g_strcmp0(mode, "bridge") == 0) {
+    run_mode("bridge", TRUE, rate, seconds, producers, batch, capacity);
+  }
+  if (mode == nullptr || g_strcmp0(mode, "both") == 0 ||
+      g_strcmp0(mode, "invoke") == 0) {
+    run_mode("invoke", FALSE, rate, seconds, producers, batch, capacity);
+  }
+
+  g_free(mode);
+  return 0;
+}
@@ -0,0 +1,631 @@
+// Caching CORS gateway for the web build.
+//
+// Browsers cannot fetch most RSS feeds directly because the feeds do not send
+// CORS headers. Run this next to the web build and pass its address with
+// --dart-define=CORS_GATEWAY_URL=http://localhost:8787:
+//
+//   cors_gateway --allow bbci.co.uk,nytimes.com [--port 8787] [--origin URL]
+//
+// GET /fetch?url=<feed url> returns the origin's body unchanged with CORS
+// headers. Only hosts on the allowlist (and their subdomains) are fetched,
+// so the gateway is not an open proxy; redirects are followed only to
+// allowlisted hosts. Responses are cached in memory:
+//
+//  - while fresh (Cache-Control max-age, clamped to --min-ttl..--max-ttl, or
+//    --ttl when the origin says nothing) they are served without contacting
+//    the origin; no-cache and max-age=0 make every request revalidate;
+//  - once stale they are revalidated with If-None-Match / If-Modified-Since,
+//    and a 304 only refreshes the entry;
+//  - concurrent requests for the same URL share one origin fetch;
+//  - if the origin fails, a stale copy is served rather than an error.
+//
+// Origin fetches share one SoupSession, so connections and TLS sessions are
+// pooled, and compressed origin responses are decoded by libsoup. Clients
+// that accept gzip get a compressed body, compressed once per cache entry.
+// Every response carries X-Cache (HIT, REVALIDATED, MISS or STALE) and a
+// Server-Timing origin duration; GET /stats reports totals.
+
+#include <gio/gio.h>
+#include <libsoup/soup.h>
+
+namespace {
+
+struct CacheEntry {
+  GBytes* body;
+  GBytes* gzip_body;
+  gchar* content_type;
+  gchar* etag;
+  gchar* last_modified;
+  gint64 fresh_until_us;
+  gint64 stored_us;
+};
+
+struct Gateway {
+  SoupSession* session;
+  GHashTable* cache;     // url -> CacheEntry*
+  GHashTable* inflight;  // url -> OriginFetch*
+  gchar** allow_hosts;
+  gchar** allow_origins;
+  gint64 default_ttl_us;
+  gint64 min_ttl_us;
+  gint64 max_ttl_us;
+  gsize cache_limit;
+  gsize cache_bytes;
+
+  guint64 hits;
+  guint64 revalidated;
+  guint64 misses;
+  guint64 stale;
+  guint64 errors;
+  guint64 coalesced;
+  guint64 origin_fetches;
+  gint64 origin_total_us;
+};
+
+// An origin request and the clients waiting for it.
+struct OriginFetch {
+  Gateway* gateway;
+  gchar* url;
+  SoupMessage* request;
+  GPtrArray* waiters;  // SoupServerMessage*, each holding a reference
+  gint64 started_us;
+  guint redirects;
+  gboolean conditional;  // request carries the cached entry's validators
+};
+
+}  // namespace
+
+// Compressing feeds smaller than this costs more than it saves.
+static const gsize kMinGzipSize = 1024;
+
+// Redirects followed per origin fetch, as many as libsoup would.
+static const guint kMaxRedirects = 20;
+
+static void cache_entry_free(gpointer data) {
+  CacheEntry* entry = static_cast<CacheEntry*>(data);
+  g_bytes_unref(entry->body);
+  if (entry->gzip_body != nullptr) g_bytes_unref(entry->gzip_body);
+  g_free(entry->content_type);
+  g_free(entry->etag);
+  g_free(entry->last_modified);
+  g_free(entry);
+}
+
+static gsize cache_entry_size(CacheEntry* entry) {
+  return g_bytes_get_size(entry->body) +
+         (entry->gzip_body != nullptr ? g_bytes_get_size(entry->gzip_body) : 0);
+}
+
+static void gateway_cache_remove(Gateway* gateway, const gchar* url) {
+  CacheEntry* entry =
+      static_cast<CacheEntry*>(g_hash_table_lookup(gateway->cache, url));
+  if (entry == nullptr) return;
+  gateway->cache_bytes -= cache_entry_size(entry);
+  g_hash_table_remove(gateway->cache, url);
+}
+
+// Evicts the least recently stored entries until the cache fits its limit.
+static void gateway_cache_trim(Gateway* gateway) {
+  while (gateway->cache_bytes > gateway->cache_limit &&
+         g_hash_table_size(gateway->cache) > 1) {
+    GHashTableIter iter;
+    gpointer key, value;
+    const gchar* oldest_url = nullptr;
+    gint64 oldest = G_MAXINT64;
+    g_hash_table_iter_init(&iter, gateway->cache);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+      CacheEntry* entry = static_cast<CacheEntry*>(value);
+      if (entry->stored_us < oldest) {
+        oldest = entry->stored_us;
+        oldest_url = static_cast<const gchar*>(key);
+      }
+    }
+    g_autofree gchar* url = g_strdup(oldest_url);
+    gateway_cache_remove(gateway, url);
+  }
+}
+
+// Returns whether |host| is an allowlisted host or a subdomain of one.
+static gboolean gateway_host_allowed(Gateway* gateway, const gchar* host) {
+  if (host == nullptr) return FALSE;
+  gsize host_length = strlen(host);
+  for (gchar** allowed = gateway->allow_hosts; *allowed != nullptr; allowed++) {
+    gsize length = strlen(*allowed);
+    if (length == 0) continue;
+    if (g_ascii_strcasecmp(host, *allowed) == 0) return TRUE;
+    if (host_length > length && host[host_length - length - 1] == '.' &&
+        g_ascii_strcasecmp(host + host_length - length, *allowed) == 0) {
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+// Freshness lifetime from the origin's Cache-Control, or -1 for no-store.
+static gint64 gateway_freshness_us(Gateway* gateway,
+                                   SoupMessageHeaders* headers) {
+  const char* cache_control =
+      soup_message_headers_get_list(headers, "Cache-Control");
+  if (cache_control == nullptr) return gateway->default_ttl_us;
+
+  GHashTable* params = soup_header_parse_param_list(cache_control);
+  gint64 ttl = gateway->default_ttl_us;
+  if (g_hash_table_contains(params, "no-store")) {
+    ttl = -1;
+  } else if (g_hash_table_contains(params, "no-cache")) {
+    ttl = 0;
+  } else {
+    const gchar* max_age =
+        static_cast<const gchar*>(g_hash_table_lookup(params, "s-maxage"));
+    if (max_age == nullptr) {
+      max_age = static_cast<const gchar*>(g_hash_table_lookup(params, "max-age"));
+    }
+    if (max_age != nullptr) {
+      ttl = g_ascii_strtoll(max_age, nullptr, 10) * G_USEC_PER_SEC;
+    }
+  }
+  soup_header_free_param_list(params);
+
+  if (ttl < 0) return -1;
+  // --min-ttl limits short lifetimes; it does not override an origin that
+  // asks for every use to be revalidated.
+  if (ttl == 0) return 0;
+  return CLAMP(ttl, gateway->min_ttl_us, gateway->max_ttl_us);
+}
+
+static GBytes* gzip_bytes(GBytes* input) {
+  g_autoptr(GZlibCompressor) compressor =
+      g_zlib_compressor_new(G_ZLIB_COMPRESSOR_FORMAT_GZIP, 6);
+  g_autoptr(GOutputStream) memory = g_memory_output_stream_new_resizable();
+  g_autoptr(GOutputStream) stream =
+      g_converter_output_stream_new(memory, G_CONVERTER(compressor));
+  gsize size = 0;
+  const void* data = g_bytes_get_data(input, &size);
+  if (!g_output_stream_write_all(stream, data, size, nullptr, nullptr,
+                                 nullptr) ||
+      !g_output_stream_close(stream, nullptr, nullptr)) {
+    return nullptr;
+  }
+  return g_memory_output_stream_steal_as_bytes(G_MEMORY_OUTPUT_STREAM(memory));
+}
+
+// Adds the CORS headers for the request's Origin, if it is allowed.
+static void gateway_add_cors_headers(Gateway* gateway, SoupServerMessage* msg) {
+  SoupMessageHeaders* response = soup_server_message_get_response_headers(msg);
+  if (gateway->allow_origins == nullptr) {
+    soup_message_headers_replace(response, "Access-Control-Allow-Origin", "*");
+  } else {
+    const char* origin = soup_message_headers_get_one(
+        soup_server_message_get_request_headers(msg), "Origin");
+    if (origin != nullptr &&
+        g_strv_contains(const_cast<const gchar* const*>(gateway->allow_origins),
+                        origin)) {
+      soup_message_headers_replace(response, "Access-Control-Allow-Origin",
+                                   origin);
+    }
+    soup_message_headers_append(response, "Vary", "Origin");
+  }
+  soup_message_headers_replace(response, "Access-Control-Expose-Headers",
+                               "X-Cache, Server-Timing");
+  soup_message_headers_replace(response, "Timing-Allow-Origin", "*");
+}
+
+static void gateway_respond_error(Gateway* gateway, SoupServerMessage* msg,
+                                  guint status, const gchar* message) {
+  gateway_add_cors_headers(gateway, msg);
+  soup_server_message_set_status(msg, status, nullptr);
+  soup_server_message_set_response(msg, "text/plain; charset=utf-8",
+                                   SOUP_MEMORY_COPY, message, strlen(message));
+}
+
+static void gateway_respond_entry(Gateway* gateway, SoupServerMessage* msg,
+                                  CacheEntry* entry, const gchar* cache_status,
+                                  gint64 origin_us) {
+  SoupMessageHeaders* response = soup_server_message_get_response_headers(msg);
+  gateway_add_cors_headers(gateway, msg);
+  soup_message_headers_replace(response, "X-Cache", cache_status);
+  g_autofree gchar* timing =
+      g_strdup_printf("origin;dur=%.1f", origin_us / 1000.0);
+  soup_message_headers_replace(response, "Server-Timing", timing);
+  soup_message_headers_append(response, "Vary", "Accept-Encoding");
+  if (entry->content_type != nullptr) {
+    soup_message_headers_replace(response, "Content-Type", entry->content_type);
+  }
+
+  GBytes* body = entry->body;
+  if (g_bytes_get_size(entry->body) >= kMinGzipSize &&
+      soup_message_headers_header_contains(
+          soup_server_message_get_request_headers(msg), "Accept-Encoding",
+          "gzip")) {
+    if (entry->gzip_body == nullptr) {
+      entry->gzip_body = gzip_bytes(entry->body);
+      if (entry->gzip_body != nullptr) {
+        gateway->cache_bytes += g_bytes_get_size(entry->gzip_body);
+      }
+    }
+    if (entry->gzip_body != nullptr) {
+      body = entry->gzip_body;
+      soup_message_headers_replace(response, "Content-Encoding", "gzip");
+    }
+  }
+
+  soup_server_message_set_status(msg, SOUP_STATUS_OK, nullptr);
+  soup_message_body_append_bytes(soup_server_message_get_response_body(msg),
+                                 body);
+}
+
+static void origin_fetch_free(OriginFetch* fetch) {
+  g_ptr_array_unref(fetch->waiters);
+  g_object_unref(fetch->request);
+  g_free(fetch->url);
+  g_free(fetch);
+}
+
+static gboolean is_http_uri(GUri* uri) {
+  return g_strcmp0(g_uri_get_scheme(uri), "http") == 0 ||
+         g_strcmp0(g_uri_get_scheme(uri), "https") == 0;
+}
+
+static void origin_fetch_cb(GObject* source, GAsyncResult* result,
+                            gpointer user_data);
+
+// Sends |fetch|'s request to |uri|, with the cached entry's validators if
+// |conditional|.
+static void origin_fetch_send(OriginFetch* fetch, GUri* uri,
+                              gboolean conditional) {
+  Gateway* gateway = fetch->gateway;
+  g_clear_object(&fetch->request);
+  fetch->request = soup_message_new_from_uri(SOUP_METHOD_GET, uri);
+  // origin_fetch_cb follows redirects itself, so each target is checked
+  // against the allowlist.
+  soup_message_add_flags(fetch->request, SOUP_MESSAGE_NO_REDIRECT);
+
+  SoupMessageHeaders* headers = soup_message_get_request_headers(fetch->request);
+  soup_message_headers_replace(
+      headers, "Accept",
+      "application/rss+xml, application/atom+xml, application/xml, text/xml, */*");
+  fetch->conditional = FALSE;
+  CacheEntry* entry =
+      conditional ? static_cast<CacheEntry*>(
+                        g_hash_table_lookup(gateway->cache, fetch->url))
+                  : nullptr;
+  if (entry != nullptr && entry->etag != nullptr) {
+    soup_message_headers_replace(headers, "If-None-Match", entry->etag);
+    fetch->conditional = TRUE;
+  }
+  if (entry != nullptr && entry->last_modified != nullptr) {
+    soup_message_headers_replace(headers, "If-Modified-Since",
+                                 entry->last_modified);
+    fetch->conditional = TRUE;
+  }
+
+  soup_session_send_and_read_async(gateway->session, fetch->request,
+                                   G_PRIORITY_DEFAULT, nullptr,
+                                   origin_fetch_cb, fetch);
+}
+
+// Where the redirect |fetch| just received points, or nullptr with |reason|
+// set if it must not be followed.
+static GUri* origin_fetch_redirect_target(OriginFetch* fetch,
+                                          const gchar** reason) {
+  const char* location = soup_message_headers_get_one(
+      soup_message_get_response_headers(fetch->request), "Location");
+  if (location == nullptr) {
+    *reason = "redirect without a Location";
+    return nullptr;
+  }
+  if (fetch->redirects >= kMaxRedirects) {
+    *reason = "too many redirects";
+    return nullptr;
+  }
+  GUri* target = g_uri_parse_relative(soup_message_get_uri(fetch->request),
+                                      location, SOUP_HTTP_URI_FLAGS, nullptr);
+  if (target == nullptr || !is_http_uri(target) ||
+      !gateway_host_allowed(fetch->gateway, g_uri_get_host(target))) {
+    if (target != nullptr) g_uri_unref(target);
+    *reason = "redirected to a host that is not on the gateway allowlist";
+    return nullptr;
+  }
+  return target;
+}
+
+static void origin_fetch_cb(GObject* source, GAsyncResult* result,
+                            gpointer user_data) {
+  OriginFetch* fetch = static_cast<OriginFetch*>(user_data);
+  Gateway* gateway = fetch->gateway;
+
+  g_autoptr(GError) error = nullptr;
+  g_autoptr(GBytes) body =
+      soup_session_send_and_read_finish(SOUP_SESSION(source), result, &error);
+  guint status = soup_message_get_status(fetch->request);
+  SoupMessageHeaders* headers =
+      soup_message_get_response_headers(fetch->request);
+  CacheEntry* entry = static_cast<CacheEntry*>(
+      g_hash_table_lookup(gateway->cache, fetch->url));
+  const gchar* refused = nullptr;
+
+  if (error == nullptr && SOUP_STATUS_IS_REDIRECTION(status) &&
+      status != SOUP_STATUS_NOT_MODIFIED) {
+    g_autoptr(GUri) target = origin_fetch_redirect_target(fetch, &refused);
+    if (target != nullptr) {
+      fetch->redirects++;
+      origin_fetch_send(fetch, target, fetch->conditional);
+      return;
+    }
+  } else if (error == nullptr && status == SOUP_STATUS_NOT_MODIFIED &&
+             entry == nullptr && fetch->conditional) {
+    // The entry was evicted while it was being revalidated, so there is
+    // nothing left to refresh; ask for the body.
+    g_autoptr(GUri) uri = g_uri_ref(soup_message_get_uri(fetch->request));
+    origin_fetch_send(fetch, uri, FALSE);
+    return;
+  }
+
+  g_hash_table_remove(gateway->inflight, fetch->url);
+  gint64 now = g_get_monotonic_time();
+  gint64 origin_us = now - fetch->started_us;
+  gateway->origin_fetches++;
+  gateway->origin_total_us += origin_us;
+  const gchar* failure =
+      refused != nullptr  ? refused
+      : error != nullptr ? error->message
+                         : soup_status_get_phrase(status);
+  const gchar* cache_status = nullptr;
+
+  if (error == nullptr && status == SOUP_STATUS_NOT_MODIFIED && entry != nullptr) {
+    gint64 ttl = gateway_freshness_us(gateway, headers);
+    entry->fresh_until_us = now + MAX(ttl, 0);
+    cache_status = "REVALIDATED";
+    gateway->revalidated += fetch->waiters->len;
+  } else if (error == nullptr && status == SOUP_STATUS_OK && body != nullptr) {
+    gateway_cache_remove(gateway, fetch->url);
+    gint64 ttl = gateway_freshness_us(gateway, headers);
+    entry = g_new0(CacheEntry, 1);
+    entry->body = g_bytes_ref(body);
+    entry->content_type =
+        g_strdup(soup_message_headers_get_one(headers, "Content-Type"));
+    entry->etag = g_strdup(soup_message_headers_get_one(headers, "ETag"));
+    entry->last_modified =
+        g_strdup(soup_message_headers_get_one(headers, "Last-Modified"));
+    entry->fresh_until_us = now + MAX(ttl, 0);
+    entry->stored_us = now;
+    gateway->cache_bytes += cache_entry_size(entry);
+    g_hash_table_insert(gateway->cache, g_strdup(fetch->url), entry);
+    cache_status = "MISS";
+    gateway->misses += fetch->waiters->len;
+  } else if (entry != nullptr) {
+    // The origin is down or erroring; old content beats none.
+    g_message("Origin failed for %s (%s), serving stale copy", fetch->url,
+              failure);
+    cache_status = "STALE";
+    gateway->stale += fetch->waiters->len;
+  }
+
+  for (guint i = 0; i < fetch->waiters->len; i++) {
+    SoupServerMessage* msg =
+        static_cast<SoupServerMessage*>(g_ptr_array_index(fetch->waiters, i));
+    if (cache_status != nullptr) {
+      gateway_respond_entry(gateway, msg, entry, cache_status, origin_us);
+    } else {
+      gateway->errors++;
+      g_autofree gchar* message =
+          g_strdup_printf("Origin request failed: %s", failure);
+      gateway_respond_error(gateway, msg, SOUP_STATUS_BAD_GATEWAY, message);
+    }
+    soup_server_message_unpause(msg);
+  }
+
+  // A no-store response is passed through once and not kept.
+  if (cache_status != nullptr && g_strcmp0(cache_status, "MISS") == 0 &&
+      gateway_freshness_us(gateway, headers) < 0) {
+    gateway_cache_remove(gateway, fetch->url);
+  }
+  gateway_cache_trim(gateway);
+  origin_fetch_free(fetch);
+}
+
+// Starts (or joins) the origin fetch for |url| and parks |msg| on it.
+static void gateway_fetch_origin(Gateway* gateway, SoupServerMessage* msg,
+                                 const gchar* url, GUri* uri) {
+  soup_server_message_pause(msg);
+
+  OriginFetch* running = static_cast<OriginFetch*>(
+      g_hash_table_lookup(gateway->inflight, url));
+  if (running != nullptr) {
+    gateway->coalesced++;
+    g_ptr_array_add(running->waiters, g_object_ref(msg));
+    return;
+  }
+
+  OriginFetch* fetch = g_new0(OriginFetch, 1);
+  fetch->gateway = gateway;
+  fetch->url = g_strdup(url);
+  fetch->waiters = g_ptr_array_new_with_free_func(g_object_unref);
+  g_ptr_array_add(fetch->waiters, g_object_ref(msg));
+  fetch->started_us = g_get_monotonic_time();
+  g_hash_table_insert(gateway->inflight, g_strdup(url), fetch);
+  origin_fetch_send(fetch, uri, TRUE);
+}
+
+// Handles /fetch?url=...
+static void fetch_handler(SoupServer* server, SoupServerMessage* msg,
+                          const char* path, GHashTable* query,
+                          gpointer user_data) {
+  Gateway* gateway = static_cast<Gateway*>(user_data);
+  const char* method = soup_server_message_get_method(msg);
+
+  if (g_strcmp0(method, SOUP_METHOD_OPTIONS) == 0) {
+    gateway_add_cors_headers(gateway, msg);
+    SoupMessageHeaders* response = soup_server_message_get_response_headers(msg);
+    soup_message_headers_replace(response, "Access-Control-Allow-Methods",
+                                 "GET, OPTIONS");
+    soup_message_headers_replace(response, "Access-Control-Max-Age", "86400");
+    soup_server_message_set_status(msg, SOUP_STATUS_NO_CONTENT, nullptr);
+    return;
+  }
+  if (g_strcmp0(method, SOUP_METHOD_GET) != 0) {
+    gateway_respond_error(gateway, msg, SOUP_STATUS_METHOD_NOT_ALLOWED,
+                          "Only GET is supported");
+    return;
+  }
+
+  const gchar* url = query != nullptr
+                         ? static_cast<const gchar*>(g_hash_table_lookup(query, "url"))
+                         : nullptr;
+  g_autoptr(GUri) uri =
+      url != nullptr ? g_uri_parse(url, G_URI_FLAGS_NONE, nullptr) : nullptr;
+  if (uri == nullptr || !is_http_uri(uri)) {
+    gateway_respond_error(gateway, msg, SOUP_STATUS_BAD_REQUEST,
+                          "Expected ?url=<http or https URL>");
+    return;
+  }
+  if (!gateway_host_allowed(gateway, g_uri_get_host(uri))) {
+    gateway_respond_error(gateway, msg, SOUP_STATUS_FORBIDDEN,
+                          "Host is not on the gateway allowlist");
+    return;
+  }
+
+  CacheEntry* entry =
+      static_cast<CacheEntry*>(g_hash_table_lookup(gateway->cache, url));
+  if (entry != nullptr && g_get_monotonic_time() < entry->fresh_until_us) {
+    gateway->hits++;
+    gateway_respond_entry(gateway, msg, entry, "HIT", 0);
+    return;
+  }
+  gateway_fetch_origin(gateway, msg, url, uri);
+}
+
+static void health_handler(SoupServer* server, SoupServerMessage* msg,
+                           const char* path, GHashTable* query,
+                           gpointer user_data) {
+  gateway_add_cors_headers(static_cast<Gateway*>(user_data), msg);
+  soup_server_message_set_status(msg, SOUP_STATUS_OK, nullptr);
+  soup_server_message_set_response(msg, "text/plain", SOUP_MEMORY_STATIC, "ok",
+                                   2);
+}
+
+static void stats_handler(SoupServer* server, SoupServerMessage* msg,
+                          const char* path, GHashTable* query,
+                          gpointer user_data) {
+  Gateway* gateway = static_cast<Gateway*>(user_data);
+  g_autofree gchar* json = g_strdup_printf(
+      "{\"hits\":%" G_GUINT64_FORMAT ",\"revalidated\":%" G_GUINT64_FORMAT
+      ",\"misses\":%" G_GUINT64_FORMAT ",\"stale\":%" G_GUINT64_FORMAT
+      ",\"errors\":%" G_GUINT64_FORMAT ",\"coalesced\":%" G_GUINT64_FORMAT
+      ",\"entries\":%u,\"bytes\":%" G_GSIZE_FORMAT
+      ",\"meanOriginMs\":%.1f}",
+      gateway->hits, gateway->revalidated, gateway->misses, gateway->stale,
+      gateway->errors, gateway->coalesced, g_hash_table_size(gateway->cache),
+      gateway->cache_bytes,
+      gateway->origin_fetches > 0
+          ? gateway->origin_total_us / 1000.0 / gateway->origin_fetches
+          : 0.0);
+  gateway_add_cors_headers(gateway, msg);
+  soup_server_message_set_status(msg, SOUP_STATUS_OK, nullptr);
+  soup_server_message_set_response(msg, "application/json", SOUP_MEMORY_COPY,
+                                   json, strlen(json));
+}
+
+int main(int argc, char** argv) {
+  gint port = 8787;
+  gboolean listen_all = FALSE;
+  gchar* allow = nullptr;
+  gchar* origins = nullptr;
+  gint ttl = 300;
+  gint min_ttl = 60;
+  gint max_ttl = 3600;
+  gint cache_mb = 64;
+  gint max_conns = 32;
+
+  GOptionEntry entries[] = {
+      {"port", 'p', 0, G_OPTION_ARG_INT, &port, "Port to listen on (8787)",
+       "PORT"},
+      {"listen-all", 0, 0, G_OPTION_ARG_NONE, &listen_all,
+       "Listen on all interfaces instead of localhost", nullptr},
+      {"allow", 'a', 0, G_OPTION_ARG_STRING, &allow,
+       "Comma-separated feed hosts that may be fetched (required)", "HOSTS"},
+      {"origin", 'o', 0, G_OPTION_ARG_STRING, &origins,
+       "Comma-separated origins allowed to read responses (any)", "ORIGINS"},
+      {"ttl", 0, 0, G_OPTION_ARG_INT, &ttl,
+       "Seconds a response stays fresh when the origin sets no max-age (300)",
+       "SECONDS"},
+      {"min-ttl", 0, 0, G_OPTION_ARG_INT, &min_ttl,
+       "Lower bound on freshness (60)", "SECONDS"},
+      {"max-ttl", 0, 0, G_OPTION_ARG_INT, &max_ttl,
+       "Upper bound on freshness (3600)", "SECONDS"},
+      {"cache-mb", 0, 0, G_OPTION_ARG_INT, &cache_mb,
+       "Memory for cached responses (64)", "MB"},
+      {"max-conns", 0, 0, G_OPTION_ARG_INT, &max_conns,
+       "Pooled origin connections (32)", "N"},
+      {nullptr},
+  };
+
+  g_autoptr(GOptionContext) context =
+      g_option_context_new("- caching CORS gateway for feeds");
+  g_option_context_add_main_entries(context, entries, nullptr);
+  g_autoptr(GError) error = nullptr;
+  if (!g_option_context_parse(context, &argc, &argv, &error)) {
+    g_printerr("%s\n", error->message);
+    return 1;
+  }
+  if (allow == nullptr || *allow == '\0') {
+    g_printerr("--allow is required; the gateway does not proxy arbitrary hosts\n");
+    return 1;
+  }
+
+  Gateway gateway = {};
+  gateway.allow_hosts = g_strsplit(allow, ",", -1);
+  for (gchar** host = gateway.allow_hosts; *host != nullptr; host++) {
+    g_strstrip(*host);
+  }
+  if (origins != nullptr && *origins != '\0') {
+    gateway.allow_origins = g_strsplit(origins, ",", -1);
+    for (gchar** origin = gateway.allow_origins; *origin != nullptr; origin++) {
+      g_strstrip(*origin);
+    }
+  }
+  gateway.default_ttl_us = static_cast<gint64>(MAX(ttl, 0)) * G_USEC_PER_SEC;
+  gateway.min_ttl_us = static_cast<gint64>(MAX(min_ttl, 0)) * G_USEC_PER_SEC;
+  gateway.max_ttl_us =
+      MAX(static_cast<gint64>(max_ttl) * G_USEC_PER_SEC, gateway.min_ttl_us);
+  gateway.cache_limit = static_cast<gsize>(MAX(cache_mb, 1)) * 1024 * 1024;
+  gateway.cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                        cache_entry_free);
+  gateway.inflight = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                           nullptr);
+  gateway.session = soup_session_new_with_options(
+      "max-conns", MAX(max_conns, 1), "max-conns-per-host", 6, "timeout", 15,
+      "idle-timeout", 90, "user-agent", "ModernDashboard-CorsGateway/1.0",
+      nullptr);
+
+  g_autoptr(SoupServer) server =
+      soup_server_new("server-header", "cors-gateway ", nullptr);
+  soup_server_add_handler(server, "/fetch", fetch_handler, &gateway, nullptr);
+  soup_server_add_handler(server, "/health", health_handler, &gateway, nullptr);
+  soup_server_add_handler(server, "/stats", stats_handler, &gateway, nullptr);
+
+  SoupServerListenOptions listen_options =
+      static_cast<SoupServerListenOptions>(0);
+  gboolean listening =
+      listen_all
+          ? soup_server_listen_all(server, port, listen_options, &error)
+          : soup_server_listen_local(server, port, listen_options, &error);
+  if (!listening) {
+    g_printerr("Cannot listen on port %d: %s\n", port, error->message);
+    return 1;
+  }
+  g_message("Listening on %s:%d for %s", listen_all ? "*" : "localhost", port,
+            allow);
+
+  g_autoptr(GMainLoop) loop = g_main_loop_new(nullptr, FALSE);
+  g_main_loop_run(loop);
+
+  g_object_unref(gateway.session);
+  g_hash_table_unref(gateway.inflight);
+  g_hash_table_unref(gateway.cache);
+  g_strfreev(gateway.allow_hosts);
+  g_strfreev(gateway.allow_origins);
+  g_free(allow);
+  g_free(origins);
+  return 0;
+}
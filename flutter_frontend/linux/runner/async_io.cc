@@ -0,0 +1,885 @@
+#include "async_io.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include "mpsc_queue.h"
+
+// The io_uring backend needs the uapi header of Linux 5.12 or later, which
+// defines the opcodes used here; older headers build the thread pool only.
+// The syscalls are made directly, so liburing is not needed.
+#if defined(__NR_io_uring_setup) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#if defined(IORING_FEAT_NATIVE_WORKERS)
+#define ASYNC_IO_HAVE_URING 1
+#endif
+#endif
+
+// Set to "threads" to keep requests off io_uring, e.g. to compare backends.
+static const char* kBackendEnvironment = "MODERN_DASHBOARD_ASYNC_IO";
+
+// Registered buffers for small reads and writes: 1 MiB in total.
+static const guint kFixedBuffers = 64;
+static const gsize kFixedBufferSize = 16 * 1024;
+
+namespace {
+
+enum class Op { kOpen, kClose, kRead, kWrite, kFsync, kRename, kUnlink, kCall };
+
+struct Waiter {
+  AsyncIoCallback callback;
+  gpointer user_data;
+};
+
+struct Request {
+  Op op;
+  int fd = -1;
+  gchar* path = nullptr;
+  gchar* new_path = nullptr;
+  int flags = 0;
+  int mode = 0;
+  gsize length = 0;
+  goffset offset = 0;
+  GBytes* bytes = nullptr;
+  // Read target, or write source once copied into a registered buffer.
+  guint8* buffer = nullptr;
+  // Registered buffer index, or -1.
+  int slot = -1;
+  AsyncIoFunc func = nullptr;
+  gpointer func_data = nullptr;
+  // For writes, the order among the writes to |fd|.
+  guint64 sequence = 0;
+  // More than one when fsyncs were coalesced.
+  std::vector<Waiter> waiters;
+  gssize result = 0;
+};
+
+// Requests outstanding on a descriptor.
+//
+// An fsync only has to wait for the writes queued before it. While it
+// waits, later fsync requests join it and it waits for their writes as
+// well, so a stream of write-then-fsync pairs costs one fsync per batch. A
+// close waits for everything on the descriptor.
+struct FdState {
+  guint in_flight = 0;
+  guint writes_in_flight = 0;
+  guint64 writes_queued = 0;
+  Request* pending_fsync = nullptr;
+  // Writes up to this sequence number must finish before |pending_fsync|.
+  guint64 fsync_after = 0;
+  guint writes_before_fsync = 0;
+  Request* pending_close = nullptr;
+};
+
+bool has_descriptor(const Request* request) {
+  return request->op == Op::kClose || request->op == Op::kRead ||
+         request->op == Op::kWrite || request->op == Op::kFsync;
+}
+
+#ifdef ASYNC_IO_HAVE_URING
+
+// An io_uring driven through the raw syscalls: the submission and completion
+// rings are mapped from the kernel and shared with it.
+class Ring {
+ public:
+  Ring() = default;
+  ~Ring();
+
+  Ring(const Ring&) = delete;
+  Ring& operator=(const Ring&) = delete;
+
+  // Sets up a ring with room for |entries| submissions and probes the
+  // opcodes the kernel supports. Returns false if io_uring is unavailable.
+  bool Init(unsigned entries);
+
+  bool Supports(unsigned opcode) const {
+    return opcode < supported_.size() && supported_[opcode];
+  }
+
+  // Completions will signal |event_fd|.
+  bool RegisterEventFd(int event_fd) {
+    return Register(IORING_REGISTER_EVENTFD, &event_fd, 1) == 0;
+  }
+
+  bool RegisterBuffers(const struct iovec* iovecs, unsigned count) {
+    return Register(IORING_REGISTER_BUFFERS, iovecs, count) == 0;
+  }
+
+  unsigned capacity() const { return sq_entries_; }
+
+  // Returns a zeroed submission entry, or nullptr when the ring is full.
+  io_uring_sqe* NextSqe();
+
+  // Hands the entries taken since the last call to the kernel with one
+  // io_uring_enter(). Returns the number accepted or a negative errno; any
+  // not accepted stay queued for the next call.
+  int Submit();
+
+  bool HasUnsubmitted() const {
+    return sqe_tail_ != __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  }
+
+  // Moves the ready completions into |done|.
+  void Reap(std::vector<io_uring_cqe>* done);
+
+ private:
+  int Register(unsigned opcode, const void* arg, unsigned count) {
+    return syscall(__NR_io_uring_register, fd_, opcode, arg, count) < 0
+               ? -errno
+               : 0;
+  }
+
+  int fd_ = -1;
+  void* sq_ring_ = MAP_FAILED;
+  void* cq_ring_ = MAP_FAILED;
+  gsize sq_ring_size_ = 0;
+  gsize cq_ring_size_ = 0;
+  io_uring_sqe* sqes_ = static_cast<io_uring_sqe*>(MAP_FAILED);
+  gsize sqes_size_ = 0;
+
+  unsigned sq_entries_ = 0;
+  unsigned* sq_head_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned* sq_mask_ = nullptr;
+  unsigned* sq_array_ = nullptr;
+  // Entries prepared but not yet published through |sq_tail_|.
+  unsigned sqe_tail_ = 0;
+
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned* cq_mask_ = nullptr;
+  io_uring_cqe* cqes_ = nullptr;
+
+  std::vector<bool> supported_;
+};
+
+Ring::~Ring() {
+  if (sqes_ != MAP_FAILED) munmap(sqes_, sqes_size_);
+  if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != MAP_FAILED) munmap(sq_ring_, sq_ring_size_);
+  if (fd_ >= 0) close(fd_);
+}
+
+bool Ring::Init(unsigned entries) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  fd_ = syscall(__NR_io_uring_setup, entries, &params);
+  if (fd_ < 0) return false;
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = MAX(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) return false;
+  cq_ring_ = single_mmap
+                 ? sq_ring_
+                 : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+  if (cq_ring_ == MAP_FAILED) return false;
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  sqes_ = static_cast<io_uring_sqe*>(mmap(nullptr, sqes_size_,
+                                          PROT_READ | PROT_WRITE,
+                                          MAP_SHARED | MAP_POPULATE, fd_,
+                                          IORING_OFF_SQES));
+  if (sqes_ == MAP_FAILED) return false;
+
+  char* sq = static_cast<char*>(sq_ring_);
+  sq_entries_ = params.sq_entries;
+  sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+  sqe_tail_ = *sq_tail_;
+
+  char* cq = static_cast<char*>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+  // Kernels before 5.6 cannot probe; they also lack most of the opcodes.
+  std::vector<char> probe_buffer(
+      sizeof(io_uring_probe) + IORING_OP_LAST * sizeof(io_uring_probe_op), 0);
+  io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(probe_buffer.data());
+  if (Register(IORING_REGISTER_PROBE, probe, IORING_OP_LAST) != 0) return false;
+  supported_.assign(IORING_OP_LAST, false);
+  for (unsigned op = 0; op <= probe->last_op && op < IORING_OP_LAST; op++) {
+    supported_[op] = (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+  }
+  return true;
+}
+
+io_uring_sqe* Ring::NextSqe() {
+  unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  if (sqe_tail_ - head >= sq_entries_) return nullptr;
+  unsigned index = sqe_tail_ & *sq_mask_;
+  io_uring_sqe* sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sq_array_[index] = index;
+  sqe_tail_++;
+  return sqe;
+}
+
+int Ring::Submit() {
+  __atomic_store_n(sq_tail_, sqe_tail_, __ATOMIC_RELEASE);
+  unsigned count = sqe_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  if (count == 0) return 0;
+  long submitted =
+      syscall(__NR_io_uring_enter, fd_, count, 0, 0, nullptr, 0);
+  return submitted < 0 ? -errno : static_cast<int>(submitted);
+}
+
+void Ring::Reap(std::vector<io_uring_cqe>* done) {
+  unsigned head = *cq_head_;
+  unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  for (; head != tail; head++) done->push_back(cqes_[head & *cq_mask_]);
+  __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+}
+
+#endif  // ASYNC_IO_HAVE_URING
+
+// A GSource that submits queued requests before the main loop polls and
+// dispatches completions once the eventfd is signalled.
+struct CompletionSource {
+  GSource source;
+  AsyncIo* io;
+};
+
+}  // namespace
+
+struct _AsyncIo {
+  GObject parent_instance;
+
+#ifdef ASYNC_IO_HAVE_URING
+  Ring* ring;  // nullptr on the thread backend
+#endif
+  guint queue_depth;
+  guint ring_in_flight;
+
+  int event_fd;
+  GSource* source;
+  GThreadPool* pool;
+  MpscQueue<Request*>* pool_done;
+
+  guint8* buffers;  // kFixedBuffers slots, registered with the ring
+  std::vector<int>* free_slots;
+
+  std::deque<Request*>* ready;  // waiting to be submitted
+  std::unordered_map<int, FdState>* descriptors;
+  guint outstanding;
+
+  AsyncIoStats stats;
+};
+
+G_DEFINE_TYPE(AsyncIo, async_io, G_TYPE_OBJECT)
+
+// Runs |request| with plain syscalls. Returns the result or a negative errno.
+static gssize async_io_run_blocking(Request* request) {
+  gssize result = -1;
+  switch (request->op) {
+    case Op::kOpen:
+      result = open(request->path, request->flags | O_CLOEXEC, request->mode);
+      break;
+    case Op::kClose:
+      result = close(request->fd);
+      break;
+    case Op::kRead:
+      do {
+        result = pread(request->fd, request->buffer, request->length,
+                       request->offset);
+      } while (result < 0 && errno == EINTR);
+      break;
+    case Op::kWrite:
+      do {
+        result = pwrite(request->fd,
+                        g_bytes_get_data(request->bytes, nullptr),
+                        request->length, request->offset);
+      } while (result < 0 && errno == EINTR);
+      break;
+    case Op::kFsync:
+      result = fsync(request->fd);
+      break;
+    case Op::kRename:
+      result = rename(request->path, request->new_path);
+      break;
+    case Op::kUnlink:
+      result = unlink(request->path);
+      break;
+    case Op::kCall:
+      return request->func(request->func_data);
+  }
+  return result < 0 ? -errno : result;
+}
+
+// Runs one request on a pool thread.
+static void pool_run(gpointer data, gpointer user_data) {
+  AsyncIo* self = ASYNC_IO(user_data);
+  Request* request = static_cast<Request*>(data);
+  request->result = async_io_run_blocking(request);
+  self->pool_done->Push(request);
+  uint64_t one = 1;
+  if (write(self->event_fd, &one, sizeof(one)) < 0) {
+    g_warning("AsyncIo: failed to signal eventfd");
+  }
+}
+
+#ifdef ASYNC_IO_HAVE_URING
+
+static unsigned ring_opcode(const Request* request, gboolean fixed) {
+  switch (request->op) {
+    case Op::kOpen:
+      return IORING_OP_OPENAT;
+    case Op::kClose:
+      return IORING_OP_CLOSE;
+    case Op::kRead:
+      return fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    case Op::kWrite:
+      return fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    case Op::kFsync:
+      return IORING_OP_FSYNC;
+    case Op::kRename:
+      return IORING_OP_RENAMEAT;
+    case Op::kUnlink:
+      return IORING_OP_UNLINKAT;
+    case Op::kCall:
+      break;
+  }
+  return IORING_OP_LAST;
+}
+
+static void ring_prepare(Request* request, io_uring_sqe* sqe) {
+  sqe->opcode = ring_opcode(request, request->slot >= 0);
+  sqe->user_data = reinterpret_cast<uintptr_t>(request);
+  switch (request->op) {
+    case Op::kOpen:
+      sqe->fd = AT_FDCWD;
+      sqe->addr = reinterpret_cast<uintptr_t>(request->path);
+      sqe->len = request->mode;
+      sqe->open_flags = request->flags | O_CLOEXEC;
+      break;
+    case Op::kClose:
+    case Op::kFsync:
+      sqe->fd = request->fd;
+      break;
+    case Op::kRead:
+    case Op::kWrite:
+      sqe->fd = request->fd;
+      sqe->addr = reinterpret_cast<uintptr_t>(
+          request->buffer != nullptr
+              ? request->buffer
+              : g_bytes_get_data(request->bytes, nullptr));
+      sqe->len = request->length;
+      sqe->off = request->offset;
+      if (request->slot >= 0) sqe->buf_index = request->slot;
+      break;
+    case Op::kRename:
+      sqe->fd = AT_FDCWD;
+      sqe->addr = reinterpret_cast<uintptr_t>(request->path);
+      sqe->len = static_cast<__u32>(AT_FDCWD);
+      sqe->addr2 = reinterpret_cast<uintptr_t>(request->new_path);
+      break;
+    case Op::kUnlink:
+      sqe->fd = AT_FDCWD;
+      sqe->addr = reinterpret_cast<uintptr_t>(request->path);
+      break;
+    case Op::kCall:
+      break;
+  }
+}
+
+// Whether |request| can use a registered buffer right now.
+static gboolean ring_fits_slot(AsyncIo* self, const Request* request) {
+  return self->buffers != nullptr && !self->free_slots->empty() &&
+         request->length <= kFixedBufferSize &&
+         (request->op == Op::kRead || request->op == Op::kWrite) &&
+         self->ring->Supports(ring_opcode(request, TRUE));
+}
+
+// Queues |request| on the ring. Returns FALSE if the kernel lacks its
+// opcode, or TRUE with |*full| set if the ring has no room for it now.
+static gboolean ring_queue(AsyncIo* self, Request* request, gboolean* full) {
+  *full = FALSE;
+  if (self->ring == nullptr || request->op == Op::kCall) return FALSE;
+  gboolean fixed = ring_fits_slot(self, request);
+  if (!fixed && !self->ring->Supports(ring_opcode(request, FALSE))) {
+    return FALSE;
+  }
+  io_uring_sqe* sqe = self->ring_in_flight < self->queue_depth
+                          ? self->ring->NextSqe()
+                          : nullptr;
+  if (sqe == nullptr) {
+    *full = TRUE;
+    return TRUE;
+  }
+
+  if (fixed) {
+    // Small records skip the page pinning of an unregistered buffer.
+    request->slot = self->free_slots->back();
+    self->free_slots->pop_back();
+    request->buffer = self->buffers + request->slot * kFixedBufferSize;
+    if (request->op == Op::kWrite) {
+      memcpy(request->buffer, g_bytes_get_data(request->bytes, nullptr),
+             request->length);
+    }
+    self->stats.fixed_buffer_ops++;
+  } else if (request->op == Op::kRead) {
+    request->buffer = static_cast<guint8*>(g_malloc(MAX(request->length, 1)));
+  }
+  ring_prepare(request, sqe);
+  self->ring_in_flight++;
+  return TRUE;
+}
+
+#endif  // ASYNC_IO_HAVE_URING
+
+// Submits the ready requests: to the ring in one batch, and to the pool
+// when the ring cannot take them.
+static void async_io_submit(AsyncIo* self) {
+  while (!self->ready->empty()) {
+    Request* request = self->ready->front();
+#ifdef ASYNC_IO_HAVE_URING
+    gboolean full = FALSE;
+    if (ring_queue(self, request, &full)) {
+      if (full) break;
+      self->ready->pop_front();
+      continue;
+    }
+#endif
+    self->ready->pop_front();
+    if (request->op == Op::kRead && request->buffer == nullptr) {
+      request->buffer = static_cast<guint8*>(g_malloc(MAX(request->length, 1)));
+    }
+    self->stats.pool_ops++;
+    g_thread_pool_push(self->pool, request, nullptr);
+  }
+
+#ifdef ASYNC_IO_HAVE_URING
+  if (self->ring != nullptr && self->ring->HasUnsubmitted()) {
+    int submitted = self->ring->Submit();
+    if (submitted > 0) {
+      self->stats.ring_submits++;
+    } else if (submitted < 0 && submitted != -EAGAIN && submitted != -EBUSY &&
+               submitted != -EINTR) {
+      // Anything left is retried after the next completion.
+      g_warning("AsyncIo: io_uring_enter failed: %s", g_strerror(-submitted));
+    }
+  }
+#endif
+}
+
+// Makes |request| ready for submission.
+static void async_io_dispatch(AsyncIo* self, Request* request) {
+  if (request->op == Op::kFsync) self->stats.fsyncs++;
+  if (has_descriptor(request)) {
+    FdState& state = (*self->descriptors)[request->fd];
+    state.in_flight++;
+    if (request->op == Op::kWrite) state.writes_in_flight++;
+  }
+  self->ready->push_back(request);
+}
+
+// Dispatches the fsync and close on |fd| once nothing holds them back.
+static void async_io_advance(AsyncIo* self, int fd) {
+  auto it = self->descriptors->find(fd);
+  if (it == self->descriptors->end()) return;
+  FdState& state = it->second;
+  if (state.pending_fsync != nullptr && state.writes_before_fsync == 0) {
+    Request* fsync = state.pending_fsync;
+    state.pending_fsync = nullptr;
+    async_io_dispatch(self, fsync);
+  }
+  if (state.pending_close != nullptr && state.pending_fsync == nullptr &&
+      state.in_flight == 0) {
+    Request* close = state.pending_close;
+    state.pending_close = nullptr;
+    async_io_dispatch(self, close);
+  }
+  if (state.in_flight == 0 && state.pending_fsync == nullptr &&
+      state.pending_close == nullptr) {
+    self->descriptors->erase(it);
+  }
+}
+
+// Accounts for |request| finishing on its descriptor.
+static void async_io_release(AsyncIo* self, Request* request) {
+  auto it = self->descriptors->find(request->fd);
+  if (it == self->descriptors->end()) return;
+  FdState& state = it->second;
+  state.in_flight--;
+  if (request->op == Op::kWrite) {
+    state.writes_in_flight--;
+    if (state.pending_fsync != nullptr && request->sequence <= state.fsync_after) {
+      state.writes_before_fsync--;
+    }
+  }
+  async_io_advance(self, request->fd);
+}
+
+static void async_io_finish(AsyncIo* self, Request* request) {
+  if (has_descriptor(request)) async_io_release(self, request);
+  self->outstanding--;
+  self->stats.completed += request->waiters.size();
+
+  const guint8* data =
+      request->op == Op::kRead && request->result >= 0 ? request->buffer
+                                                       : nullptr;
+  for (const Waiter& waiter : request->waiters) {
+    if (waiter.callback != nullptr) {
+      waiter.callback(request->result, data, waiter.user_data);
+    }
+  }
+
+  if (request->slot >= 0) {
+    self->free_slots->push_back(request->slot);
+  } else if (request->op == Op::kRead) {
+    g_free(request->buffer);
+  }
+  g_free(request->path);
+  g_free(request->new_path);
+  if (request->bytes != nullptr) g_bytes_unref(request->bytes);
+  delete request;
+}
+
+// Runs the callbacks of everything that has completed, then submits what
+// became ready meanwhile.
+static void async_io_complete(AsyncIo* self) {
+  uint64_t count;
+  if (read(self->event_fd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+    g_warning("AsyncIo: failed to read eventfd");
+  }
+
+  // A callback may drop the last reference to the caller, and with it to us.
+  g_object_ref(self);
+  std::vector<Request*> done;
+#ifdef ASYNC_IO_HAVE_URING
+  if (self->ring != nullptr) {
+    std::vector<io_uring_cqe> completions;
+    self->ring->Reap(&completions);
+    self->ring_in_flight -= completions.size();
+    for (const io_uring_cqe& cqe : completions) {
+      Request* request = reinterpret_cast<Request*>(cqe.user_data);
+      request->result = cqe.res;
+      done.push_back(request);
+    }
+  }
+#endif
+  Request* request;
+  while (self->pool_done->Pop(&request)) done.push_back(request);
+
+  for (Request* finished : done) async_io_finish(self, finished);
+  async_io_submit(self);
+  g_object_unref(self);
+}
+
+static gboolean completion_source_prepare(GSource* source, gint* timeout) {
+  *timeout = -1;
+  async_io_submit(reinterpret_cast<CompletionSource*>(source)->io);
+  return FALSE;
+}
+
+static gboolean completion_source_dispatch(GSource* source, GSourceFunc callback,
+                                           gpointer user_data) {
+  async_io_complete(reinterpret_cast<CompletionSource*>(source)->io);
+  return G_SOURCE_CONTINUE;
+}
+
+static GSourceFuncs completion_source_funcs = {
+    completion_source_prepare,
+    nullptr,  // check: readiness comes from the unix fd.
+    completion_source_dispatch,
+    nullptr,  // finalize
+    nullptr,
+    nullptr,
+};
+
+// Takes ownership of |request| and queues it.
+static void async_io_queue(AsyncIo* self, Request* request,
+                           AsyncIoCallback callback, gpointer user_data) {
+  self->stats.submitted++;
+  if (request->op == Op::kFsync) self->stats.fsync_requests++;
+
+  if (self->event_fd < 0) {
+    // Nothing could wake the main loop; run inline instead.
+    request->waiters.push_back(Waiter{callback, user_data});
+    if (request->op == Op::kRead) {
+      request->buffer = static_cast<guint8*>(g_malloc(MAX(request->length, 1)));
+    }
+    request->result = async_io_run_blocking(request);
+    self->outstanding++;
+    async_io_finish(self, request);
+    return;
+  }
+
+  if (!has_descriptor(request)) {
+    request->waiters.push_back(Waiter{callback, user_data});
+    self->outstanding++;
+    async_io_dispatch(self, request);
+    return;
+  }
+
+  int fd = request->fd;
+  FdState& state = (*self->descriptors)[fd];
+  if (request->op == Op::kFsync) {
+    if (state.pending_fsync != nullptr) {
+      state.pending_fsync->waiters.push_back(Waiter{callback, user_data});
+      delete request;
+    } else {
+      request->waiters.push_back(Waiter{callback, user_data});
+      self->outstanding++;
+      state.pending_fsync = request;
+    }
+    // Every write in flight was queued before this request.
+    state.fsync_after = state.writes_queued;
+    state.writes_before_fsync = state.writes_in_flight;
+    async_io_advance(self, fd);
+    return;
+  }
+
+  request->waiters.push_back(Waiter{callback, user_data});
+  self->outstanding++;
+  if (request->op == Op::kClose) {
+    state.pending_close = request;
+    async_io_advance(self, fd);
+    return;
+  }
+  if (request->op == Op::kWrite) request->sequence = ++state.writes_queued;
+  async_io_dispatch(self, request);
+}
+
+static void async_io_drain(AsyncIo* self) {
+  while (self->outstanding > 0) {
+    async_io_submit(self);
+    struct pollfd poll_fd = {self->event_fd, POLLIN, 0};
+    if (poll(&poll_fd, 1, -1) < 0 && errno != EINTR) {
+      g_warning("AsyncIo: poll failed: %s", g_strerror(errno));
+      break;
+    }
+    async_io_complete(self);
+  }
+}
+
+static void async_io_dispose(GObject* object) {
+  AsyncIo* self = ASYNC_IO(object);
+
+  // The kernel may still be filling our buffers; finish everything first.
+  if (self->ready != nullptr && self->event_fd >= 0) async_io_drain(self);
+  if (self->source != nullptr) {
+    g_source_destroy(self->source);
+    g_clear_pointer(&self->source, g_source_unref);
+  }
+  if (self->pool != nullptr) {
+    g_thread_pool_free(self->pool, FALSE, TRUE);
+    self->pool = nullptr;
+  }
+#ifdef ASYNC_IO_HAVE_URING
+  delete self->ring;
+  self->ring = nullptr;
+#endif
+  if (self->buffers != nullptr) {
+    munmap(self->buffers, kFixedBuffers * kFixedBufferSize);
+    self->buffers = nullptr;
+  }
+  delete self->pool_done;
+  self->pool_done = nullptr;
+  delete self->free_slots;
+  self->free_slots = nullptr;
+  delete self->ready;
+  self->ready = nullptr;
+  delete self->descriptors;
+  self->descriptors = nullptr;
+  if (self->event_fd >= 0) {
+    close(self->event_fd);
+    self->event_fd = -1;
+  }
+
+  G_OBJECT_CLASS(async_io_parent_class)->dispose(object);
+}
+
+static void async_io_class_init(AsyncIoClass* klass) {
+  G_OBJECT_CLASS(klass)->dispose = async_io_dispose;
+}
+
+static void async_io_init(AsyncIo* self) {
+  self->event_fd = -1;
+}
+
+#ifdef ASYNC_IO_HAVE_URING
+
+// Sets up the ring, or leaves the thread backend in place if the kernel
+// refuses: io_uring may be missing, disabled by sysctl or blocked by a
+// seccomp filter.
+static void async_io_init_ring(AsyncIo* self) {
+  Ring* ring = new Ring();
+  if (!ring->Init(self->queue_depth) || !ring->RegisterEventFd(self->event_fd)) {
+    delete ring;
+    return;
+  }
+  self->ring = ring;
+  self->queue_depth = MIN(self->queue_depth, ring->capacity());
+
+  // Without registered buffers small requests use READ/WRITE like the rest;
+  // registration fails e.g. under a low RLIMIT_MEMLOCK on older kernels.
+  void* buffers = mmap(nullptr, kFixedBuffers * kFixedBufferSize,
+                       PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (buffers == MAP_FAILED) return;
+  struct iovec iovecs[kFixedBuffers];
+  for (guint i = 0; i < kFixedBuffers; i++) {
+    iovecs[i].iov_base = static_cast<guint8*>(buffers) + i * kFixedBufferSize;
+    iovecs[i].iov_len = kFixedBufferSize;
+  }
+  if (!ring->RegisterBuffers(iovecs, kFixedBuffers)) {
+    munmap(buffers, kFixedBuffers * kFixedBufferSize);
+    return;
+  }
+  self->buffers = static_cast<guint8*>(buffers);
+  for (guint i = kFixedBuffers; i > 0; i--) self->free_slots->push_back(i - 1);
+}
+
+#endif  // ASYNC_IO_HAVE_URING
+
+AsyncIo* async_io_new(guint queue_depth, guint max_threads) {
+  AsyncIo* self = ASYNC_IO(g_object_new(async_io_get_type(), nullptr));
+  self->queue_depth = MAX(queue_depth, 1u);
+  self->pool_done = new MpscQueue<Request*>();
+  self->free_slots = new std::vector<int>();
+  self->ready = new std::deque<Request*>();
+  self->descriptors = new std::unordered_map<int, FdState>();
+  self->pool = g_thread_pool_new(pool_run, self, MAX(max_threads, 1u), FALSE,
+                                 nullptr);
+
+  self->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (self->event_fd < 0) {
+    g_critical("AsyncIo: eventfd failed: %s", g_strerror(errno));
+    return self;
+  }
+  self->source =
+      g_source_new(&completion_source_funcs, sizeof(CompletionSource));
+  reinterpret_cast<CompletionSource*>(self->source)->io = self;
+  g_source_add_unix_fd(self->source, self->event_fd, G_IO_IN);
+  g_source_set_name(self->source, "AsyncIo");
+  g_source_attach(self->source, g_main_context_default());
+
+#ifdef ASYNC_IO_HAVE_URING
+  if (g_strcmp0(g_getenv(kBackendEnvironment), "threads") != 0) {
+    async_io_init_ring(self);
+  }
+#endif
+  return self;
+}
+
+const gchar* async_io_get_backend(AsyncIo* self) {
+  g_return_val_if_fail(ASYNC_IS_IO(self), nullptr);
+#ifdef ASYNC_IO_HAVE_URING
+  if (self->ring != nullptr) return "io_uring";
+#endif
+  return "threads";
+}
+
+void async_io_open(AsyncIo* self, const gchar* path, int flags, int mode,
+                   AsyncIoCallback callback, gpointer user_data) {
+  g_return_if_fail(ASYNC_IS_IO(self));
+  Request* request = new Request();
+  request->op = Op::kOpen;
+  request->path = g_strdup(path);
+  request->flags = flags;
+  request->mode = mode;
+  async_io_queue(self, request, callback, user_data);
+}
+
+void async_io_close(AsyncIo* self, int fd, AsyncIoCallback callback,
+                    gpointer user_data) {
+  g_return_if_fail(ASYNC_IS_IO(self));
+  Request* request = new Request();
+  request->op = Op::kClose;
+  request->fd = fd;
+  async_io_queue(self, request, callback, user_data);
+}
+
+void async_io_read(AsyncIo* self, int fd, gsize length, goffset offset,
+                   AsyncIoCallback callback, gpointer user_data) {
+  g_return_if_fail(ASYNC_IS_IO(self));
+  Request* request = new Request();
+  request->op = Op::kRead;
+  request->fd = fd;
+  request->length = length;
+  request->offset = offset;
+  async_io_queue(self, request, callback, user_data);
+}
+
+void async_io_write(AsyncIo* self, int fd, GBytes* bytes, goffset offset,
+                    AsyncIoCallback callback, gpointer user_data) {
+  g_return_if_fail(ASYNC_IS_IO(self));
+  Request* request = new Request();
+  request->op = Op::kWrite;
+  request->fd = fd;
+  request->bytes = g_bytes_ref(bytes);
+  request->length = g_bytes_get_size(bytes);
+  request->offset = offset;
+  async_io_queue(self, request, callback, user_data);
+}
+
+void async_io_fsync(AsyncIo* self, int fd, AsyncIoCallback callback,
+                    gpointer user_data) {
+  g_return_if_fail(ASYNC_IS_IO(self));
+  Request* request = new Request();
+  request->op = Op::kFsync;
+  request->fd = fd;
+  async_io_queue(self, request, callback, user_data);
+}
+
+void async_io_rename(AsyncIo* self, const gchar* from, const gchar* to,
+                     AsyncIoCallback callback, gpointer user_data) {
+  g_return_if_fail(ASYNC_IS_IO(self));
+  Request* request = new Request();
+  request->op = Op::kRename;
+  request->path = g_strdup(from);
+  request->new_path = g_strdup(to);
+  async_io_queue(self, request, callback, user_data);
+}
+
+void async_io_unlink(AsyncIo* self, const gchar* path, AsyncIoCallback callback,
+                     gpointer user_data) {
+  g_return_if_fail(ASYNC_IS_IO(self));
+  Request* request = new Request();
+  request->op = Op::kUnlink;
+  request->path = g_strdup(path);
+  async_io_queue(self, request, callback, user_data);
+}
+
+void async_io_call(AsyncIo* self, AsyncIoFunc func, gpointer data,
+                   AsyncIoCallback callback, gpointer user_data) {
+  g_return_if_fail(ASYNC_IS_IO(self));
+  Request* request = new Request();
+  request->op = Op::kCall;
+  request->func = func;
+  request->func_data = data;
+  async_io_queue(self, request, callback, user_data);
+}
+
+void async_io_flush(AsyncIo* self) {
+  g_return_if_fail(ASYNC_IS_IO(self));
+  if (self->ready != nullptr) async_io_submit(self);
+}
+
+void async_io_get_stats(AsyncIo* self, AsyncIoStats* stats) {
+  g_return_if_fail(ASYNC_IS_IO(self));
+  *stats = self->stats;
+}
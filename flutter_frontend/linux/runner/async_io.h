@@ -0,0 +1,188 @@
+#ifndef FLUTTER_ASYNC_IO_H_
+#define FLUTTER_ASYNC_IO_H_
+
+#include <glib-object.h>
+
+G_DECLARE_FINAL_TYPE(AsyncIo, async_io, ASYNC, IO, GObject)
+
+/**
+ * AsyncIo:
+ *
+ * Asynchronous file I/O for the runner's disk stores, with completions
+ * delivered on the main loop.
+ *
+ * Requests are queued and submitted together once per main loop iteration,
+ * or at once with async_io_flush(). Where the kernel allows it, they go
+ * through an io_uring: one io_uring_enter() submits the batch, and an
+ * eventfd registered with the ring wakes the main loop when completions are
+ * ready. Opcodes the kernel lacks, and all requests when io_uring is
+ * unavailable (old kernels, seccomp filters, `MODERN_DASHBOARD_ASYNC_IO=threads`),
+ * run on a thread pool that reports back through the same eventfd.
+ *
+ * Reads and writes of up to 16 KiB use a pool of buffers registered with
+ * the ring (READ_FIXED/WRITE_FIXED), so small records skip the per-request
+ * page pinning. Requests to fsync a descriptor are coalesced: one fsync is
+ * issued once the writes queued before it have completed, and it answers
+ * every request that arrived in the meantime.
+ *
+ * All functions must be called on the main thread, and callbacks run there.
+ */
+
+/**
+ * AsyncIoCallback:
+ * @result: the syscall's result (bytes transferred, a descriptor, or 0), or
+ *   a negative errno.
+ * @data: for reads, the bytes read; only valid during the callback.
+ * @user_data: the data passed with the request.
+ */
+typedef void (*AsyncIoCallback)(gssize result, const guint8* data,
+                                gpointer user_data);
+
+/**
+ * AsyncIoFunc:
+ * @data: the data passed to async_io_call().
+ *
+ * Blocking work run on the thread pool.
+ *
+ * Returns: the result handed to the callback.
+ */
+typedef gssize (*AsyncIoFunc)(gpointer data);
+
+/**
+ * AsyncIoStats:
+ *
+ * Counters since the #AsyncIo was created.
+ */
+typedef struct {
+  guint64 submitted;
+  guint64 completed;
+  guint64 ring_submits;    // io_uring_enter() calls that submitted requests
+  guint64 fixed_buffer_ops;
+  guint64 pool_ops;        // requests run on the thread pool
+  guint64 fsync_requests;
+  guint64 fsyncs;          // fsyncs actually issued
+} AsyncIoStats;
+
+/**
+ * async_io_new:
+ * @queue_depth: requests in flight at once; more wait in a queue.
+ * @max_threads: size of the thread pool.
+ *
+ * Returns: a new #AsyncIo.
+ */
+AsyncIo* async_io_new(guint queue_depth, guint max_threads);
+
+/**
+ * async_io_get_backend:
+ * @io: an #AsyncIo.
+ *
+ * Returns: "io_uring" or "threads".
+ */
+const gchar* async_io_get_backend(AsyncIo* io);
+
+/**
+ * async_io_open:
+ * @io: an #AsyncIo.
+ * @path: file to open.
+ * @flags: open(2) flags; O_CLOEXEC is always added.
+ * @mode: permissions for a created file.
+ * @callback: (nullable): called with the descriptor.
+ * @user_data: data for @callback.
+ */
+void async_io_open(AsyncIo* io, const gchar* path, int flags, int mode,
+                   AsyncIoCallback callback, gpointer user_data);
+
+/**
+ * async_io_close:
+ * @io: an #AsyncIo.
+ * @fd: descriptor to close once the requests queued before on it are done.
+ * @callback: (nullable): completion callback.
+ * @user_data: data for @callback.
+ */
+void async_io_close(AsyncIo* io, int fd, AsyncIoCallback callback,
+                    gpointer user_data);
+
+/**
+ * async_io_read:
+ * @io: an #AsyncIo.
+ * @fd: descriptor to read.
+ * @length: bytes to read.
+ * @offset: file offset to read at.
+ * @callback: called with the bytes read.
+ * @user_data: data for @callback.
+ */
+void async_io_read(AsyncIo* io, int fd, gsize length, goffset offset,
+                   AsyncIoCallback callback, gpointer user_data);
+
+/**
+ * async_io_write:
+ * @io: an #AsyncIo.
+ * @fd: descriptor to write.
+ * @bytes: data to write; referenced until the write completes.
+ * @offset: file offset to write at.
+ * @callback: (nullable): called with the bytes written.
+ * @user_data: data for @callback.
+ */
+void async_io_write(AsyncIo* io, int fd, GBytes* bytes, goffset offset,
+                    AsyncIoCallback callback, gpointer user_data);
+
+/**
+ * async_io_fsync:
+ * @io: an #AsyncIo.
+ * @fd: descriptor to sync.
+ * @callback: (nullable): called once the writes queued before this request
+ *   are on disk.
+ * @user_data: data for @callback.
+ */
+void async_io_fsync(AsyncIo* io, int fd, AsyncIoCallback callback,
+                    gpointer user_data);
+
+/**
+ * async_io_rename:
+ * @io: an #AsyncIo.
+ * @from: existing path.
+ * @to: new path, replaced atomically if it exists.
+ * @callback: (nullable): completion callback.
+ * @user_data: data for @callback.
+ */
+void async_io_rename(AsyncIo* io, const gchar* from, const gchar* to,
+                     AsyncIoCallback callback, gpointer user_data);
+
+/**
+ * async_io_unlink:
+ * @io: an #AsyncIo.
+ * @path: file to delete.
+ * @callback: (nullable): completion callback.
+ * @user_data: data for @callback.
+ */
+void async_io_unlink(AsyncIo* io, const gchar* path, AsyncIoCallback callback,
+                     gpointer user_data);
+
+/**
+ * async_io_call:
+ * @io: an #AsyncIo.
+ * @func: blocking work, such as a directory scan, to run on the pool.
+ * @data: data for @func.
+ * @callback: (nullable): called with the result of @func.
+ * @user_data: data for @callback.
+ */
+void async_io_call(AsyncIo* io, AsyncIoFunc func, gpointer data,
+                   AsyncIoCallback callback, gpointer user_data);
+
+/**
+ * async_io_flush:
+ * @io: an #AsyncIo.
+ *
+ * Submits queued requests now rather than at the end of the main loop
+ * iteration.
+ */
+void async_io_flush(AsyncIo* io);
+
+/**
+ * async_io_get_stats:
+ * @io: an #AsyncIo.
+ * @stats: (out): counters.
+ */
+void async_io_get_stats(AsyncIo* io, AsyncIoStats* stats);
+
+#endif  // FLUTTER_ASYNC_IO_H_
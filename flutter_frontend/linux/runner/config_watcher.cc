@@ -0,0 +1,601 @@
+#include "config_watcher.h"
+
+#include <glib-unix.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+static const char* kChannelName = "modern_dashboard/config";
+
+// Replaces the config directory, e.g. on a kiosk image that ships one.
+static const char* kDirectoryEnvironment = "MODERN_DASHBOARD_CONFIG_DIR";
+
+// An editor's save is several events. A reload waits for this much quiet
+// after the last one, but never more than kMaxDelayMs after the first.
+static const gint64 kDebounceMs = 20;
+static const gint64 kMaxDelayMs = 60;
+
+// How often to look for the directory again after it went away.
+static const guint kRewatchSeconds = 2;
+
+static const guint32 kWatchMask = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+                                  IN_MOVED_FROM | IN_MOVED_TO |
+                                  IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+// Groups named "feed <id>" define feeds.
+static const char* kFeedGroupPrefix = "feed ";
+
+namespace {
+
+enum class OptionType { kWidgets, kInteger };
+
+struct Option {
+  const char* group;
+  const char* key;
+  const char* name;  // key in the map Dart sees
+  OptionType type;
+  gint64 min;
+  gint64 max;
+};
+
+}  // namespace
+
+static const Option kOptions[] = {
+    {"layout", "widgets", "widgets", OptionType::kWidgets, 0, 0},
+    {"refresh", "dashboard", "dashboardSeconds", OptionType::kInteger, 10,
+     24 * 60 * 60},
+    {"refresh", "weather_current", "weatherCurrentSeconds",
+     OptionType::kInteger, 60, 24 * 60 * 60},
+    {"refresh", "weather_forecast", "weatherForecastSeconds",
+     OptionType::kInteger, 5 * 60, 24 * 60 * 60},
+    {"refresh", "weather_calls_per_hour", "weatherMaxCallsPerHour",
+     OptionType::kInteger, 1, 3600},
+};
+
+// Widgets the dashboard layout can build
+// (lib/widgets/dashboard/dashboard_layout.dart).
+static const char* const kWidgetIds[] = {"news", "weather", "todo",
+                                         "video", "mail",    nullptr};
+
+static const char* const kFeedKeys[] = {"name", "url", "category", "active",
+                                        nullptr};
+
+// The sections of the config Dart sees, each a map.
+static const char* kSections[] = {"layout", "refresh", "feeds"};
+
+struct _ConfigWatcher {
+  GObject parent_instance;
+
+  FlMethodChannel* channel;
+  gchar* directory;
+  int inotify_fd;
+  int watch;  // -1 while the directory is not watched
+  guint inotify_source_id;
+  guint debounce_source_id;
+  guint rewatch_source_id;
+  gint64 burst_started_us;  // first event not yet reloaded, or 0
+
+  FlValue* config;
+  guint64 generation;
+  gchar* error;  // why the files on disk are not in force, or nullptr
+
+  guint64 reloads;
+  guint64 rejected;
+  guint64 unchanged;
+  gint64 last_latency_us;
+};
+
+G_DEFINE_TYPE(ConfigWatcher, config_watcher, G_TYPE_OBJECT)
+
+static FlValue* config_new_empty() {
+  FlValue* config = fl_value_new_map();
+  for (const char* section : kSections) {
+    fl_value_set_string_take(config, section, fl_value_new_map());
+  }
+  return config;
+}
+
+static gint compare_names(gconstpointer a, gconstpointer b) {
+  return strcmp(*static_cast<const gchar* const*>(a),
+                *static_cast<const gchar* const*>(b));
+}
+
+// Copies every value of |from| into |to|, replacing the ones already there.
+static void merge_key_file(GKeyFile* to, GKeyFile* from) {
+  g_auto(GStrv) groups = g_key_file_get_groups(from, nullptr);
+  for (gchar** group = groups; *group != nullptr; group++) {
+    g_auto(GStrv) keys = g_key_file_get_keys(from, *group, nullptr, nullptr);
+    for (gchar** key = keys; key != nullptr && *key != nullptr; key++) {
+      g_autofree gchar* value =
+          g_key_file_get_value(from, *group, *key, nullptr);
+      if (value != nullptr) g_key_file_set_value(to, *group, *key, value);
+    }
+  }
+}
+
+// Reads the *.conf files in |directory|, in name order, into one key file.
+// A missing directory is an empty config.
+static GKeyFile* read_config_files(const gchar* directory, GError** error) {
+  GKeyFile* merged = g_key_file_new();
+  g_autoptr(GDir) dir = g_dir_open(directory, 0, nullptr);
+  if (dir == nullptr) return merged;
+
+  g_autoptr(GPtrArray) names = g_ptr_array_new_with_free_func(g_free);
+  const gchar* name;
+  while ((name = g_dir_read_name(dir)) != nullptr) {
+    // Editors keep their swap and backup files hidden.
+    if (name[0] != '.' && g_str_has_suffix(name, ".conf")) {
+      g_ptr_array_add(names, g_strdup(name));
+    }
+  }
+  g_ptr_array_sort(names, compare_names);
+
+  for (guint i = 0; i < names->len; i++) {
+    name = static_cast<const gchar*>(g_ptr_array_index(names, i));
+    g_autofree gchar* path = g_build_filename(directory, name, nullptr);
+    g_autoptr(GKeyFile) file = g_key_file_new();
+    g_autoptr(GError) file_error = nullptr;
+    if (g_key_file_load_from_file(file, path, G_KEY_FILE_NONE, &file_error)) {
+      merge_key_file(merged, file);
+    } else if (!g_error_matches(file_error, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
+      // A file renamed away since the listing is simply gone.
+      g_set_error(error, file_error->domain, file_error->code, "%s: %s", name,
+                  file_error->message);
+      g_key_file_free(merged);
+      return nullptr;
+    }
+  }
+  return merged;
+}
+
+static FlValue* parse_widgets(GKeyFile* file, const Option* option,
+                              GError** error) {
+  gsize length = 0;
+  g_auto(GStrv) ids = g_key_file_get_string_list(file, option->group,
+                                                 option->key, &length, error);
+  if (ids == nullptr) return nullptr;
+
+  g_autoptr(FlValue) widgets = fl_value_new_list();
+  for (gsize i = 0; i < length; i++) {
+    const gchar* id = g_strstrip(ids[i]);
+    if (!g_strv_contains(kWidgetIds, id)) {
+      g_set_error(error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_INVALID_VALUE,
+                  "[%s] %s: unknown widget \"%s\"", option->group, option->key,
+                  id);
+      return nullptr;
+    }
+    for (size_t j = 0; j < fl_value_get_length(widgets); j++) {
+      if (g_strcmp0(fl_value_get_string(fl_value_get_list_value(widgets, j)),
+                    id) == 0) {
+        g_set_error(error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_INVALID_VALUE,
+                    "[%s] %s: \"%s\" is listed twice", option->group,
+                    option->key, id);
+        return nullptr;
+      }
+    }
+    fl_value_append_take(widgets, fl_value_new_string(id));
+  }
+  if (fl_value_get_length(widgets) == 0) {
+    g_set_error(error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_INVALID_VALUE,
+                "[%s] %s: no widgets listed", option->group, option->key);
+    return nullptr;
+  }
+  return fl_value_ref(widgets);
+}
+
+static FlValue* parse_integer(GKeyFile* file, const Option* option,
+                              GError** error) {
+  g_autoptr(GError) parse_error = nullptr;
+  gint64 value =
+      g_key_file_get_int64(file, option->group, option->key, &parse_error);
+  if (parse_error != nullptr) {
+    g_propagate_prefixed_error(error, g_steal_pointer(&parse_error),
+                               "[%s] %s: ", option->group, option->key);
+    return nullptr;
+  }
+  if (value < option->min || value > option->max) {
+    g_set_error(error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_INVALID_VALUE,
+                "[%s] %s: %" G_GINT64_FORMAT " is outside %" G_GINT64_FORMAT
+                "..%" G_GINT64_FORMAT,
+                option->group, option->key, value, option->min, option->max);
+    return nullptr;
+  }
+  return fl_value_new_int(value);
+}
+
+// Returns the feed defined by |group| as {name, url, category, active}.
+static FlValue* parse_feed(GKeyFile* file, const gchar* group,
+                           const gchar* id, GError** error) {
+  g_auto(GStrv) keys = g_key_file_get_keys(file, group, nullptr, nullptr);
+  for (gchar** key = keys; key != nullptr && *key != nullptr; key++) {
+    if (!g_strv_contains(kFeedKeys, *key)) {
+      g_set_error(error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_KEY_NOT_FOUND,
+                  "[%s] %s: unknown option", group, *key);
+      return nullptr;
+    }
+  }
+
+  g_autofree gchar* url = g_key_file_get_string(file, group, "url", nullptr);
+  g_autoptr(GUri) uri =
+      url != nullptr ? g_uri_parse(url, G_URI_FLAGS_NONE, nullptr) : nullptr;
+  const gchar* scheme = uri != nullptr ? g_uri_get_scheme(uri) : nullptr;
+  const gchar* host = uri != nullptr ? g_uri_get_host(uri) : nullptr;
+  if (scheme == nullptr || host == nullptr || host[0] == '\0' ||
+      (g_ascii_strcasecmp(scheme, "http") != 0 &&
+       g_ascii_strcasecmp(scheme, "https") != 0)) {
+    g_set_error(error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_INVALID_VALUE,
+                "[%s] url: an http or https URL is required", group);
+    return nullptr;
+  }
+
+  g_autofree gchar* name = g_key_file_get_string(file, group, "name", nullptr);
+  g_autofree gchar* category =
+      g_key_file_get_string(file, group, "category", nullptr);
+  gboolean active = TRUE;
+  if (g_key_file_has_key(file, group, "active", nullptr)) {
+    g_autoptr(GError) parse_error = nullptr;
+    active = g_key_file_get_boolean(file, group, "active", &parse_error);
+    if (parse_error != nullptr) {
+      g_propagate_prefixed_error(error, g_steal_pointer(&parse_error),
+                                 "[%s] active: ", group);
+      return nullptr;
+    }
+  }
+
+  FlValue* feed = fl_value_new_map();
+  fl_value_set_string_take(feed, "name",
+                           fl_value_new_string(name != nullptr ? name : id));
+  fl_value_set_string_take(feed, "url", fl_value_new_string(url));
+  fl_value_set_string_take(
+      feed, "category",
+      fl_value_new_string(category != nullptr ? category : "General"));
+  fl_value_set_string_take(feed, "active", fl_value_new_bool(active));
+  return feed;
+}
+
+static const Option* find_option(const gchar* group, const gchar* key) {
+  for (const Option& option : kOptions) {
+    if (g_strcmp0(option.group, group) == 0 &&
+        g_strcmp0(option.key, key) == 0) {
+      return &option;
+    }
+  }
+  return nullptr;
+}
+
+// Validates |file| against the schema and returns the config Dart sees, or
+// nullptr with |error| set.
+static FlValue* parse_config(GKeyFile* file, GError** error) {
+  g_autoptr(FlValue) config = config_new_empty();
+  g_auto(GStrv) groups = g_key_file_get_groups(file, nullptr);
+  for (gchar** group = groups; *group != nullptr; group++) {
+    if (g_str_has_prefix(*group, kFeedGroupPrefix)) {
+      const gchar* id = *group + strlen(kFeedGroupPrefix);
+      if (id[0] == '\0') {
+        g_set_error(error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_GROUP_NOT_FOUND,
+                    "[%s]: a feed needs an id", *group);
+        return nullptr;
+      }
+      FlValue* feed = parse_feed(file, *group, id, error);
+      if (feed == nullptr) return nullptr;
+      fl_value_set_string_take(fl_value_lookup_string(config, "feeds"), id,
+                               feed);
+      continue;
+    }
+
+    g_auto(GStrv) keys = g_key_file_get_keys(file, *group, nullptr, nullptr);
+    for (gchar** key = keys; key != nullptr && *key != nullptr; key++) {
+      const Option* option = find_option(*group, *key);
+      if (option == nullptr) {
+        g_set_error(error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_KEY_NOT_FOUND,
+                    "[%s] %s: unknown option", *group, *key);
+        return nullptr;
+      }
+      FlValue* value = option->type == OptionType::kWidgets
+                           ? parse_widgets(file, option, error)
+                           : parse_integer(file, option, error);
+      if (value == nullptr) return nullptr;
+      fl_value_set_string_take(fl_value_lookup_string(config, option->group),
+                               option->name, value);
+    }
+  }
+  return fl_value_ref(config);
+}
+
+// Returns the options of |to| that differ from |from|, with null for the
+// ones |to| dropped, by section; or nullptr when nothing changed.
+static FlValue* config_diff(FlValue* from, FlValue* to) {
+  g_autoptr(FlValue) changes = fl_value_new_map();
+  for (const char* name : kSections) {
+    FlValue* old_section = fl_value_lookup_string(from, name);
+    FlValue* new_section = fl_value_lookup_string(to, name);
+    g_autoptr(FlValue) section = fl_value_new_map();
+    for (size_t i = 0; i < fl_value_get_length(new_section); i++) {
+      FlValue* key = fl_value_get_map_key(new_section, i);
+      FlValue* value = fl_value_get_map_value(new_section, i);
+      FlValue* old_value = fl_value_lookup(old_section, key);
+      if (old_value == nullptr || !fl_value_equal(old_value, value)) {
+        fl_value_set(section, key, value);
+      }
+    }
+    for (size_t i = 0; i < fl_value_get_length(old_section); i++) {
+      FlValue* key = fl_value_get_map_key(old_section, i);
+      if (fl_value_lookup(new_section, key) == nullptr) {
+        fl_value_set_take(section, fl_value_ref(key), fl_value_new_null());
+      }
+    }
+    if (fl_value_get_length(section) > 0) {
+      fl_value_set_string(changes, name, section);
+    }
+  }
+  return fl_value_get_length(changes) > 0 ? fl_value_ref(changes) : nullptr;
+}
+
+static void config_watcher_reload(ConfigWatcher* self) {
+  gint64 started_us = self->burst_started_us != 0 ? self->burst_started_us
+                                                  : g_get_monotonic_time();
+  self->burst_started_us = 0;
+  self->reloads++;
+
+  g_autoptr(GError) error = nullptr;
+  g_autoptr(GKeyFile) file = read_config_files(self->directory, &error);
+  g_autoptr(FlValue) config =
+      file != nullptr ? parse_config(file, &error) : nullptr;
+  if (config == nullptr) {
+    self->rejected++;
+    g_free(self->error);
+    self->error = g_strdup(error->message);
+    g_warning("ConfigWatcher: keeping the previous config: %s",
+              error->message);
+    if (self->channel != nullptr) {
+      g_autoptr(FlValue) args = fl_value_new_map();
+      fl_value_set_string_take(args, "error",
+                               fl_value_new_string(error->message));
+      fl_method_channel_invoke_method(self->channel, "configRejected", args,
+                                      nullptr, nullptr, nullptr);
+    }
+    return;
+  }
+  g_clear_pointer(&self->error, g_free);
+
+  g_autoptr(FlValue) changes = config_diff(self->config, config);
+  if (changes == nullptr) {
+    self->unchanged++;
+    return;
+  }
+  fl_value_unref(self->config);
+  self->config = fl_value_ref(config);
+  self->generation++;
+  self->last_latency_us = g_get_monotonic_time() - started_us;
+
+  if (self->channel != nullptr) {
+    g_autoptr(FlValue) args = fl_value_new_map();
+    fl_value_set_string_take(args, "generation",
+                             fl_value_new_int(self->generation));
+    fl_value_set_string(args, "changes", changes);
+    fl_value_set_string_take(args, "latencyUs",
+                             fl_value_new_int(self->last_latency_us));
+    fl_method_channel_invoke_method(self->channel, "configChanged", args,
+                                    nullptr, nullptr, nullptr);
+  }
+}
+
+static gboolean reload_cb(gpointer user_data) {
+  ConfigWatcher* self = CONFIG_WATCHER(user_data);
+  self->debounce_source_id = 0;
+  config_watcher_reload(self);
+  return G_SOURCE_REMOVE;
+}
+
+static void config_watcher_schedule_reload(ConfigWatcher* self) {
+  gint64 now = g_get_monotonic_time();
+  if (self->burst_started_us == 0) self->burst_started_us = now;
+  gint64 left_ms = kMaxDelayMs - (now - self->burst_started_us) / 1000;
+  if (self->debounce_source_id != 0) g_source_remove(self->debounce_source_id);
+  self->debounce_source_id =
+      g_timeout_add(CLAMP(left_ms, 0, kDebounceMs), reload_cb, self);
+}
+
+static gboolean config_watcher_watch(ConfigWatcher* self) {
+  self->watch =
+      inotify_add_watch(self->inotify_fd, self->directory, kWatchMask);
+  return self->watch >= 0;
+}
+
+static gboolean rewatch_cb(gpointer user_data) {
+  ConfigWatcher* self = CONFIG_WATCHER(user_data);
+  if (!config_watcher_watch(self)) return G_SOURCE_CONTINUE;
+  self->rewatch_source_id = 0;
+  // The files may have changed while nothing was watching.
+  config_watcher_schedule_reload(self);
+  return G_SOURCE_REMOVE;
+}
+
+static void config_watcher_schedule_rewatch(ConfigWatcher* self) {
+  if (self->rewatch_source_id != 0) return;
+  self->rewatch_source_id =
+      g_timeout_add_seconds(kRewatchSeconds, rewatch_cb, self);
+}
+
+static gboolean inotify_cb(gint fd, GIOCondition condition,
+                           gpointer user_data) {
+  ConfigWatcher* self = CONFIG_WATCHER(user_data);
+
+  gboolean changed = FALSE;
+  gboolean lost = FALSE;
+  alignas(struct inotify_event) char buffer[4096];
+  ssize_t length;
+  while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+    for (char* next = buffer; next < buffer + length;) {
+      const struct inotify_event* event =
+          reinterpret_cast<const struct inotify_event*>(next);
+      next += sizeof(struct inotify_event) + event->len;
+      if (event->mask & IN_MOVE_SELF) {
+        // The watch would follow the directory to its new name.
+        inotify_rm_watch(fd, event->wd);
+      } else if (event->mask & IN_IGNORED) {
+        lost = TRUE;
+      } else if (event->mask & IN_Q_OVERFLOW) {
+        changed = TRUE;
+      } else if (event->len > 0 && event->name[0] != '.' &&
+                 g_str_has_suffix(event->name, ".conf")) {
+        changed = TRUE;
+      }
+    }
+  }
+
+  // While the directory is missing the last config stays in force.
+  if (lost && self->watch >= 0) {
+    g_warning("ConfigWatcher: %s went away", self->directory);
+    self->watch = -1;
+    config_watcher_schedule_rewatch(self);
+  } else if (changed) {
+    config_watcher_schedule_reload(self);
+  }
+  return G_SOURCE_CONTINUE;
+}
+
+static FlValue* config_watcher_describe(ConfigWatcher* self) {
+  FlValue* result = fl_value_new_map();
+  fl_value_set_string_take(result, "generation",
+                           fl_value_new_int(self->generation));
+  fl_value_set_string(result, "config", self->config);
+  fl_value_set_string_take(result, "directory",
+                           fl_value_new_string(self->directory));
+  fl_value_set_string_take(result, "error",
+                           self->error != nullptr
+                               ? fl_value_new_string(self->error)
+                               : fl_value_new_null());
+  return result;
+}
+
+static FlValue* config_watcher_get_stats(ConfigWatcher* self) {
+  FlValue* stats = fl_value_new_map();
+  fl_value_set_string_take(stats, "generation",
+                           fl_value_new_int(self->generation));
+  fl_value_set_string_take(stats, "watching",
+                           fl_value_new_bool(self->watch >= 0));
+  fl_value_set_string_take(stats, "reloads", fl_value_new_int(self->reloads));
+  fl_value_set_string_take(stats, "rejected",
+                           fl_value_new_int(self->rejected));
+  fl_value_set_string_take(stats, "unchanged",
+                           fl_value_new_int(self->unchanged));
+  fl_value_set_string_take(stats, "lastLatencyUs",
+                           fl_value_new_int(self->last_latency_us));
+  return stats;
+}
+
+// Handles the channel methods.
+static void method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
+                           gpointer user_data) {
+  ConfigWatcher* self = CONFIG_WATCHER(user_data);
+  const gchar* method = fl_method_call_get_name(method_call);
+
+  g_autoptr(FlMethodResponse) response = nullptr;
+  if (g_strcmp0(method, "getConfig") == 0) {
+    g_autoptr(FlValue) result = config_watcher_describe(self);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (g_strcmp0(method, "getStats") == 0) {
+    g_autoptr(FlValue) stats = config_watcher_get_stats(self);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(stats));
+  } else {
+    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(method_call, response, &error)) {
+    g_warning("ConfigWatcher: failed to respond to %s: %s", method,
+              error->message);
+  }
+}
+
+static void config_watcher_dispose(GObject* object) {
+  ConfigWatcher* self = CONFIG_WATCHER(object);
+
+  if (self->inotify_source_id != 0) {
+    g_source_remove(self->inotify_source_id);
+    self->inotify_source_id = 0;
+  }
+  if (self->debounce_source_id != 0) {
+    g_source_remove(self->debounce_source_id);
+    self->debounce_source_id = 0;
+  }
+  if (self->rewatch_source_id != 0) {
+    g_source_remove(self->rewatch_source_id);
+    self->rewatch_source_id = 0;
+  }
+  if (self->inotify_fd >= 0) {
+    close(self->inotify_fd);
+    self->inotify_fd = -1;
+  }
+  g_clear_object(&self->channel);
+  g_clear_pointer(&self->config, fl_value_unref);
+  g_clear_pointer(&self->directory, g_free);
+  g_clear_pointer(&self->error, g_free);
+
+  G_OBJECT_CLASS(config_watcher_parent_class)->dispose(object);
+}
+
+static void config_watcher_class_init(ConfigWatcherClass* klass) {
+  G_OBJECT_CLASS(klass)->dispose = config_watcher_dispose;
+}
+
+static void config_watcher_init(ConfigWatcher* self) {
+  self->inotify_fd = -1;
+  self->watch = -1;
+}
+
+ConfigWatcher* config_watcher_new() {
+  ConfigWatcher* self =
+      CONFIG_WATCHER(g_object_new(config_watcher_get_type(), nullptr));
+
+  const gchar* directory = g_getenv(kDirectoryEnvironment);
+  self->directory =
+      directory != nullptr && directory[0] != '\0'
+          ? g_strdup(directory)
+          : g_build_filename(g_get_user_config_dir(), APPLICATION_ID, nullptr);
+  self->config = config_new_empty();
+
+  // Watch before the first read so no change slips in between, and even
+  // without a config so one dropped in later applies.
+  self->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (self->inotify_fd >= 0) {
+    self->inotify_source_id =
+        g_unix_fd_add(self->inotify_fd, G_IO_IN, inotify_cb, self);
+    g_mkdir_with_parents(self->directory, 0700);
+    if (!config_watcher_watch(self)) {
+      g_warning("ConfigWatcher: cannot watch %s", self->directory);
+      config_watcher_schedule_rewatch(self);
+    }
+  } else {
+    g_warning("ConfigWatcher: inotify unavailable, %s is read once",
+              self->directory);
+  }
+
+  config_watcher_reload(self);
+  return self;
+}
+
+void config_watcher_attach(ConfigWatcher* self, FlBinaryMessenger* messenger) {
+  g_clear_object(&self->channel);
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  self->channel =
+      fl_method_channel_new(messenger, kChannelName, FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(self->channel, method_call_cb, self,
+                                            nullptr);
+}
+
+guint64 config_watcher_get_generation(ConfigWatcher* self) {
+  g_return_val_if_fail(CONFIG_IS_WATCHER(self), 0);
+  return self->generation;
+}
+
+FlValue* config_watcher_get_config(ConfigWatcher* self) {
+  g_return_val_if_fail(CONFIG_IS_WATCHER(self), nullptr);
+  return self->config;
+}
+
+const gchar* config_watcher_get_error(ConfigWatcher* self) {
+  g_return_val_if_fail(CONFIG_IS_WATCHER(self), nullptr);
+  return self->error;
+}
@@ -0,0 +1,97 @@
+#ifndef FLUTTER_CONFIG_WATCHER_H_
+#define FLUTTER_CONFIG_WATCHER_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+G_DECLARE_FINAL_TYPE(ConfigWatcher, config_watcher, CONFIG, WATCHER, GObject)
+
+/**
+ * ConfigWatcher:
+ *
+ * Local dashboard configuration that is applied while the app runs.
+ *
+ * The configuration is every `*.conf` key file in
+ * `$XDG_CONFIG_HOME/<application id>` (or `$MODERN_DASHBOARD_CONFIG_DIR`),
+ * read in name order with later files overriding earlier ones:
+ *
+ * |[
+ * [layout]
+ * widgets=weather;news;video
+ *
+ * [refresh]
+ * dashboard=120
+ * weather_current=600
+ * weather_forecast=3600
+ * weather_calls_per_hour=120
+ *
+ * [feed bbc]
+ * name=BBC News
+ * url=https://feeds.bbci.co.uk/news/rss.xml
+ * category=News
+ * active=true
+ * ]|
+ *
+ * The directory is watched with inotify. A burst of events is debounced
+ * for 20 ms, and never delayed more than 60 ms past its first event. The
+ * files are then re-read and validated against the schema above. A config
+ * that does not validate, such as one caught mid-edit, is rejected as a
+ * whole and the previous one stays in force.
+ *
+ * Dart sees the config as `{layout, refresh, feeds}` maps keyed by option
+ * (refresh options as `dashboardSeconds`, `weatherCurrentSeconds`,
+ * `weatherForecastSeconds` and `weatherMaxCallsPerHour`; feeds by the id in
+ * the group name). After a change the runner invokes `configChanged
+ * {generation, changes, latencyUs}` on the `modern_dashboard/config`
+ * channel. @changes holds only the sections and options that differ from
+ * the previous generation, with %NULL for removed ones. A rejected config
+ * is reported with `configRejected {error}`.
+ *
+ * Methods served on the channel:
+ *  - `getConfig` answers `{generation, config, directory, error}`;
+ *  - `getStats`.
+ */
+
+/**
+ * config_watcher_new:
+ *
+ * Loads the configuration and starts watching its directory.
+ *
+ * Returns: a new #ConfigWatcher.
+ */
+ConfigWatcher* config_watcher_new();
+
+/**
+ * config_watcher_attach:
+ * @watcher: a #ConfigWatcher.
+ * @messenger: an #FlBinaryMessenger.
+ *
+ * Serves the method channel on @messenger once the engine exists.
+ */
+void config_watcher_attach(ConfigWatcher* watcher,
+                           FlBinaryMessenger* messenger);
+
+/**
+ * config_watcher_get_generation:
+ * @watcher: a #ConfigWatcher.
+ *
+ * Returns: how many configs have been applied; 0 while the config is empty.
+ */
+guint64 config_watcher_get_generation(ConfigWatcher* watcher);
+
+/**
+ * config_watcher_get_config:
+ * @watcher: a #ConfigWatcher.
+ *
+ * Returns: (transfer none): the config in force, as Dart sees it.
+ */
+FlValue* config_watcher_get_config(ConfigWatcher* watcher);
+
+/**
+ * config_watcher_get_error:
+ * @watcher: a #ConfigWatcher.
+ *
+ * Returns: (nullable): why the files on disk are not in force, or %NULL.
+ */
+const gchar* config_watcher_get_error(ConfigWatcher* watcher);
+
+#endif  // FLUTTER_CONFIG_WATCHER_H_
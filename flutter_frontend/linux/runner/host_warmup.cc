@@ -0,0 +1,597 @@
+#include "host_warmup.h"
+
+#include <arpa/inet.h>
+#include <arpa/nameser.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <resolv.h>
+#include <sys/socket.h>
+
+#include "native_bridge.h"
+
+static const char* kChannelName = "modern_dashboard/host_warmup";
+
+// Origins resolved at startup and offered to Dart for pre-connecting.
+static const guint kWarmOrigins = 24;
+
+// Scores are halved on every launch so hosts that are no longer used fade
+// out; below this they are forgotten.
+static const double kScoreDecay = 0.5;
+static const double kMinScore = 0.05;
+
+// Bounds on cached TTLs. Very short TTLs still cover the launch burst, and
+// long ones must not pin a host that moved for days.
+static const guint32 kMinTtl = 30;
+static const guint32 kMaxTtl = 6 * 60 * 60;
+
+// TTL for getaddrinfo() answers, which do not carry one.
+static const guint32 kFallbackTtl = 60;
+
+// Delay before changed tables are written.
+static const guint kSaveDelaySeconds = 5;
+
+// Finished lookups applied per main-loop dispatch.
+static const guint kResultBatch = 32;
+
+namespace {
+
+struct DnsEntry {
+  GPtrArray* addresses;  // gchar*
+  gint64 expires_us;     // wall clock
+  gboolean resolving;
+  GPtrArray* waiters;  // FlMethodCall*
+};
+
+// A queued lookup. It holds its own references rather than one to the
+// HostWarmup, so disposing that never waits for a lookup to finish.
+struct ResolveJob {
+  gchar* host;
+  NativeBridge* results;
+  GCancellable* cancellable;
+};
+
+}  // namespace
+
+struct _HostWarmup {
+  GObject parent_instance;
+
+  FlMethodChannel* channel;
+  NativeBridge* results;
+  GCancellable* cancellable;
+  GThreadPool* pool;
+  gchar* directory;
+  gint64 launched_at_us;
+
+  // Only touched on the main thread; workers just resolve.
+  GHashTable* dns;     // host -> DnsEntry*
+  GHashTable* scores;  // origin -> double*
+  guint save_source_id;
+
+  guint64 hits;
+  guint64 resolved;
+  guint64 failed;
+};
+
+G_DEFINE_TYPE(HostWarmup, host_warmup, G_TYPE_OBJECT)
+
+static void dns_entry_free(gpointer data) {
+  DnsEntry* entry = static_cast<DnsEntry*>(data);
+  g_ptr_array_unref(entry->addresses);
+  g_ptr_array_unref(entry->waiters);
+  g_free(entry);
+}
+
+static DnsEntry* host_warmup_entry(HostWarmup* self, const gchar* host) {
+  DnsEntry* entry =
+      static_cast<DnsEntry*>(g_hash_table_lookup(self->dns, host));
+  if (entry == nullptr) {
+    entry = g_new0(DnsEntry, 1);
+    entry->addresses = g_ptr_array_new_with_free_func(g_free);
+    entry->waiters = g_ptr_array_new_with_free_func(g_object_unref);
+    g_hash_table_insert(self->dns, g_strdup(host), entry);
+  }
+  return entry;
+}
+
+static gboolean dns_entry_is_fresh(DnsEntry* entry) {
+  return !entry->resolving && entry->addresses->len > 0 &&
+         entry->expires_us > g_get_real_time();
+}
+
+// Appends the A or AAAA records for |host| to |addresses| and returns the
+// smallest TTL in the answer, or G_MAXUINT32 when there was none.
+static guint32 query_records(const gchar* host, int type,
+                             GPtrArray* addresses) {
+  guint32 ttl = G_MAXUINT32;
+  unsigned char answer[NS_PACKETSZ * 4];
+  int length = res_query(host, ns_c_in, type, answer, sizeof(answer));
+  if (length < 0) return ttl;
+
+  ns_msg message;
+  if (ns_initparse(answer, length, &message) < 0) return ttl;
+  for (int i = 0; i < ns_msg_count(message, ns_s_an); i++) {
+    ns_rr record;
+    if (ns_parserr(&message, ns_s_an, i, &record) < 0) continue;
+    // CNAMEs on the way limit the lifetime of the answer too.
+    ttl = MIN(ttl, ns_rr_ttl(record));
+    char text[INET6_ADDRSTRLEN];
+    if (ns_rr_type(record) == ns_t_a && ns_rr_rdlen(record) == 4 &&
+        inet_ntop(AF_INET, ns_rr_rdata(record), text, sizeof(text))) {
+      g_ptr_array_add(addresses, g_strdup(text));
+    } else if (ns_rr_type(record) == ns_t_aaaa && ns_rr_rdlen(record) == 16 &&
+               inet_ntop(AF_INET6, ns_rr_rdata(record), text, sizeof(text))) {
+      g_ptr_array_add(addresses, g_strdup(text));
+    }
+  }
+  return ttl;
+}
+
+// Falls back to the system resolver, which also honours /etc/hosts.
+static void query_system(const gchar* host, GPtrArray* addresses) {
+  struct addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo* results = nullptr;
+  if (getaddrinfo(host, nullptr, &hints, &results) != 0) return;
+  for (struct addrinfo* info = results; info != nullptr; info = info->ai_next) {
+    char text[INET6_ADDRSTRLEN];
+    const void* address = nullptr;
+    if (info->ai_family == AF_INET) {
+      address = &reinterpret_cast<struct sockaddr_in*>(info->ai_addr)->sin_addr;
+    } else if (info->ai_family == AF_INET6) {
+      address =
+          &reinterpret_cast<struct sockaddr_in6*>(info->ai_addr)->sin6_addr;
+    }
+    if (address != nullptr &&
+        inet_ntop(info->ai_family, address, text, sizeof(text))) {
+      g_ptr_array_add(addresses, g_strdup(text));
+    }
+  }
+  freeaddrinfo(results);
+}
+
+static void host_warmup_schedule_save(HostWarmup* self);
+
+static FlValue* dns_entry_to_value(DnsEntry* entry) {
+  FlValue* value = fl_value_new_map();
+  FlValue* addresses = fl_value_new_list();
+  for (guint i = 0; i < entry->addresses->len; i++) {
+    fl_value_append_take(addresses,
+                         fl_value_new_string(static_cast<const gchar*>(
+                             g_ptr_array_index(entry->addresses, i))));
+  }
+  fl_value_set_string_take(value, "addresses", addresses);
+  gint64 remaining = (entry->expires_us - g_get_real_time()) / G_USEC_PER_SEC;
+  fl_value_set_string_take(value, "ttl", fl_value_new_int(MAX(remaining, 0)));
+  return value;
+}
+
+// Applies one finished lookup, `{host, addresses, ttl}`, and answers the
+// calls waiting for it.
+static void host_warmup_apply_result(HostWarmup* self, FlValue* result) {
+  FlValue* addresses = fl_value_lookup_string(result, "addresses");
+  size_t count = fl_value_get_length(addresses);
+  DnsEntry* entry = host_warmup_entry(
+      self, fl_value_get_string(fl_value_lookup_string(result, "host")));
+  entry->resolving = FALSE;
+
+  if (count > 0) {
+    self->resolved++;
+    g_ptr_array_set_size(entry->addresses, 0);
+    for (size_t i = 0; i < count; i++) {
+      g_ptr_array_add(entry->addresses,
+                      g_strdup(fl_value_get_string(
+                          fl_value_get_list_value(addresses, i))));
+    }
+    gint64 ttl = fl_value_get_int(fl_value_lookup_string(result, "ttl"));
+    entry->expires_us =
+        g_get_real_time() + CLAMP(ttl, kMinTtl, kMaxTtl) * G_USEC_PER_SEC;
+    host_warmup_schedule_save(self);
+  } else {
+    self->failed++;
+    entry->expires_us = 0;
+  }
+
+  g_autoptr(FlValue) value =
+      count > 0 ? dns_entry_to_value(entry) : fl_value_new_null();
+  for (guint i = 0; i < entry->waiters->len; i++) {
+    FlMethodCall* method_call =
+        FL_METHOD_CALL(g_ptr_array_index(entry->waiters, i));
+    g_autoptr(FlMethodResponse) response =
+        FL_METHOD_RESPONSE(fl_method_success_response_new(value));
+    g_autoptr(GError) error = nullptr;
+    if (!fl_method_call_respond(method_call, response, &error)) {
+      g_warning("HostWarmup: failed to respond to lookup: %s", error->message);
+    }
+  }
+  g_ptr_array_set_size(entry->waiters, 0);
+}
+
+// Receives finished lookups from the results bridge on the main thread.
+static void resolve_results_cb(FlValue* batch, gpointer user_data) {
+  HostWarmup* self = HOST_WARMUP(user_data);
+  size_t count = fl_value_get_length(batch);
+  for (size_t i = 0; i < count; i++) {
+    host_warmup_apply_result(self, fl_value_get_list_value(batch, i));
+  }
+}
+
+static void resolve_job_free(ResolveJob* job) {
+  g_free(job->host);
+  g_object_unref(job->results);
+  g_object_unref(job->cancellable);
+  delete job;
+}
+
+// Resolves one host on a pool thread. Lookups still queued when the
+// HostWarmup is disposed are skipped.
+static void resolve_job_run(gpointer data, gpointer user_data) {
+  ResolveJob* job = static_cast<ResolveJob*>(data);
+  if (g_cancellable_is_cancelled(job->cancellable)) {
+    resolve_job_free(job);
+    return;
+  }
+  const gchar* host = job->host;
+
+  g_autoptr(GPtrArray) addresses = g_ptr_array_new_with_free_func(g_free);
+  // IPv4 first, the order Dart tries them in.
+  guint32 ttl_v4 = query_records(host, ns_t_a, addresses);
+  guint32 ttl_v6 = query_records(host, ns_t_aaaa, addresses);
+  guint32 ttl = MIN(ttl_v4, ttl_v6);
+  if (addresses->len == 0) {
+    query_system(host, addresses);
+    ttl = kFallbackTtl;
+  }
+
+  FlValue* result = fl_value_new_map();
+  fl_value_set_string_take(result, "host", fl_value_new_string(host));
+  FlValue* list = fl_value_new_list();
+  for (guint i = 0; i < addresses->len; i++) {
+    fl_value_append_take(list, fl_value_new_string(static_cast<const gchar*>(
+                                   g_ptr_array_index(addresses, i))));
+  }
+  fl_value_set_string_take(result, "addresses", list);
+  fl_value_set_string_take(result, "ttl", fl_value_new_int(ttl));
+
+  // Rejected once the bridge is closed, i.e. after dispose.
+  native_bridge_post(job->results, result);
+  resolve_job_free(job);
+}
+
+static void host_warmup_resolve(HostWarmup* self, const gchar* host) {
+  DnsEntry* entry = host_warmup_entry(self, host);
+  if (entry->resolving) return;
+  entry->resolving = TRUE;
+  g_thread_pool_push(
+      self->pool,
+      new ResolveJob{g_strdup(host), NATIVE_BRIDGE(g_object_ref(self->results)),
+                     G_CANCELLABLE(g_object_ref(self->cancellable))},
+      nullptr);
+}
+
+static gint compare_scores(gconstpointer a, gconstpointer b,
+                           gpointer user_data) {
+  GHashTable* scores = static_cast<GHashTable*>(user_data);
+  double score_a = *static_cast<double*>(
+      g_hash_table_lookup(scores, *static_cast<const gchar* const*>(a)));
+  double score_b = *static_cast<double*>(
+      g_hash_table_lookup(scores, *static_cast<const gchar* const*>(b)));
+  if (score_a == score_b) return 0;
+  return score_a > score_b ? -1 : 1;
+}
+
+// Returns the best-scored origins, at most kWarmOrigins.
+static GPtrArray* host_warmup_top_origins(HostWarmup* self) {
+  GPtrArray* origins = g_ptr_array_new();
+  GHashTableIter iter;
+  gpointer key;
+  g_hash_table_iter_init(&iter, self->scores);
+  while (g_hash_table_iter_next(&iter, &key, nullptr)) {
+    g_ptr_array_add(origins, key);
+  }
+  g_ptr_array_sort_with_data(origins, compare_scores, self->scores);
+  if (origins->len > kWarmOrigins) g_ptr_array_set_size(origins, kWarmOrigins);
+  return origins;
+}
+
+static gchar* origin_host(const gchar* origin) {
+  g_autoptr(GUri) uri = g_uri_parse(origin, G_URI_FLAGS_NONE, nullptr);
+  if (uri == nullptr || g_uri_get_host(uri) == nullptr ||
+      g_hostname_is_ip_address(g_uri_get_host(uri))) {
+    return nullptr;
+  }
+  return g_strdup(g_uri_get_host(uri));
+}
+
+static gchar* host_warmup_path(HostWarmup* self, const gchar* name) {
+  return g_build_filename(self->directory, name, nullptr);
+}
+
+// Reads "<score>\t<origin>" lines, decaying every score by one launch.
+static void host_warmup_load_scores(HostWarmup* self) {
+  g_autofree gchar* path = host_warmup_path(self, "origins");
+  g_autofree gchar* contents = nullptr;
+  if (!g_file_get_contents(path, &contents, nullptr, nullptr)) return;
+
+  g_auto(GStrv) lines = g_strsplit(contents, "\n", -1);
+  for (gchar** line = lines; *line != nullptr; line++) {
+    g_auto(GStrv) fields = g_strsplit(*line, "\t", 2);
+    if (g_strv_length(fields) != 2) continue;
+    double score = g_ascii_strtod(fields[0], nullptr) * kScoreDecay;
+    if (score < kMinScore) continue;
+    double* value = g_new(double, 1);
+    *value = score;
+    g_hash_table_replace(self->scores, g_strdup(fields[1]), value);
+  }
+}
+
+// Reads "<host>\t<expiry, unix seconds>\t<address>,<address>..." lines,
+// dropping expired answers.
+static void host_warmup_load_dns(HostWarmup* self) {
+  g_autofree gchar* path = host_warmup_path(self, "dns");
+  g_autofree gchar* contents = nullptr;
+  if (!g_file_get_contents(path, &contents, nullptr, nullptr)) return;
+
+  gint64 now = g_get_real_time();
+  g_auto(GStrv) lines = g_strsplit(contents, "\n", -1);
+  for (gchar** line = lines; *line != nullptr; line++) {
+    g_auto(GStrv) fields = g_strsplit(*line, "\t", 3);
+    if (g_strv_length(fields) != 3) continue;
+    gint64 expires_us = g_ascii_strtoll(fields[1], nullptr, 10) * G_USEC_PER_SEC;
+    if (expires_us <= now) continue;
+    DnsEntry* entry = host_warmup_entry(self, fields[0]);
+    g_auto(GStrv) addresses = g_strsplit(fields[2], ",", -1);
+    for (gchar** address = addresses; *address != nullptr; address++) {
+      if (g_hostname_is_ip_address(*address)) {
+        g_ptr_array_add(entry->addresses, g_strdup(*address));
+      }
+    }
+    entry->expires_us = expires_us;
+  }
+}
+
+static gboolean host_warmup_save_cb(gpointer user_data) {
+  HostWarmup* self = HOST_WARMUP(user_data);
+  self->save_source_id = 0;
+
+  if (g_mkdir_with_parents(self->directory, 0700) != 0) {
+    g_warning("HostWarmup: cannot create %s", self->directory);
+    return G_SOURCE_REMOVE;
+  }
+
+  g_autoptr(GString) origins = g_string_new(nullptr);
+  GHashTableIter iter;
+  gpointer key, value;
+  g_hash_table_iter_init(&iter, self->scores);
+  while (g_hash_table_iter_next(&iter, &key, &value)) {
+    gchar score[G_ASCII_DTOSTR_BUF_SIZE];
+    g_ascii_dtostr(score, sizeof(score), *static_cast<double*>(value));
+    g_string_append_printf(origins, "%s\t%s\n", score,
+                           static_cast<const gchar*>(key));
+  }
+
+  gint64 now = g_get_real_time();
+  g_autoptr(GString) dns = g_string_new(nullptr);
+  g_hash_table_iter_init(&iter, self->dns);
+  while (g_hash_table_iter_next(&iter, &key, &value)) {
+    DnsEntry* entry = static_cast<DnsEntry*>(value);
+    if (entry->addresses->len == 0 || entry->expires_us <= now) continue;
+    g_string_append_printf(dns, "%s\t%" G_GINT64_FORMAT "\t",
+                           static_cast<const gchar*>(key),
+                           entry->expires_us / G_USEC_PER_SEC);
+    for (guint i = 0; i < entry->addresses->len; i++) {
+      if (i > 0) g_string_append_c(dns, ',');
+      g_string_append(dns, static_cast<const gchar*>(
+                               g_ptr_array_index(entry->addresses, i)));
+    }
+    g_string_append_c(dns, '\n');
+  }
+
+  g_autofree gchar* origins_path = host_warmup_path(self, "origins");
+  g_autofree gchar* dns_path = host_warmup_path(self, "dns");
+  g_autoptr(GError) error = nullptr;
+  if (!g_file_set_contents(origins_path, origins->str, origins->len, &error) ||
+      !g_file_set_contents(dns_path, dns->str, dns->len, &error)) {
+    g_warning("HostWarmup: failed to save: %s", error->message);
+  }
+  return G_SOURCE_REMOVE;
+}
+
+static void host_warmup_schedule_save(HostWarmup* self) {
+  if (self->save_source_id != 0) return;
+  self->save_source_id =
+      g_timeout_add_seconds(kSaveDelaySeconds, host_warmup_save_cb, self);
+}
+
+// Answers from the cache, or queues the call behind a resolution. Returns
+// nullptr when the call will be answered later.
+static FlMethodResponse* host_warmup_lookup(HostWarmup* self,
+                                            FlMethodCall* method_call) {
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* host = nullptr;
+  if (args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
+    host = fl_value_lookup_string(args, "host");
+  }
+  if (host == nullptr || fl_value_get_type(host) != FL_VALUE_TYPE_STRING) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "bad_args", "lookup expects {host: String}", nullptr));
+  }
+
+  DnsEntry* entry = host_warmup_entry(self, fl_value_get_string(host));
+  if (dns_entry_is_fresh(entry)) {
+    self->hits++;
+    g_autoptr(FlValue) value = dns_entry_to_value(entry);
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(value));
+  }
+  g_ptr_array_add(entry->waiters, g_object_ref(method_call));
+  host_warmup_resolve(self, fl_value_get_string(host));
+  return nullptr;
+}
+
+static FlValue* host_warmup_get_warm_origins(HostWarmup* self) {
+  FlValue* result = fl_value_new_map();
+  fl_value_set_string_take(
+      result, "launchedAtMs",
+      fl_value_new_int(self->launched_at_us / G_TIME_SPAN_MILLISECOND));
+  FlValue* origins = fl_value_new_list();
+  g_autoptr(GPtrArray) top = host_warmup_top_origins(self);
+  for (guint i = 0; i < top->len; i++) {
+    fl_value_append_take(
+        origins,
+        fl_value_new_string(static_cast<const gchar*>(g_ptr_array_index(top, i))));
+  }
+  fl_value_set_string_take(result, "origins", origins);
+  return result;
+}
+
+static FlMethodResponse* host_warmup_record_usage(HostWarmup* self,
+                                                  FlMethodCall* method_call) {
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* origins = nullptr;
+  if (args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
+    origins = fl_value_lookup_string(args, "origins");
+  }
+  if (origins == nullptr || fl_value_get_type(origins) != FL_VALUE_TYPE_MAP) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "bad_args", "recordUsage expects {origins: Map<String, int>}", nullptr));
+  }
+
+  for (size_t i = 0; i < fl_value_get_length(origins); i++) {
+    FlValue* origin = fl_value_get_map_key(origins, i);
+    FlValue* count = fl_value_get_map_value(origins, i);
+    if (fl_value_get_type(origin) != FL_VALUE_TYPE_STRING ||
+        fl_value_get_type(count) != FL_VALUE_TYPE_INT) {
+      continue;
+    }
+    double* score = static_cast<double*>(
+        g_hash_table_lookup(self->scores, fl_value_get_string(origin)));
+    if (score == nullptr) {
+      score = g_new0(double, 1);
+      g_hash_table_insert(self->scores, g_strdup(fl_value_get_string(origin)),
+                          score);
+    }
+    *score += fl_value_get_int(count);
+  }
+  host_warmup_schedule_save(self);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+static FlValue* host_warmup_get_stats(HostWarmup* self) {
+  FlValue* stats = fl_value_new_map();
+  fl_value_set_string_take(stats, "hits", fl_value_new_int(self->hits));
+  fl_value_set_string_take(stats, "resolved", fl_value_new_int(self->resolved));
+  fl_value_set_string_take(stats, "failed", fl_value_new_int(self->failed));
+  fl_value_set_string_take(stats, "hosts",
+                           fl_value_new_int(g_hash_table_size(self->dns)));
+  fl_value_set_string_take(stats, "origins",
+                           fl_value_new_int(g_hash_table_size(self->scores)));
+  return stats;
+}
+
+// Handles the channel methods.
+static void method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
+                           gpointer user_data) {
+  HostWarmup* self = HOST_WARMUP(user_data);
+  const gchar* method = fl_method_call_get_name(method_call);
+
+  g_autoptr(FlMethodResponse) response = nullptr;
+  if (g_strcmp0(method, "lookup") == 0) {
+    response = host_warmup_lookup(self, method_call);
+    if (response == nullptr) return;
+  } else if (g_strcmp0(method, "getWarmOrigins") == 0) {
+    g_autoptr(FlValue) result = host_warmup_get_warm_origins(self);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (g_strcmp0(method, "recordUsage") == 0) {
+    response = host_warmup_record_usage(self, method_call);
+  } else if (g_strcmp0(method, "getStats") == 0) {
+    g_autoptr(FlValue) stats = host_warmup_get_stats(self);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(stats));
+  } else {
+    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(method_call, response, &error)) {
+    g_warning("HostWarmup: failed to respond to %s: %s", method,
+              error->message);
+  }
+}
+
+static void host_warmup_dispose(GObject* object) {
+  HostWarmup* self = HOST_WARMUP(object);
+
+  // A lookup blocked in res_query() cannot be interrupted, so running ones
+  // are left to finish on their own; their results are dropped by the
+  // closed bridge.
+  if (self->cancellable != nullptr) g_cancellable_cancel(self->cancellable);
+  if (self->pool != nullptr) {
+    g_thread_pool_free(self->pool, FALSE, FALSE);
+    self->pool = nullptr;
+  }
+  if (self->save_source_id != 0) {
+    g_source_remove(self->save_source_id);
+    host_warmup_save_cb(self);
+  }
+  g_clear_object(&self->channel);
+  if (self->results != nullptr) {
+    native_bridge_close(self->results);
+    g_clear_object(&self->results);
+  }
+  g_clear_object(&self->cancellable);
+  g_clear_pointer(&self->dns, g_hash_table_unref);
+  g_clear_pointer(&self->scores, g_hash_table_unref);
+  g_clear_pointer(&self->directory, g_free);
+
+  G_OBJECT_CLASS(host_warmup_parent_class)->dispose(object);
+}
+
+static void host_warmup_class_init(HostWarmupClass* klass) {
+  G_OBJECT_CLASS(klass)->dispose = host_warmup_dispose;
+}
+
+static void host_warmup_init(HostWarmup* self) {}
+
+HostWarmup* host_warmup_new(guint max_workers) {
+  HostWarmup* self =
+      HOST_WARMUP(g_object_new(host_warmup_get_type(), nullptr));
+
+  self->launched_at_us = g_get_real_time();
+  self->directory =
+      g_build_filename(g_get_user_cache_dir(), APPLICATION_ID, "net", nullptr);
+  self->dns =
+      g_hash_table_new_full(g_str_hash, g_str_equal, g_free, dns_entry_free);
+  self->scores = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+  // At most one lookup per host is in flight, which bounds the queue.
+  self->results = native_bridge_new_with_handler(G_MAXUINT, kResultBatch,
+                                                 resolve_results_cb, self);
+  self->cancellable = g_cancellable_new();
+  // Lookups wait on the network, not the CPU, so they are not bounded by
+  // the worker budget.
+  self->pool = g_thread_pool_new(resolve_job_run, nullptr, MAX(max_workers, 1u),
+                                 FALSE, nullptr);
+
+  host_warmup_load_scores(self);
+  host_warmup_load_dns(self);
+
+  g_autoptr(GPtrArray) top = host_warmup_top_origins(self);
+  for (guint i = 0; i < top->len; i++) {
+    g_autofree gchar* host =
+        origin_host(static_cast<const gchar*>(g_ptr_array_index(top, i)));
+    if (host != nullptr &&
+        !dns_entry_is_fresh(host_warmup_entry(self, host))) {
+      host_warmup_resolve(self, host);
+    }
+  }
+  // Persist the decayed scores even if nothing else changes.
+  host_warmup_schedule_save(self);
+  return self;
+}
+
+void host_warmup_attach(HostWarmup* self, FlBinaryMessenger* messenger) {
+  g_clear_object(&self->channel);
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  self->channel =
+      fl_method_channel_new(messenger, kChannelName, FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(self->channel, method_call_cb, self,
+                                            nullptr);
+}
@@ -0,0 +1,51 @@
+#ifndef FLUTTER_HOST_WARMUP_H_
+#define FLUTTER_HOST_WARMUP_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+G_DECLARE_FINAL_TYPE(HostWarmup, host_warmup, HOST, WARMUP, GObject)
+
+/**
+ * HostWarmup:
+ *
+ * Persisted DNS cache and host ranking that make the first refresh after a
+ * launch skip most name lookups.
+ *
+ * Dart reports which origins (`scheme://host:port`) it connected to, and the
+ * runner keeps a decaying usage score per origin. DNS answers are cached
+ * with their record TTLs, read with res_query(). Both tables are saved
+ * under `$XDG_CACHE_HOME/<application id>/net`.
+ *
+ * The object is created in GApplication::startup, before the engine starts.
+ * It immediately re-resolves the hosts of the top-ranked origins whose
+ * cached answers have expired, so lookups run in parallel with engine boot.
+ *
+ * Methods on the `modern_dashboard/host_warmup` channel:
+ *  - `getWarmOrigins` answers `{launchedAtMs, origins}`: the launch time
+ *    and the top-ranked origins, for Dart to pre-connect;
+ *  - `lookup {host}` answers `{addresses, ttl}` from the cache, resolving
+ *    (or waiting for a running resolution) when needed, or %NULL;
+ *  - `recordUsage {origins: {origin: count}}` adds to the ranking;
+ *  - `getStats`.
+ */
+
+/**
+ * host_warmup_new:
+ * @max_workers: maximum number of concurrent lookups.
+ *
+ * Loads the saved tables and starts resolving the top-ranked hosts.
+ *
+ * Returns: a new #HostWarmup.
+ */
+HostWarmup* host_warmup_new(guint max_workers);
+
+/**
+ * host_warmup_attach:
+ * @warmup: a #HostWarmup.
+ * @messenger: an #FlBinaryMessenger.
+ *
+ * Serves the method channel on @messenger once the engine exists.
+ */
+void host_warmup_attach(HostWarmup* warmup, FlBinaryMessenger* messenger);
+
+#endif  // FLUTTER_HOST_WARMUP_H_
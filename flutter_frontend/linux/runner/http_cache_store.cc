@@ -0,0 +1,724 @@
+#include "http_cache_store.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <glib/gstdio.h>
+#include <string.h>
+
+static const char* kChannelName = "modern_dashboard/http_cache";
+
+// "MDHC" read as a little-endian u32.
+static const guint32 kMagic = 0x4348444d;
+static const gsize kHeaderSize = 8;
+
+// Entry files are named by the SHA-256 of their key in hex.
+static const gsize kFileNameLength = 64;
+
+// Writes in progress before further ones are dropped; a dropped write only
+// costs a refetch.
+static const guint kMaxQueuedWrites = 64;
+
+namespace {
+
+struct IndexEntry {
+  gint64 size;
+  gint64 last_used_us;
+};
+
+enum class StoreOp { kGet, kPut, kUpdateMeta, kRemove, kClear, kEvict };
+
+// A store call in progress. Calls on one entry run one after another, and a
+// clear waits for the calls before it and holds back the ones after it.
+struct StoreJob {
+  HttpCacheStore* self;  // holds a reference until the job finishes
+  StoreOp op;
+  FlMethodCall* method_call;  // nullptr for evictions
+  gchar* name;
+  gchar* meta;
+  GBytes* body;
+
+  gint64 size;
+  int fd;
+  GBytes* contents;  // the entry file being written
+  gssize written;
+  guint unlinks_left;
+};
+
+// The cache directory as found at startup; filled on a pool thread.
+struct ScanJob {
+  HttpCacheStore* self;
+  gchar* directory;
+  GPtrArray* names;
+  GArray* entries;  // IndexEntry, parallel to |names|
+};
+
+}  // namespace
+
+struct _HttpCacheStore {
+  GObject parent_instance;
+
+  FlMethodChannel* channel;
+  AsyncIo* io;
+  gchar* directory;
+  gint64 max_bytes;
+
+  GHashTable* index;  // file name -> IndexEntry*
+  gboolean index_loaded;
+  gint64 total_bytes;
+
+  GHashTable* busy;  // file name -> GQueue* of jobs behind the running one
+  GQueue* deferred;  // jobs waiting for the index or a clear
+  guint running;     // started jobs, including those queued in |busy|
+  gboolean clearing;
+  guint writes_in_progress;
+
+  guint64 hits;
+  guint64 misses;
+  guint64 writes;
+  guint64 dropped_writes;
+  guint64 evictions;
+};
+
+G_DEFINE_TYPE(HttpCacheStore, http_cache_store, G_TYPE_OBJECT)
+
+static void store_run(StoreJob* job);
+static void store_start(HttpCacheStore* self, StoreJob* job);
+static void store_submit(HttpCacheStore* self, StoreJob* job);
+
+static gboolean is_entry_name(const gchar* name) {
+  if (strlen(name) != kFileNameLength) return FALSE;
+  for (const gchar* c = name; *c != '\0'; c++) {
+    if (!g_ascii_isxdigit(*c)) return FALSE;
+  }
+  return TRUE;
+}
+
+static gchar* entry_path(HttpCacheStore* self, const gchar* name) {
+  return g_build_filename(self->directory, name, nullptr);
+}
+
+// Entry files are written here and renamed into place, so readers never see
+// a partial write. The name is not an entry name, so the startup scan
+// deletes one left by an interrupted write.
+static gchar* temporary_path(HttpCacheStore* self, const gchar* name) {
+  return g_strdup_printf("%s/%s.tmp", self->directory, name);
+}
+
+static StoreJob* store_job_new(HttpCacheStore* self, StoreOp op,
+                               FlMethodCall* method_call, const gchar* name) {
+  StoreJob* job = g_new0(StoreJob, 1);
+  job->self = HTTP_CACHE_STORE(g_object_ref(self));
+  job->op = op;
+  job->method_call =
+      method_call != nullptr ? FL_METHOD_CALL(g_object_ref(method_call)) : nullptr;
+  job->name = g_strdup(name);
+  job->fd = -1;
+  return job;
+}
+
+static void store_job_free(StoreJob* job) {
+  g_clear_object(&job->method_call);
+  g_free(job->name);
+  g_free(job->meta);
+  g_clear_pointer(&job->body, g_bytes_unref);
+  g_clear_pointer(&job->contents, g_bytes_unref);
+  g_object_unref(job->self);
+  g_free(job);
+}
+
+// Answers the call behind |job|, if any, with |result|, which it takes.
+static void store_respond(StoreJob* job, FlValue* result) {
+  g_autoptr(FlValue) value = result;
+  if (job->method_call == nullptr) return;
+  g_autoptr(FlMethodResponse) response =
+      FL_METHOD_RESPONSE(fl_method_success_response_new(value));
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(job->method_call, response, &error)) {
+    g_warning("HttpCacheStore: failed to respond: %s", error->message);
+  }
+  g_clear_object(&job->method_call);
+}
+
+static void store_index_set(HttpCacheStore* self, const gchar* name,
+                            gint64 size, gint64 last_used_us) {
+  IndexEntry* entry =
+      static_cast<IndexEntry*>(g_hash_table_lookup(self->index, name));
+  if (entry == nullptr) {
+    entry = g_new0(IndexEntry, 1);
+    g_hash_table_insert(self->index, g_strdup(name), entry);
+  } else {
+    self->total_bytes -= entry->size;
+  }
+  entry->size = size;
+  entry->last_used_us = last_used_us;
+  self->total_bytes += size;
+}
+
+static void store_forget(HttpCacheStore* self, const gchar* name) {
+  IndexEntry* entry =
+      static_cast<IndexEntry*>(g_hash_table_lookup(self->index, name));
+  if (entry != nullptr) {
+    self->total_bytes -= entry->size;
+    g_hash_table_remove(self->index, name);
+  }
+}
+
+// Starts the jobs held back by the index load or a clear, up to the next
+// clear that still has to wait for running jobs.
+static void store_start_deferred(HttpCacheStore* self) {
+  if (!self->index_loaded || self->clearing) return;
+  StoreJob* job;
+  while ((job = static_cast<StoreJob*>(g_queue_peek_head(self->deferred))) !=
+         nullptr) {
+    gboolean clear = job->op == StoreOp::kClear;
+    if (clear && self->running > 0) return;
+    g_queue_pop_head(self->deferred);
+    store_start(self, job);
+    if (clear) return;
+  }
+}
+
+// Ends |job| and starts the next one on its entry.
+static void store_finish(StoreJob* job) {
+  HttpCacheStore* self = job->self;
+  self->running--;
+  if (job->op == StoreOp::kPut) self->writes_in_progress--;
+  if (job->op == StoreOp::kClear) self->clearing = FALSE;
+
+  if (job->name != nullptr) {
+    GQueue* waiting =
+        static_cast<GQueue*>(g_hash_table_lookup(self->busy, job->name));
+    StoreJob* next =
+        waiting != nullptr ? static_cast<StoreJob*>(g_queue_pop_head(waiting))
+                           : nullptr;
+    if (next == nullptr) g_hash_table_remove(self->busy, job->name);
+    store_start_deferred(self);
+    store_job_free(job);
+    if (next != nullptr) store_run(next);
+    return;
+  }
+  store_start_deferred(self);
+  store_job_free(job);
+}
+
+static void unlinked_cb(gssize result, const guint8* data, gpointer user_data) {
+  StoreJob* job = static_cast<StoreJob*>(user_data);
+  if (--job->unlinks_left > 0) return;
+  if (job->op == StoreOp::kRemove || job->op == StoreOp::kClear) {
+    store_respond(job, fl_value_new_null());
+  }
+  store_finish(job);
+}
+
+// Deletes |paths| and then finishes |job|.
+static void store_unlink_and_finish(StoreJob* job, GPtrArray* paths) {
+  if (paths->len == 0) {
+    job->unlinks_left = 1;
+    unlinked_cb(0, nullptr, job);
+    return;
+  }
+  job->unlinks_left = paths->len;
+  for (guint i = 0; i < paths->len; i++) {
+    async_io_unlink(job->self->io,
+                    static_cast<const gchar*>(g_ptr_array_index(paths, i)),
+                    unlinked_cb, job);
+  }
+}
+
+// Drops the entry of |job| from the index and disk, then finishes |job|.
+static void store_delete_and_finish(StoreJob* job) {
+  HttpCacheStore* self = job->self;
+  store_forget(self, job->name);
+  g_autoptr(GPtrArray) paths = g_ptr_array_new_with_free_func(g_free);
+  g_ptr_array_add(paths, entry_path(self, job->name));
+  if (job->contents != nullptr) {
+    g_ptr_array_add(paths, temporary_path(self, job->name));
+  }
+  store_unlink_and_finish(job, paths);
+}
+
+static gint compare_last_used(gconstpointer a, gconstpointer b,
+                              gpointer user_data) {
+  GHashTable* index = static_cast<GHashTable*>(user_data);
+  const IndexEntry* entry_a = static_cast<const IndexEntry*>(
+      g_hash_table_lookup(index, *static_cast<const gchar* const*>(a)));
+  const IndexEntry* entry_b = static_cast<const IndexEntry*>(
+      g_hash_table_lookup(index, *static_cast<const gchar* const*>(b)));
+  if (entry_a->last_used_us == entry_b->last_used_us) return 0;
+  return entry_a->last_used_us < entry_b->last_used_us ? -1 : 1;
+}
+
+// Evicts least recently used entries once the store is over its limit.
+// Entries with calls in progress are left alone.
+static void store_trim(HttpCacheStore* self) {
+  if (self->total_bytes <= self->max_bytes) return;
+
+  g_autoptr(GPtrArray) names = g_ptr_array_new_with_free_func(g_free);
+  GHashTableIter iter;
+  gpointer key;
+  g_hash_table_iter_init(&iter, self->index);
+  while (g_hash_table_iter_next(&iter, &key, nullptr)) {
+    if (g_hash_table_contains(self->busy, key)) continue;
+    g_ptr_array_add(names, g_strdup(static_cast<const gchar*>(key)));
+  }
+  g_ptr_array_sort_with_data(names, compare_last_used, self->index);
+
+  gint64 target = self->max_bytes / 10 * 9;
+  for (guint i = 0; i < names->len && self->total_bytes > target; i++) {
+    const gchar* name = static_cast<const gchar*>(g_ptr_array_index(names, i));
+    store_forget(self, name);
+    store_submit(self, store_job_new(self, StoreOp::kEvict, nullptr, name));
+    self->evictions++;
+  }
+}
+
+// Checks the header of an entry file. Returns the metadata length, or -1
+// if the file is malformed.
+static gssize entry_meta_length(const guint8* contents, gsize length) {
+  guint32 header[2] = {0, 0};
+  if (length < kHeaderSize) return -1;
+  memcpy(header, contents, kHeaderSize);
+  gsize meta_length = GUINT32_FROM_LE(header[1]);
+  if (GUINT32_FROM_LE(header[0]) != kMagic ||
+      meta_length > length - kHeaderSize ||
+      !g_utf8_validate(reinterpret_cast<const gchar*>(contents) + kHeaderSize,
+                       meta_length, nullptr)) {
+    return -1;
+  }
+  return meta_length;
+}
+
+static GBytes* entry_contents(const gchar* meta, const guint8* body,
+                              gsize body_length) {
+  gsize meta_length = strlen(meta);
+  gsize length = kHeaderSize + meta_length + body_length;
+  guint8* contents = static_cast<guint8*>(g_malloc(length));
+  guint32 header[2] = {GUINT32_TO_LE(kMagic),
+                       GUINT32_TO_LE(static_cast<guint32>(meta_length))};
+  memcpy(contents, header, kHeaderSize);
+  memcpy(contents + kHeaderSize, meta, meta_length);
+  if (body_length > 0) {
+    memcpy(contents + kHeaderSize + meta_length, body, body_length);
+  }
+  return g_bytes_new_take(contents, length);
+}
+
+static void store_write_failed(StoreJob* job, gssize error) {
+  g_warning("HttpCacheStore: failed to write entry: %s", g_strerror(-error));
+  store_respond(job, fl_value_new_bool(FALSE));
+  store_delete_and_finish(job);
+}
+
+static void entry_renamed_cb(gssize result, const guint8* data,
+                             gpointer user_data) {
+  StoreJob* job = static_cast<StoreJob*>(user_data);
+  HttpCacheStore* self = job->self;
+  if (result < 0) {
+    store_write_failed(job, result);
+    return;
+  }
+  store_index_set(self, job->name, g_bytes_get_size(job->contents),
+                  g_get_real_time());
+  self->writes++;
+  store_respond(job, fl_value_new_bool(TRUE));
+  store_trim(self);
+  store_finish(job);
+}
+
+static void temporary_written_cb(gssize result, const guint8* data,
+                                 gpointer user_data) {
+  static_cast<StoreJob*>(user_data)->written = result;
+}
+
+static void temporary_closed_cb(gssize result, const guint8* data,
+                                gpointer user_data) {
+  StoreJob* job = static_cast<StoreJob*>(user_data);
+  if (job->written != static_cast<gssize>(g_bytes_get_size(job->contents))) {
+    store_write_failed(job, job->written < 0 ? job->written : -EIO);
+    return;
+  }
+  if (result < 0) {
+    store_write_failed(job, result);
+    return;
+  }
+  g_autofree gchar* temporary = temporary_path(job->self, job->name);
+  g_autofree gchar* path = entry_path(job->self, job->name);
+  async_io_rename(job->self->io, temporary, path, entry_renamed_cb, job);
+}
+
+static void temporary_opened_cb(gssize result, const guint8* data,
+                                gpointer user_data) {
+  StoreJob* job = static_cast<StoreJob*>(user_data);
+  if (result < 0) {
+    store_write_failed(job, result);
+    return;
+  }
+  // The close waits for the write.
+  job->fd = result;
+  async_io_write(job->self->io, job->fd, job->contents, 0, temporary_written_cb,
+                 job);
+  async_io_close(job->self->io, job->fd, temporary_closed_cb, job);
+}
+
+// Writes |contents|, which it takes, as the entry of |job|.
+static void store_write(StoreJob* job, GBytes* contents) {
+  job->contents = contents;
+  g_autofree gchar* temporary = temporary_path(job->self, job->name);
+  async_io_open(job->self->io, temporary, O_WRONLY | O_CREAT | O_TRUNC, 0600,
+                temporary_opened_cb, job);
+}
+
+// Answers a get or updateMeta whose entry is missing or unreadable.
+static void store_read_failed(StoreJob* job) {
+  if (job->op == StoreOp::kGet) {
+    job->self->misses++;
+    store_respond(job, fl_value_new_null());
+  } else {
+    store_respond(job, fl_value_new_bool(FALSE));
+  }
+  store_delete_and_finish(job);
+}
+
+// Bumps the modification time so recency survives a restart.
+static gssize touch_entry(gpointer data) {
+  g_autofree gchar* path = static_cast<gchar*>(data);
+  return g_utime(path, nullptr) == 0 ? 0 : -errno;
+}
+
+static void entry_read_cb(gssize result, const guint8* data,
+                          gpointer user_data) {
+  StoreJob* job = static_cast<StoreJob*>(user_data);
+  HttpCacheStore* self = job->self;
+  gssize meta_length = result == job->size ? entry_meta_length(data, result) : -1;
+  if (meta_length < 0) {
+    store_read_failed(job);
+    return;
+  }
+  gsize body_offset = kHeaderSize + meta_length;
+
+  if (job->op == StoreOp::kUpdateMeta) {
+    store_write(job, entry_contents(job->meta, data + body_offset,
+                                    result - body_offset));
+    return;
+  }
+
+  self->hits++;
+  IndexEntry* entry =
+      static_cast<IndexEntry*>(g_hash_table_lookup(self->index, job->name));
+  if (entry != nullptr) entry->last_used_us = g_get_real_time();
+  async_io_call(self->io, touch_entry, entry_path(self, job->name), nullptr,
+                nullptr);
+
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(
+      value, "meta",
+      fl_value_new_string_sized(reinterpret_cast<const gchar*>(data) + kHeaderSize,
+                                meta_length));
+  fl_value_set_string_take(
+      value, "body",
+      fl_value_new_uint8_list(data + body_offset, result - body_offset));
+  store_respond(job, value);
+  store_finish(job);
+}
+
+static void entry_opened_cb(gssize result, const guint8* data,
+                            gpointer user_data) {
+  StoreJob* job = static_cast<StoreJob*>(user_data);
+  if (result < 0) {
+    store_read_failed(job);
+    return;
+  }
+  // The close waits for the read.
+  job->fd = result;
+  async_io_read(job->self->io, job->fd, job->size, 0, entry_read_cb, job);
+  async_io_close(job->self->io, job->fd, nullptr, nullptr);
+}
+
+// Runs |job|, whose entry no other job is using.
+static void store_run(StoreJob* job) {
+  HttpCacheStore* self = job->self;
+  switch (job->op) {
+    case StoreOp::kGet:
+    case StoreOp::kUpdateMeta: {
+      IndexEntry* entry =
+          static_cast<IndexEntry*>(g_hash_table_lookup(self->index, job->name));
+      if (entry == nullptr) {
+        if (job->op == StoreOp::kGet) self->misses++;
+        store_respond(job, job->op == StoreOp::kGet ? fl_value_new_null()
+                                                    : fl_value_new_bool(FALSE));
+        store_finish(job);
+        return;
+      }
+      job->size = entry->size;
+      g_autofree gchar* path = entry_path(self, job->name);
+      async_io_open(self->io, path, O_RDONLY, 0, entry_opened_cb, job);
+      break;
+    }
+    case StoreOp::kPut: {
+      gsize body_length = 0;
+      const guint8* body =
+          static_cast<const guint8*>(g_bytes_get_data(job->body, &body_length));
+      store_write(job, entry_contents(job->meta, body, body_length));
+      break;
+    }
+    case StoreOp::kRemove:
+    case StoreOp::kEvict:
+      store_delete_and_finish(job);
+      break;
+    case StoreOp::kClear: {
+      g_autoptr(GPtrArray) paths = g_ptr_array_new_with_free_func(g_free);
+      GHashTableIter iter;
+      gpointer key;
+      g_hash_table_iter_init(&iter, self->index);
+      while (g_hash_table_iter_next(&iter, &key, nullptr)) {
+        g_ptr_array_add(paths, entry_path(self, static_cast<const gchar*>(key)));
+      }
+      g_hash_table_remove_all(self->index);
+      self->total_bytes = 0;
+      store_unlink_and_finish(job, paths);
+      break;
+    }
+  }
+}
+
+// Starts |job| now, or queues it behind the job running on its entry.
+static void store_start(HttpCacheStore* self, StoreJob* job) {
+  self->running++;
+  if (job->op == StoreOp::kClear) {
+    self->clearing = TRUE;
+    store_run(job);
+    return;
+  }
+  GQueue* waiting =
+      static_cast<GQueue*>(g_hash_table_lookup(self->busy, job->name));
+  if (waiting != nullptr) {
+    g_queue_push_tail(waiting, job);
+    return;
+  }
+  g_hash_table_insert(self->busy, g_strdup(job->name), g_queue_new());
+  store_run(job);
+}
+
+static void store_submit(HttpCacheStore* self, StoreJob* job) {
+  if (!self->index_loaded || self->clearing ||
+      !g_queue_is_empty(self->deferred) ||
+      (job->op == StoreOp::kClear && self->running > 0)) {
+    g_queue_push_tail(self->deferred, job);
+    return;
+  }
+  store_start(self, job);
+}
+
+// Lists the cache directory on a pool thread. Anything that is not an entry
+// file, such as a temporary file left by an interrupted write, is deleted.
+static gssize scan_directory(gpointer data) {
+  ScanJob* scan = static_cast<ScanJob*>(data);
+  if (g_mkdir_with_parents(scan->directory, 0700) != 0) {
+    int error = errno;
+    g_warning("HttpCacheStore: cannot create %s: %s", scan->directory,
+              g_strerror(error));
+    return -error;
+  }
+  g_autoptr(GError) error = nullptr;
+  g_autoptr(GDir) dir = g_dir_open(scan->directory, 0, &error);
+  if (dir == nullptr) {
+    g_warning("HttpCacheStore: cannot read %s: %s", scan->directory,
+              error->message);
+    return -EIO;
+  }
+
+  const gchar* name;
+  while ((name = g_dir_read_name(dir)) != nullptr) {
+    g_autofree gchar* path = g_build_filename(scan->directory, name, nullptr);
+    GStatBuf stat_buf;
+    if (!is_entry_name(name) || g_stat(path, &stat_buf) != 0) {
+      g_unlink(path);
+      continue;
+    }
+    IndexEntry entry = {stat_buf.st_size,
+                        static_cast<gint64>(stat_buf.st_mtime) * G_USEC_PER_SEC};
+    g_ptr_array_add(scan->names, g_strdup(name));
+    g_array_append_val(scan->entries, entry);
+  }
+  return scan->names->len;
+}
+
+static void directory_scanned_cb(gssize result, const guint8* data,
+                                 gpointer user_data) {
+  ScanJob* scan = static_cast<ScanJob*>(user_data);
+  HttpCacheStore* self = scan->self;
+  for (guint i = 0; i < scan->names->len; i++) {
+    const IndexEntry& entry = g_array_index(scan->entries, IndexEntry, i);
+    store_index_set(self,
+                    static_cast<const gchar*>(g_ptr_array_index(scan->names, i)),
+                    entry.size, entry.last_used_us);
+  }
+  self->index_loaded = TRUE;
+  store_start_deferred(self);
+
+  g_ptr_array_unref(scan->names);
+  g_array_unref(scan->entries);
+  g_free(scan->directory);
+  g_object_unref(scan->self);
+  g_free(scan);
+}
+
+static FlValue* http_cache_store_get_stats(HttpCacheStore* self) {
+  FlValue* stats = fl_value_new_map();
+  fl_value_set_string_take(stats, "entries",
+                           fl_value_new_int(g_hash_table_size(self->index)));
+  fl_value_set_string_take(stats, "bytes", fl_value_new_int(self->total_bytes));
+  fl_value_set_string_take(stats, "maxBytes", fl_value_new_int(self->max_bytes));
+  fl_value_set_string_take(stats, "hits", fl_value_new_int(self->hits));
+  fl_value_set_string_take(stats, "misses", fl_value_new_int(self->misses));
+  fl_value_set_string_take(stats, "writes", fl_value_new_int(self->writes));
+  fl_value_set_string_take(stats, "droppedWrites",
+                           fl_value_new_int(self->dropped_writes));
+  fl_value_set_string_take(stats, "evictions",
+                           fl_value_new_int(self->evictions));
+  return stats;
+}
+
+// Returns the string argument |name|, or nullptr.
+static const gchar* lookup_string(FlValue* args, const gchar* name) {
+  FlValue* value = fl_value_lookup_string(args, name);
+  if (value == nullptr || fl_value_get_type(value) != FL_VALUE_TYPE_STRING) {
+    return nullptr;
+  }
+  return fl_value_get_string(value);
+}
+
+// Queues a store job. Returns the response when the call is answered right
+// away, or nullptr when the job will answer it.
+static FlMethodResponse* http_cache_store_queue(HttpCacheStore* self,
+                                                FlMethodCall* method_call,
+                                                StoreOp op) {
+  FlValue* args = fl_method_call_get_args(method_call);
+  gboolean has_args =
+      args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP;
+  const gchar* key = has_args ? lookup_string(args, "key") : nullptr;
+  const gchar* meta = has_args ? lookup_string(args, "meta") : nullptr;
+  FlValue* body = has_args ? fl_value_lookup_string(args, "body") : nullptr;
+
+  if (op != StoreOp::kClear && key == nullptr) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "bad_args", "expected a String key", nullptr));
+  }
+  if ((op == StoreOp::kPut || op == StoreOp::kUpdateMeta) && meta == nullptr) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "bad_args", "expected String meta", nullptr));
+  }
+  if (op == StoreOp::kPut &&
+      (body == nullptr || fl_value_get_type(body) != FL_VALUE_TYPE_UINT8_LIST)) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "bad_args", "expected Uint8List body", nullptr));
+  }
+
+  if (op == StoreOp::kPut && self->writes_in_progress >= kMaxQueuedWrites) {
+    self->dropped_writes++;
+    g_autoptr(FlValue) stored = fl_value_new_bool(FALSE);
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(stored));
+  }
+
+  g_autofree gchar* name =
+      key != nullptr ? g_compute_checksum_for_string(G_CHECKSUM_SHA256, key, -1)
+                     : nullptr;
+  StoreJob* job = store_job_new(self, op, method_call, name);
+  job->meta = g_strdup(meta);
+  if (op == StoreOp::kPut) {
+    job->body =
+        g_bytes_new(fl_value_get_uint8_list(body), fl_value_get_length(body));
+    self->writes_in_progress++;
+  }
+  store_submit(self, job);
+  return nullptr;
+}
+
+// Handles the store methods and "getStats".
+static void method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
+                           gpointer user_data) {
+  HttpCacheStore* self = HTTP_CACHE_STORE(user_data);
+  const gchar* method = fl_method_call_get_name(method_call);
+
+  g_autoptr(FlMethodResponse) response = nullptr;
+  if (g_strcmp0(method, "getStats") == 0) {
+    g_autoptr(FlValue) stats = http_cache_store_get_stats(self);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(stats));
+  } else {
+    StoreOp op = StoreOp::kGet;
+    if (g_strcmp0(method, "get") == 0) {
+      op = StoreOp::kGet;
+    } else if (g_strcmp0(method, "put") == 0) {
+      op = StoreOp::kPut;
+    } else if (g_strcmp0(method, "updateMeta") == 0) {
+      op = StoreOp::kUpdateMeta;
+    } else if (g_strcmp0(method, "remove") == 0) {
+      op = StoreOp::kRemove;
+    } else if (g_strcmp0(method, "clear") == 0) {
+      op = StoreOp::kClear;
+    } else {
+      response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+    }
+    if (response == nullptr) {
+      response = http_cache_store_queue(self, method_call, op);
+      if (response == nullptr) return;
+    }
+  }
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(method_call, response, &error)) {
+    g_warning("HttpCacheStore: failed to respond to %s: %s", method,
+              error->message);
+  }
+}
+
+static void http_cache_store_dispose(GObject* object) {
+  HttpCacheStore* self = HTTP_CACHE_STORE(object);
+
+  // Jobs hold a reference, so none is left by now.
+  g_clear_object(&self->channel);
+  g_clear_object(&self->io);
+  g_clear_pointer(&self->index, g_hash_table_unref);
+  g_clear_pointer(&self->busy, g_hash_table_unref);
+  g_clear_pointer(&self->deferred, g_queue_free);
+  g_clear_pointer(&self->directory, g_free);
+
+  G_OBJECT_CLASS(http_cache_store_parent_class)->dispose(object);
+}
+
+static void http_cache_store_class_init(HttpCacheStoreClass* klass) {
+  G_OBJECT_CLASS(klass)->dispose = http_cache_store_dispose;
+}
+
+static void http_cache_store_init(HttpCacheStore* self) {}
+
+HttpCacheStore* http_cache_store_new(FlBinaryMessenger* messenger,
+                                     AsyncIo* io, gint64 max_bytes) {
+  HttpCacheStore* self =
+      HTTP_CACHE_STORE(g_object_new(http_cache_store_get_type(), nullptr));
+
+  self->directory = g_build_filename(g_get_user_cache_dir(), APPLICATION_ID,
+                                     "http", nullptr);
+  self->max_bytes = max_bytes;
+  self->io = ASYNC_IO(g_object_ref(io));
+  self->index = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+  self->busy = g_hash_table_new_full(
+      g_str_hash, g_str_equal, g_free,
+      reinterpret_cast<GDestroyNotify>(g_queue_free));
+  self->deferred = g_queue_new();
+
+  // Calls wait in |deferred| until the index is built.
+  ScanJob* scan = g_new0(ScanJob, 1);
+  scan->self = HTTP_CACHE_STORE(g_object_ref(self));
+  scan->directory = g_strdup(self->directory);
+  scan->names = g_ptr_array_new_with_free_func(g_free);
+  scan->entries = g_array_new(FALSE, FALSE, sizeof(IndexEntry));
+  async_io_call(io, scan_directory, scan, directory_scanned_cb, scan);
+
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  self->channel =
+      fl_method_channel_new(messenger, kChannelName, FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(self->channel, method_call_cb, self,
+                                            nullptr);
+  return self;
+}
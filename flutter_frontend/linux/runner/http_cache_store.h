@@ -0,0 +1,48 @@
+#ifndef FLUTTER_HTTP_CACHE_STORE_H_
+#define FLUTTER_HTTP_CACHE_STORE_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+#include "async_io.h"
+
+G_DECLARE_FINAL_TYPE(HttpCacheStore, http_cache_store, HTTP, CACHE_STORE,
+                     GObject)
+
+/**
+ * HttpCacheStore:
+ *
+ * Size-bounded disk store behind the Dart HTTP cache
+ * (lib/core/services/http_cache.dart).
+ *
+ * Dart owns the caching rules; the store only keeps opaque entries, one
+ * file per key under `$XDG_CACHE_HOME/<application id>/http`. A file is a
+ * little-endian header (u32 magic "MDHC", u32 metadata length) followed by
+ * the UTF-8 metadata Dart supplied and the response body.
+ *
+ * Methods on the `modern_dashboard/http_cache` channel:
+ *  - `get {key}` answers `{meta, body}` or %NULL;
+ *  - `put {key, meta, body}` stores an entry, replacing any previous one;
+ *  - `updateMeta {key, meta}` rewrites the metadata and keeps the body;
+ *  - `remove {key}`, `clear` and `getStats`.
+ *
+ * File access goes through the shared #AsyncIo, so the engine thread never
+ * waits on disk and calls on different entries overlap. Calls on one entry
+ * run in order, and a clear waits for the calls before it. An entry is
+ * written to a temporary file and renamed into place. When the store grows
+ * past its limit the least recently used entries are deleted until it is
+ * back under 90% of the limit. Recency survives restarts through file
+ * modification times.
+ */
+
+/**
+ * http_cache_store_new:
+ * @messenger: an #FlBinaryMessenger.
+ * @io: the #AsyncIo for file access.
+ * @max_bytes: size the entries on disk may grow to.
+ *
+ * Returns: a new #HttpCacheStore.
+ */
+HttpCacheStore* http_cache_store_new(FlBinaryMessenger* messenger,
+                                     AsyncIo* io, gint64 max_bytes);
+
+#endif  // FLUTTER_HTTP_CACHE_STORE_H_
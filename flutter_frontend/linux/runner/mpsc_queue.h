@@ -0,0 +1,63 @@
+#ifndef FLUTTER_MPSC_QUEUE_H_
+#define FLUTTER_MPSC_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+
+// Unbounded lock-free multi-producer single-consumer queue (Vyukov's
+// node-based design). Push is wait-free: one exchange and one store. Pop must
+// only be called from the single consumer thread.
+//
+// The queue always holds one dummy node; a popped value is moved out of the
+// node after the dummy, which then becomes the new dummy.
+template <typename T>
+class MpscQueue {
+ public:
+  MpscQueue() : head_(new Node()), tail_(head_.load(std::memory_order_relaxed)) {}
+
+  ~MpscQueue() {
+    T value;
+    while (Pop(&value)) {
+    }
+    delete tail_;
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  // Thread-safe; may be called from any producer thread.
+  void Push(T value) {
+    Node* node = new Node();
+    node->value = value;
+    Node* previous = head_.exchange(node, std::memory_order_acq_rel);
+    // Between the exchange and this store the consumer sees the queue as
+    // ending at |previous|; it simply picks |node| up on the next pop.
+    previous->next.store(node, std::memory_order_release);
+  }
+
+  // Consumer thread only. Returns false if the queue is (momentarily) empty.
+  bool Pop(T* value) {
+    Node* tail = tail_;
+    Node* next = tail->next.load(std::memory_order_acquire);
+    if (next == nullptr) return false;
+    *value = next->value;
+    next->value = T();
+    tail_ = next;
+    delete tail;
+    return true;
+  }
+
+ private:
+  struct Node {
+    std::atomic<Node*> next{nullptr};
+    T value{};
+  };
+
+  // Producers hammer |head_| while the consumer owns |tail_|; keep them on
+  // separate cache lines without requiring an over-aligned allocation.
+  std::atomic<Node*> head_;
+  char padding_[64 - sizeof(std::atomic<Node*>)];
+  Node* tail_;
+};
+
+#endif  // FLUTTER_MPSC_QUEUE_H_
@@ -5,15 +5,68 @@
 #include <gdk/gdkx.h>
 #endif
 
+#include "async_io.h"
+#include "config_watcher.h"
 #include "flutter/generated_plugin_registrant.h"
+#include "host_warmup.h"
+#include "http_cache_store.h"
+#include "native_bridge.h"
+#include "resource_budget.h"
+#include "runtime_profile.h"
+#include "stream_snapshot.h"
+
+// Requests the native stores may have in flight on io_uring at once.
+static const guint kAsyncIoQueueDepth = 64;
+
+// Disk space for cached HTTP responses.
+static const gint64 kHttpCacheMaxBytes = 256 * 1024 * 1024;
+
+// Channel for runner-level runtime information consumed by the Dart side.
+static const char* kRuntimeChannelName = "modern_dashboard/runtime";
+
+// Bridge the worker threads post their results to Dart through.
+static const char* kWorkerResultsChannelName = "modern_dashboard/worker_results";
+static const guint kWorkerResultsCapacity = 256;
+static const guint kWorkerResultsMaxBatch = 32;
+static const guint kWorkerResultsMaxInFlight = 2;
 
 struct _MyApplication {
   GtkApplication parent_instance;
   char** dart_entrypoint_arguments;
+  ResourceBudget resource_budget;
+  const RuntimeProfile* runtime_profile;
+  FlMethodChannel* runtime_channel;
+  NativeBridge* worker_results;
+  StreamSnapshot* stream_snapshot;
+  AsyncIo* async_io;
+  ConfigWatcher* config_watcher;
+  HttpCacheStore* http_cache_store;
+  HostWarmup* host_warmup;
 };
 
 G_DEFINE_TYPE(MyApplication, my_application, GTK_TYPE_APPLICATION)
 
+// Handles method calls on the runtime channel.
+static void runtime_method_call_cb(FlMethodChannel* channel,
+                                   FlMethodCall* method_call,
+                                   gpointer user_data) {
+  MyApplication* self = MY_APPLICATION(user_data);
+  const gchar* method = fl_method_call_get_name(method_call);
+
+  g_autoptr(FlMethodResponse) response = nullptr;
+  if (g_strcmp0(method, "getResourceBudget") == 0) {
+    g_autoptr(FlValue) result = resource_budget_to_value(&self->resource_budget);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else {
+    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(method_call, response, &error)) {
+    g_warning("Failed to respond to %s: %s", method, error->message);
+  }
+}
+
 // Implements GApplication::activate.
 static void my_application_activate(GApplication* application) {
   MyApplication* self = MY_APPLICATION(application);
@@ -50,6 +103,12 @@ static void my_application_activate(GApplication* application) {
   gtk_window_set_default_size(window, 1280, 720);
   gtk_widget_show(GTK_WIDGET(window));
 
+  // Engine switches are read when the engine starts, so the profile has to be
+  // in the environment before the project is run by the view.
+  if (self->runtime_profile != nullptr) {
+    runtime_profile_apply(self->runtime_profile, &self->resource_budget);
+  }
+
   g_autoptr(FlDartProject) project = fl_dart_project_new();
   fl_dart_project_set_dart_entrypoint_arguments(project, self->dart_entrypoint_arguments);
 
@@ -59,6 +118,37 @@ static void my_application_activate(GApplication* application) {
 
   fl_register_plugins(FL_PLUGIN_REGISTRY(view));
 
+  FlBinaryMessenger* messenger =
+      fl_engine_get_binary_messenger(fl_view_get_engine(view));
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  g_clear_object(&self->runtime_channel);
+  self->runtime_channel = fl_method_channel_new(messenger, kRuntimeChannelName,
+                                                FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(
+      self->runtime_channel, runtime_method_call_cb, self, nullptr);
+
+  if (self->worker_results != nullptr) {
+    native_bridge_close(self->worker_results);
+    g_clear_object(&self->worker_results);
+  }
+  self->worker_results = native_bridge_new(
+      messenger, kWorkerResultsChannelName, kWorkerResultsCapacity,
+      kWorkerResultsMaxBatch, kWorkerResultsMaxInFlight);
+
+  // Snapshot decodes are CPU-heavy and share the machine with the engine, so
+  // at most two run at once.
+  g_clear_object(&self->stream_snapshot);
+  self->stream_snapshot =
+      stream_snapshot_new(messenger, self->worker_results,
+                          MIN(self->resource_budget.worker_pool_size, 2u));
+
+  g_clear_object(&self->http_cache_store);
+  self->http_cache_store =
+      http_cache_store_new(messenger, self->async_io, kHttpCacheMaxBytes);
+
+  host_warmup_attach(self->host_warmup, messenger);
+  config_watcher_attach(self->config_watcher, messenger);
+
   gtk_widget_grab_focus(GTK_WIDGET(view));
 }
 
@@ -67,6 +157,8 @@ static gboolean my_application_local_command_line(GApplication* application, gch
   MyApplication* self = MY_APPLICATION(application);
   // Strip out the first argument as it is the binary name.
   self->dart_entrypoint_arguments = g_strdupv(*arguments + 1);
+  self->runtime_profile =
+      runtime_profile_select(self->dart_entrypoint_arguments);
 
   g_autoptr(GError) error = nullptr;
   if (!g_application_register(application, nullptr, &error)) {
@@ -83,9 +175,27 @@ static gboolean my_application_local_command_line(GApplication* application, gch
 
 // Implements GApplication::startup.
 static void my_application_startup(GApplication* application) {
-  //MyApplication* self = MY_APPLICATION(object);
+  MyApplication* self = MY_APPLICATION(application);
+
+  // Size pools and caches for the container we are running in before the
+  // engine starts, so the exported budget is visible to plugins as well.
+  resource_budget_detect(&self->resource_budget);
+  resource_budget_export(&self->resource_budget);
 
-  // Perform any actions required at application startup.
+  // Resolve the hosts the last sessions used most while the engine boots.
+  g_clear_object(&self->host_warmup);
+  self->host_warmup = host_warmup_new(self->resource_budget.fetch_concurrency);
+
+  // Shared file I/O for the native stores; it falls back to a thread pool
+  // where io_uring is unavailable.
+  g_clear_object(&self->async_io);
+  self->async_io = async_io_new(kAsyncIoQueueDepth,
+                                self->resource_budget.worker_pool_size);
+
+  // Read the local dashboard config and keep applying edits to it while the
+  // app runs.
+  g_clear_object(&self->config_watcher);
+  self->config_watcher = config_watcher_new();
 
   G_APPLICATION_CLASS(my_application_parent_class)->startup(application);
 }
@@ -103,6 +213,16 @@ static void my_application_shutdown(GApplication* application) {
 static void my_application_dispose(GObject* object) {
   MyApplication* self = MY_APPLICATION(object);
   g_clear_pointer(&self->dart_entrypoint_arguments, g_strfreev);
+  g_clear_object(&self->runtime_channel);
+  if (self->worker_results != nullptr) {
+    native_bridge_close(self->worker_results);
+    g_clear_object(&self->worker_results);
+  }
+  g_clear_object(&self->stream_snapshot);
+  g_clear_object(&self->http_cache_store);
+  g_clear_object(&self->async_io);
+  g_clear_object(&self->host_warmup);
+  g_clear_object(&self->config_watcher);
   G_OBJECT_CLASS(my_application_parent_class)->dispose(object);
 }
 
@@ -0,0 +1,368 @@
+#include "native_bridge.h"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+
+#include "mpsc_queue.h"
+
+namespace {
+
+struct QueuedValue {
+  FlValue* value;
+  gint64 enqueued_us;
+};
+
+// A GSource that becomes ready when the bridge's eventfd is signalled.
+struct BridgeSource {
+  GSource source;
+  NativeBridge* bridge;
+};
+
+}  // namespace
+
+struct _NativeBridge {
+  GObject parent_instance;
+
+  // Either the Dart channels or a native handler consumes the batches.
+  FlEventChannel* event_channel;
+  FlMethodChannel* control_channel;
+  NativeBridgeHandler handler;
+  gpointer handler_data;
+  GSource* source;
+  int event_fd;
+
+  MpscQueue<QueuedValue>* queue;
+  guint capacity;
+  guint max_batch;
+  guint max_in_flight;
+
+  // Shared with producer threads.
+  std::atomic<guint> pending;
+  std::atomic<bool> signaled;
+  std::atomic<bool> listening;
+  std::atomic<guint64> posted;
+  std::atomic<guint64> rejected;
+
+  // Main thread only.
+  guint in_flight;
+  gint64 next_batch_id;
+  guint64 dispatched_batches;
+  guint64 dispatched_values;
+  guint largest_batch;
+  gint64 total_latency_us;
+  gint64 max_latency_us;
+};
+
+G_DEFINE_TYPE(NativeBridge, native_bridge, G_TYPE_OBJECT)
+
+// Wakes the main context. Only the first producer after a drain pays for the
+// syscall; the rest see |signaled| already set.
+static void native_bridge_signal(NativeBridge* self) {
+  if (!self->signaled.exchange(true, std::memory_order_acq_rel)) {
+    uint64_t one = 1;
+    if (write(self->event_fd, &one, sizeof(one)) < 0) {
+      g_warning("NativeBridge: failed to signal eventfd");
+    }
+  }
+}
+
+// Releases everything still queued, e.g. after Dart stops listening.
+static void native_bridge_discard(NativeBridge* self) {
+  QueuedValue queued;
+  while (self->queue->Pop(&queued)) {
+    fl_value_unref(queued.value);
+    self->pending.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+// Moves up to |max_batch| values into one batch and hands it to the handler
+// or sends it to Dart.
+static gboolean native_bridge_send_batch(NativeBridge* self) {
+  g_autoptr(FlValue) items = fl_value_new_list();
+  gint64 now = g_get_monotonic_time();
+  guint count = 0;
+
+  QueuedValue queued;
+  while (count < self->max_batch && self->queue->Pop(&queued)) {
+    fl_value_append_take(items, queued.value);
+    gint64 latency = now - queued.enqueued_us;
+    self->total_latency_us += latency;
+    self->max_latency_us = MAX(self->max_latency_us, latency);
+    count++;
+  }
+  if (count == 0) return FALSE;
+  self->pending.fetch_sub(count, std::memory_order_relaxed);
+
+  if (self->handler != nullptr) {
+    self->handler(items, self->handler_data);
+    self->dispatched_batches++;
+    self->dispatched_values += count;
+    self->largest_batch = MAX(self->largest_batch, count);
+    return TRUE;
+  }
+
+  g_autoptr(FlValue) event = fl_value_new_map();
+  fl_value_set_string_take(event, "batch", fl_value_new_int(self->next_batch_id++));
+  fl_value_set_string(event, "items", items);
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_event_channel_send(self->event_channel, event, nullptr, &error)) {
+    g_warning("NativeBridge: failed to send batch: %s", error->message);
+    return FALSE;
+  }
+
+  self->in_flight++;
+  self->dispatched_batches++;
+  self->dispatched_values += count;
+  self->largest_batch = MAX(self->largest_batch, count);
+  return TRUE;
+}
+
+static void native_bridge_drain(NativeBridge* self) {
+  uint64_t count;
+  if (read(self->event_fd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+    g_warning("NativeBridge: failed to read eventfd");
+  }
+  // Clear before draining so a value pushed during the drain signals again.
+  self->signaled.store(false, std::memory_order_release);
+
+  if (!self->listening.load(std::memory_order_acquire)) {
+    native_bridge_discard(self);
+    return;
+  }
+
+  // Stop once Dart has max_in_flight unprocessed batches; the acknowledgement
+  // re-arms the source, and meanwhile the queue fills up to its capacity.
+  // A native handler has no acknowledgement and takes everything queued. It
+  // may drop the last outside reference, so keep the bridge alive meanwhile.
+  g_object_ref(self);
+  while ((self->handler != nullptr || self->in_flight < self->max_in_flight) &&
+         self->listening.load(std::memory_order_acquire) &&
+         native_bridge_send_batch(self)) {
+  }
+  g_object_unref(self);
+}
+
+static gboolean bridge_source_dispatch(GSource* source, GSourceFunc callback,
+                                       gpointer user_data) {
+  native_bridge_drain(reinterpret_cast<BridgeSource*>(source)->bridge);
+  return G_SOURCE_CONTINUE;
+}
+
+static GSourceFuncs bridge_source_funcs = {
+    nullptr,  // prepare: readiness comes from the unix fd.
+    nullptr,  // check
+    bridge_source_dispatch,
+    nullptr,  // finalize
+    nullptr,
+    nullptr,
+};
+
+static FlValue* native_bridge_get_stats(NativeBridge* self) {
+  FlValue* stats = fl_value_new_map();
+  fl_value_set_string_take(
+      stats, "posted",
+      fl_value_new_int(self->posted.load(std::memory_order_relaxed)));
+  fl_value_set_string_take(
+      stats, "rejected",
+      fl_value_new_int(self->rejected.load(std::memory_order_relaxed)));
+  fl_value_set_string_take(
+      stats, "pending",
+      fl_value_new_int(self->pending.load(std::memory_order_relaxed)));
+  fl_value_set_string_take(stats, "inFlight", fl_value_new_int(self->in_flight));
+  fl_value_set_string_take(stats, "batches",
+                           fl_value_new_int(self->dispatched_batches));
+  fl_value_set_string_take(stats, "values",
+                           fl_value_new_int(self->dispatched_values));
+  fl_value_set_string_take(stats, "largestBatch",
+                           fl_value_new_int(self->largest_batch));
+  fl_value_set_string_take(
+      stats, "meanLatencyUs",
+      fl_value_new_int(self->dispatched_values > 0
+                           ? self->total_latency_us /
+                                 static_cast<gint64>(self->dispatched_values)
+                           : 0));
+  fl_value_set_string_take(stats, "maxLatencyUs",
+                           fl_value_new_int(self->max_latency_us));
+  return stats;
+}
+
+// Handles "ack" and "getStats" on the control channel.
+static void control_method_call_cb(FlMethodChannel* channel,
+                                   FlMethodCall* method_call,
+                                   gpointer user_data) {
+  NativeBridge* self = NATIVE_BRIDGE(user_data);
+  const gchar* method = fl_method_call_get_name(method_call);
+
+  g_autoptr(FlMethodResponse) response = nullptr;
+  if (g_strcmp0(method, "ack") == 0) {
+    if (self->in_flight > 0) self->in_flight--;
+    if (self->pending.load(std::memory_order_relaxed) > 0) {
+      native_bridge_signal(self);
+    }
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (g_strcmp0(method, "getStats") == 0) {
+    g_autoptr(FlValue) stats = native_bridge_get_stats(self);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(stats));
+  } else {
+    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(method_call, response, &error)) {
+    g_warning("NativeBridge: failed to respond to %s: %s", method,
+              error->message);
+  }
+}
+
+static FlMethodErrorResponse* listen_cb(FlEventChannel* channel, FlValue* args,
+                                        gpointer user_data) {
+  NativeBridge* self = NATIVE_BRIDGE(user_data);
+  self->in_flight = 0;
+  self->listening.store(true, std::memory_order_release);
+  return nullptr;
+}
+
+static FlMethodErrorResponse* cancel_cb(FlEventChannel* channel, FlValue* args,
+                                        gpointer user_data) {
+  NativeBridge* self = NATIVE_BRIDGE(user_data);
+  self->listening.store(false, std::memory_order_release);
+  native_bridge_discard(self);
+  return nullptr;
+}
+
+static void native_bridge_dispose(GObject* object) {
+  NativeBridge* self = NATIVE_BRIDGE(object);
+
+  self->listening.store(false, std::memory_order_release);
+  if (self->source != nullptr) {
+    g_source_destroy(self->source);
+    g_clear_pointer(&self->source, g_source_unref);
+  }
+  if (self->queue != nullptr) {
+    native_bridge_discard(self);
+    delete self->queue;
+    self->queue = nullptr;
+  }
+  if (self->event_fd >= 0) {
+    close(self->event_fd);
+    self->event_fd = -1;
+  }
+  g_clear_object(&self->event_channel);
+  g_clear_object(&self->control_channel);
+
+  G_OBJECT_CLASS(native_bridge_parent_class)->dispose(object);
+}
+
+static void native_bridge_class_init(NativeBridgeClass* klass) {
+  G_OBJECT_CLASS(klass)->dispose = native_bridge_dispose;
+}
+
+static void native_bridge_init(NativeBridge* self) {
+  self->event_fd = -1;
+}
+
+// Creates the queue and the eventfd source shared by both kinds of bridge.
+static NativeBridge* native_bridge_create(const gchar* name, guint capacity,
+                                          guint max_batch) {
+  NativeBridge* self =
+      NATIVE_BRIDGE(g_object_new(native_bridge_get_type(), nullptr));
+  self->queue = new MpscQueue<QueuedValue>();
+  self->capacity = MAX(capacity, 1u);
+  self->max_batch = MAX(max_batch, 1u);
+  self->max_in_flight = 1;
+
+  self->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (self->event_fd < 0) {
+    g_critical("NativeBridge: eventfd failed for %s", name);
+    return self;
+  }
+
+  self->source = g_source_new(&bridge_source_funcs, sizeof(BridgeSource));
+  reinterpret_cast<BridgeSource*>(self->source)->bridge = self;
+  g_source_add_unix_fd(self->source, self->event_fd, G_IO_IN);
+  g_source_set_name(self->source, name);
+  g_source_attach(self->source, g_main_context_default());
+  return self;
+}
+
+NativeBridge* native_bridge_new(FlBinaryMessenger* messenger, const gchar* name,
+                                guint capacity, guint max_batch,
+                                guint max_in_flight) {
+  NativeBridge* self = native_bridge_create(name, capacity, max_batch);
+  self->max_in_flight = MAX(max_in_flight, 1u);
+
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  self->event_channel =
+      fl_event_channel_new(messenger, name, FL_METHOD_CODEC(codec));
+  fl_event_channel_set_stream_handlers(self->event_channel, listen_cb,
+                                       cancel_cb, self, nullptr);
+
+  g_autofree gchar* control_name = g_strdup_printf("%s/control", name);
+  self->control_channel =
+      fl_method_channel_new(messenger, control_name, FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(
+      self->control_channel, control_method_call_cb, self, nullptr);
+
+  return self;
+}
+
+NativeBridge* native_bridge_new_with_handler(guint capacity, guint max_batch,
+                                             NativeBridgeHandler handler,
+                                             gpointer user_data) {
+  g_return_val_if_fail(handler != nullptr, nullptr);
+
+  NativeBridge* self =
+      native_bridge_create("NativeBridge handler", capacity, max_batch);
+  self->handler = handler;
+  self->handler_data = user_data;
+  self->listening.store(true, std::memory_order_release);
+  return self;
+}
+
+void native_bridge_close(NativeBridge* self) {
+  g_return_if_fail(NATIVE_IS_BRIDGE(self));
+
+  self->listening.store(false, std::memory_order_release);
+  if (self->source != nullptr) {
+    g_source_destroy(self->source);
+    g_clear_pointer(&self->source, g_source_unref);
+  }
+  native_bridge_discard(self);
+  g_clear_object(&self->event_channel);
+  g_clear_object(&self->control_channel);
+  self->handler = nullptr;
+}
+
+// Drops a value the bridge cannot accept.
+static gboolean native_bridge_reject(NativeBridge* self, FlValue* value) {
+  self->rejected.fetch_add(1, std::memory_order_relaxed);
+  fl_value_unref(value);
+  return FALSE;
+}
+
+gboolean native_bridge_post(NativeBridge* self, FlValue* value) {
+  g_return_val_if_fail(NATIVE_IS_BRIDGE(self), FALSE);
+
+  if (self->event_fd < 0 || !self->listening.load(std::memory_order_acquire)) {
+    return native_bridge_reject(self, value);
+  }
+  if (self->pending.fetch_add(1, std::memory_order_acq_rel) >= self->capacity) {
+    self->pending.fetch_sub(1, std::memory_order_relaxed);
+    return native_bridge_reject(self, value);
+  }
+
+  self->queue->Push(QueuedValue{value, g_get_monotonic_time()});
+  self->posted.fetch_add(1, std::memory_order_relaxed);
+  native_bridge_signal(self);
+  return TRUE;
+}
+
+guint native_bridge_get_pending(NativeBridge* self) {
+  g_return_val_if_fail(NATIVE_IS_BRIDGE(self), 0);
+  return self->pending.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,101 @@
+#ifndef FLUTTER_NATIVE_BRIDGE_H_
+#define FLUTTER_NATIVE_BRIDGE_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+G_DECLARE_FINAL_TYPE(NativeBridge, native_bridge, NATIVE, BRIDGE, GObject)
+
+/**
+ * NativeBridge:
+ *
+ * Delivers results from native worker threads to the platform thread.
+ *
+ * Workers post values into a lock-free MPSC queue. A single eventfd-backed
+ * #GSource on the main context drains it in batches of up to max_batch
+ * values, so a burst of results costs one main-loop wakeup rather than one
+ * idle source each. Posts fail once the queue reaches its capacity.
+ *
+ * A bridge made with native_bridge_new() sends each batch to Dart as one
+ * `{"batch": id, "items": [...]}` event on the event channel. Dart
+ * acknowledges each batch on the `<name>/control` method channel; once
+ * max_in_flight batches are unacknowledged the bridge stops dispatching
+ * until Dart catches up. A bridge made with native_bridge_new_with_handler()
+ * hands each batch to a function on the main thread instead, for results
+ * that answer method calls or update main-thread state.
+ */
+
+/**
+ * NativeBridgeHandler:
+ * @batch: list of the dispatched values, in posting order.
+ * @user_data: user data given to native_bridge_new_with_handler().
+ *
+ * Receives posted values on the main thread.
+ */
+typedef void (*NativeBridgeHandler)(FlValue* batch, gpointer user_data);
+
+/**
+ * native_bridge_new:
+ * @messenger: an #FlBinaryMessenger.
+ * @name: event channel name.
+ * @capacity: maximum number of queued values before posts are rejected.
+ * @max_batch: maximum number of values per event.
+ * @max_in_flight: maximum number of unacknowledged events.
+ *
+ * Creates a bridge attached to the default main context.
+ *
+ * Returns: a new #NativeBridge.
+ */
+NativeBridge* native_bridge_new(FlBinaryMessenger* messenger, const gchar* name,
+                                guint capacity, guint max_batch,
+                                guint max_in_flight);
+
+/**
+ * native_bridge_new_with_handler:
+ * @capacity: maximum number of queued values before posts are rejected.
+ * @max_batch: maximum number of values per call of @handler.
+ * @handler: function called with the values on the main thread.
+ * @user_data: data passed to @handler.
+ *
+ * Creates a bridge to a native consumer, attached to the default main
+ * context.
+ *
+ * Returns: a new #NativeBridge.
+ */
+NativeBridge* native_bridge_new_with_handler(guint capacity, guint max_batch,
+                                             NativeBridgeHandler handler,
+                                             gpointer user_data);
+
+/**
+ * native_bridge_close:
+ * @bridge: a #NativeBridge.
+ *
+ * Stops dispatching and releases the channels, on the main thread. Later
+ * posts are rejected, so workers that are still running may keep a
+ * reference and post until they notice they are done; the bridge itself
+ * is freed with the last reference, on whichever thread drops it.
+ */
+void native_bridge_close(NativeBridge* bridge);
+
+/**
+ * native_bridge_post:
+ * @bridge: a #NativeBridge.
+ * @value: (transfer full): value to deliver.
+ *
+ * Queues @value for delivery. Safe to call from any thread that holds a
+ * reference to @bridge.
+ *
+ * Returns: %TRUE if queued, %FALSE if Dart is not listening, the bridge is
+ * closed or the queue is full, in which case @value is released and the
+ * caller should slow down.
+ */
+gboolean native_bridge_post(NativeBridge* bridge, FlValue* value);
+
+/**
+ * native_bridge_get_pending:
+ * @bridge: a #NativeBridge.
+ *
+ * Returns: the number of values queued but not yet dispatched.
+ */
+guint native_bridge_get_pending(NativeBridge* bridge);
+
+#endif  // FLUTTER_NATIVE_BRIDGE_H_
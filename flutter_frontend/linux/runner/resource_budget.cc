@@ -0,0 +1,226 @@
+#include "resource_budget.h"
+
+#include <sched.h>
+#include <unistd.h>
+
+#include <cmath>
+
+// Root of the cgroup v2 unified hierarchy (or of the v1 controllers).
+static const char* kCgroupRoot = "/sys/fs/cgroup";
+
+static const gint64 kMiB = 1024 * 1024;
+
+// Reads a small pseudo-file and strips trailing whitespace.
+static gchar* read_trimmed(const gchar* path) {
+  gchar* contents = nullptr;
+  if (!g_file_get_contents(path, &contents, nullptr, nullptr)) {
+    return nullptr;
+  }
+  return g_strstrip(contents);
+}
+
+// Returns the cgroup v2 path of this process, e.g. "/system.slice/kiosk.scope",
+// or nullptr when the process is not in a unified hierarchy.
+static gchar* cgroup_v2_path() {
+  g_autofree gchar* contents = nullptr;
+  if (!g_file_get_contents("/proc/self/cgroup", &contents, nullptr, nullptr)) {
+    return nullptr;
+  }
+  g_auto(GStrv) lines = g_strsplit(contents, "\n", -1);
+  for (gchar** line = lines; *line != nullptr; line++) {
+    if (g_str_has_prefix(*line, "0::")) {
+      return g_strdup(*line + 3);
+    }
+  }
+  return nullptr;
+}
+
+// Counts the CPUs in a cpuset list such as "0-3,8,10-11".
+static guint count_cpu_list(const gchar* list) {
+  guint count = 0;
+  g_auto(GStrv) ranges = g_strsplit(list, ",", -1);
+  for (gchar** range = ranges; *range != nullptr; range++) {
+    if (**range == '\0') continue;
+    guint64 first = 0, last = 0;
+    gchar* end = nullptr;
+    first = g_ascii_strtoull(*range, &end, 10);
+    last = (end != nullptr && *end == '-') ? g_ascii_strtoull(end + 1, nullptr, 10)
+                                           : first;
+    if (last >= first) count += last - first + 1;
+  }
+  return count;
+}
+
+// Returns the quota/period ratio from a v2 `cpu.max` file, or 0 if unlimited.
+static double parse_cpu_max(const gchar* contents) {
+  g_auto(GStrv) fields = g_strsplit(contents, " ", 2);
+  if (fields[0] == nullptr || g_strcmp0(fields[0], "max") == 0) return 0;
+  double quota = g_ascii_strtod(fields[0], nullptr);
+  double period = fields[1] != nullptr ? g_ascii_strtod(fields[1], nullptr) : 100000;
+  return (quota > 0 && period > 0) ? quota / period : 0;
+}
+
+// Walks from the process cgroup up to the root, keeping the tightest CPU quota
+// and memory limit. Nested limits apply, so the minimum along the path is the
+// one that is enforced.
+static void detect_cgroup_v2(const gchar* cgroup, double* cpu_quota,
+                             gint64* memory_max, guint* cpuset_cpus) {
+  g_autofree gchar* dir = g_build_filename(kCgroupRoot, cgroup, nullptr);
+  while (g_str_has_prefix(dir, kCgroupRoot)) {
+    g_autofree gchar* cpu_path = g_build_filename(dir, "cpu.max", nullptr);
+    g_autofree gchar* cpu_max = read_trimmed(cpu_path);
+    if (cpu_max != nullptr) {
+      double quota = parse_cpu_max(cpu_max);
+      if (quota > 0 && (*cpu_quota == 0 || quota < *cpu_quota)) *cpu_quota = quota;
+    }
+
+    g_autofree gchar* memory_path = g_build_filename(dir, "memory.max", nullptr);
+    g_autofree gchar* memory = read_trimmed(memory_path);
+    if (memory != nullptr && g_strcmp0(memory, "max") != 0) {
+      gint64 limit = g_ascii_strtoll(memory, nullptr, 10);
+      if (limit > 0 && (*memory_max < 0 || limit < *memory_max)) *memory_max = limit;
+    }
+
+    if (*cpuset_cpus == 0) {
+      g_autofree gchar* cpuset_path =
+          g_build_filename(dir, "cpuset.cpus.effective", nullptr);
+      g_autofree gchar* cpuset = read_trimmed(cpuset_path);
+      if (cpuset != nullptr && *cpuset != '\0') *cpuset_cpus = count_cpu_list(cpuset);
+    }
+
+    if (g_strcmp0(dir, kCgroupRoot) == 0) break;
+    gchar* parent = g_path_get_dirname(dir);
+    g_free(dir);
+    dir = parent;
+  }
+}
+
+// Reads the cgroup v1 CFS quota and memory limit, for older container hosts.
+static void detect_cgroup_v1(double* cpu_quota, gint64* memory_max) {
+  g_autofree gchar* quota = read_trimmed("/sys/fs/cgroup/cpu/cpu.cfs_quota_us");
+  g_autofree gchar* period = read_trimmed("/sys/fs/cgroup/cpu/cpu.cfs_period_us");
+  if (quota != nullptr && period != nullptr) {
+    double q = g_ascii_strtod(quota, nullptr);
+    double p = g_ascii_strtod(period, nullptr);
+    if (q > 0 && p > 0) *cpu_quota = q / p;
+  }
+
+  g_autofree gchar* memory =
+      read_trimmed("/sys/fs/cgroup/memory/memory.limit_in_bytes");
+  if (memory != nullptr) {
+    gint64 limit = g_ascii_strtoll(memory, nullptr, 10);
+    // An unlimited v1 cgroup reports a page-aligned LONG_MAX.
+    if (limit > 0 && limit < G_MAXINT64 / 2) *memory_max = limit;
+  }
+}
+
+static guint clamp_uint(double value, guint low, guint high) {
+  if (value < low) return low;
+  if (value > high) return high;
+  return static_cast<guint>(value);
+}
+
+static gint64 clamp_int64(gint64 value, gint64 low, gint64 high) {
+  return MAX(low, MIN(value, high));
+}
+
+void resource_budget_detect(ResourceBudget* budget) {
+  double cpu_quota = 0;
+  gint64 memory_max = -1;
+  guint cpuset_cpus = 0;
+
+  g_autofree gchar* cgroup = cgroup_v2_path();
+  if (cgroup != nullptr) {
+    detect_cgroup_v2(cgroup, &cpu_quota, &memory_max, &cpuset_cpus);
+  } else {
+    detect_cgroup_v1(&cpu_quota, &memory_max);
+  }
+
+  // The affinity mask already reflects the cpuset; the cgroup file is only
+  // consulted as well in case affinity was widened after the cpuset shrank.
+  cpu_set_t affinity;
+  CPU_ZERO(&affinity);
+  guint online = static_cast<guint>(MAX(1L, sysconf(_SC_NPROCESSORS_ONLN)));
+  guint cpus = sched_getaffinity(0, sizeof(affinity), &affinity) == 0
+                   ? static_cast<guint>(CPU_COUNT(&affinity))
+                   : online;
+  if (cpuset_cpus > 0) cpus = MIN(cpus, cpuset_cpus);
+
+  double effective_cpus = cpus;
+  if (cpu_quota > 0) effective_cpus = MIN(effective_cpus, cpu_quota);
+
+  gint64 physical = static_cast<gint64>(sysconf(_SC_PHYS_PAGES)) *
+                    static_cast<gint64>(sysconf(_SC_PAGE_SIZE));
+  gint64 memory = physical > 0 ? physical : 0;
+  if (memory_max > 0 && (memory == 0 || memory_max < memory)) memory = memory_max;
+
+  budget->effective_cpus = effective_cpus;
+  budget->memory_limit_bytes = memory;
+  budget->cgroup_limited = cpu_quota > 0 || memory_max > 0;
+
+  // CPU-bound pools get one thread per whole CPU of quota; a fractional quota
+  // still needs a thread but more would only be throttled.
+  budget->worker_pool_size = clamp_uint(std::floor(effective_cpus), 1, 16);
+
+  // Fetches mostly wait on the network, so allow a few per CPU, but keep a
+  // floor so a 0.5 CPU kiosk still refreshes feeds in parallel.
+  budget->fetch_concurrency = clamp_uint(std::ceil(effective_cpus * 4), 4, 24);
+
+  // Flutter's defaults are 100 MiB / 1000 images. Give decoded images 1/16 of
+  // the memory limit within [16 MiB, 256 MiB], at roughly 100 KiB per entry.
+  gint64 image_bytes = memory > 0 ? memory / 16 : 100 * kMiB;
+  budget->image_cache_bytes = clamp_int64(image_bytes, 16 * kMiB, 256 * kMiB);
+  budget->image_cache_entries =
+      clamp_uint(budget->image_cache_bytes / (100 * 1024), 100, 1000);
+
+  // One entry per 16 MiB, between the old fixed size and a generous cap.
+  budget->type_cache_entries =
+      clamp_uint(memory > 0 ? memory / (16 * kMiB) : 100, 100, 1024);
+}
+
+void resource_budget_export(const ResourceBudget* budget) {
+  g_autofree gchar* cpus = g_strdup_printf("%.2f", budget->effective_cpus);
+  g_autofree gchar* memory =
+      g_strdup_printf("%" G_GINT64_FORMAT, budget->memory_limit_bytes);
+  g_autofree gchar* workers = g_strdup_printf("%u", budget->worker_pool_size);
+  g_autofree gchar* fetches = g_strdup_printf("%u", budget->fetch_concurrency);
+  g_autofree gchar* image_bytes =
+      g_strdup_printf("%" G_GINT64_FORMAT, budget->image_cache_bytes);
+  g_autofree gchar* image_entries = g_strdup_printf("%u", budget->image_cache_entries);
+
+  g_setenv("MODERN_DASHBOARD_EFFECTIVE_CPUS", cpus, TRUE);
+  g_setenv("MODERN_DASHBOARD_MEMORY_LIMIT", memory, TRUE);
+  g_setenv("MODERN_DASHBOARD_WORKER_POOL_SIZE", workers, TRUE);
+  g_setenv("MODERN_DASHBOARD_FETCH_CONCURRENCY", fetches, TRUE);
+  g_setenv("MODERN_DASHBOARD_IMAGE_CACHE_BYTES", image_bytes, TRUE);
+  g_setenv("MODERN_DASHBOARD_IMAGE_CACHE_ENTRIES", image_entries, TRUE);
+
+  g_message("Resource budget: %s CPUs, %" G_GINT64_FORMAT
+            " MiB%s -> %u workers, %u fetches, %" G_GINT64_FORMAT
+            " MiB image cache",
+            cpus, budget->memory_limit_bytes / kMiB,
+            budget->cgroup_limited ? " (cgroup)" : "",
+            budget->worker_pool_size, budget->fetch_concurrency,
+            budget->image_cache_bytes / kMiB);
+}
+
+FlValue* resource_budget_to_value(const ResourceBudget* budget) {
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(value, "effectiveCpus",
+                           fl_value_new_float(budget->effective_cpus));
+  fl_value_set_string_take(value, "memoryLimitBytes",
+                           fl_value_new_int(budget->memory_limit_bytes));
+  fl_value_set_string_take(value, "cgroupLimited",
+                           fl_value_new_bool(budget->cgroup_limited));
+  fl_value_set_string_take(value, "workerPoolSize",
+                           fl_value_new_int(budget->worker_pool_size));
+  fl_value_set_string_take(value, "fetchConcurrency",
+                           fl_value_new_int(budget->fetch_concurrency));
+  fl_value_set_string_take(value, "imageCacheBytes",
+                           fl_value_new_int(budget->image_cache_bytes));
+  fl_value_set_string_take(value, "imageCacheEntries",
+                           fl_value_new_int(budget->image_cache_entries));
+  fl_value_set_string_take(value, "typeCacheEntries",
+                           fl_value_new_int(budget->type_cache_entries));
+  return value;
+}
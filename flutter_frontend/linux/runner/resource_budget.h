@@ -0,0 +1,60 @@
+#ifndef FLUTTER_RESOURCE_BUDGET_H_
+#define FLUTTER_RESOURCE_BUDGET_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+/**
+ * ResourceBudget:
+ * @effective_cpus: CPUs available to this process after cgroup CPU quota and
+ * cpuset restrictions are applied.
+ * @memory_limit_bytes: effective memory limit, the smaller of the cgroup
+ * `memory.max` and physical memory.
+ * @cgroup_limited: %TRUE if a cgroup quota or limit was found.
+ * @worker_pool_size: threads for CPU-bound native and isolate pools.
+ * @fetch_concurrency: maximum concurrent network fetches.
+ * @image_cache_bytes: byte budget for the decoded image cache.
+ * @image_cache_entries: entry budget for the decoded image cache.
+ * @type_cache_entries: entry budget for small per-type lookup caches.
+ *
+ * Pool sizes and cache budgets derived from the container the runner is
+ * executing in.
+ */
+typedef struct {
+  double effective_cpus;
+  gint64 memory_limit_bytes;
+  gboolean cgroup_limited;
+  guint worker_pool_size;
+  guint fetch_concurrency;
+  gint64 image_cache_bytes;
+  guint image_cache_entries;
+  guint type_cache_entries;
+} ResourceBudget;
+
+/**
+ * resource_budget_detect:
+ * @budget: budget to fill in.
+ *
+ * Detects the effective CPU count from the cgroup `cpu.max` quota and the
+ * cpuset, and the memory limit from `memory.max` (falling back to cgroup v1
+ * and then to the host), then derives pool sizes and cache budgets from them.
+ */
+void resource_budget_detect(ResourceBudget* budget);
+
+/**
+ * resource_budget_export:
+ * @budget: a #ResourceBudget.
+ *
+ * Exports the chosen budget as `MODERN_DASHBOARD_*` environment variables so
+ * plugins and child processes size themselves consistently.
+ */
+void resource_budget_export(const ResourceBudget* budget);
+
+/**
+ * resource_budget_to_value:
+ * @budget: a #ResourceBudget.
+ *
+ * Returns: (transfer full): the budget as a map for the Dart side.
+ */
+FlValue* resource_budget_to_value(const ResourceBudget* budget);
+
+#endif  // FLUTTER_RESOURCE_BUDGET_H_
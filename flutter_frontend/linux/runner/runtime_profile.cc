@@ -0,0 +1,99 @@
+#include "runtime_profile.h"
+
+#include <cstdlib>
+#include <cstring>
+
+static const gchar* kProfileArgument = "--runtime-profile=";
+static const gchar* kProfileEnvironment = "MODERN_DASHBOARD_RUNTIME_PROFILE";
+
+// Feed refresh allocates many short-lived maps and strings. On constrained
+// kiosks the old generation is capped below the container limit so the VM
+// collects before the kernel reclaims; without a profile the VM keeps its
+// growth policy. "benchmark" also opens the VM service on a known port,
+// where tool/gc_pauses.dart drives refreshes and reads the GC timeline so
+// pause distributions can be compared with and without a heap cap.
+static const RuntimeProfile kProfiles[] = {
+    {"kiosk-low-mem", 0, 0},
+    {"benchmark", -1, 8181},
+};
+
+static const RuntimeProfile* lookup_profile(const gchar* name) {
+  for (const RuntimeProfile& profile : kProfiles) {
+    if (g_strcmp0(profile.name, name) == 0) return &profile;
+  }
+  g_warning("Unknown runtime profile '%s', using VM defaults", name);
+  return nullptr;
+}
+
+const RuntimeProfile* runtime_profile_select(gchar** arguments) {
+  g_autofree gchar* argument_name = nullptr;
+
+  // Remove the argument so it is not forwarded to the Dart entrypoint.
+  gchar** out = arguments;
+  for (gchar** arg = arguments; arg != nullptr && *arg != nullptr; arg++) {
+    if (g_str_has_prefix(*arg, kProfileArgument)) {
+      g_free(argument_name);
+      argument_name = g_strdup(*arg + strlen(kProfileArgument));
+      g_free(*arg);
+    } else {
+      *out++ = *arg;
+    }
+  }
+  if (out != nullptr) *out = nullptr;
+
+  const gchar* name = argument_name != nullptr ? argument_name
+                                               : g_getenv(kProfileEnvironment);
+  if (name == nullptr || *name == '\0') return nullptr;
+  return lookup_profile(name);
+}
+
+// Appends one switch, keeping any the user already set in the environment.
+static void append_engine_switch(const gchar* value) {
+  const gchar* count_value = g_getenv("FLUTTER_ENGINE_SWITCHES");
+  gint count = count_value != nullptr ? atoi(count_value) : 0;
+  count++;
+
+  g_autofree gchar* key = g_strdup_printf("FLUTTER_ENGINE_SWITCH_%d", count);
+  g_autofree gchar* new_count = g_strdup_printf("%d", count);
+  g_setenv(key, value, TRUE);
+  g_setenv("FLUTTER_ENGINE_SWITCHES", new_count, TRUE);
+}
+
+void runtime_profile_apply(const RuntimeProfile* profile,
+                           const ResourceBudget* budget) {
+#ifdef FLUTTER_RELEASE
+  // The engine drops FLUTTER_ENGINE_SWITCHES in release builds.
+  g_warning("Runtime profile '%s' ignored: release builds do not honour "
+            "engine switches; use a profile build",
+            profile->name);
+  return;
+#endif
+
+  gint64 old_gen_mb = profile->old_gen_heap_mb;
+  if (old_gen_mb == 0) {
+    // A quarter of the memory limit leaves room for the engine, raster
+    // caches and decoded images, capped where more heap stops helping.
+    old_gen_mb = budget->memory_limit_bytes > 0
+                     ? budget->memory_limit_bytes / (4 * 1024 * 1024)
+                     : 256;
+    old_gen_mb = CLAMP(old_gen_mb, 64, 256);
+  }
+  g_autofree gchar* heap = g_strdup("default");
+  if (old_gen_mb > 0) {
+    g_autofree gchar* value =
+        g_strdup_printf("old-gen-heap-size=%" G_GINT64_FORMAT, old_gen_mb);
+    append_engine_switch(value);
+    g_free(heap);
+    heap = g_strdup_printf("%" G_GINT64_FORMAT " MiB", old_gen_mb);
+  }
+
+  if (profile->vm_service_port > 0) {
+    g_autofree gchar* value =
+        g_strdup_printf("vm-service-port=%d", profile->vm_service_port);
+    append_engine_switch(value);
+    append_engine_switch("disable-service-auth-codes");
+  }
+
+  g_message("Runtime profile '%s': old-gen heap %s, VM service port %d",
+            profile->name, heap, profile->vm_service_port);
+}
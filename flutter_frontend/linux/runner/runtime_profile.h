@@ -0,0 +1,54 @@
+#ifndef FLUTTER_RUNTIME_PROFILE_H_
+#define FLUTTER_RUNTIME_PROFILE_H_
+
+#include <glib.h>
+
+#include "resource_budget.h"
+
+/**
+ * RuntimeProfile:
+ * @name: profile name as given on the command line.
+ * @old_gen_heap_mb: old-generation heap limit in MiB, 0 to derive it from the
+ * memory budget, or -1 to leave the VM default.
+ * @vm_service_port: port the VM service listens on without an auth code, so
+ * `tool/gc_pauses.dart` can record collections, or 0 to leave it alone.
+ *
+ * A named set of Dart VM heap settings.
+ *
+ * Only engine switches are used. The engine splits `--dart-flags` on commas
+ * and refuses to start on any VM flag outside a short allowlist, which
+ * excludes the new-space and GC flags. Idle-time collection needs no flag:
+ * the engine already reports the idle time between frames to the VM.
+ */
+typedef struct {
+  const gchar* name;
+  gint old_gen_heap_mb;
+  gint vm_service_port;
+} RuntimeProfile;
+
+/**
+ * runtime_profile_select:
+ * @arguments: (inout): command line arguments without the binary name.
+ *
+ * Picks the profile named by a `--runtime-profile=NAME` argument (which is
+ * removed from @arguments) or the `MODERN_DASHBOARD_RUNTIME_PROFILE`
+ * environment variable.
+ *
+ * Returns: the selected profile, or %NULL to use the VM defaults.
+ */
+const RuntimeProfile* runtime_profile_select(gchar** arguments);
+
+/**
+ * runtime_profile_apply:
+ * @profile: a #RuntimeProfile.
+ * @budget: the detected #ResourceBudget.
+ *
+ * Appends the profile's engine switches to `FLUTTER_ENGINE_SWITCHES` so the
+ * engine picks them up when the #FlDartProject is started. The engine only
+ * honours these switches in debug and profile builds, so in a release build
+ * this only warns.
+ */
+void runtime_profile_apply(const RuntimeProfile* profile,
+                           const ResourceBudget* budget);
+
+#endif  // FLUTTER_RUNTIME_PROFILE_H_
@@ -0,0 +1,103 @@
+#include "stream_capture.h"
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <gst/app/gstappsink.h>
+#include <gst/gst.h>
+#include <gst/video/video.h>
+
+// How often a waiting capture checks for cancellation and pipeline errors.
+static const GstClockTime kPollInterval = 100 * GST_MSECOND;
+
+// Encodes a decoded RGB sample as JPEG.
+static GBytes* encode_sample(GstSample* sample, GError** error) {
+  GstVideoInfo info;
+  GstVideoFrame frame;
+  if (!gst_video_info_from_caps(&info, gst_sample_get_caps(sample)) ||
+      !gst_video_frame_map(&frame, &info, gst_sample_get_buffer(sample),
+                           GST_MAP_READ)) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                "cannot map decoded frame");
+    return nullptr;
+  }
+
+  g_autoptr(GdkPixbuf) pixbuf = gdk_pixbuf_new_from_data(
+      static_cast<const guchar*>(GST_VIDEO_FRAME_PLANE_DATA(&frame, 0)),
+      GDK_COLORSPACE_RGB, FALSE, 8, GST_VIDEO_FRAME_WIDTH(&frame),
+      GST_VIDEO_FRAME_HEIGHT(&frame), GST_VIDEO_FRAME_PLANE_STRIDE(&frame, 0),
+      nullptr, nullptr);
+  gchar* jpeg = nullptr;
+  gsize size = 0;
+  gboolean saved = gdk_pixbuf_save_to_buffer(pixbuf, &jpeg, &size, "jpeg",
+                                             error, "quality", "80", nullptr);
+  gst_video_frame_unmap(&frame);
+  return saved ? g_bytes_new_take(jpeg, size) : nullptr;
+}
+
+// Waits for the first sample, in short pulls so that cancellation and
+// pipeline errors end the wait early.
+static GstSample* pull_first_sample(GstElement* pipeline, GstElement* sink,
+                                    const gchar* uri, gint64 timeout_us,
+                                    GCancellable* cancellable, GError** error) {
+  g_autoptr(GstBus) bus = gst_element_get_bus(pipeline);
+  gint64 deadline = g_get_monotonic_time() + timeout_us;
+  while (TRUE) {
+    GstSample* sample =
+        gst_app_sink_try_pull_sample(GST_APP_SINK(sink), kPollInterval);
+    if (sample != nullptr) return sample;
+
+    g_autoptr(GstMessage) message = gst_bus_pop_filtered(bus, GST_MESSAGE_ERROR);
+    if (message != nullptr) {
+      gst_message_parse_error(message, error, nullptr);
+      return nullptr;
+    }
+    if (g_cancellable_set_error_if_cancelled(cancellable, error)) {
+      return nullptr;
+    }
+    if (gst_app_sink_is_eos(GST_APP_SINK(sink))) {
+      g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                  "no video frame in %s", uri);
+      return nullptr;
+    }
+    if (g_get_monotonic_time() >= deadline) {
+      g_set_error(error, G_IO_ERROR, G_IO_ERROR_TIMED_OUT,
+                  "no frame decoded from %s", uri);
+      return nullptr;
+    }
+  }
+}
+
+GBytes* stream_capture_frame(const gchar* uri, gint height, gint64 timeout_us,
+                             GCancellable* cancellable, GError** error) {
+  g_autofree gchar* description = g_strdup_printf(
+      "uridecodebin name=source ! videoconvert ! videoscale ! "
+      "video/x-raw,format=RGB,height=%d,pixel-aspect-ratio=1/1 ! "
+      "appsink name=sink max-buffers=1 sync=false",
+      height);
+  g_autoptr(GError) parse_error = nullptr;
+  g_autoptr(GstElement) pipeline = gst_parse_launch(description, &parse_error);
+  if (pipeline == nullptr) {
+    g_propagate_error(error, g_steal_pointer(&parse_error));
+    return nullptr;
+  }
+
+  g_autoptr(GstElement) source = gst_bin_get_by_name(GST_BIN(pipeline), "source");
+  g_autoptr(GstElement) sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+  g_object_set(source, "uri", uri, nullptr);
+
+  GBytes* result = nullptr;
+  if (gst_element_set_state(pipeline, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_FAILURE) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                "cannot start pipeline for %s", uri);
+  } else {
+    GstSample* sample = pull_first_sample(pipeline, sink, uri, timeout_us,
+                                          cancellable, error);
+    if (sample != nullptr) {
+      result = encode_sample(sample, error);
+      gst_sample_unref(sample);
+    }
+  }
+
+  gst_element_set_state(pipeline, GST_STATE_NULL);
+  return result;
+}
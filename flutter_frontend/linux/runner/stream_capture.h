@@ -0,0 +1,27 @@
+#ifndef FLUTTER_STREAM_CAPTURE_H_
+#define FLUTTER_STREAM_CAPTURE_H_
+
+#include <gio/gio.h>
+
+// Still-frame capture behind StreamSnapshot. Needs GStreamer: it is only
+// built when GStreamer is found, and gst_init() must have been called.
+
+/**
+ * stream_capture_frame:
+ * @uri: URI of a media segment that starts on a keyframe.
+ * @height: height of the frame in pixels; the width keeps the aspect ratio.
+ * @timeout_us: time allowed for fetching the segment and decoding.
+ * @cancellable: (nullable): cancels the capture within 100 ms.
+ * @error: return location for a #GError.
+ *
+ * Decodes the first frame of @uri and encodes it as JPEG. The pipeline is
+ * torn down as soon as that frame arrives, so the rest of the segment is
+ * neither decoded nor, for the most part, downloaded. Safe to call from any
+ * thread.
+ *
+ * Returns: (transfer full): the JPEG bytes, or %NULL with @error set.
+ */
+GBytes* stream_capture_frame(const gchar* uri, gint height, gint64 timeout_us,
+                             GCancellable* cancellable, GError** error);
+
+#endif  // FLUTTER_STREAM_CAPTURE_H_
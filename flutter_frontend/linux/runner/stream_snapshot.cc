@@ -0,0 +1,279 @@
+#include "stream_snapshot.h"
+
+#include <atomic>
+
+#ifdef HAVE_GSTREAMER
+#include <gst/gst.h>
+
+#include "stream_capture.h"
+#endif
+
+static const char* kChannelName = "modern_dashboard/stream_snapshot";
+
+namespace {
+
+// State the capture workers share with the StreamSnapshot. Each queued job
+// holds a reference, so disposing the StreamSnapshot never waits for them.
+struct CaptureContext {
+  std::atomic<gint> ref_count;
+  GCancellable* cancellable;
+  NativeBridge* results;
+  std::atomic<guint64> captured;
+  std::atomic<guint64> failed;
+  std::atomic<guint64> dropped;
+  std::atomic<gint64> total_capture_us;
+};
+
+struct CaptureJob {
+  CaptureContext* context;
+  gint64 id;
+  gchar* url;
+  gint height;
+};
+
+}  // namespace
+
+struct _StreamSnapshot {
+  GObject parent_instance;
+
+  FlMethodChannel* channel;
+  CaptureContext* context;
+  GThreadPool* pool;
+
+  // Main thread only.
+  gint64 next_id;
+  guint64 rejected;
+};
+
+G_DEFINE_TYPE(StreamSnapshot, stream_snapshot, G_TYPE_OBJECT)
+
+static CaptureContext* capture_context_new(NativeBridge* results) {
+  CaptureContext* context = new CaptureContext();
+  context->ref_count = 1;
+  context->cancellable = g_cancellable_new();
+  context->results = NATIVE_BRIDGE(g_object_ref(results));
+  return context;
+}
+
+// May run on a worker thread; the bridge allows its last reference there.
+static void capture_context_unref(CaptureContext* context) {
+  if (context->ref_count.fetch_sub(1, std::memory_order_acq_rel) > 1) return;
+  g_object_unref(context->cancellable);
+  g_object_unref(context->results);
+  delete context;
+}
+
+#ifdef HAVE_GSTREAMER
+
+static CaptureContext* capture_context_ref(CaptureContext* context) {
+  context->ref_count.fetch_add(1, std::memory_order_relaxed);
+  return context;
+}
+
+// Tags this service's values on the shared results bridge.
+static const char* kResultSource = "stream_snapshot";
+
+// Captures waiting behind the running ones before new calls are turned away.
+static const guint kMaxQueued = 8;
+
+// Time allowed for fetching a segment and decoding its first frame.
+static const gint64 kCaptureTimeoutUs = 8 * G_USEC_PER_SEC;
+
+// Largest frame height a caller may ask for.
+static const gint64 kMaxHeight = 1080;
+
+// Runs one capture on a pool thread and posts the frame to the results
+// bridge. Once the service is disposed, queued captures are skipped and a
+// running one stops at its next poll.
+static void capture_job_run(gpointer data, gpointer user_data) {
+  CaptureJob* job = static_cast<CaptureJob*>(data);
+  CaptureContext* context = job->context;
+
+  if (!g_cancellable_is_cancelled(context->cancellable)) {
+    gint64 start = g_get_monotonic_time();
+    g_autoptr(GError) error = nullptr;
+    g_autoptr(GBytes) jpeg =
+        stream_capture_frame(job->url, job->height, kCaptureTimeoutUs,
+                             context->cancellable, &error);
+    context->total_capture_us.fetch_add(g_get_monotonic_time() - start,
+                                        std::memory_order_relaxed);
+
+    if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+      FlValue* result = fl_value_new_map();
+      fl_value_set_string_take(result, "source",
+                               fl_value_new_string(kResultSource));
+      fl_value_set_string_take(result, "id", fl_value_new_int(job->id));
+      if (jpeg == nullptr) {
+        context->failed.fetch_add(1, std::memory_order_relaxed);
+        fl_value_set_string_take(result, "error",
+                                 fl_value_new_string(error->message));
+      } else {
+        context->captured.fetch_add(1, std::memory_order_relaxed);
+        gsize size = 0;
+        const uint8_t* bytes =
+            static_cast<const uint8_t*>(g_bytes_get_data(jpeg, &size));
+        fl_value_set_string_take(result, "frame",
+                                 fl_value_new_uint8_list(bytes, size));
+      }
+      // Dart times the capture out when its result is dropped here.
+      if (!native_bridge_post(context->results, result)) {
+        context->dropped.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  capture_context_unref(context);
+  g_free(job->url);
+  delete job;
+}
+
+#endif  // HAVE_GSTREAMER
+
+// Queues a capture and answers with its id.
+static FlMethodResponse* stream_snapshot_capture(StreamSnapshot* self,
+                                                 FlMethodCall* method_call) {
+#ifdef HAVE_GSTREAMER
+  if (self->pool == nullptr) {
+    return FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* url = nullptr;
+  FlValue* height = nullptr;
+  if (args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
+    url = fl_value_lookup_string(args, "url");
+    height = fl_value_lookup_string(args, "height");
+  }
+  if (url == nullptr || fl_value_get_type(url) != FL_VALUE_TYPE_STRING ||
+      height == nullptr || fl_value_get_type(height) != FL_VALUE_TYPE_INT) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "bad_args", "capture expects {url: String, height: int}", nullptr));
+  }
+
+  if (g_thread_pool_unprocessed(self->pool) >= kMaxQueued) {
+    self->rejected++;
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "busy", "Too many captures queued", nullptr));
+  }
+
+  CaptureJob* job = new CaptureJob{
+      capture_context_ref(self->context),
+      self->next_id++,
+      g_strdup(fl_value_get_string(url)),
+      static_cast<gint>(CLAMP(fl_value_get_int(height), 16, kMaxHeight)),
+  };
+  gint64 id = job->id;
+  g_autoptr(GError) error = nullptr;
+  if (!g_thread_pool_push(self->pool, job, &error)) {
+    capture_context_unref(job->context);
+    g_free(job->url);
+    delete job;
+    return FL_METHOD_RESPONSE(
+        fl_method_error_response_new("capture_failed", error->message, nullptr));
+  }
+
+  g_autoptr(FlValue) ticket = fl_value_new_map();
+  fl_value_set_string_take(ticket, "id", fl_value_new_int(id));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(ticket));
+#else
+  return FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+#endif
+}
+
+static FlValue* stream_snapshot_get_stats(StreamSnapshot* self) {
+  CaptureContext* context = self->context;
+  guint64 captured = context->captured.load(std::memory_order_relaxed);
+  guint64 failed = context->failed.load(std::memory_order_relaxed);
+  gint64 total_us = context->total_capture_us.load(std::memory_order_relaxed);
+
+  FlValue* stats = fl_value_new_map();
+  fl_value_set_string_take(stats, "captured", fl_value_new_int(captured));
+  fl_value_set_string_take(stats, "failed", fl_value_new_int(failed));
+  fl_value_set_string_take(stats, "rejected", fl_value_new_int(self->rejected));
+  fl_value_set_string_take(
+      stats, "dropped",
+      fl_value_new_int(context->dropped.load(std::memory_order_relaxed)));
+  fl_value_set_string_take(
+      stats, "queued",
+      fl_value_new_int(self->pool != nullptr
+                           ? g_thread_pool_unprocessed(self->pool)
+                           : 0));
+  fl_value_set_string_take(
+      stats, "meanCaptureUs",
+      fl_value_new_int(captured + failed > 0
+                           ? total_us / static_cast<gint64>(captured + failed)
+                           : 0));
+  return stats;
+}
+
+// Handles "capture" and "getStats".
+static void method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
+                           gpointer user_data) {
+  StreamSnapshot* self = STREAM_SNAPSHOT(user_data);
+  const gchar* method = fl_method_call_get_name(method_call);
+
+  g_autoptr(FlMethodResponse) response = nullptr;
+  if (g_strcmp0(method, "capture") == 0) {
+    response = stream_snapshot_capture(self, method_call);
+  } else if (g_strcmp0(method, "getStats") == 0) {
+    g_autoptr(FlValue) stats = stream_snapshot_get_stats(self);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(stats));
+  } else {
+    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(method_call, response, &error)) {
+    g_warning("StreamSnapshot: failed to respond to %s: %s", method,
+              error->message);
+  }
+}
+
+static void stream_snapshot_dispose(GObject* object) {
+  StreamSnapshot* self = STREAM_SNAPSHOT(object);
+
+  // Cancelling skips the queued captures and stops the running ones at
+  // their next poll. They hold the context, so nothing here waits for them;
+  // the pool's threads exit once they are done.
+  if (self->context != nullptr) {
+    g_cancellable_cancel(self->context->cancellable);
+  }
+  if (self->pool != nullptr) {
+    g_thread_pool_free(self->pool, FALSE, FALSE);
+    self->pool = nullptr;
+  }
+  g_clear_pointer(&self->context, capture_context_unref);
+  g_clear_object(&self->channel);
+
+  G_OBJECT_CLASS(stream_snapshot_parent_class)->dispose(object);
+}
+
+static void stream_snapshot_class_init(StreamSnapshotClass* klass) {
+  G_OBJECT_CLASS(klass)->dispose = stream_snapshot_dispose;
+}
+
+static void stream_snapshot_init(StreamSnapshot* self) {}
+
+StreamSnapshot* stream_snapshot_new(FlBinaryMessenger* messenger,
+                                    NativeBridge* results, guint max_workers) {
+  StreamSnapshot* self =
+      STREAM_SNAPSHOT(g_object_new(stream_snapshot_get_type(), nullptr));
+  self->context = capture_context_new(results);
+
+#ifdef HAVE_GSTREAMER
+  g_autoptr(GError) error = nullptr;
+  if (gst_init_check(nullptr, nullptr, &error)) {
+    self->pool = g_thread_pool_new(capture_job_run, nullptr, MAX(max_workers, 1u),
+                                   FALSE, nullptr);
+  } else {
+    g_warning("StreamSnapshot: GStreamer unavailable: %s", error->message);
+  }
+#endif
+
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  self->channel =
+      fl_method_channel_new(messenger, kChannelName, FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(self->channel, method_call_cb, self,
+                                            nullptr);
+  return self;
+}
@@ -0,0 +1,41 @@
+#ifndef FLUTTER_STREAM_SNAPSHOT_H_
+#define FLUTTER_STREAM_SNAPSHOT_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+#include "native_bridge.h"
+
+G_DECLARE_FINAL_TYPE(StreamSnapshot, stream_snapshot, STREAM, SNAPSHOT, GObject)
+
+/**
+ * StreamSnapshot:
+ *
+ * Captures still frames from live HLS segments for the stream tiles.
+ *
+ * Dart calls `capture` on the `modern_dashboard/stream_snapshot` method
+ * channel with `{"url": <segment url>, "height": <tile height in pixels>}`
+ * and is answered at once with `{"id": <capture id>}`. A worker thread
+ * fetches the segment, decodes its first frame (HLS segments start on a
+ * keyframe), scales it to the requested height and posts
+ * `{"source": "stream_snapshot", "id": <capture id>, "frame": <JPEG bytes>}`
+ * to the results bridge, with a %NULL frame when none could be decoded or
+ * an `"error"` message instead when the capture failed. Captures beyond the
+ * worker count wait in a short queue; when that is full the call fails with
+ * a `busy` error so Dart retries on its next refresh.
+ *
+ * Decoding needs GStreamer; runners built without it answer
+ * not-implemented and Dart falls back to its placeholders.
+ */
+
+/**
+ * stream_snapshot_new:
+ * @messenger: an #FlBinaryMessenger.
+ * @results: bridge the captured frames are posted to.
+ * @max_workers: maximum number of concurrent captures.
+ *
+ * Returns: a new #StreamSnapshot.
+ */
+StreamSnapshot* stream_snapshot_new(FlBinaryMessenger* messenger,
+                                    NativeBridge* results, guint max_workers);
+
+#endif  // FLUTTER_STREAM_SNAPSHOT_H_
@@ -0,0 +1,345 @@
+// Tests for AsyncIo (runner/async_io.cc) on each backend, against files in a
+// temporary directory. Backends the kernel refuses are skipped. Built with
+// -DMODERN_DASHBOARD_TESTS=ON; run with ctest.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <glib/gstdio.h>
+#include <unistd.h>
+
+#include "runner/async_io.h"
+
+namespace {
+
+const gint64 kTimeoutUs = 5 * G_USEC_PER_SEC;
+
+struct Fixture {
+  gchar* directory;
+  AsyncIo* io;
+  GPtrArray* calls;
+  guint completions;
+};
+
+// One request's completion.
+struct Call {
+  Fixture* fixture;
+  gboolean done;
+  gssize result;
+  GBytes* data;  // what a read returned
+  guint order;   // position among all completions, from 1
+};
+
+void call_free(gpointer data) {
+  Call* call = static_cast<Call*>(data);
+  if (call->data != nullptr) g_bytes_unref(call->data);
+  g_free(call);
+}
+
+void call_cb(gssize result, const guint8* data, gpointer user_data) {
+  Call* call = static_cast<Call*>(user_data);
+  g_assert_false(call->done);
+  call->done = TRUE;
+  call->result = result;
+  call->order = ++call->fixture->completions;
+  if (data != nullptr && result > 0) call->data = g_bytes_new(data, result);
+}
+
+Call* new_call(Fixture* fixture) {
+  Call* call = g_new0(Call, 1);
+  call->fixture = fixture;
+  g_ptr_array_add(fixture->calls, call);
+  return call;
+}
+
+// Runs the main loop until |call| completes or kTimeoutUs passes.
+gssize wait_for(Call* call) {
+  gint64 deadline = g_get_monotonic_time() + kTimeoutUs;
+  while (!call->done) {
+    g_assert_cmpint(g_get_monotonic_time(), <, deadline);
+    g_main_context_iteration(nullptr, FALSE);
+    g_usleep(100);
+  }
+  return call->result;
+}
+
+// |data| is the backend name.
+void fixture_set_up(Fixture* fixture, gconstpointer data) {
+  const gchar* backend = static_cast<const gchar*>(data);
+  g_autoptr(GError) error = nullptr;
+  fixture->directory = g_dir_make_tmp("async_io_test_XXXXXX", &error);
+  g_assert_no_error(error);
+  fixture->calls = g_ptr_array_new_with_free_func(call_free);
+
+  g_setenv("MODERN_DASHBOARD_ASYNC_IO", backend, TRUE);
+  fixture->io = async_io_new(8, 4);
+  if (g_strcmp0(async_io_get_backend(fixture->io), backend) != 0) {
+    g_autofree gchar* message = g_strdup_printf("%s is not available", backend);
+    g_test_skip(message);
+    g_clear_object(&fixture->io);
+  }
+}
+
+void fixture_tear_down(Fixture* fixture, gconstpointer) {
+  g_clear_object(&fixture->io);
+  g_ptr_array_unref(fixture->calls);
+  g_autoptr(GDir) dir = g_dir_open(fixture->directory, 0, nullptr);
+  const gchar* name;
+  while (dir != nullptr && (name = g_dir_read_name(dir)) != nullptr) {
+    g_autofree gchar* path =
+        g_build_filename(fixture->directory, name, nullptr);
+    g_remove(path);
+  }
+  g_rmdir(fixture->directory);
+  g_free(fixture->directory);
+}
+
+gchar* test_path(Fixture* fixture, const gchar* name) {
+  return g_build_filename(fixture->directory, name, nullptr);
+}
+
+GBytes* make_record(gsize size, guint8 seed) {
+  guint8* data = static_cast<guint8*>(g_malloc(size));
+  for (gsize i = 0; i < size; i++) data[i] = static_cast<guint8>(seed + i);
+  return g_bytes_new_take(data, size);
+}
+
+int open_file(Fixture* fixture, const gchar* name, int flags) {
+  g_autofree gchar* path = test_path(fixture, name);
+  Call* opened = new_call(fixture);
+  async_io_open(fixture->io, path, flags, 0600, call_cb, opened);
+  int fd = wait_for(opened);
+  g_assert_cmpint(fd, >=, 0);
+  return fd;
+}
+
+// Records that fit a registered buffer and records that don't read back
+// as written.
+void test_round_trip(Fixture* fixture, gconstpointer) {
+  if (fixture->io == nullptr) return;
+  int fd = open_file(fixture, "records", O_RDWR | O_CREAT | O_TRUNC);
+
+  const gsize sizes[] = {100, 16 * 1024, 64 * 1024 + 3};
+  goffset offsets[G_N_ELEMENTS(sizes)];
+  g_autoptr(GPtrArray) records = g_ptr_array_new_with_free_func(
+      reinterpret_cast<GDestroyNotify>(g_bytes_unref));
+  goffset offset = 0;
+  for (guint i = 0; i < G_N_ELEMENTS(sizes); i++) {
+    GBytes* record = make_record(sizes[i], i * 31);
+    g_ptr_array_add(records, record);
+    offsets[i] = offset;
+    offset += sizes[i];
+    async_io_write(fixture->io, fd, record, offsets[i], call_cb,
+                   new_call(fixture));
+  }
+  Call* fsync = new_call(fixture);
+  async_io_fsync(fixture->io, fd, call_cb, fsync);
+  g_assert_cmpint(wait_for(fsync), ==, 0);
+  for (guint i = 0; i < G_N_ELEMENTS(sizes); i++) {
+    Call* writing =
+        static_cast<Call*>(g_ptr_array_index(fixture->calls, i + 1));
+    g_assert_true(writing->done);
+    g_assert_cmpint(writing->result, ==, sizes[i]);
+  }
+
+  for (guint i = 0; i < G_N_ELEMENTS(sizes); i++) {
+    Call* reading = new_call(fixture);
+    async_io_read(fixture->io, fd, sizes[i], offsets[i], call_cb, reading);
+    g_assert_cmpint(wait_for(reading), ==, sizes[i]);
+    g_assert_true(g_bytes_equal(reading->data,
+                                g_ptr_array_index(records, i)));
+  }
+
+  // Past the end of the file a read is short.
+  Call* tail = new_call(fixture);
+  async_io_read(fixture->io, fd, 200, offset - 50, call_cb, tail);
+  g_assert_cmpint(wait_for(tail), ==, 50);
+
+  Call* closing = new_call(fixture);
+  async_io_close(fixture->io, fd, call_cb, closing);
+  g_assert_cmpint(wait_for(closing), ==, 0);
+}
+
+// Failures come back as negative errnos.
+void test_errors(Fixture* fixture, gconstpointer) {
+  if (fixture->io == nullptr) return;
+  g_autofree gchar* missing = test_path(fixture, "missing");
+  g_autofree gchar* other = test_path(fixture, "other");
+
+  Call* opened = new_call(fixture);
+  async_io_open(fixture->io, missing, O_RDONLY, 0, call_cb, opened);
+  Call* removal = new_call(fixture);
+  async_io_unlink(fixture->io, missing, call_cb, removal);
+  Call* renaming = new_call(fixture);
+  async_io_rename(fixture->io, missing, other, call_cb, renaming);
+  g_assert_cmpint(wait_for(opened), ==, -ENOENT);
+  g_assert_cmpint(wait_for(removal), ==, -ENOENT);
+  g_assert_cmpint(wait_for(renaming), ==, -ENOENT);
+
+  int fd = open_file(fixture, "write-only", O_WRONLY | O_CREAT);
+  Call* reading = new_call(fixture);
+  async_io_read(fixture->io, fd, 16, 0, call_cb, reading);
+  g_assert_cmpint(wait_for(reading), ==, -EBADF);
+  g_assert_null(reading->data);
+  close(fd);
+}
+
+// fsync requests made while writes are in flight share one fsync, which
+// waits for those writes.
+void test_fsync_coalescing(Fixture* fixture, gconstpointer) {
+  if (fixture->io == nullptr) return;
+  int fd = open_file(fixture, "log", O_WRONLY | O_CREAT | O_TRUNC);
+  AsyncIoStats before;
+  async_io_get_stats(fixture->io, &before);
+
+  const guint kWrites = 16;
+  const guint kFsyncs = 4;
+  g_autoptr(GBytes) record = make_record(512, 7);
+  Call* writes[kWrites];
+  Call* fsyncs[kFsyncs];
+  guint queued_fsyncs = 0;
+  for (guint i = 0; i < kWrites; i++) {
+    writes[i] = new_call(fixture);
+    async_io_write(fixture->io, fd, record, i * 512, call_cb, writes[i]);
+    // Interleaved, so each fsync is queued behind a different set of writes.
+    if ((i + 1) % (kWrites / kFsyncs) == 0) {
+      Call* fsync = fsyncs[queued_fsyncs++] = new_call(fixture);
+      async_io_fsync(fixture->io, fd, call_cb, fsync);
+    }
+  }
+  for (Call* fsync : fsyncs) g_assert_cmpint(wait_for(fsync), ==, 0);
+
+  guint last_write = 0;
+  for (Call* writing : writes) {
+    g_assert_true(writing->done);
+    g_assert_cmpint(writing->result, ==, 512);
+    last_write = MAX(last_write, writing->order);
+  }
+  for (Call* fsync : fsyncs) g_assert_cmpuint(fsync->order, >, last_write);
+
+  AsyncIoStats after;
+  async_io_get_stats(fixture->io, &after);
+  g_assert_cmpuint(after.fsync_requests - before.fsync_requests, ==, kFsyncs);
+  g_assert_cmpuint(after.fsyncs - before.fsyncs, ==, 1);
+  if (g_strcmp0(async_io_get_backend(fixture->io), "threads") == 0) {
+    g_assert_cmpuint(after.ring_submits, ==, 0);
+  }
+  close(fd);
+}
+
+// A close waits for the requests queued before it on the descriptor.
+void test_close_order(Fixture* fixture, gconstpointer) {
+  if (fixture->io == nullptr) return;
+  int fd = open_file(fixture, "closed", O_RDWR | O_CREAT | O_TRUNC);
+  g_autoptr(GBytes) record = make_record(4096, 1);
+  Call* writing = new_call(fixture);
+  async_io_write(fixture->io, fd, record, 0, call_cb, writing);
+  Call* reading = new_call(fixture);
+  async_io_read(fixture->io, fd, 4096, 0, call_cb, reading);
+  Call* closing = new_call(fixture);
+  async_io_close(fixture->io, fd, call_cb, closing);
+
+  g_assert_cmpint(wait_for(closing), ==, 0);
+  g_assert_true(writing->done);
+  g_assert_true(reading->done);
+  g_assert_cmpuint(writing->order, <, closing->order);
+  g_assert_cmpuint(reading->order, <, closing->order);
+  g_assert_cmpint(fcntl(fd, F_GETFD), ==, -1);
+}
+
+// Renames replace the target; unlinks delete.
+void test_rename_unlink(Fixture* fixture, gconstpointer) {
+  if (fixture->io == nullptr) return;
+  g_autofree gchar* from = test_path(fixture, "from");
+  g_autofree gchar* to = test_path(fixture, "to");
+  g_assert_true(g_file_set_contents(from, "new", -1, nullptr));
+  g_assert_true(g_file_set_contents(to, "old", -1, nullptr));
+
+  Call* renaming = new_call(fixture);
+  async_io_rename(fixture->io, from, to, call_cb, renaming);
+  g_assert_cmpint(wait_for(renaming), ==, 0);
+  g_assert_false(g_file_test(from, G_FILE_TEST_EXISTS));
+  g_autofree gchar* contents = nullptr;
+  g_assert_true(g_file_get_contents(to, &contents, nullptr, nullptr));
+  g_assert_cmpstr(contents, ==, "new");
+
+  Call* removal = new_call(fixture);
+  async_io_unlink(fixture->io, to, call_cb, removal);
+  g_assert_cmpint(wait_for(removal), ==, 0);
+  g_assert_false(g_file_test(to, G_FILE_TEST_EXISTS));
+}
+
+struct Work {
+  GThread* caller;
+  GThread* worker;
+};
+
+gssize work_func(gpointer data) {
+  static_cast<Work*>(data)->worker = g_thread_self();
+  return 42;
+}
+
+// async_io_call() runs the work off the main thread and reports back on it.
+void test_call(Fixture* fixture, gconstpointer) {
+  if (fixture->io == nullptr) return;
+  Work work = {g_thread_self(), nullptr};
+  Call* call = new_call(fixture);
+  async_io_call(fixture->io, work_func, &work, call_cb, call);
+  g_assert_false(call->done);
+  g_assert_cmpint(wait_for(call), ==, 42);
+  g_assert_nonnull(work.worker);
+  g_assert_true(work.worker != work.caller);
+}
+
+// Dropping the last reference completes everything still queued.
+void test_dispose_drains(Fixture* fixture, gconstpointer) {
+  if (fixture->io == nullptr) return;
+  int fd = open_file(fixture, "drained", O_WRONLY | O_CREAT | O_TRUNC);
+  g_autoptr(GBytes) record = make_record(1000, 3);
+  const guint kWrites = 20;
+  for (guint i = 0; i < kWrites; i++) {
+    async_io_write(fixture->io, fd, record, i * 1000, call_cb,
+                   new_call(fixture));
+  }
+  Call* fsync = new_call(fixture);
+  async_io_fsync(fixture->io, fd, call_cb, fsync);
+  g_clear_object(&fixture->io);
+
+  for (guint i = 1; i < fixture->calls->len; i++) {
+    Call* call = static_cast<Call*>(g_ptr_array_index(fixture->calls, i));
+    g_assert_true(call->done);
+    g_assert_cmpint(call->result, >=, 0);
+  }
+  GStatBuf info;
+  g_autofree gchar* path = test_path(fixture, "drained");
+  g_assert_cmpint(g_stat(path, &info), ==, 0);
+  g_assert_cmpint(info.st_size, ==, kWrites * 1000);
+  close(fd);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  g_test_init(&argc, &argv, nullptr);
+  struct {
+    const gchar* name;
+    void (*func)(Fixture*, gconstpointer);
+  } tests[] = {
+      {"round-trip", test_round_trip},
+      {"errors", test_errors},
+      {"fsync-coalescing", test_fsync_coalescing},
+      {"close-order", test_close_order},
+      {"rename-unlink", test_rename_unlink},
+      {"call", test_call},
+      {"dispose-drains", test_dispose_drains},
+  };
+  const gchar* backends[] = {"io_uring", "threads"};
+  for (const gchar* backend : backends) {
+    for (const auto& test : tests) {
+      g_autofree gchar* path =
+          g_strdup_printf("/async-io/%s/%s", backend, test.name);
+      g_test_add(path, Fixture, backend, fixture_set_up, test.func,
+                 fixture_tear_down);
+    }
+  }
+  return g_test_run();
+}
@@ -0,0 +1,230 @@
+// Tests for ConfigWatcher (runner/config_watcher.cc) against a temporary
+// config directory. Built with -DMODERN_DASHBOARD_TESTS=ON; run with ctest.
+
+#include <glib/gstdio.h>
+
+#include "runner/config_watcher.h"
+
+namespace {
+
+const gint64 kTimeoutUs = 2 * G_USEC_PER_SEC;
+
+// Long enough for a debounced reload to have happened if one was coming.
+const gint64 kSettleUs = 200 * 1000;
+
+struct Fixture {
+  gchar* directory;
+};
+
+void fixture_set_up(Fixture* fixture, gconstpointer) {
+  g_autoptr(GError) error = nullptr;
+  fixture->directory = g_dir_make_tmp("config_watcher_test_XXXXXX", &error);
+  g_assert_no_error(error);
+  g_setenv("MODERN_DASHBOARD_CONFIG_DIR", fixture->directory, TRUE);
+}
+
+void fixture_tear_down(Fixture* fixture, gconstpointer) {
+  g_autoptr(GDir) dir = g_dir_open(fixture->directory, 0, nullptr);
+  const gchar* name;
+  while (dir != nullptr && (name = g_dir_read_name(dir)) != nullptr) {
+    g_autofree gchar* path =
+        g_build_filename(fixture->directory, name, nullptr);
+    g_remove(path);
+  }
+  g_rmdir(fixture->directory);
+  g_free(fixture->directory);
+}
+
+// Writes |contents| to |name| in the config directory by renaming a
+// temporary file over it, as editors do.
+void write_config(Fixture* fixture, const gchar* name, const gchar* contents) {
+  g_autofree gchar* path = g_build_filename(fixture->directory, name, nullptr);
+  g_autoptr(GError) error = nullptr;
+  g_assert_true(g_file_set_contents(path, contents, -1, &error));
+  g_assert_no_error(error);
+}
+
+// Runs the main loop until |done| holds or kTimeoutUs passes.
+template <typename Predicate>
+gboolean run_until(Predicate done) {
+  gint64 deadline = g_get_monotonic_time() + kTimeoutUs;
+  while (!done()) {
+    if (g_get_monotonic_time() > deadline) return FALSE;
+    g_main_context_iteration(nullptr, FALSE);
+    g_usleep(1000);
+  }
+  return TRUE;
+}
+
+void run_for(gint64 duration_us) {
+  gint64 end = g_get_monotonic_time() + duration_us;
+  while (g_get_monotonic_time() < end) {
+    g_main_context_iteration(nullptr, FALSE);
+    g_usleep(1000);
+  }
+}
+
+FlValue* section(ConfigWatcher* watcher, const gchar* name) {
+  return fl_value_lookup_string(config_watcher_get_config(watcher), name);
+}
+
+gint64 refresh_option(ConfigWatcher* watcher, const gchar* name) {
+  FlValue* value = fl_value_lookup_string(section(watcher, "refresh"), name);
+  g_assert_nonnull(value);
+  return fl_value_get_int(value);
+}
+
+// Every schema section is read, with feed defaults filled in.
+void test_initial_config(Fixture* fixture, gconstpointer) {
+  write_config(fixture, "dashboard.conf",
+               "[layout]\n"
+               "widgets=weather; news ;video\n"
+               "\n"
+               "[refresh]\n"
+               "dashboard=120\n"
+               "weather_calls_per_hour=30\n"
+               "\n"
+               "[feed bbc]\n"
+               "url=https://feeds.bbci.co.uk/news/rss.xml\n"
+               "active=false\n");
+  g_autoptr(ConfigWatcher) watcher = config_watcher_new();
+
+  g_assert_null(config_watcher_get_error(watcher));
+  g_assert_cmpuint(config_watcher_get_generation(watcher), ==, 1);
+
+  FlValue* widgets = fl_value_lookup_string(section(watcher, "layout"),
+                                            "widgets");
+  g_assert_nonnull(widgets);
+  g_assert_cmpuint(fl_value_get_length(widgets), ==, 3);
+  g_assert_cmpstr(fl_value_get_string(fl_value_get_list_value(widgets, 1)),
+                  ==, "news");
+
+  g_assert_cmpint(refresh_option(watcher, "dashboardSeconds"), ==, 120);
+  g_assert_cmpint(refresh_option(watcher, "weatherMaxCallsPerHour"), ==, 30);
+  g_assert_null(fl_value_lookup_string(section(watcher, "refresh"),
+                                       "weatherCurrentSeconds"));
+
+  FlValue* feed = fl_value_lookup_string(section(watcher, "feeds"), "bbc");
+  g_assert_nonnull(feed);
+  g_assert_cmpstr(fl_value_get_string(fl_value_lookup_string(feed, "name")),
+                  ==, "bbc");
+  g_assert_cmpstr(
+      fl_value_get_string(fl_value_lookup_string(feed, "category")), ==,
+      "General");
+  g_assert_false(fl_value_get_bool(fl_value_lookup_string(feed, "active")));
+}
+
+// Later files override earlier ones; hidden and other files are ignored.
+void test_file_order(Fixture* fixture, gconstpointer) {
+  write_config(fixture, "10-base.conf",
+               "[refresh]\ndashboard=60\nweather_current=600\n");
+  write_config(fixture, "20-site.conf", "[refresh]\ndashboard=300\n");
+  write_config(fixture, ".20-site.conf.swp", "[refresh]\ndashboard=30\n");
+  write_config(fixture, "notes.txt", "not a key file");
+  g_autoptr(ConfigWatcher) watcher = config_watcher_new();
+
+  g_assert_null(config_watcher_get_error(watcher));
+  g_assert_cmpint(refresh_option(watcher, "dashboardSeconds"), ==, 300);
+  g_assert_cmpint(refresh_option(watcher, "weatherCurrentSeconds"), ==, 600);
+}
+
+// Each of these rejects the whole config.
+void test_invalid_configs(Fixture* fixture, gconstpointer) {
+  const gchar* invalid[] = {
+      "[refresh]\ndashboard=5\n",
+      "[refresh]\ndashboard=soon\n",
+      "[refresh]\nsometimes=60\n",
+      "[layout]\nwidgets=news;clock\n",
+      "[layout]\nwidgets=news;news\n",
+      "[layout]\nwidgets=\n",
+      "[feed local]\nurl=file:///etc/passwd\n",
+      "[feed local]\nurl=https://example.com/rss\ncolour=red\n",
+      "[feed local]\nurl=https://example.com/rss\nactive=maybe\n",
+      "[refresh\ndashboard=60\n",
+  };
+  for (const gchar* contents : invalid) {
+    write_config(fixture, "dashboard.conf", contents);
+    g_test_expect_message(nullptr, G_LOG_LEVEL_WARNING,
+                          "ConfigWatcher: keeping the previous config*");
+    g_autoptr(ConfigWatcher) watcher = config_watcher_new();
+    g_test_assert_expected_messages();
+
+    g_assert_nonnull(config_watcher_get_error(watcher));
+    g_assert_cmpuint(config_watcher_get_generation(watcher), ==, 0);
+    g_assert_cmpuint(fl_value_get_length(section(watcher, "refresh")), ==, 0);
+  }
+}
+
+// Edits apply while running; a broken edit keeps the previous config
+// until it is fixed, and an edit that changes nothing is no generation.
+void test_reload(Fixture* fixture, gconstpointer) {
+  g_autoptr(ConfigWatcher) watcher = config_watcher_new();
+  g_assert_cmpuint(config_watcher_get_generation(watcher), ==, 0);
+
+  write_config(fixture, "dashboard.conf", "[refresh]\ndashboard=120\n");
+  g_assert_true(run_until(
+      [&] { return config_watcher_get_generation(watcher) == 1; }));
+  g_assert_cmpint(refresh_option(watcher, "dashboardSeconds"), ==, 120);
+
+  g_test_expect_message(nullptr, G_LOG_LEVEL_WARNING,
+                        "ConfigWatcher: keeping the previous config*");
+  write_config(fixture, "dashboard.conf", "[refresh]\ndashboard=\n");
+  g_assert_true(
+      run_until([&] { return config_watcher_get_error(watcher) != nullptr; }));
+  g_test_assert_expected_messages();
+  g_assert_cmpuint(config_watcher_get_generation(watcher), ==, 1);
+  g_assert_cmpint(refresh_option(watcher, "dashboardSeconds"), ==, 120);
+
+  write_config(fixture, "dashboard.conf", "[refresh]\ndashboard=240\n");
+  g_assert_true(run_until(
+      [&] { return config_watcher_get_generation(watcher) == 2; }));
+  g_assert_null(config_watcher_get_error(watcher));
+  g_assert_cmpint(refresh_option(watcher, "dashboardSeconds"), ==, 240);
+
+  write_config(fixture, "dashboard.conf",
+               "# touched\n[refresh]\ndashboard=240\n");
+  run_for(kSettleUs);
+  g_assert_cmpuint(config_watcher_get_generation(watcher), ==, 2);
+
+  // Removing the file drops its options.
+  g_autofree gchar* path =
+      g_build_filename(fixture->directory, "dashboard.conf", nullptr);
+  g_assert_cmpint(g_remove(path), ==, 0);
+  g_assert_true(run_until(
+      [&] { return config_watcher_get_generation(watcher) == 3; }));
+  g_assert_cmpuint(fl_value_get_length(section(watcher, "refresh")), ==, 0);
+}
+
+// Writes in quick succession are applied as one generation.
+void test_burst(Fixture* fixture, gconstpointer) {
+  g_autoptr(ConfigWatcher) watcher = config_watcher_new();
+  write_config(fixture, "10-layout.conf", "[layout]\nwidgets=news\n");
+  write_config(fixture, "20-refresh.conf", "[refresh]\ndashboard=90\n");
+  write_config(fixture, "30-feed.conf",
+               "[feed local]\nurl=http://localhost:8080/rss\n");
+
+  g_assert_true(run_until(
+      [&] { return config_watcher_get_generation(watcher) >= 1; }));
+  run_for(kSettleUs);
+  g_assert_cmpuint(config_watcher_get_generation(watcher), ==, 1);
+  g_assert_cmpint(refresh_option(watcher, "dashboardSeconds"), ==, 90);
+  g_assert_nonnull(
+      fl_value_lookup_string(section(watcher, "feeds"), "local"));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  g_test_init(&argc, &argv, nullptr);
+  g_test_add("/config-watcher/initial-config", Fixture, nullptr,
+             fixture_set_up, test_initial_config, fixture_tear_down);
+  g_test_add("/config-watcher/file-order", Fixture, nullptr, fixture_set_up,
+             test_file_order, fixture_tear_down);
+  g_test_add("/config-watcher/invalid-configs", Fixture, nullptr,
+             fixture_set_up, test_invalid_configs, fixture_tear_down);
+  g_test_add("/config-watcher/reload", Fixture, nullptr, fixture_set_up,
+             test_reload, fixture_tear_down);
+  g_test_add("/config-watcher/burst", Fixture, nullptr, fixture_set_up,
+             test_burst, fixture_tear_down);
+  return g_test_run();
+}
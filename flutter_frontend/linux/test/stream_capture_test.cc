@@ -0,0 +1,105 @@
+// Tests for stream_capture_frame() against the HLS fixture in
+// test/fixtures/hls. Built with -DMODERN_DASHBOARD_TESTS=ON when GStreamer
+// is found; run with ctest.
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <gio/gio.h>
+#include <gst/gst.h>
+
+#include "runner/stream_capture.h"
+
+namespace {
+
+const gint64 kTimeoutUs = 8 * G_USEC_PER_SEC;
+
+gchar* fixture_uri(const gchar* name) {
+  g_autofree gchar* path =
+      g_build_filename(FIXTURES_DIR, "hls", name, nullptr);
+  return g_filename_to_uri(path, nullptr, nullptr);
+}
+
+GdkPixbuf* decode_jpeg(GBytes* jpeg) {
+  g_autoptr(GInputStream) stream = g_memory_input_stream_new_from_bytes(jpeg);
+  return gdk_pixbuf_new_from_stream(stream, nullptr, nullptr);
+}
+
+// The first frame comes back at the requested height with the segment's
+// 16:9 aspect ratio.
+void test_first_frame() {
+  g_autofree gchar* uri = fixture_uri("360p_1.ts");
+  g_autoptr(GError) error = nullptr;
+  g_autoptr(GBytes) jpeg =
+      stream_capture_frame(uri, 90, kTimeoutUs, nullptr, &error);
+  g_assert_no_error(error);
+  g_assert_nonnull(jpeg);
+
+  g_autoptr(GdkPixbuf) pixbuf = decode_jpeg(jpeg);
+  g_assert_nonnull(pixbuf);
+  g_assert_cmpint(gdk_pixbuf_get_height(pixbuf), ==, 90);
+  g_assert_cmpint(gdk_pixbuf_get_width(pixbuf), ==, 160);
+}
+
+void test_missing_segment() {
+  g_autofree gchar* uri = fixture_uri("missing.ts");
+  g_autoptr(GError) error = nullptr;
+  g_autoptr(GBytes) jpeg =
+      stream_capture_frame(uri, 90, kTimeoutUs, nullptr, &error);
+  g_assert_null(jpeg);
+  g_assert_nonnull(error);
+  g_assert_false(g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED));
+}
+
+gpointer cancel_later(gpointer user_data) {
+  g_usleep(200 * 1000);
+  g_cancellable_cancel(G_CANCELLABLE(user_data));
+  return nullptr;
+}
+
+// A server that accepts the connection but never answers stalls the
+// capture until its timeout; cancelling ends it within a poll interval.
+// This is what lets StreamSnapshot's dispose return without waiting.
+void test_cancel_stalled_fetch() {
+  g_autoptr(GError) error = nullptr;
+  g_autoptr(GSocket) listener = g_socket_new(
+      G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_STREAM, G_SOCKET_PROTOCOL_TCP, &error);
+  g_assert_no_error(error);
+  g_autoptr(GInetAddress) loopback =
+      g_inet_address_new_loopback(G_SOCKET_FAMILY_IPV4);
+  g_autoptr(GSocketAddress) any = g_inet_socket_address_new(loopback, 0);
+  g_assert_true(g_socket_bind(listener, any, TRUE, &error));
+  // Connections complete in the backlog; nothing ever accepts them.
+  g_assert_true(g_socket_listen(listener, &error));
+  g_autoptr(GSocketAddress) bound = g_socket_get_local_address(listener, &error);
+  g_assert_no_error(error);
+  g_autofree gchar* uri = g_strdup_printf(
+      "http://127.0.0.1:%u/live/segment.ts",
+      g_inet_socket_address_get_port(G_INET_SOCKET_ADDRESS(bound)));
+
+  g_autoptr(GCancellable) cancellable = g_cancellable_new();
+  GThread* canceller = g_thread_new("cancel", cancel_later, cancellable);
+  gint64 start = g_get_monotonic_time();
+  g_autoptr(GBytes) jpeg =
+      stream_capture_frame(uri, 90, kTimeoutUs, cancellable, &error);
+  gint64 elapsed = g_get_monotonic_time() - start;
+  g_thread_join(canceller);
+
+  g_assert_null(jpeg);
+  if (g_error_matches(error, GST_CORE_ERROR, GST_CORE_ERROR_MISSING_PLUGIN)) {
+    g_test_skip("no GStreamer source for http:// URIs");
+    return;
+  }
+  g_assert_error(error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_assert_cmpint(elapsed, <, G_USEC_PER_SEC);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  gst_init(&argc, &argv);
+  g_test_init(&argc, &argv, nullptr);
+  g_test_add_func("/stream-capture/first-frame", test_first_frame);
+  g_test_add_func("/stream-capture/missing-segment", test_missing_segment);
+  g_test_add_func("/stream-capture/cancel-stalled-fetch",
+                  test_cancel_stalled_fetch);
+  return g_test_run();
+}
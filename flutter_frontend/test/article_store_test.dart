@@ -0,0 +1,147 @@
+import 'dart:convert';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+import 'package:modern_dashboard/core/utils/deflate_dictionary.dart';
+import 'package:modern_dashboard/models/rss_feed.dart';
+import 'package:modern_dashboard/services/article_store.dart';
+
+final DateTime _published = DateTime.fromMillisecondsSinceEpoch(1700000000000);
+
+List<NewsArticle> _articles(String feedId, int count, {int from = 0}) => [
+      for (var i = from; i < from + count; i++)
+        NewsArticle(
+          id: '$feedId-article-$i',
+          title: 'Council approves new budget for the harbour district, part $i',
+          description: 'The city council voted on Tuesday to approve the budget. '
+              'Residents of the harbour district will see changes to parking, '
+              'public transport and waste collection over the coming year ($i).',
+          url: 'https://news.example.com/$feedId/2024/01/council-budget-$i',
+          imageUrl: i.isEven ? 'https://img.example.com/$feedId/$i.jpg' : null,
+          publishedAt: _published.add(Duration(minutes: i)),
+          feedId: feedId,
+          feedName: 'Example News',
+        ),
+    ];
+
+/// What the store writes per article, before deflate
+List<Uint8List> _payloads(List<NewsArticle> articles) => [
+      for (final article in articles)
+        utf8.encode([
+          article.title,
+          article.description,
+          article.url,
+          article.imageUrl ?? '',
+          article.feedName,
+        ].join('\u001f')),
+    ];
+
+Uint8List _deflate(List<int> raw, Uint8List? dictionary) =>
+    Uint8List.fromList(ZLibEncoder(raw: true, dictionary: dictionary).convert(raw));
+
+List<int> _inflate(List<int> stored, Uint8List? dictionary) =>
+    ZLibDecoder(raw: true, dictionary: dictionary).convert(stored);
+
+void main() {
+  group('trainDeflateDictionary', () {
+    test('shrinks single records and inflates back exactly', () {
+      final samples = _payloads(_articles('training', 100));
+      final dictionary = trainDeflateDictionary(samples, size: 4096);
+      expect(dictionary, isNotEmpty);
+      expect(dictionary.length, lessThanOrEqualTo(4096));
+
+      // Records the dictionary was not trained on
+      final unseen = _payloads(_articles('unseen', 20, from: 500));
+      var raw = 0;
+      var plain = 0;
+      var withDictionary = 0;
+      for (final record in unseen) {
+        final stored = _deflate(record, dictionary);
+        expect(_inflate(stored, dictionary), record);
+        raw += record.length;
+        plain += _deflate(record, null).length;
+        withDictionary += stored.length;
+      }
+      debugPrint('trainDeflateDictionary: ${unseen.length} records of $raw B, '
+          '$plain B plain, $withDictionary B with a ${dictionary.length} B dictionary');
+      expect(withDictionary, lessThan(plain));
+    });
+
+    test('returns nothing without enough samples', () {
+      final samples = _payloads(_articles('few', 2));
+      expect(trainDeflateDictionary(samples), isEmpty);
+      expect(trainDeflateDictionary([Uint8List(4), Uint8List(4), Uint8List(4)]), isEmpty);
+    });
+  });
+
+  group('ArticleStore', () {
+    late Directory directory;
+
+    setUp(() async => directory = await Directory.systemTemp.createTemp('article_store_test'));
+    tearDown(() => directory.delete(recursive: true));
+
+    Future<ArticleStore> open() async {
+      final store = ArticleStore.at(directory.path);
+      await store.initialize();
+      return store;
+    }
+
+    List<Map<String, dynamic>> maps(List<NewsArticle>? articles) =>
+        [for (final article in articles ?? const <NewsArticle>[]) article.toMap()];
+
+    List<Map<String, dynamic>> newestFirst(List<NewsArticle> articles) =>
+        maps(articles.reversed.toList());
+
+    test('reads stored articles back, newest first, across a reopen', () async {
+      final news = _articles('news', 30);
+      final sport = _articles('sport', 5);
+      final store = await open();
+      expect(store.hasArticles('news'), isFalse);
+      expect(await store.articlesOf('news'), isNull);
+
+      store
+        ..putFeed('news', news)
+        ..putFeed('sport', sport)
+        // Already stored: not written again
+        ..putFeed('news', news.sublist(0, 10));
+      expect(store.hasArticles('news'), isTrue);
+      expect(maps(await store.articlesOf('news')), newestFirst(news));
+
+      final reopened = await open();
+      expect(reopened.hasArticles('sport'), isTrue);
+      expect(maps(await reopened.articlesOf('news')), newestFirst(news));
+      expect(maps(await reopened.articlesOf('sport')), newestFirst(sport));
+    });
+
+    // Under the size that starts a dictionary retrain on the idle scheduler
+    test('keeps removals across a reopen', () async {
+      final news = _articles('news', 20);
+      final store = await open();
+      store
+        ..putFeed('news', news)
+        ..putFeed('gone', _articles('gone', 3))
+        ..removeFeed('gone');
+      expect(store.hasArticles('gone'), isFalse);
+      expect(await store.articlesOf('gone'), isNull);
+
+      final reopened = await open();
+      expect(reopened.hasArticles('gone'), isFalse);
+      expect(maps(await reopened.articlesOf('news')), newestFirst(news));
+    });
+
+    test('ignores a torn write at the end of the log', () async {
+      final news = _articles('news', 4);
+      (await open()).putFeed('news', news);
+      final log = File('${directory.path}/articles.log');
+      await log.writeAsBytes([1, 0, 0, 0, 200, 0], mode: FileMode.append);
+
+      final reopened = await open();
+      expect(maps(await reopened.articlesOf('news')), newestFirst(news));
+      reopened.putFeed('news', _articles('news', 1, from: 4));
+      expect(await reopened.articlesOf('news'), hasLength(5));
+    });
+  });
+}
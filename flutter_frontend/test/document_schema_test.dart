@@ -0,0 +1,135 @@
+import 'package:cloud_firestore/cloud_firestore.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+import 'package:modern_dashboard/core/utils/document_schema.dart';
+import 'package:modern_dashboard/models/weather.dart';
+import 'package:modern_dashboard/repositories/news_repository.dart';
+import 'package:modern_dashboard/repositories/todo_repository.dart';
+
+final DateTime _updated = DateTime.utc(2024, 1, 15, 10, 30);
+
+typedef _Note = ({String title, List<String> tags, int count});
+
+/// A schema with short caps and a field the builder can not do without
+DocumentSchema<_Note> _noteSchema() => DocumentSchema<_Note>(
+      'Note',
+      const [
+        FieldSpec('title', FieldKind.string, fallback: '', maxLength: 5),
+        FieldSpec('tags', FieldKind.stringList, maxLength: 3),
+        FieldSpec('count', FieldKind.integer),
+      ],
+      (f) => (title: f.string(0), tags: f.strings(1), count: f.integer(2)),
+    );
+
+void main() {
+  group('DocumentSchema', () {
+    test('rejects documents without their required fields', () {
+      final schema = TodoItem.schema;
+      final before = schema.stats;
+
+      expect(schema.decode({'title': 'Buy milk'}), isNull);
+      expect(schema.decode({'id': 'a', 'title': null}), isNull);
+      expect(schema.decode({'id': 'a'}, id: 'b'), isNull);
+      // The document ID stands in for a missing id field
+      expect(schema.decode({'title': 'Buy milk'}, id: 'b')?.id, 'b');
+      // Present but of the wrong type: the field falls back, the document stays
+      expect(schema.decode({'id': 'a', 'title': 42})?.title, '');
+
+      final after = schema.stats;
+      expect(after.documents - before.documents, 5);
+      expect(after.rejected - before.rejected, 3);
+      expect(after.typeMismatches - before.typeMismatches, 1);
+    });
+
+    test('fills missing and null fields with their fallbacks', () {
+      final todo = TodoItem.schema.decode({'title': 'Buy milk', 'category': null}, id: 't1')!;
+      expect(todo.id, 't1');
+      expect(todo.description, '');
+      expect(todo.category, 'general');
+      expect(todo.priority, 'medium');
+      expect(todo.status, 'pending');
+      expect(todo.dueDate, isNull);
+      expect(todo.tags, isEmpty);
+      expect(todo.userId, isNull);
+
+      final news = NewsItem.schema.decode({})!;
+      expect(news.id, '');
+      expect(news.category, 'general');
+      expect(news.author, isNull);
+      expect(news.expiresAt, isNull);
+
+      final weather = WeatherData.schema.decode({'location': 'Bern'})!;
+      expect(weather.id, 'unknown');
+      expect(weather.location, 'Bern');
+      expect(weather.temperature, 0.0);
+      expect(weather.humidity, 0);
+      expect(weather.icon, '01d');
+      expect(weather.units, 'metric');
+    });
+
+    test('converts numbers and timestamps, falling back on type mismatches', () {
+      final before = WeatherData.schema.stats;
+      final weather = WeatherData.schema.decode({
+        'latitude': 46,
+        'longitude': 7.4474,
+        'temperature': '21.5',
+        'humidity': 80.6,
+        'wind_direction': true,
+        'timestamp': Timestamp.fromDate(_updated),
+        'unknown_field': {'nested': 1},
+      })!;
+      expect(weather.latitude, 46.0);
+      expect(weather.longitude, 7.4474);
+      expect(weather.temperature, 0.0);
+      expect(weather.humidity, 81);
+      expect(weather.windDirection, 0);
+      expect(weather.timestamp, _updated.toLocal());
+      expect(weather.timestamp.isUtc, isFalse);
+      expect(WeatherData.schema.stats.typeMismatches - before.typeMismatches, 2);
+
+      for (final value in [
+        _updated.millisecondsSinceEpoch,
+        _updated.toIso8601String(),
+        {'seconds': _updated.millisecondsSinceEpoch ~/ 1000, 'nanoseconds': 0},
+      ]) {
+        final todo = TodoItem.schema.decode({'title': 'x', 'updated_at': value}, id: 'a')!;
+        expect(todo.updatedAt, _updated.toLocal(), reason: '$value');
+      }
+      final todo = TodoItem.schema.decode(
+        {'title': 'x', 'due_date': 'tomorrow', 'tags': 'urgent'},
+        id: 'a',
+      )!;
+      expect(todo.dueDate, isNull);
+      expect(todo.tags, isEmpty);
+    });
+
+    test('caps string lengths and list sizes', () {
+      final schema = _noteSchema();
+      final note = schema.decode({
+        'title': 'Groceries',
+        'tags': [for (var i = 0; i < 60; i++) i.isEven ? 'tag$i' : i],
+        'count': 2,
+      })!;
+      expect(note.title, 'Groce');
+      expect(note.count, 2);
+      // 50 items are looked at; the numbers among them are dropped
+      expect(note.tags, hasLength(25));
+      expect(note.tags.every((tag) => tag.length <= 3), isTrue);
+      expect(note.tags.first, 'tag');
+
+      // No count to build the note with
+      expect(schema.decode({'title': 'Todo'}), isNull);
+      expect(schema.stats.rejected, 1);
+    });
+
+    test('decodes a snapshot, skipping invalid documents in place', () {
+      final todos = TodoItem.schema.decodeAll([
+        ('a', {'title': 'First'}),
+        ('b', {'description': 'no title'}),
+        ('c', {'title': 'Third', 'id': 'ignored'}),
+      ], context: 'document_schema_test');
+      expect(todos.map((todo) => todo.id), ['a', 'c']);
+      expect(todos.map((todo) => todo.title), ['First', 'Third']);
+    });
+  });
+}
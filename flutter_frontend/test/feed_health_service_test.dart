@@ -0,0 +1,188 @@
+import 'dart:math';
+
+import 'package:flutter_test/flutter_test.dart';
+import 'package:shared_preferences/shared_preferences.dart';
+
+import 'package:modern_dashboard/services/feed_health_service.dart';
+
+const Duration _fallback = Duration(seconds: 10);
+
+void _succeed(String feedId, {int latencyMs = 200, int bytes = 0, int? newArticles = 1}) {
+  FeedHealthService.instance.recordSuccess(
+    feedId,
+    latency: Duration(milliseconds: latencyMs),
+    bytes: bytes,
+    parseTime: Duration.zero,
+    newArticles: newArticles,
+  );
+}
+
+void _fail(String feedId, {int latencyMs = 200}) {
+  FeedHealthService.instance.recordFailure(feedId, Duration(milliseconds: latencyMs), 'TIMEOUT');
+}
+
+/// How far in the future [feedId]'s quarantine ends
+Duration _quarantineLeft(String feedId) =>
+    FeedHealthService.instance.healthOf(feedId)!.quarantinedUntil!.difference(DateTime.now());
+
+/// Pretend the last fetch of [feedId] happened [ago]
+void _lastAttempt(String feedId, Duration ago) {
+  FeedHealthService.instance.healthOf(feedId)!.lastAttemptAt = DateTime.now().subtract(ago);
+}
+
+void main() {
+  TestWidgetsFlutterBinding.ensureInitialized();
+  SharedPreferences.setMockInitialValues({});
+  final health = FeedHealthService.instance;
+
+  group('FeedHealth', () {
+    test('weighs reliability, tail latency, yield and cost', () {
+      // A new feed: everything perfect but the yield of one article per fetch
+      final yieldOfOne = 100 * 0.15 * (1 - exp(-1));
+      expect(FeedHealth().score, closeTo(85 + yieldOfOne, 1e-9));
+
+      expect(FeedHealth(successRate: 0).score, closeTo(40 + yieldOfOne, 1e-9));
+      expect(FeedHealth(latenciesMs: [10000]).score, closeTo(60 + yieldOfOne, 1e-9));
+      // Half of the latency range, from 1 s to 10 s
+      expect(FeedHealth(latenciesMs: [5500]).score, closeTo(72.5 + yieldOfOne, 1e-9));
+      expect(FeedHealth(freshnessYield: 0).score, closeTo(85, 1e-9));
+      expect(
+        FeedHealth(payloadBytes: 1024 * 1024, parseMs: 500).score,
+        closeTo(70 + yieldOfOne, 1e-9),
+      );
+    });
+
+    test('states follow the score and the quarantine', () {
+      final now = DateTime.now();
+      expect(FeedHealth().state(now), FeedHealthState.healthy);
+      expect(FeedHealth(successRate: 0.2).state(now), FeedHealthState.demoted);
+      expect(
+        FeedHealth(quarantinedUntil: now.add(const Duration(minutes: 1))).state(now),
+        FeedHealthState.quarantined,
+      );
+      expect(
+        FeedHealth(quarantinedUntil: now.subtract(const Duration(minutes: 1))).state(now),
+        FeedHealthState.healthy,
+      );
+    });
+  });
+
+  group('FeedHealthService', () {
+    test('moves the averages a fifth of the way towards each fetch', () {
+      _succeed('ema', bytes: 1000, newArticles: 6);
+      final feed = health.healthOf('ema')!;
+      expect(feed.successRate, 1.0);
+      expect(feed.payloadBytes, closeTo(200, 1e-9));
+      expect(feed.freshnessYield, closeTo(2, 1e-9));
+
+      _fail('ema');
+      expect(feed.successRate, closeTo(0.8, 1e-9));
+      expect(feed.attempts, 2);
+      expect(feed.failures, 1);
+      expect(feed.lastError, 'TIMEOUT');
+
+      // Nothing to compare with leaves the yield alone
+      _succeed('ema', newArticles: null);
+      expect(feed.successRate, closeTo(0.84, 1e-9));
+      expect(feed.freshnessYield, closeTo(2, 1e-9));
+      expect(feed.lastError, isNull);
+      expect(feed.latenciesMs, [200, 200, 200]);
+    });
+
+    test('fetches demoted feeds less often', () {
+      expect(health.isDue('unknown'), isTrue);
+
+      _succeed('healthy');
+      expect(health.healthOf('healthy')!.state(DateTime.now()), FeedHealthState.healthy);
+      expect(health.isDue('healthy'), isTrue);
+
+      // Slow, heavy and with nothing new: 45 + 15 * (1 - e^-0.8), about 53
+      _succeed('demoted', latencyMs: 10000, bytes: 10 << 20, newArticles: 0);
+      final demoted = health.healthOf('demoted')!;
+      expect(
+        demoted.score,
+        inExclusiveRange(FeedHealthService.poorBelow, FeedHealthService.demoteBelow),
+      );
+      expect(health.isDue('demoted'), isFalse);
+      _lastAttempt('demoted', const Duration(minutes: 14));
+      expect(health.isDue('demoted'), isFalse);
+      _lastAttempt('demoted', FeedHealthService.demotedInterval);
+      expect(health.isDue('demoted'), isTrue);
+
+      // One failure more takes it below poorBelow
+      _fail('demoted', latencyMs: 10000);
+      expect(demoted.score, lessThan(FeedHealthService.poorBelow));
+      _lastAttempt('demoted', const Duration(minutes: 59));
+      expect(health.isDue('demoted'), isFalse);
+      _lastAttempt('demoted', FeedHealthService.poorInterval);
+      expect(health.isDue('demoted'), isTrue);
+    });
+
+    test('quarantines after repeated failures, doubling up to the cap', () {
+      for (var i = 0; i < FeedHealthService.quarantineAfter - 1; i++) {
+        _fail('broken');
+      }
+      expect(health.isQuarantined('broken'), isFalse);
+
+      var expected = FeedHealthService.quarantineBase;
+      for (var i = 0; i < 8; i++) {
+        _fail('broken');
+        if (expected > FeedHealthService.quarantineMax) expected = FeedHealthService.quarantineMax;
+        expect(_quarantineLeft('broken').inSeconds, closeTo(expected.inSeconds, 2), reason: '$i');
+        expected *= 2;
+      }
+      expect(_quarantineLeft('broken').inSeconds,
+          closeTo(FeedHealthService.quarantineMax.inSeconds, 2));
+      expect(health.isQuarantined('broken'), isTrue);
+      expect(health.healthOf('broken')!.state(DateTime.now()), FeedHealthState.quarantined);
+      expect(health.isDue('broken'), isFalse);
+    });
+
+    test('probes once a quarantine ends, whatever the score', () {
+      for (var i = 0; i < FeedHealthService.quarantineAfter; i++) {
+        _fail('probe', latencyMs: 10000);
+      }
+      // Demoted, and it was just tried
+      final feed = health.healthOf('probe')!;
+      expect(feed.score, lessThan(FeedHealthService.demoteBelow));
+      expect(health.isDue('probe'), isFalse);
+
+      feed.quarantinedUntil = DateTime.now().subtract(const Duration(seconds: 1));
+      expect(health.isDue('probe'), isTrue);
+
+      // A failed probe doubles the quarantine
+      _fail('probe');
+      expect(_quarantineLeft('probe').inSeconds,
+          closeTo((FeedHealthService.quarantineBase * 2).inSeconds, 2));
+
+      // A good probe ends it
+      feed.quarantinedUntil = DateTime.now().subtract(const Duration(seconds: 1));
+      _succeed('probe');
+      expect(feed.quarantinedUntil, isNull);
+      expect(feed.consecutiveFailures, 0);
+      expect(health.isQuarantined('probe'), isFalse);
+    });
+
+    test('adapts the timeout to tail latency within its bounds', () {
+      expect(health.timeoutFor('unseen', _fallback), _fallback);
+
+      for (var i = 0; i < 4; i++) {
+        _succeed('fast', latencyMs: 300);
+      }
+      // Too few samples to go by
+      expect(health.timeoutFor('fast', _fallback), _fallback);
+      _succeed('fast', latencyMs: 300);
+      expect(health.timeoutFor('fast', _fallback), const Duration(seconds: 4));
+
+      for (var i = 0; i < 5; i++) {
+        _succeed('steady', latencyMs: 2000);
+      }
+      expect(health.timeoutFor('steady', _fallback), const Duration(seconds: 6));
+
+      for (var i = 0; i < 5; i++) {
+        _succeed('slow', latencyMs: 5000);
+      }
+      expect(health.timeoutFor('slow', _fallback), _fallback);
+    });
+  });
+}
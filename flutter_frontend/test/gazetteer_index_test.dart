@@ -0,0 +1,99 @@
+import 'dart:typed_data';
+
+import 'package:flutter_test/flutter_test.dart';
+
+import 'package:modern_dashboard/core/utils/gazetteer_index.dart';
+
+GazetteerIndex _index({bool withBern = true}) {
+  final builder = GazetteerBuilder()
+    ..add(name: 'Berlin', country: 'DE', latitude: 52.52, longitude: 13.405, population: 3600000)
+    ..add(name: 'Bergen', country: 'NO', latitude: 60.3913, longitude: 5.3221, population: 285000)
+    ..add(name: 'London', country: 'GB', latitude: 51.5074, longitude: -0.1278, population: 9500000)
+    ..add(
+        name: 'London',
+        country: 'CA',
+        admin: 'ON',
+        latitude: 42.9849,
+        longitude: -81.2453,
+        population: 420000)
+    ..add(name: 'Paris', country: 'FR', latitude: 48.8566, longitude: 2.3522, population: 11100000)
+    ..add(
+        name: 'Paris',
+        country: 'US',
+        admin: 'TX',
+        latitude: 33.6609,
+        longitude: -95.5555,
+        population: 25000)
+    ..add(
+        name: 'Zürich',
+        country: 'CH',
+        latitude: 47.3769,
+        longitude: 8.5417,
+        population: 1400000,
+        alternateNames: ['Zurigo']);
+  if (withBern) {
+    builder.add(name: 'Bern', country: 'CH', latitude: 46.948, longitude: 7.4474, population: 134000);
+  }
+  return GazetteerIndex(builder.build());
+}
+
+List<String> _names(List<GazetteerPlace> places) =>
+    [for (final place in places) '${place.name}/${place.country}'];
+
+void main() {
+  group('GazetteerIndex', () {
+    test('ranks prefix matches by population', () {
+      final places = _index().search('lon');
+      expect(_names(places), ['London/GB', 'London/CA']);
+      expect(places.every((place) => place.distance == 0), isTrue);
+      expect(places.first.latitude, closeTo(51.5074, 1e-5));
+    });
+
+    test('answers one- and two-letter queries from the shortlist', () {
+      expect(_names(_index().search('p')), ['Paris/FR', 'Paris/US']);
+      expect(_names(_index().search('zu')), ['Zürich/CH']);
+    });
+
+    test('narrows by country code or admin region after a comma', () {
+      expect(_names(_index().search('paris, us')), ['Paris/US']);
+      expect(_names(_index().search('london, on')), ['London/CA']);
+    });
+
+    test('folds case and diacritics and finds alternate names', () {
+      expect(_names(_index().search('ZURICH')), ['Zürich/CH']);
+      expect(_names(_index().search('zurigo')), ['Zürich/CH']);
+    });
+
+    test('ranks an exact name ahead of typo-tolerant guesses', () {
+      final places = _index().search('bern');
+      expect(places.first.name, 'Bern');
+      expect(places.first.distance, 0);
+      final berlin = places.firstWhere((place) => place.name == 'Berlin');
+      expect(berlin.distance, 1);
+    });
+
+    test('marks guesses with their edit distance when nothing matches', () {
+      // What the weather search must not mistake for an answer
+      final places = _index(withBern: false).search('bern');
+      expect(places, isNotEmpty);
+      expect(places.map((place) => place.name), contains('Berlin'));
+      expect(places.every((place) => place.distance > 0), isTrue);
+    });
+
+    test('tolerates one typo or transposition in longer queries', () {
+      expect(_index().search('londn').first.name, 'London');
+      expect(_index().search('lodnon').first.name, 'London');
+      expect(_index().search('londn').first.distance, 1);
+      expect(_index().search('xyzzy'), isEmpty);
+    });
+
+    test('respects the limit', () {
+      expect(_index().search('l', limit: 1), hasLength(1));
+      expect(_index().search('london', limit: 0), isEmpty);
+    });
+
+    test('rejects bytes that are not an index', () {
+      expect(() => GazetteerIndex(Uint8List(64)), throwsFormatException);
+    });
+  });
+}
@@ -0,0 +1,223 @@
+import 'dart:async';
+import 'dart:io';
+
+import 'package:flutter_test/flutter_test.dart';
+import 'package:http/http.dart' as http;
+import 'package:http/testing.dart';
+
+import 'package:modern_dashboard/core/services/http_cache.dart';
+
+final Uri _url = Uri.parse('https://news.example.com/feed.xml');
+
+/// A network that answers with [respond] and counts the requests it saw
+class _Origin {
+  final Future<http.Response> Function(http.Request request) respond;
+  final List<http.Request> requests = [];
+
+  _Origin(this.respond);
+
+  late final HttpCache cache = HttpCache.over(MockClient((request) {
+    requests.add(request);
+    return respond(request);
+  }));
+
+  /// Fetch through the cache and let it finish storing the response
+  Future<http.Response> get([Map<String, String>? headers]) async {
+    final response = await cache.client.get(_url, headers: headers);
+    await Future<void>.delayed(Duration.zero);
+    return response;
+  }
+}
+
+http.Response _response(String body, Map<String, String> headers, {int status = 200}) =>
+    http.Response(body, status, headers: headers);
+
+String? _cacheStatus(http.Response response) => response.headers['x-http-cache'];
+
+/// Seconds from now until [response] stops being fresh
+int _freshFor(Map<String, String> headers) =>
+    HttpCache.freshUntil(_response('', headers)).difference(DateTime.now()).inSeconds;
+
+void main() {
+  group('HttpCache', () {
+    test('computes freshness lifetime and age from the response headers', () {
+      final now = DateTime.now();
+      final date = HttpDate.format(now);
+      expect(_freshFor({'cache-control': 'max-age=60'}), inInclusiveRange(58, 60));
+      // max-age wins over Expires; Age counts against it
+      expect(
+        _freshFor({
+          'cache-control': 'public, max-age=60',
+          'expires': HttpDate.format(now.add(const Duration(hours: 1))),
+          'age': '20',
+        }),
+        inInclusiveRange(38, 40),
+      );
+      expect(
+        _freshFor({'date': date, 'expires': HttpDate.format(now.add(const Duration(minutes: 2)))}),
+        inInclusiveRange(118, 120),
+      );
+      expect(_freshFor({'date': date, 'expires': '0'}), lessThanOrEqualTo(0));
+      // A Date in the past is apparent age
+      expect(
+        _freshFor({
+          'date': HttpDate.format(now.subtract(const Duration(seconds: 30))),
+          'cache-control': 'max-age=60',
+        }),
+        inInclusiveRange(28, 30),
+      );
+      // Heuristic: a tenth of the time since Last-Modified, at most a day
+      expect(
+        _freshFor({
+          'date': date,
+          'last-modified': HttpDate.format(now.subtract(const Duration(hours: 10))),
+        }),
+        inInclusiveRange(3598, 3600),
+      );
+      expect(
+        _freshFor({
+          'date': date,
+          'last-modified': HttpDate.format(now.subtract(const Duration(days: 30))),
+        }),
+        inInclusiveRange(86398, 86400),
+      );
+      expect(_freshFor({'date': date}), lessThanOrEqualTo(0));
+    });
+
+    test('answers from the cache while fresh', () async {
+      final origin = _Origin((_) async => _response('v1', {'cache-control': 'max-age=60'}));
+      expect(_cacheStatus(await origin.get()), 'MISS');
+      final hit = await origin.get();
+      expect(_cacheStatus(hit), 'HIT');
+      expect(hit.body, 'v1');
+      expect(int.parse(hit.headers['age']!), lessThanOrEqualTo(1));
+      expect(origin.requests, hasLength(1));
+
+      expect(_cacheStatus(await origin.get({'cache-control': 'no-cache'})), 'MISS');
+      expect(origin.requests, hasLength(2));
+    });
+
+    test('serves a stored variant only to requests with the same Vary headers', () async {
+      final origin = _Origin((request) async => _response(
+            request.headers['accept-language']!,
+            {'cache-control': 'max-age=60', 'vary': 'Accept-Language'},
+          ));
+      expect((await origin.get({'accept-language': 'en'})).body, 'en');
+      expect(_cacheStatus(await origin.get({'Accept-Language': 'en'})), 'HIT');
+
+      final german = await origin.get({'accept-language': 'de'});
+      expect(_cacheStatus(german), 'MISS');
+      expect(german.body, 'de');
+      // One variant per URL: German replaced English
+      expect(_cacheStatus(await origin.get({'accept-language': 'de'})), 'HIT');
+      expect(_cacheStatus(await origin.get({'accept-language': 'en'})), 'MISS');
+      expect(origin.requests, hasLength(3));
+    });
+
+    test('revalidates a stale entry and freshens it from a 304', () async {
+      final origin = _Origin((request) async {
+        if (request.headers['if-none-match'] == '"v1"') {
+          return _response('', {'cache-control': 'max-age=60', 'x-feed': 'checked'},
+              status: 304);
+        }
+        return _response('v1', {'cache-control': 'max-age=0', 'etag': '"v1"'});
+      });
+      expect(_cacheStatus(await origin.get()), 'MISS');
+
+      final revalidated = await origin.get();
+      expect(_cacheStatus(revalidated), 'REVALIDATED');
+      expect(revalidated.statusCode, 200);
+      expect(revalidated.body, 'v1');
+      expect(revalidated.headers['etag'], '"v1"');
+      expect(revalidated.headers['x-feed'], 'checked');
+      expect(origin.requests.last.headers['if-none-match'], '"v1"');
+
+      // The 304's max-age now applies
+      expect(_cacheStatus(await origin.get()), 'HIT');
+      expect(origin.requests, hasLength(2));
+    });
+
+    test('serves a stale entry on errors within stale-if-error', () async {
+      http.Response? next;
+      var failure = false;
+      var delay = Duration.zero;
+      final origin = _Origin((_) async {
+        await Future<void>.delayed(delay);
+        if (failure) throw const SocketException('Network is unreachable');
+        return next!;
+      });
+      next = _response('v1', {'cache-control': 'max-age=0, stale-if-error=60'});
+      expect(_cacheStatus(await origin.get()), 'MISS');
+
+      next = _response('', {}, status: 503);
+      final onServerError = await origin.get();
+      expect(_cacheStatus(onServerError), 'STALE');
+      expect(onServerError.body, 'v1');
+
+      failure = true;
+      expect((await origin.get()).body, 'v1');
+
+      // Running past the deadline counts as being offline
+      failure = false;
+      delay = const Duration(milliseconds: 500);
+      final timedOut =
+          await origin.get(HttpCache.timeoutHeaders(const Duration(milliseconds: 20)));
+      expect(_cacheStatus(timedOut), 'STALE');
+      expect(origin.requests.last.headers, isNot(contains('x-http-cache-timeout')));
+      delay = Duration.zero;
+
+      // A response that is not stored in its place leaves the entry alone
+      next = _response('slow down', {}, status: 429);
+      expect((await origin.get()).statusCode, 429);
+      failure = true;
+      expect(_cacheStatus(await origin.get()), 'STALE');
+
+      // no-store drops it
+      failure = false;
+      next = _response('gone', {'cache-control': 'no-store'}, status: 429);
+      await origin.get();
+      failure = true;
+      await expectLater(origin.get(), throwsA(isA<SocketException>()));
+    });
+
+    test('fails a request past its deadline when nothing is stored', () async {
+      final origin = _Origin((_) async {
+        await Future<void>.delayed(const Duration(milliseconds: 500));
+        return _response('late', {'cache-control': 'max-age=60'});
+      });
+      await expectLater(
+        origin.get(HttpCache.timeoutHeaders(const Duration(milliseconds: 20))),
+        throwsA(isA<TimeoutException>()),
+      );
+    });
+
+    test('does not serve must-revalidate entries stale', () async {
+      var failure = false;
+      final origin = _Origin((_) async {
+        if (failure) throw http.ClientException('Connection refused');
+        return _response('v1', {'cache-control': 'max-age=0, must-revalidate'});
+      });
+      await origin.get();
+      failure = true;
+      await expectLater(origin.get(), throwsA(isA<http.ClientException>()));
+    });
+
+    test('shares one fetch between concurrent requests for the same resource', () async {
+      final release = Completer<void>();
+      final origin = _Origin((_) async {
+        await release.future;
+        return _response('shared', {'cache-control': 'max-age=60'});
+      });
+      final first = origin.get();
+      // A different deadline still shares the fetch
+      final second = origin.get(HttpCache.timeoutHeaders(const Duration(seconds: 5)));
+      final other = origin.get({'accept': 'application/rss+xml'});
+      await Future<void>.delayed(Duration.zero);
+      release.complete();
+
+      final responses = await Future.wait([first, second, other]);
+      expect(responses.map((response) => response.body), everyElement('shared'));
+      expect(origin.requests, hasLength(2));
+    });
+  });
+}
@@ -0,0 +1,125 @@
+import 'dart:async';
+
+import 'package:flutter_test/flutter_test.dart';
+
+import 'package:modern_dashboard/core/services/idle_scheduler.dart';
+
+Future<void> _wait(int milliseconds) => Future<void>.delayed(Duration(milliseconds: milliseconds));
+
+/// Poll until [condition] holds; the first slice waits for input to settle
+Future<void> _until(bool Function() condition) async {
+  while (!condition()) {
+    await _wait(10);
+  }
+}
+
+void main() {
+  TestWidgetsFlutterBinding.ensureInitialized();
+  final scheduler = IdleScheduler.instance;
+
+  setUpAll(() async {
+    scheduler.initialize();
+    // Let the startup input quiet period pass
+    await _wait(IdleScheduler.inputQuiet.inMilliseconds + 50);
+  });
+
+  group('IdleScheduler', () {
+    test('waits for the UI to go idle', () async {
+      final owner = Object();
+      scheduler.holdBusy(owner);
+      expect(scheduler.isIdle, isFalse);
+
+      final deferralsBefore = scheduler.stats['deferrals'] as int;
+      var ran = false;
+      final done = scheduler.schedule('test.gated', (_) {
+        ran = true;
+        return true;
+      });
+      await _wait(200);
+      expect(ran, isFalse);
+      expect(scheduler.stats['deferrals'], greaterThan(deferralsBefore));
+
+      final released = Stopwatch()..start();
+      scheduler.releaseBusy(owner);
+      await done;
+      expect(ran, isTrue);
+      // Releasing counts as input, which has to settle first
+      expect(released.elapsed, greaterThanOrEqualTo(IdleScheduler.inputQuiet));
+    });
+
+    test('runs a task past its maxDelay even while busy', () async {
+      final owner = Object();
+      scheduler.holdBusy(owner);
+      final forcedBefore = scheduler.stats['forced'] as int;
+
+      final watch = Stopwatch()..start();
+      await scheduler.schedule(
+        'test.forced',
+        (_) => true,
+        maxDelay: const Duration(milliseconds: 150),
+      );
+      expect(watch.elapsed, greaterThanOrEqualTo(const Duration(milliseconds: 150)));
+      expect(scheduler.isIdle, isFalse);
+      expect(scheduler.stats['forced'], forcedBefore + 1);
+      scheduler.releaseBusy(owner);
+    });
+
+    test('runs other work while a step waits, then calls the task again', () async {
+      final io = Completer<bool>();
+      final steps = <String>[];
+      final parked = scheduler.schedule('test.parked', (_) {
+        if (steps.contains('read')) {
+          steps.add('write');
+          return true;
+        }
+        steps.add('read');
+        return io.future;
+      });
+      await _until(() => steps.isNotEmpty);
+      expect(steps, ['read']);
+
+      // The pending step does not hold up other tasks
+      await scheduler.schedule('test.meanwhile', (_) {
+        steps.add('other');
+        return true;
+      });
+      expect(steps, ['read', 'other']);
+
+      // Completing with false asks for another step in a later slice
+      io.complete(false);
+      await parked;
+      expect(steps, ['read', 'other', 'write']);
+    });
+
+    test('runs a key again only after its running task has finished', () async {
+      final first = Completer<bool>();
+      var runs = 0;
+      var overlapping = false;
+      var active = false;
+      FutureOr<bool> save(IdleDeadline _) {
+        if (active) overlapping = true;
+        active = true;
+        runs++;
+        if (runs == 1) return first.future.whenComplete(() => active = false);
+        active = false;
+        return true;
+      }
+
+      final running = scheduler.schedule('test.save', save);
+      await _until(() => runs > 0);
+      expect(runs, 1);
+
+      // Calls while it runs come down to one more run, after it
+      final again = scheduler.schedule('test.save', save);
+      expect(identical(scheduler.schedule('test.save', save), again), isTrue);
+      await _wait(100);
+      expect(runs, 1);
+
+      first.complete(true);
+      await running;
+      await again;
+      expect(runs, 2);
+      expect(overlapping, isFalse);
+    });
+  });
+}
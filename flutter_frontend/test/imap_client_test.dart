@@ -0,0 +1,198 @@
+import 'dart:convert';
+import 'dart:io';
+
+import 'package:flutter_test/flutter_test.dart';
+
+import 'package:modern_dashboard/services/imap_client.dart';
+import 'package:modern_dashboard/services/mail_sync_engine.dart';
+
+/// A scripted IMAP server on loopback. [reply] answers each command line
+/// the client sends, with the tag split off.
+class _StandInServer {
+  final ServerSocket _server;
+  final List<String> received = [];
+  final Future<void> Function(Socket socket, String tag, String command) reply;
+
+  _StandInServer._(this._server, this.reply) {
+    _server.listen(_serve);
+  }
+
+  static Future<_StandInServer> start(
+    Future<void> Function(Socket socket, String tag, String command) reply,
+  ) async {
+    return _StandInServer._(await ServerSocket.bind(InternetAddress.loopbackIPv4, 0), reply);
+  }
+
+  int get port => _server.port;
+
+  Future<void> close() => _server.close();
+
+  Future<void> _serve(Socket socket) async {
+    socket.write('* OK [CAPABILITY IMAP4rev1 IDLE] stand-in ready\r\n');
+    await for (final line in socket.cast<List<int>>().transform(utf8.decoder).transform(const LineSplitter())) {
+      received.add(line);
+      final space = line.indexOf(' ');
+      await reply(socket, line.substring(0, space), line.substring(space + 1));
+    }
+  }
+}
+
+/// Writes [parts] as separate TCP segments, so the client sees the
+/// response in pieces
+Future<void> _writeInPieces(Socket socket, List<String> parts) async {
+  for (final part in parts) {
+    socket.add(utf8.encode(part));
+    await socket.flush();
+    await Future.delayed(const Duration(milliseconds: 20));
+  }
+}
+
+void main() {
+  group('ImapClient against a stand-in server', () {
+    late _StandInServer server;
+    final untagged = <ImapResponse>[];
+
+    Future<ImapClient> connect() =>
+        ImapClient.connect('127.0.0.1', server.port, secure: false, onUntagged: untagged.add);
+
+    setUp(() => untagged.clear());
+    tearDown(() => server.close());
+
+    test('reads the greeting and logs in over loopback with quoted credentials', () async {
+      server = await _StandInServer.start((socket, tag, command) async {
+        socket.write('$tag OK [CAPABILITY IMAP4rev1 QRESYNC ESEARCH] logged in\r\n');
+      });
+      final client = await connect();
+      expect(client.has('IDLE'), isTrue);
+
+      await client.login('me@example.com', r'p"a\ss');
+      expect(server.received.single, r'A1 LOGIN "me@example.com" "p\"a\\ss"');
+      // The completion's response code replaces the greeting's list
+      expect(client.has('QRESYNC'), isTrue);
+      expect(client.has('IDLE'), isFalse);
+      client.destroy();
+    });
+
+    test('frames a literal split across segments, even one that looks like a completion', () async {
+      const body = 'Grüße aus Zürich\r\nA2 OK not the end\r\n';
+      final length = utf8.encode(body).length;
+      server = await _StandInServer.start((socket, tag, command) async {
+        await _writeInPieces(socket, [
+          '* 3 FETCH (UID 42 FLAGS (\\Seen) BODY[TEXT]<0> {',
+          '$length}\r',
+          '\nGrüße aus Zü',
+          'rich\r\nA2 OK not',
+          ' the end\r\n)\r\n$tag OK',
+          ' FETCH completed\r\n',
+        ]);
+      });
+      final client = await connect();
+      final result = await client.command('UID FETCH 42 (UID FLAGS BODY.PEEK[TEXT]<0.256>)');
+
+      expect(result.completion.status, 'OK');
+      expect(result.completion.text, 'FETCH completed');
+      expect(result.untagged, hasLength(1));
+      final fetch = result.untagged.single;
+      expect(fetch.tag, '*');
+      expect(fetch.data.sublist(0, 2), ['3', 'FETCH']);
+      expect(fetch.data[2], [
+        'UID',
+        '42',
+        'FLAGS',
+        ['\\Seen'],
+        'BODY[TEXT]<0>',
+        body,
+      ]);
+      expect(untagged, [fetch]);
+      client.destroy();
+    });
+
+    test('parses NIL, quoted strings and response codes', () async {
+      server = await _StandInServer.start((socket, tag, command) async {
+        socket.write('* 2 FETCH (UID 9 MODSEQ (12) X-NAME "a \\"quoted\\" name" X-EMPTY NIL)\r\n'
+            '* OK [UIDVALIDITY 3857529045] UIDs valid\r\n'
+            '$tag OK [READ-WRITE] SELECT completed\r\n');
+      });
+      final client = await connect();
+      final result = await client.command('SELECT "INBOX"');
+
+      expect(result.untagged.first.data[2], [
+        'UID',
+        '9',
+        'MODSEQ',
+        ['12'],
+        'X-NAME',
+        'a "quoted" name',
+        'X-EMPTY',
+        null,
+      ]);
+      final ok = result.untagged.last;
+      expect(ok.status, 'OK');
+      expect(ok.code, ['UIDVALIDITY', '3857529045']);
+      expect(ok.text, 'UIDs valid');
+      expect(result.completion.code, ['READ-WRITE']);
+      client.destroy();
+    });
+
+    test('fails NO completions and pending commands when the server hangs up', () async {
+      server = await _StandInServer.start((socket, tag, command) async {
+        if (command.startsWith('SELECT')) {
+          socket.write('$tag NO [NONEXISTENT] no such mailbox\r\n');
+        } else {
+          await socket.close();
+        }
+      });
+      final client = await connect();
+
+      await expectLater(client.command('SELECT "Missing"'), throwsA(isA<ImapException>()));
+      await expectLater(client.command('NOOP'), throwsA(isA<ImapException>()));
+      await client.done;
+      expect(client.isClosed, isTrue);
+    });
+  });
+
+  group('Plaintext LOGIN', () {
+    test('is only allowed to this machine', () {
+      expect(ImapClient.allowsPlaintextLogin(InternetAddress.loopbackIPv4), isTrue);
+      expect(ImapClient.allowsPlaintextLogin(InternetAddress.loopbackIPv6), isTrue);
+      expect(ImapClient.allowsPlaintextLogin(InternetAddress('192.0.2.10')), isFalse);
+      expect(ImapClient.allowsPlaintextLogin(InternetAddress('2001:db8::1')), isFalse);
+    });
+  });
+
+  group('MailAccount', () {
+    late Directory directory;
+
+    setUp(() async => directory = await Directory.systemTemp.createTemp('mail_account_test'));
+    tearDown(() => directory.delete(recursive: true));
+
+    Future<File> write(String mode, Map<String, dynamic> json) async {
+      final file = File('${directory.path}/${MailAccount.fileName}');
+      await file.writeAsString(jsonEncode(json));
+      final chmod = await Process.run('chmod', [mode, file.path]);
+      expect(chmod.exitCode, 0);
+      return file;
+    }
+
+    test('reads an owner-only file with defaults', () async {
+      final file = await write('600', {'host': 'imap.example.com', 'user': 'me', 'password': 'secret'});
+      final account = MailAccount.load(file)!;
+      expect(account.host, 'imap.example.com');
+      expect(account.port, 993);
+      expect(account.secure, isTrue);
+      expect(account.password, 'secret');
+      expect(account.mailbox, 'INBOX');
+    });
+
+    test('ignores a file others can read', () async {
+      final file = await write('644', {'host': 'imap.example.com', 'user': 'me', 'password': 'secret'});
+      expect(MailAccount.load(file), isNull);
+    });
+
+    test('ignores a missing file or one without host and user', () async {
+      expect(MailAccount.load(File('${directory.path}/missing.json')), isNull);
+      final file = await write('600', {'host': '', 'user': 'me'});
+      expect(MailAccount.load(file), isNull);
+    });
+  }, skip: Platform.isWindows ? 'POSIX permissions only' : null);
+}
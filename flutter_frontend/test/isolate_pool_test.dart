@@ -0,0 +1,109 @@
+import 'dart:async';
+import 'dart:io';
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:xml/xml.dart';
+
+import 'package:modern_dashboard/core/services/isolate_pool_service.dart';
+
+int _block(int milliseconds) {
+  sleep(Duration(milliseconds: milliseconds));
+  return milliseconds;
+}
+
+int _identity(int value) => value;
+
+int _fail(int value) => throw StateError('task $value failed');
+
+int _countItems(String xml) => XmlDocument.parse(xml).findAllElements('item').length;
+
+String _feed(int items) {
+  final buffer = StringBuffer('<?xml version="1.0"?><rss version="2.0"><channel>'
+      '<title>Example News</title>');
+  for (var i = 0; i < items; i++) {
+    buffer.write('<item><title>Council approves budget, part $i</title>'
+        '<link>https://news.example.com/2024/01/budget-$i</link>'
+        '<description><![CDATA[<p>The city council voted on Tuesday ($i).</p>]]></description>'
+        '<pubDate>Mon, 15 Jan 2024 10:${(i % 60).toString().padLeft(2, '0')}:00 GMT</pubDate>'
+        '</item>');
+  }
+  buffer.write('</channel></rss>');
+  return buffer.toString();
+}
+
+/// Longest time the calling isolate went without running a 1 ms timer
+/// while [work] ran, and the time [work] took
+Future<(Duration, Duration)> _stalls(Future<void> Function() work) async {
+  final watch = Stopwatch()..start();
+  var longest = Duration.zero;
+  var last = Duration.zero;
+  void tick() {
+    final now = watch.elapsed;
+    if (now - last > longest) longest = now - last;
+    last = now;
+  }
+
+  final timer = Timer.periodic(const Duration(milliseconds: 1), (_) => tick());
+  await work();
+  tick();
+  timer.cancel();
+  return (longest, watch.elapsed);
+}
+
+void main() {
+  final pool = IsolatePoolService.instance;
+
+  setUpAll(() => pool.initialize());
+  tearDownAll(() => pool.dispose());
+
+  group('IsolatePoolService', () {
+    test('runs tasks on the workers and returns their results and errors', () async {
+      expect(pool.stats.workers, greaterThan(0));
+      expect(await pool.run(_identity, 7), 7);
+      await expectLater(pool.run(_fail, 3), throwsStateError);
+    });
+
+    test('gives an idle worker the highest-priority task, whatever was queued first', () async {
+      // Every worker is busy; the first frees up after 100 ms, the others later
+      final blockers = [
+        for (var i = 0; i < pool.stats.workers; i++) pool.run(_block, 100 + i * 200),
+      ];
+      final order = <String>[];
+      final low = pool.run(_identity, 1, priority: TaskPriority.low).then((_) => order.add('low'));
+      final normal = pool.run(_identity, 2).then((_) => order.add('normal'));
+      final high =
+          pool.run(_identity, 3, priority: TaskPriority.high).then((_) => order.add('high'));
+      await Future<void>.delayed(Duration.zero);
+      expect(pool.stats.queued, 3);
+
+      await Future.wait([low, normal, high, ...blockers]);
+      expect(order, ['high', 'normal', 'low']);
+      expect(pool.stats.queued, 0);
+    });
+
+    // UI-isolate time per refresh: the longest stall of the calling isolate
+    // while eight feeds are parsed inline, as with ISOLATE_POOL=false, and on
+    // the pool
+    test('keeps feed parsing off the calling isolate', () async {
+      const feeds = 8;
+      final xml = _feed(2000);
+      expect(await pool.run(_countItems, xml), 2000);
+
+      final (inlineStall, inlineTime) = await _stalls(() async {
+        for (var i = 0; i < feeds; i++) {
+          _countItems(xml);
+          // Responses arrive one by one
+          await Future<void>.delayed(Duration.zero);
+        }
+      });
+      final (poolStall, poolTime) = await _stalls(
+        () => Future.wait([for (var i = 0; i < feeds; i++) pool.run(_countItems, xml)]),
+      );
+      debugPrint('IsolatePoolService: $feeds feeds of ${xml.length ~/ 1024} KiB, longest '
+          'stall of the calling isolate ${inlineStall.inMicroseconds / 1000} ms inline '
+          '(${inlineTime.inMilliseconds} ms total), ${poolStall.inMicroseconds / 1000} ms '
+          'with ${pool.stats.workers} workers (${poolTime.inMilliseconds} ms total)');
+    });
+  });
+}
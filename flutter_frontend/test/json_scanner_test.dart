@@ -0,0 +1,120 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+import 'package:flutter_test/flutter_test.dart';
+
+import 'package:modern_dashboard/core/utils/json_scanner.dart';
+
+JsonScanner _scan(String text) => JsonScanner(Uint8List.fromList(utf8.encode(text)));
+
+void main() {
+  group('JsonScanner', () {
+    test('reads numbers exactly like double.parse', () {
+      const numbers = [
+        '0',
+        '-0',
+        '7',
+        '12.5',
+        '-3.25',
+        '0.1',
+        '273.15',
+        '1013.25',
+        '-0.000001',
+        '123456789012345',
+        '1234567890123456789',
+        '0.12345678901234567',
+        '1e3',
+        '1.5E-2',
+        '-2.5e+10',
+      ];
+      final scanner = _scan('[${numbers.join(',')}]');
+      expect(scanner.beginArray(), isTrue);
+      for (final text in numbers) {
+        expect(scanner.nextElement(), isTrue);
+        final value = scanner.number();
+        expect(value, double.parse(text), reason: text);
+        expect(value!.isNegative, double.parse(text).isNegative, reason: 'sign of $text');
+      }
+      expect(scanner.nextElement(), isFalse);
+    });
+
+    test('rounds integers and reads other types as null, consuming them', () {
+      final scanner = _scan('[2.6, -2.5, null, "12", true, {"a": [1, "]"]}, [], 4]');
+      expect(scanner.beginArray(), isTrue);
+      final values = <int?>[];
+      while (scanner.nextElement()) {
+        values.add(scanner.integer());
+      }
+      expect(values, [3, -3, null, null, null, null, null, 4]);
+    });
+
+    test('reads strings with escapes and multi-byte text', () {
+      final scanner = _scan(r'["plain", "a \"quoted\" \\ word", "Zürich", "été", 5]');
+      expect(scanner.beginArray(), isTrue);
+      final values = <String?>[];
+      while (scanner.nextElement()) {
+        values.add(scanner.string());
+      }
+      expect(values, ['plain', r'a "quoted" \ word', 'Zürich', 'été', null]);
+    });
+
+    test('matches keys and skips unknown values of any shape', () {
+      final keys = JsonScanner.keys(['temp', 'name']);
+      final scanner = _scan('{"skip": {"x": "}{", "y": [[], {}]}, "temperature": 1, '
+          '"temp": 21.5, "other": "a\\"}", "name": "Bern", "last": null}');
+      expect(scanner.beginObject(), isTrue);
+      final seen = <String>[];
+      while (true) {
+        final key = scanner.nextKey(keys);
+        if (key == JsonScanner.end) break;
+        switch (key) {
+          case 0:
+            seen.add('temp=${scanner.number()}');
+          case 1:
+            seen.add('name=${scanner.string()}');
+          default:
+            expect(key, JsonScanner.unknown);
+            scanner.skipValue();
+        }
+      }
+      expect(seen, ['temp=21.5', 'name=Bern']);
+    });
+
+    test('skips the rest of a container', () {
+      final scanner = _scan('[[1, [2, "]"], 3], 4]');
+      expect(scanner.beginArray(), isTrue);
+      expect(scanner.nextElement(), isTrue);
+      expect(scanner.beginArray(), isTrue);
+      expect(scanner.nextElement(), isTrue);
+      expect(scanner.integer(), 1);
+      scanner.skipRest();
+      expect(scanner.nextElement(), isTrue);
+      expect(scanner.integer(), 4);
+      expect(scanner.nextElement(), isFalse);
+    });
+
+    test('treats null as an absent object or array', () {
+      final scanner = _scan('[null, null]');
+      expect(scanner.beginArray(), isTrue);
+      expect(scanner.nextElement(), isTrue);
+      expect(scanner.beginObject(), isFalse);
+      expect(scanner.nextElement(), isTrue);
+      expect(scanner.beginArray(), isFalse);
+      expect(scanner.nextElement(), isFalse);
+    });
+
+    test('rejects malformed input', () {
+      final keys = JsonScanner.keys(['a']);
+      expect(() => _scan('{"a": 1}').nextKey(keys), throwsFormatException);
+      expect(() => (_scan('{"a": ')..beginObject()..nextKey(keys)).number(),
+          throwsFormatException);
+      expect(() => (_scan('{"a" 1}')..beginObject()).nextKey(keys), throwsFormatException);
+      expect(() => (_scan('{"a')..beginObject()).nextKey(keys), throwsFormatException);
+      expect(() => (_scan('{1: 2}')..beginObject()).nextKey(keys), throwsFormatException);
+      expect(() => (_scan('[[1, 2]')..beginArray()).skipRest(), throwsFormatException);
+      expect(() => _scan('"text"').beginObject(), throwsFormatException);
+      expect(() => _scan('[-]')..beginArray()..number(), throwsFormatException);
+      expect(() => _scan('   ').beginArray(), throwsFormatException);
+    });
+  });
+}
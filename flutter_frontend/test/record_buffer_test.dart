@@ -0,0 +1,171 @@
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+import 'package:modern_dashboard/core/utils/record_buffer.dart';
+import 'package:modern_dashboard/models/rss_feed.dart';
+import 'package:modern_dashboard/models/weather.dart';
+import 'package:modern_dashboard/repositories/todo_repository.dart';
+
+final DateTime _published = DateTime.fromMillisecondsSinceEpoch(1700000000000);
+
+List<NewsArticle> _articles(int count) => [
+      for (var i = 0; i < count; i++)
+        NewsArticle(
+          id: 'article-$i',
+          title: 'Headline number $i – Zürich',
+          description: 'A paragraph of summary text for article $i. ' * 3,
+          url: 'https://example.com/news/$i',
+          imageUrl: i.isEven ? 'https://example.com/img/$i.jpg' : null,
+          publishedAt: _published.add(Duration(minutes: i)),
+          feedId: 'feed-${i % 7}',
+          feedName: 'Feed ${i % 7}',
+        ),
+    ];
+
+List<TodoItem> _todos(int count) => [
+      for (var i = 0; i < count; i++)
+        TodoItem(
+          id: 'todo-$i',
+          title: 'Task $i',
+          description: i.isEven ? 'Details for task $i' : '',
+          category: 'work',
+          priority: 'high',
+          status: 'pending',
+          createdAt: _published,
+          updatedAt: _published.add(Duration(hours: i)),
+          dueDate: i.isEven ? _published.add(Duration(days: i)) : null,
+          tags: i.isEven ? ['a', 'b c'] : const [],
+          userId: 'user-1',
+        ),
+    ];
+
+List<WeatherData> _weather(int count) => [
+      for (var i = 0; i < count; i++)
+        WeatherData(
+          id: 'station-$i',
+          location: 'Bern',
+          latitude: 46.948,
+          longitude: 7.447,
+          temperature: -3.25 + i,
+          feelsLike: -6.5,
+          humidity: 81,
+          pressure: 1013.2,
+          description: 'light snow',
+          icon: '13d',
+          windSpeed: 4.1,
+          windDirection: 230,
+          cloudiness: 90,
+          visibility: 8000,
+          timestamp: _published,
+          units: 'metric',
+        ),
+    ];
+
+void main() {
+  group('RecordBuffer', () {
+    test('round-trips articles', () {
+      final articles = _articles(20);
+      final buffer = RecordBuffer(RecordBufferWriter.encodeArticles(articles));
+      expect(buffer.type, RecordType.article);
+      expect(buffer.length, articles.length);
+      for (var i = 0; i < articles.length; i++) {
+        final article = buffer.article(i);
+        expect(article.toMap(), articles[i].toMap());
+      }
+      expect(buffer.isNull(1, ArticleField.imageUrl), isTrue);
+    });
+
+    test('round-trips todos, including empty tags and no due date', () {
+      final todos = _todos(6);
+      final buffer = RecordBuffer(RecordBufferWriter.encodeTodos(todos));
+      for (var i = 0; i < todos.length; i++) {
+        final todo = buffer.todo(i);
+        expect(todo.title, todos[i].title);
+        expect(todo.description, todos[i].description);
+        expect(todo.updatedAt, todos[i].updatedAt);
+        expect(todo.dueDate, todos[i].dueDate);
+        expect(todo.tags, todos[i].tags);
+        expect(todo.userId, todos[i].userId);
+      }
+    });
+
+    test('round-trips weather, including negative numbers', () {
+      final observations = _weather(3);
+      final buffer = RecordBuffer(RecordBufferWriter.encodeWeather(observations));
+      for (var i = 0; i < observations.length; i++) {
+        expect(buffer.weather(i).toJson(), observations[i].toJson());
+      }
+    });
+
+    test('keeps 64-bit integers exact up to 2^53', () {
+      final writer = RecordBufferWriter(RecordType.todo)
+        ..beginRecord()
+        ..setInt(TodoField.createdAt, -1)
+        ..beginRecord()
+        ..setInt(TodoField.createdAt, 9007199254740991);
+      final buffer = RecordBuffer(writer.finish());
+      expect(buffer.integer(0, TodoField.createdAt), -1);
+      expect(buffer.integer(1, TodoField.createdAt), 9007199254740991);
+      expect(buffer.integer(0, TodoField.dueDate), isNull);
+    });
+
+    test('rejects foreign bytes and the wrong record type', () {
+      expect(() => RecordBuffer(Uint8List(32)), throwsFormatException);
+      final buffer = RecordBuffer(RecordBufferWriter.encodeArticles(_articles(1)));
+      expect(() => buffer.todo(0), throwsStateError);
+      expect(() => buffer.article(1), throwsRangeError);
+    });
+  });
+
+  // What crossing an isolate or channel costs as one record buffer instead
+  // of a StandardMessageCodec list of maps. Prints the sizes and timings;
+  // only the size, which does not depend on the machine, is asserted.
+  group('RecordBuffer compared with StandardMessageCodec', () {
+    const codec = StandardMessageCodec();
+    const count = 5000;
+    const page = 20;
+
+    void compare<T>(
+      String name,
+      List<T> items,
+      Uint8List Function(List<T>) encode,
+      Map<String, dynamic> Function(T) toMap,
+      T Function(RecordBuffer, int) read,
+    ) {
+      final records = encode(items);
+      final message = codec.encodeMessage(items.map(toMap).toList())!;
+      expect(records.lengthInBytes, lessThan(message.lengthInBytes));
+
+      final stopwatch = Stopwatch()..start();
+      final decoded = codec.decodeMessage(message) as List<Object?>;
+      final codecUs = stopwatch.elapsedMicroseconds;
+
+      stopwatch.reset();
+      final buffer = RecordBuffer(records);
+      final visible = [for (var i = 0; i < page; i++) read(buffer, i)];
+      final recordsUs = stopwatch.elapsedMicroseconds;
+
+      expect(decoded, hasLength(count));
+      expect(visible, hasLength(page));
+      debugPrint('$name x$count: records ${records.lengthInBytes} B, '
+          'codec ${message.lengthInBytes} B; first $page of the records '
+          'in $recordsUs us, codec decode in $codecUs us');
+    }
+
+    test('articles', () {
+      compare<NewsArticle>('articles', _articles(count), RecordBufferWriter.encodeArticles,
+          (a) => a.toMap(), (buffer, i) => buffer.article(i));
+    });
+
+    test('todos', () {
+      compare<TodoItem>('todos', _todos(count), RecordBufferWriter.encodeTodos,
+          (t) => t.toJson(), (buffer, i) => buffer.todo(i));
+    });
+
+    test('weather', () {
+      compare<WeatherData>('weather', _weather(count), RecordBufferWriter.encodeWeather,
+          (w) => w.toJson(), (buffer, i) => buffer.weather(i));
+    });
+  });
+}
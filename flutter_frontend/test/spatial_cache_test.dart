@@ -0,0 +1,151 @@
+import 'dart:async';
+
+import 'package:flutter_test/flutter_test.dart';
+
+import 'package:modern_dashboard/core/utils/spatial_cache.dart';
+
+// Bern, and points about 1 km and 3 km east of it
+const double _lat = 46.948;
+const double _lon = 7.4474;
+const double _lon1km = 7.4605;
+const double _lon3km = 7.4868;
+
+void main() {
+  group('Geohash', () {
+    test('encodes known coordinates', () {
+      expect(Geohash.encode(57.64911, 10.40744, precision: 11), 'u4pruydqqvj');
+      expect(Geohash.encode(0, 0, precision: 5), 's0000');
+      expect(Geohash.encode(-90, -180, precision: 3), '000');
+      expect(Geohash.encode(_lat, _lon), startsWith('u0m'));
+    });
+
+    test('reports cell sizes and covers the neighbours', () {
+      final (lat, lon) = Geohash.cellSize(5);
+      expect(lat, closeTo(0.0439, 1e-4));
+      expect(lon, closeTo(0.0439, 1e-4));
+
+      final cells = Geohash.neighbourhood(_lat, _lon, precision: 5);
+      expect(cells, hasLength(9));
+      expect(cells, contains(Geohash.encode(_lat, _lon, precision: 5)));
+      expect(cells, contains(Geohash.encode(_lat + lat, _lon - lon, precision: 5)));
+    });
+
+    test('wraps neighbours across the antimeridian', () {
+      final cells = Geohash.neighbourhood(0.01, 179.99, precision: 5);
+      expect(cells, contains(Geohash.encode(0.01, -179.97, precision: 5)));
+    });
+
+    test('measures great-circle distances', () {
+      expect(Geohash.distanceMeters(0, 0, 0, 1), closeTo(111195, 1));
+      expect(Geohash.distanceMeters(48.8566, 2.3522, 51.5074, -0.1278), closeTo(343500, 3500));
+      expect(Geohash.distanceMeters(_lat, _lon, _lat, _lon1km), closeTo(1000, 50));
+      expect(Geohash.distanceMeters(_lat, _lon, _lat, _lon3km), closeTo(3000, 100));
+    });
+  });
+
+  group('SpatialCache', () {
+    test('serves exact and nearby hits within the tolerance', () {
+      final cache = SpatialCache<String>()..put(_lat, _lon, 'bern');
+      expect(cache.lookup(_lat, _lon), 'bern');
+      expect(cache.lookup(_lat, _lon1km), 'bern');
+      expect(cache.lookup(_lat, _lon3km), isNull);
+
+      final stats = cache.stats;
+      expect(stats.hits, 2);
+      expect(stats.nearbyHits, 1);
+      expect(stats.misses, 1);
+      expect(stats.hitRate, closeTo(2 / 3, 1e-9));
+    });
+
+    test('prefers the closest entry and keeps one per coordinate', () {
+      final cache = SpatialCache<String>()
+        ..put(_lat, _lon, 'old')
+        ..put(_lat, _lon, 'centre')
+        ..put(_lat, _lon1km, 'east');
+      expect(cache.stats.entries, 2);
+      expect(cache.lookup(_lat, _lon + 0.001), 'centre');
+      expect(cache.lookup(_lat, _lon1km - 0.001), 'east');
+    });
+
+    test('keeps partitions apart', () {
+      final cache = SpatialCache<String>()..put(_lat, _lon, 'metric', partition: 'metric');
+      expect(cache.lookup(_lat, _lon, partition: 'imperial'), isNull);
+      expect(cache.lookup(_lat, _lon, partition: 'metric'), 'metric');
+    });
+
+    test('expires entries but can still serve them stale', () async {
+      final cache = SpatialCache<String>(maxAge: const Duration(milliseconds: 1))
+        ..put(_lat, _lon, 'bern');
+      await Future.delayed(const Duration(milliseconds: 10));
+      expect(cache.lookup(_lat, _lon), isNull);
+      expect(cache.lookup(_lat, _lon, maxAge: const Duration(hours: 1)), 'bern');
+      expect(cache.lookupStale(_lat, _lon1km), 'bern');
+      expect(cache.lookupStale(_lat, _lon3km), isNull);
+    });
+
+    test('evicts the oldest entry beyond maxEntries', () {
+      final cache = SpatialCache<int>(maxEntries: 2)
+        ..put(10, 10, 1)
+        ..put(20, 20, 2)
+        ..put(30, 30, 3);
+      expect(cache.stats.entries, 2);
+      expect(cache.lookup(10, 10), isNull);
+      expect(cache.lookup(20, 20), 2);
+      expect(cache.lookup(30, 30), 3);
+
+      cache.clear();
+      expect(cache.stats.entries, 0);
+      expect(cache.lookup(30, 30), isNull);
+    });
+
+    test('merges concurrent fetches for nearby coordinates', () async {
+      final cache = SpatialCache<String>();
+      final completer = Completer<String>();
+      var fetches = 0;
+      Future<String> fetch() {
+        fetches++;
+        return completer.future;
+      }
+
+      final first = cache.getOrFetch(_lat, _lon, fetch);
+      final second = cache.getOrFetch(_lat, _lon1km, fetch);
+      final far = cache.getOrFetch(_lat, _lon3km, () async => 'far');
+      expect(fetches, 1);
+
+      completer.complete('bern');
+      expect(await first, 'bern');
+      expect(await second, 'bern');
+      expect(await far, 'far');
+      expect(await cache.getOrFetch(_lat, _lon, fetch), 'bern');
+      expect(fetches, 1);
+
+      final stats = cache.stats;
+      expect(stats.coalesced, 1);
+      expect(stats.misses, 2);
+      expect(stats.hits, 1);
+    });
+
+    test('caches under the coordinate the result reports', () async {
+      final cache = SpatialCache<(double, double)>();
+      final value = await cache.getOrFetch(
+        _lat,
+        _lon3km,
+        () async => (_lat, _lon),
+        resultLatitude: (value) => value.$1,
+        resultLongitude: (value) => value.$2,
+      );
+      expect(cache.lookup(_lat, _lon1km), value);
+      expect(cache.lookup(_lat, _lon3km), isNull);
+    });
+
+    test('does not cache a failed fetch', () async {
+      final cache = SpatialCache<String>();
+      await expectLater(
+        cache.getOrFetch(_lat, _lon, () async => throw Exception('offline')),
+        throwsException,
+      );
+      expect(cache.stats.entries, 0);
+      expect(await cache.getOrFetch(_lat, _lon, () async => 'bern'), 'bern');
+    });
+  });
+}
@@ -0,0 +1,116 @@
+import 'dart:io';
+
+import 'package:flutter_test/flutter_test.dart';
+
+import 'package:modern_dashboard/core/utils/stream_manifest.dart';
+
+final Uri _base = Uri.parse('https://cdn.example.com/live/master.m3u8');
+
+StreamManifest _fixture(String name, [Uri? base]) => StreamManifest.parse(
+      File('test/fixtures/hls/$name').readAsStringSync(),
+      base ?? _base.resolve(name),
+    );
+
+const String _mpd = '''<?xml version="1.0" encoding="UTF-8"?>
+<MPD xmlns="urn:mpeg:dash:schema:mpd:2011" type="static" mediaPresentationDuration="PT1M30.5S">
+  <Period>
+    <AdaptationSet mimeType="video/mp4" codecs="avc1.64001f" frameRate="30000/1001">
+      <SegmentTemplate timescale="1000" duration="4000" startNumber="5"/>
+      <Representation id="v360" bandwidth="800000" width="640" height="360"/>
+      <Representation id="v720" bandwidth="2500000" width="1280" height="720">
+      </Representation>
+    </AdaptationSet>
+    <AdaptationSet mimeType="audio/mp4" codecs="mp4a.40.2">
+      <Representation id="a" bandwidth="128000"/>
+    </AdaptationSet>
+    <AdaptationSet mimeType="application/ttml+xml">
+      <Representation id="subs" bandwidth="1000"/>
+    </AdaptationSet>
+  </Period>
+</MPD>''';
+
+void main() {
+  group('StreamManifest', () {
+    test('reads the variants of an HLS master playlist', () {
+      final manifest = _fixture('master.m3u8', _base);
+      expect(manifest.kind, ManifestKind.hlsMaster);
+      expect(manifest.variants.map((v) => v.label), ['180p', '360p']);
+      final variant = manifest.variants.last;
+      expect(variant.uri, Uri.parse('https://cdn.example.com/live/360p.m3u8'));
+      expect(variant.bandwidth, 160000);
+      expect(variant.width, 640);
+      expect(variant.codecs, 'avc1.64001e');
+    });
+
+    test('reads the segments of a live HLS media playlist', () {
+      final manifest = _fixture('360p.m3u8');
+      expect(manifest.kind, ManifestKind.hlsMedia);
+      expect(manifest.isLive, isTrue);
+      expect(manifest.duration, isNull);
+      expect(manifest.targetDuration, 1);
+      expect(manifest.reloadInterval, const Duration(seconds: 1));
+      expect(manifest.segments.map((s) => s.uri!.pathSegments.last), ['360p_0.ts', '360p_1.ts']);
+      expect(manifest.segments.map((s) => s.start), [0, 1]);
+    });
+
+    test('treats an ended playlist as VOD with a duration', () {
+      final text = '${File('test/fixtures/hls/180p.m3u8').readAsStringSync()}#EXT-X-ENDLIST\n';
+      final manifest = StreamManifest.parse(text, _base);
+      expect(manifest.isLive, isFalse);
+      expect(manifest.duration, const Duration(seconds: 2));
+    });
+
+    test('reads DASH representations, skipping text tracks', () {
+      final base = Uri.parse('https://cdn.example.com/vod/stream.mpd');
+      final manifest = StreamManifest.parse(_mpd, base);
+      expect(manifest.kind, ManifestKind.dash);
+      expect(manifest.isLive, isFalse);
+      expect(manifest.duration, const Duration(minutes: 1, seconds: 30, milliseconds: 500));
+      expect(manifest.targetDuration, 4);
+      expect(manifest.mediaSequence, 5);
+      expect(manifest.variants.map((v) => v.label), ['360p', '720p', '128 kbps']);
+      expect(manifest.variants.first.uri, base.replace(fragment: 'v360'));
+      expect(manifest.variants.first.frameRate, closeTo(29.97, 0.01));
+      expect(manifest.variants.last.isAudioOnly, isTrue);
+    });
+
+    test('rejects text that is not a manifest', () {
+      expect(StreamManifest.isManifest('<html></html>'), isFalse);
+      expect(() => StreamManifest.parse('<html></html>', _base), throwsFormatException);
+    });
+  });
+
+  group('VariantSelector', () {
+    final variants = _fixture('master.m3u8', _base).variants;
+
+    String? pick(double tile, double bandwidth, {int streams = 1, int? maxHeight}) =>
+        VariantSelector.select(
+          variants,
+          tileHeightPixels: tile,
+          bandwidthBps: bandwidth,
+          concurrentStreams: streams,
+          maxHeight: maxHeight,
+        )?.label;
+
+    test('picks the smallest variant that covers the tile', () {
+      expect(pick(100, 1e6), '180p');
+      expect(pick(300, 1e6), '360p');
+      expect(pick(1080, 1e6), '360p');
+    });
+
+    test('falls back to what the shared bandwidth affords', () {
+      expect(pick(300, 150000), '180p');
+      expect(pick(300, 400000, streams: 2), '360p');
+      expect(pick(300, 400000, streams: 3), '180p');
+      expect(pick(300, 1000), '180p');
+    });
+
+    test('honours a fixed quality and an empty list', () {
+      expect(pick(1080, 1e6, maxHeight: 180), '180p');
+      expect(
+        VariantSelector.select(const [], tileHeightPixels: 300, bandwidthBps: 1e6),
+        isNull,
+      );
+    });
+  });
+}
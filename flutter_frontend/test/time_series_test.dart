@@ -0,0 +1,154 @@
+import 'dart:math';
+import 'dart:typed_data';
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+import 'package:modern_dashboard/core/utils/time_series.dart';
+
+// Local time, as the series decodes to
+final DateTime _start = DateTime.utc(2024, 1, 15, 6).toLocal();
+
+DateTime _at(int seconds) => _start.add(Duration(seconds: seconds));
+
+/// Every sample of [column], decoded
+List<TimeSeriesPoint> _all(GorillaSeries series, int column) =>
+    series.range(column, DateTime.utc(1970), DateTime.utc(2100));
+
+void main() {
+  group('GorillaSeries', () {
+    test('round-trips regular samples of slowly changing readings', () {
+      final random = Random(7);
+      final series = GorillaSeries(2);
+      final temperatures = <double>[];
+      final pressures = <double>[];
+      var temperature = 4.0;
+      for (var i = 0; i < 500; i++) {
+        temperature += (random.nextInt(5) - 2) * 0.25;
+        temperatures.add(temperature);
+        pressures.add(1013.0 + (i ~/ 50));
+        expect(series.append(_at(i * 600), [temperature, pressures.last]), isTrue);
+      }
+
+      expect(series.length, 500);
+      final decoded = _all(series, 0);
+      expect(decoded.map((p) => p.value), temperatures);
+      expect(decoded.map((p) => p.time), [for (var i = 0; i < 500; i++) _at(i * 600)]);
+      expect(_all(series, 1).map((p) => p.value), pressures);
+
+      // Raw doubles and 32-bit timestamps would take 20 bytes a sample
+      final raw = 500 * (4 + 2 * 8);
+      debugPrint('GorillaSeries: 500 samples x2 columns in ${series.sizeInBytes} B, raw $raw B');
+      expect(series.sizeInBytes, lessThan(raw ~/ 4));
+    });
+
+    test('keeps the exact bits of unusual values', () {
+      final values = [
+        0.0,
+        -0.0,
+        double.infinity,
+        double.negativeInfinity,
+        double.minPositive,
+        double.maxFinite,
+        -273.15,
+        1e-300,
+        123456789.123456789,
+        double.nan,
+        42.0,
+        42.0,
+      ];
+      final series = GorillaSeries(1);
+      for (var i = 0; i < values.length; i++) {
+        series.append(_at(i), [values[i]]);
+      }
+      final decoded = _all(series, 0).map((p) => p.value).toList();
+      expect(decoded, hasLength(values.length));
+      for (var i = 0; i < values.length; i++) {
+        if (values[i].isNaN) {
+          expect(decoded[i].isNaN, isTrue);
+        } else {
+          expect(decoded[i], values[i]);
+          expect(decoded[i].isNegative, values[i].isNegative, reason: 'sign of ${values[i]}');
+        }
+      }
+    });
+
+    test('encodes every delta-of-delta range, including negative ones', () {
+      // Deltas chosen so consecutive differences hit 0, the 7-, 9-, 12- and
+      // 32-bit buckets and their negative counterparts
+      const deltas = [600, 600, 601, 700, 2700, 102700, 1, 64, 2000, 600, 600];
+      final times = <int>[0];
+      for (final delta in deltas) {
+        times.add(times.last + delta);
+      }
+      final series = GorillaSeries(1);
+      for (var i = 0; i < times.length; i++) {
+        series.append(_at(times[i]), [i.toDouble()]);
+      }
+      expect(_all(series, 0).map((p) => p.time), [for (final t in times) _at(t)]);
+    });
+
+    test('ignores samples that are not at least a second newer', () {
+      final series = GorillaSeries(1);
+      expect(series.append(_at(60), [1]), isTrue);
+      expect(series.append(_at(60), [2]), isFalse);
+      expect(series.append(_at(60).add(const Duration(milliseconds: 900)), [3]), isFalse);
+      expect(series.append(_at(59), [4]), isFalse);
+      expect(series.append(_at(61), [5]), isTrue);
+      expect(_all(series, 0).map((p) => p.value), [1, 5]);
+      expect(series.lastTime, _at(61));
+    });
+
+    test('answers ranges across blocks and drops whole blocks', () {
+      final series = GorillaSeries(1, blockSize: 4);
+      for (var i = 0; i < 10; i++) {
+        series.append(_at(i * 60), [i.toDouble()]);
+      }
+      expect(series.range(0, _at(150), _at(420)).map((p) => p.value), [3, 4, 5, 6, 7]);
+      expect(series.range(0, _at(-60), _at(-1)), isEmpty);
+
+      // The first block ends at 180 s; the second block straddles 300 s and
+      // is kept whole
+      series.dropBefore(_at(300));
+      expect(_all(series, 0).map((p) => p.value), [4, 5, 6, 7, 8, 9]);
+    });
+
+    test('survives a byte round trip, open block included, and keeps growing', () {
+      final series = GorillaSeries(3, blockSize: 8);
+      for (var i = 0; i < 20; i++) {
+        series.append(_at(i * 300), [i * 0.5, -i.toDouble(), 1000.0 - i]);
+      }
+      final restored = GorillaSeries.fromBytes(series.toBytes(), blockSize: 8);
+      expect(restored.columnCount, 3);
+      expect(restored.length, 20);
+      for (var c = 0; c < 3; c++) {
+        expect(_all(restored, c).map((p) => p.value), _all(series, c).map((p) => p.value));
+      }
+
+      expect(restored.append(_at(19 * 300), [0, 0, 0]), isFalse);
+      expect(restored.append(_at(20 * 300), [10, -20, 980]), isTrue);
+      expect(_all(restored, 1).last.value, -20);
+      expect(_all(restored, 1).last.time, _at(6000));
+    });
+
+    test('rejects foreign bytes', () {
+      expect(() => GorillaSeries.fromBytes(Uint8List(16)), throwsFormatException);
+    });
+  });
+
+  group('downsampleLttb', () {
+    test('keeps the first and last points and the threshold count', () {
+      final points = [
+        for (var i = 0; i < 200; i++) TimeSeriesPoint(_at(i * 60), sin(i / 10)),
+      ];
+      final sampled = downsampleLttb(points, 20);
+      expect(sampled, hasLength(20));
+      expect(sampled.first, same(points.first));
+      expect(sampled.last, same(points.last));
+      for (var i = 1; i < sampled.length; i++) {
+        expect(sampled[i].time.isAfter(sampled[i - 1].time), isTrue);
+      }
+      expect(downsampleLttb(points, 500), same(points));
+    });
+  });
+}
@@ -0,0 +1,105 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+import 'package:flutter_test/flutter_test.dart';
+
+import 'package:modern_dashboard/models/weather.dart';
+import 'package:modern_dashboard/services/weather_payload_decoder.dart';
+
+/// A /weather response with the fields the decoder skips left in
+Map<String, dynamic> _observation(int i) => {
+      'coord': {'lon': 7.4474, 'lat': 46.948},
+      'weather': [
+        {'id': 600, 'main': 'Snow', 'description': 'light snow', 'icon': '13d'},
+        {'id': 701, 'main': 'Mist', 'description': 'mist', 'icon': '50d'},
+      ],
+      'base': 'stations',
+      'main': {
+        'temp': -3.25 + i,
+        'feels_like': -6.5,
+        'temp_min': -4.1,
+        'temp_max': -2.0,
+        'pressure': 1013,
+        'humidity': 81,
+      },
+      'visibility': 8000,
+      'wind': {'speed': 4.1, 'deg': 230, 'gust': 7.2},
+      'clouds': {'all': 90},
+      'dt': 1705305600 + i * 10800,
+      'sys': {'country': 'CH', 'sunrise': 1705302000, 'sunset': 1705336000},
+      'timezone': 3600,
+      'id': 2661552,
+      'name': 'Bern',
+      'cod': 200,
+    };
+
+Uint8List _bytes(Object json) => Uint8List.fromList(utf8.encode(jsonEncode(json)));
+
+void main() {
+  group('OpenWeatherMapDecoder', () {
+    test('maps a current-weather response like the map-based parser', () {
+      final json = _observation(0);
+      final decoded = OpenWeatherMapDecoder.current(_bytes(json)).toWeatherData('metric');
+      final expected = WeatherData.fromOpenWeatherMapJson(json, 'metric');
+      expect(decoded.toJson(), expected.toJson());
+      // The first weather condition is the one shown
+      expect(decoded.description, 'light snow');
+    });
+
+    test('leaves missing and null fields to the defaults', () {
+      final observation = OpenWeatherMapDecoder.current(_bytes({
+        'coord': null,
+        'weather': [],
+        'main': {'temp': 12.5, 'humidity': null},
+        'name': 'Nowhere',
+      }));
+      expect(observation.latitude, isNull);
+      expect(observation.description, isNull);
+      expect(observation.humidity, isNull);
+      expect(observation.temperature, 12.5);
+
+      final weather = observation.toWeatherData('imperial');
+      expect(weather.id, 'unknown');
+      expect(weather.icon, '01d');
+      expect(weather.humidity, 0);
+      expect(weather.location, 'Nowhere');
+    });
+
+    test('reads every forecast entry, wherever the list is', () {
+      final entries = [
+        for (var i = 0; i < 8; i++)
+          {..._observation(i), 'dt_txt': '2024-01-15 ${(i * 3).toString().padLeft(2, '0')}:00:00'},
+      ];
+      final forecast = OpenWeatherMapDecoder.forecast(_bytes({
+        'cod': '200',
+        'city': {'name': 'Bern', 'coord': {'lat': 46.948, 'lon': 7.4474}},
+        'list': entries,
+        'cnt': entries.length,
+      }));
+      expect(forecast, hasLength(8));
+      for (var i = 0; i < entries.length; i++) {
+        expect(forecast[i].temperature, -3.25 + i);
+        expect(forecast[i].dt, entries[i]['dt']);
+        expect(forecast[i].dtText, entries[i]['dt_txt']);
+        expect(forecast[i].cloudiness, 90);
+      }
+    });
+
+    test('stops reading after the wanted forecast entries', () {
+      final bytes = _bytes({
+        'list': [for (var i = 0; i < 40; i++) _observation(i)],
+      });
+      // Cut inside the fifth entry: only a full read reaches the damage
+      final cut = Uint8List.sublistView(bytes, 0, bytes.length * 9 ~/ 80);
+      final first = OpenWeatherMapDecoder.forecast(cut, limit: 3);
+      expect(first.map((entry) => entry.temperature), [-3.25, -2.25, -1.25]);
+      expect(() => OpenWeatherMapDecoder.forecast(cut), throwsFormatException);
+    });
+
+    test('rejects an empty current-weather response', () {
+      expect(() => OpenWeatherMapDecoder.current(_bytes(null)), throwsFormatException);
+      expect(OpenWeatherMapDecoder.forecast(_bytes(null)), isEmpty);
+      expect(OpenWeatherMapDecoder.forecast(_bytes({'list': null})), isEmpty);
+    });
+  });
+}
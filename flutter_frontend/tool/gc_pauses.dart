@@ -0,0 +1,94 @@
+// Records Dart VM garbage collections while a running dashboard refreshes
+// its feeds, and prints the pause distribution per collection type.
+//
+// Build a profile bundle and start it with the runtime profile under test:
+//
+//   flutter build linux --profile
+//   build/linux/x64/profile/bundle/modern_dashboard --runtime-profile=benchmark
+//
+// The benchmark profile serves the VM service on port 8181 without an auth
+// code. For other profiles pass the service URI the engine prints at start:
+//
+//   dart run tool/gc_pauses.dart [ws://127.0.0.1:8181/ws] [refreshes]
+import 'dart:convert';
+import 'dart:io';
+
+import 'package:vm_service/vm_service.dart';
+import 'package:vm_service/vm_service_io.dart';
+
+Future<void> main(List<String> args) async {
+  final uri = args.isNotEmpty ? args[0] : 'ws://127.0.0.1:8181/ws';
+  final refreshes = args.length > 1 ? int.parse(args[1]) : 20;
+
+  final service = await vmServiceConnectUri(uri);
+  try {
+    final vm = await service.getVM();
+    final isolate = vm.isolates!.firstWhere((isolate) => isolate.name == 'main');
+
+    await service.setVMTimelineFlags(['GC']);
+    await service.clearVMTimeline();
+    final timelineStart = await service.getVMTimelineMicros();
+
+    final refreshTimes = <double>[];
+    for (var i = 0; i < refreshes; i++) {
+      final response = await service.callServiceExtension(
+        'ext.modern_dashboard.refreshFeeds',
+        isolateId: isolate.id,
+      );
+      refreshTimes.add((response.json!['elapsedMs'] as num).toDouble());
+    }
+
+    final timelineEnd = await service.getVMTimelineMicros();
+    final timeline = await service.getVMTimeline(
+      timeOriginMicros: timelineStart.timestamp,
+      timeExtentMicros: timelineEnd.timestamp! - timelineStart.timestamp!,
+    );
+
+    final pauses = _pausesByName(timeline.traceEvents ?? const []);
+    stdout.writeln('$refreshes refreshes, ${_summary(refreshTimes)}');
+    stdout.writeln('${'collection'.padRight(28)} pauses in ms');
+    for (final entry in pauses.entries) {
+      stdout.writeln('${entry.key.padRight(28)} ${_summary(entry.value)}');
+    }
+    stdout.writeln(jsonEncode({
+      'uri': uri,
+      'refreshMs': refreshTimes,
+      'pausesMs': pauses,
+    }));
+  } finally {
+    await service.dispose();
+  }
+}
+
+/// Durations in ms of the GC events, from complete events or begin/end pairs
+Map<String, List<double>> _pausesByName(List<TimelineEvent> events) {
+  final pauses = <String, List<double>>{};
+  final open = <String, List<int>>{};
+  for (final event in events) {
+    final json = event.json!;
+    if (json['cat'] != 'GC') continue;
+    final name = json['name'] as String;
+    final ts = json['ts'] as int;
+    switch (json['ph']) {
+      case 'X':
+        pauses.putIfAbsent(name, () => []).add((json['dur'] as int) / 1000);
+      case 'B':
+        open.putIfAbsent('${json['tid']}/$name', () => []).add(ts);
+      case 'E':
+        final starts = open['${json['tid']}/$name'];
+        if (starts == null || starts.isEmpty) continue;
+        pauses.putIfAbsent(name, () => []).add((ts - starts.removeLast()) / 1000);
+    }
+  }
+  return pauses;
+}
+
+String _summary(List<double> values) {
+  if (values.isEmpty) return 'none';
+  final sorted = [...values]..sort();
+  double at(double q) => sorted[((sorted.length - 1) * q).round()];
+  final total = sorted.fold<double>(0, (sum, v) => sum + v);
+  return 'n=${sorted.length} p50=${at(0.5).toStringAsFixed(2)} '
+      'p90=${at(0.9).toStringAsFixed(2)} p99=${at(0.99).toStringAsFixed(2)} '
+      'max=${sorted.last.toStringAsFixed(2)} total=${total.toStringAsFixed(1)}';
+}